@@ -0,0 +1,56 @@
+// 启动时间线：setup() 各阶段打点（距开机的微秒数），首次出数后一次性输出，定位启动慢在哪一步
+#ifndef BOOT_TIMELINE_H
+#define BOOT_TIMELINE_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+
+#define BOOT_MAX_MARKS 16
+
+struct BootMark {
+  const char *name;   // 须为字符串常量
+  uint32_t us;
+};
+
+class BootTimeline {
+ public:
+  // 时间由调用方传入（固件传 micros()，即 esp_timer 自应用启动起的微秒数）
+  void mark(const char *name, uint32_t us) {
+    if (n < BOOT_MAX_MARKS) marks[n++] = { name, us };
+  }
+
+  // 同名只记第一次（如"首个 CO2 帧"）
+  void markOnce(const char *name, uint32_t us) {
+    if (find(name) < 0) mark(name, us);
+  }
+
+  int find(const char *name) const {
+    for (uint8_t i = 0; i < n; i++)
+      if (!strcmp(marks[i].name, name)) return i;
+    return -1;
+  }
+
+  uint8_t count() const { return n; }
+  const BootMark &at(uint8_t i) const { return marks[i]; }
+  uint32_t elapsedUs() const { return n ? marks[n - 1].us : 0; }
+
+  // 逐条格式化："<name> @<ms>.<1>ms +<delta>ms"，每条回调一次
+  template <typename Fn>
+  void forEachLine(Fn fn) const {
+    char line[64];
+    for (uint8_t i = 0; i < n; i++) {
+      uint32_t d = i ? marks[i].us - marks[i - 1].us : marks[i].us;
+      snprintf(line, sizeof(line), "%-12s @%5lu.%lums +%lu.%lums", marks[i].name, (unsigned long)(marks[i].us / 1000),
+               (unsigned long)(marks[i].us % 1000 / 100), (unsigned long)(d / 1000), (unsigned long)(d % 1000 / 100));
+      fn(line);
+    }
+  }
+
+ private:
+  BootMark marks[BOOT_MAX_MARKS];
+  uint8_t n = 0;
+};
+
+#endif // BOOT_TIMELINE_H
@@ -2,7 +2,7 @@
 #ifndef CO2_CRC_H
 #define CO2_CRC_H
 
-#include <Arduino.h>
+#include <stdint.h>
 
 static const uint8_t auchCRCHi[] = {
   0x00, 0xC1, 0x81, 0x40, 0x01, 0xC0, 0x80, 0x41, 0x01, 0xC0, 0x80, 0x41, 0x00, 0xC1, 0x81, 0x40,
@@ -42,7 +42,7 @@ static const uint8_t auchCRCLo[] = {
   0x44, 0x84, 0x85, 0x45, 0x87, 0x47, 0x46, 0x86, 0x82, 0x42, 0x43, 0x83, 0x41, 0x81, 0x80, 0x40
 };
 
-static inline uint16_t modbus_calcuCRC(uint8_t *dataArray, uint16_t dataLen) {
+static inline uint16_t modbus_calcuCRC(const uint8_t *dataArray, uint16_t dataLen) {
   uint8_t uchCRCHi = 0xFF;  // CRC高字节初始化（固定值）
   uint8_t uchCRCLo = 0xFF;  // CRC低字节初始化（固定值）
   uint16_t uIndex;          // CRC表索引
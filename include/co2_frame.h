@@ -0,0 +1,72 @@
+// CO2 传感器 16 字节被动输出帧的校验与解析
+#ifndef CO2_FRAME_H
+#define CO2_FRAME_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+// 帧格式：
+// BYTE0=0x42, BYTE1=0x4D, BYTE2..BYTE14=数据内容, BYTE15= (BYTE0+...+BYTE14) & 0xFF
+// CO2 浓度 = BYTE6 * 256 + BYTE7
+#define CO2_FRAME_LEN   16
+#define CO2_FRAME_HDR0  0x42
+#define CO2_FRAME_HDR1  0x4D
+
+static inline bool co2FrameHeaderOk(const uint8_t *f) {
+  return f[0] == CO2_FRAME_HDR0 && f[1] == CO2_FRAME_HDR1;
+}
+
+// 累加校验（低 8 位）
+static inline uint8_t co2FrameChecksum(const uint8_t *f) {
+  uint16_t sum = 0;
+  for (int i = 0; i < CO2_FRAME_LEN - 1; ++i) sum += f[i];
+  return (uint8_t)(sum & 0xFF);
+}
+
+static inline bool co2FrameValid(const uint8_t *f) {
+  return co2FrameHeaderOk(f) && co2FrameChecksum(f) == f[CO2_FRAME_LEN - 1];
+}
+
+static inline uint16_t co2FramePpm(const uint8_t *f) {
+  return ((uint16_t)f[6] << 8) | f[7];
+}
+
+// 串口字节流 -> 帧头对齐的 16 字节帧；不做校验（交给 SamplePipeline），缓冲区满时丢弃新字节
+struct Co2FrameParser {
+  uint8_t buf[64];
+  size_t len = 0;
+  uint32_t skipped = 0;    // 重同步时丢弃的字节
+  uint32_t overflow = 0;   // 缓冲区满丢弃的字节
+
+  bool push(uint8_t b) {
+    if (len < sizeof(buf)) { buf[len++] = b; return true; }
+    overflow++;
+    return false;
+  }
+
+  size_t feed(const uint8_t *p, size_t n) {
+    size_t k = 0;
+    while (n--) k += push(*p++);
+    return k;
+  }
+
+  // 取出下一帧，没有完整帧时返回 false
+  bool next(uint8_t *frame) {
+    while (len >= CO2_FRAME_LEN) {
+      if (!co2FrameHeaderOk(buf)) {
+        memmove(buf, buf + 1, len - 1);
+        len -= 1;
+        skipped++;
+        continue;
+      }
+      memcpy(frame, buf, CO2_FRAME_LEN);
+      if (len > CO2_FRAME_LEN) memmove(buf, buf + CO2_FRAME_LEN, len - CO2_FRAME_LEN);
+      len -= CO2_FRAME_LEN;
+      return true;
+    }
+    return false;
+  }
+};
+
+#endif // CO2_FRAME_H
@@ -0,0 +1,272 @@
+// 延迟日志：热路径把格式化好的一行写入无锁环形缓冲，由低优先级任务慢慢发到串口
+#ifndef DEFERRED_LOG_H
+#define DEFERRED_LOG_H
+
+#include <stdint.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+#include <atomic>
+#if defined(ARDUINO_ARCH_ESP32)
+#include <Arduino.h>
+#endif
+
+// 9600 波特率下每字节约 1 ms，直接 Serial.print 会让 loop() 阻塞在发送上。
+// 这里生产者只做一次有界格式化（最多 LOG_SLOT_TEXT 字节）和一次 CAS，满了就丢弃并计数，
+// 永不等待；唯一的消费者（drain 任务）负责按顺序写出。
+// 环形队列为有界 MPSC（每槽一个序号），可在多个任务中同时写入。
+
+#define LOG_LEVEL_DEBUG 0
+#define LOG_LEVEL_INFO  1
+#define LOG_LEVEL_WARN  2
+#define LOG_LEVEL_ERROR 3
+#define LOG_LEVEL_NONE  4
+
+// 编译期阈值：低于该级别的 LOGx 调用连同参数求值一起被删除
+#ifndef LOG_LEVEL
+#define LOG_LEVEL LOG_LEVEL_INFO
+#endif
+
+#ifndef LOG_RING_SLOTS
+#define LOG_RING_SLOTS 32            // 必须是 2 的幂
+#endif
+#define LOG_SLOT_TEXT  152           // 每条记录的最大字节数（含换行），可容纳一条完整 trace 行
+
+#define LOG_ENABLED(lv) ((lv) >= LOG_LEVEL)
+
+struct DeferredLogStats {
+  uint32_t written = 0;      // 已完整写出的记录
+  uint32_t dropped = 0;      // 缓冲满被丢弃的记录
+  uint32_t truncated = 0;    // 超过 LOG_SLOT_TEXT 被截断的记录
+  uint32_t highWater = 0;    // 队列最大深度
+};
+
+class DeferredLog {
+ public:
+  DeferredLog() {
+    for (uint32_t i = 0; i < LOG_RING_SLOTS; i++) slots[i].seq.store(i, std::memory_order_relaxed);
+  }
+
+  // 格式化一行（自动补换行），缓冲满时返回 false
+  bool printf(uint8_t level, const char *fmt, ...) __attribute__((format(printf, 3, 4))) {
+    va_list ap;
+    va_start(ap, fmt);
+    bool ok = vprintf(level, fmt, ap);
+    va_end(ap);
+    return ok;
+  }
+
+  bool vprintf(uint8_t level, const char *fmt, va_list ap) {
+    uint32_t pos;
+    Slot *s = reserve(pos);
+    if (!s) return false;
+    int n = vsnprintf(s->text, LOG_SLOT_TEXT, fmt, ap);
+    size_t len = n < 0 ? 0 : (size_t)n;
+    if (len > LOG_SLOT_TEXT - 2) { len = LOG_SLOT_TEXT - 2; truncated.fetch_add(1, std::memory_order_relaxed); }
+    s->text[len++] = '\n';
+    s->len = (uint8_t)len;
+    s->level = level;
+    publish(s, pos);
+    return true;
+  }
+
+  // 原样写入一段已格式化文本（不补换行），用于 trace 行等已带换行的内容
+  bool write(uint8_t level, const char *text, size_t n) {
+    uint32_t pos;
+    Slot *s = reserve(pos);
+    if (!s) return false;
+    if (n <= LOG_SLOT_TEXT) {
+      memcpy(s->text, text, n);
+      s->len = (uint8_t)n;
+    } else {
+      memcpy(s->text, text, LOG_SLOT_TEXT - 1);
+      s->text[LOG_SLOT_TEXT - 1] = '\n';
+      s->len = LOG_SLOT_TEXT;
+      truncated.fetch_add(1, std::memory_order_relaxed);
+    }
+    s->level = level;
+    publish(s, pos);
+    return true;
+  }
+
+  // 由唯一消费者调用：最多写出 budget 字节，返回实际写出字节数。
+  // Out 需提供 write(const uint8_t*, size_t)（Arduino Print 即可）；记录可跨多次调用分段写出。
+  template <typename Out>
+  size_t drain(Out &out, size_t budget) {
+    size_t sent = 0;
+    while (sent < budget) {
+      if (!curLeft && !loadNext()) break;
+      size_t k = curLeft < budget - sent ? curLeft : budget - sent;
+      out.write((const uint8_t *)curP, k);
+      curP += k; curLeft -= k; sent += k;
+      if (!curLeft) releaseCurrent();
+    }
+    return sent;
+  }
+
+  template <typename Out>
+  size_t drainAll(Out &out) {
+    size_t total = 0, n;
+    while ((n = drain(out, 256)) > 0) total += n;
+    return total;
+  }
+
+  // 任意任务可调用：tail 只属于消费者，这里读它的原子副本，结果是近似值（生产者并发写入时可能偏大）
+  uint32_t depth() const {
+    return head.load(std::memory_order_relaxed) - tailShadow.load(std::memory_order_relaxed);
+  }
+
+  DeferredLogStats getStats() const {
+    DeferredLogStats st;
+    st.written = written;
+    st.dropped = dropped.load(std::memory_order_relaxed);
+    st.truncated = truncated.load(std::memory_order_relaxed);
+    st.highWater = highWater.load(std::memory_order_relaxed);
+    return st;
+  }
+
+ private:
+  struct Slot {
+    std::atomic<uint32_t> seq;   // == 位置：空闲可写；== 位置+1：已发布可读
+    uint8_t level;
+    uint8_t len;
+    char text[LOG_SLOT_TEXT];
+  };
+
+  Slot *reserve(uint32_t &pos) {
+    pos = head.load(std::memory_order_relaxed);
+    for (;;) {
+      Slot *s = &slots[pos & (LOG_RING_SLOTS - 1)];
+      int32_t diff = (int32_t)(s->seq.load(std::memory_order_acquire) - pos);
+      if (diff == 0) {
+        if (head.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+          uint32_t d = pos + 1 - tailShadow.load(std::memory_order_relaxed);
+          uint32_t hw = highWater.load(std::memory_order_relaxed);
+          while (d > hw && !highWater.compare_exchange_weak(hw, d, std::memory_order_relaxed)) {}
+          return s;
+        }
+      } else if (diff < 0) {
+        dropped.fetch_add(1, std::memory_order_relaxed);
+        return nullptr;
+      } else {
+        pos = head.load(std::memory_order_relaxed);
+      }
+    }
+  }
+
+  void publish(Slot *s, uint32_t pos) { s->seq.store(pos + 1, std::memory_order_release); }
+
+  bool loadNext() {
+    // 丢弃计数有变化时先插入一行说明，让日志中的缺口可见
+    uint32_t d = dropped.load(std::memory_order_relaxed);
+    if (d != dropReported) {
+      int n = snprintf(note, sizeof(note), "[log] dropped %lu\n", (unsigned long)(d - dropReported));
+      dropReported = d;
+      curP = note; curLeft = n > 0 ? (size_t)n : 0; curSlot = nullptr;
+      if (curLeft) return true;
+    }
+    Slot *s = &slots[tail & (LOG_RING_SLOTS - 1)];
+    if (s->seq.load(std::memory_order_acquire) != tail + 1) return false;
+    curSlot = s; curP = s->text; curLeft = s->len;
+    if (!curLeft) releaseCurrent();
+    return curLeft > 0 || loadNext();
+  }
+
+  void releaseCurrent() {
+    if (!curSlot) return;
+    curSlot->seq.store(tail + LOG_RING_SLOTS, std::memory_order_release);
+    tail++;
+    tailShadow.store(tail, std::memory_order_relaxed);
+    written++;
+    curSlot = nullptr;
+  }
+
+  Slot slots[LOG_RING_SLOTS];
+  std::atomic<uint32_t> head{0};
+  std::atomic<uint32_t> tailShadow{0};   // 仅用于生产者估算深度
+  std::atomic<uint32_t> dropped{0};
+  std::atomic<uint32_t> truncated{0};
+  std::atomic<uint32_t> highWater{0};
+  // 以下仅消费者访问
+  uint32_t tail = 0;
+  uint32_t written = 0;
+  uint32_t dropReported = 0;
+  Slot *curSlot = nullptr;
+  const char *curP = nullptr;
+  size_t curLeft = 0;
+  char note[32];
+};
+
+// 全局实例由使用方定义（固件在 main.cpp，主机基准在 bench_log.cpp）
+extern DeferredLog deferredLog;
+
+#if LOG_ENABLED(LOG_LEVEL_DEBUG)
+#define LOGD(...) deferredLog.printf(LOG_LEVEL_DEBUG, __VA_ARGS__)
+#else
+#define LOGD(...) ((void)0)
+#endif
+#if LOG_ENABLED(LOG_LEVEL_INFO)
+#define LOGI(...) deferredLog.printf(LOG_LEVEL_INFO, __VA_ARGS__)
+#else
+#define LOGI(...) ((void)0)
+#endif
+#if LOG_ENABLED(LOG_LEVEL_WARN)
+#define LOGW(...) deferredLog.printf(LOG_LEVEL_WARN, __VA_ARGS__)
+#else
+#define LOGW(...) ((void)0)
+#endif
+#if LOG_ENABLED(LOG_LEVEL_ERROR)
+#define LOGE(...) deferredLog.printf(LOG_LEVEL_ERROR, __VA_ARGS__)
+#else
+#define LOGE(...) ((void)0)
+#endif
+
+// 十六进制转储到 out（"42 4D ..."），返回写入长度；配合 LOG_ENABLED 使用，级别关闭时不执行
+static inline size_t logHex(char *out, size_t cap, const uint8_t *p, size_t n) {
+  static const char hexd[] = "0123456789ABCDEF";
+  size_t k = 0;
+  for (size_t i = 0; i < n && k + 4 <= cap; i++) {
+    out[k++] = hexd[p[i] >> 4];
+    out[k++] = hexd[p[i] & 0xF];
+    out[k++] = ' ';
+  }
+  if (cap) out[k < cap ? k : cap - 1] = 0;
+  return k;
+}
+
+#if defined(ARDUINO_ARCH_ESP32)
+// drain 任务：固定在 core 0，串口发送阻塞时只让出 CPU，不占用渲染所在的 core 1；
+// DUAL_CORE 下采集任务也在 core 0 且优先级更高（3 对 1），日志输出不会推迟采集
+static void deferredLogTask(void *arg) {
+  Print *out = (Print *)arg;
+  for (;;) {
+    if (!deferredLog.drain(*out, 64)) vTaskDelay(pdMS_TO_TICKS(5));
+  }
+}
+
+static inline bool deferredLogStart(Print &out, UBaseType_t prio = 1) {
+  return xTaskCreatePinnedToCore(deferredLogTask, "log", 3072, &out, prio, nullptr, 0) == pdPASS;
+}
+#else
+// 主机端（native_sim）：没有日志任务，仿真主循环在每次 loop() 之后调用 deferredLogPump()，
+// budget 按串口波特率与经过的虚拟时间给出，9600 波特率下的积压与丢弃和板上一致
+struct DeferredLogHostSink {
+  void *out = nullptr;
+  size_t (*drain)(void *out, size_t budget) = nullptr;
+};
+inline DeferredLogHostSink deferredLogHostSink;
+
+template <typename Out>
+static inline bool deferredLogStart(Out &out, int prio = 1) {
+  (void)prio;
+  deferredLogHostSink.out = &out;
+  deferredLogHostSink.drain = [](void *o, size_t budget) { return deferredLog.drain(*(Out *)o, budget); };
+  return true;
+}
+
+static inline size_t deferredLogPump(size_t budget = SIZE_MAX) {
+  return deferredLogHostSink.drain ? deferredLogHostSink.drain(deferredLogHostSink.out, budget) : 0;
+}
+#endif
+
+#endif // DEFERRED_LOG_H
@@ -1,113 +1,279 @@
-// 优化版显示助手 - 位级更新，日期低频率更新
+// 优化版显示助手 - 位级更新，日期只在跨日时更新
 #ifndef DISPLAY_OPTIMIZED_H
 #define DISPLAY_OPTIMIZED_H
 
 #include <Arduino.h>
 #include <ST7789_AVR.h>
+#include <stddef.h>
+#include "wall_clock.h"
+#if ST7789_LINEBUF
+#include <rgb565_compose.h>
+#endif
 
 extern ST7789_AVR tft;
 extern uint8_t gFirstLineSize;
 extern uint8_t gOtherLineSize;
 extern bool layoutInited;
 
-// 显示状态记录
-struct DisplayState {
-  String date = "";
-  uint32_t co2 = 0;
-  float temp = 0;
-  float hum = 0;
-  String co2Str = "----";
-  String tempStr = "--.-";
-  String humStr = "--.-";
-  unsigned long lastDateUpdate = 0; // 上次日期更新时间
+// ---- 控件表 ----
+// 屏上每一行是一个控件：标签（左，x=DISPLAY_LABEL_X）、数值（按对齐方式放置，位级更新）、单位（单位列，xUnit 起）。
+// 加一行（PM2.5、TVOC……）或改字号只需改这张表、DisplayWidgetId 和 updateDisplay 传入的数值；布局在 computeDisplayLayout 里按表一次算好，
+// 初始画面、位级更新、告警横幅合成和暖复位保留都按表走。第 0 行是标题（日期），其下画分割线。
+enum DisplayWidgetId : uint8_t { DW_DATE = 0, DW_CO2, DW_TEMP, DW_HUM, DW_COUNT };
+enum DisplayFont : uint8_t { DFONT_TITLE, DFONT_DATA };       // gFirstLineSize / gOtherLineSize
+enum DisplayAlign : uint8_t { DALIGN_CENTER, DALIGN_RIGHT };  // 整屏居中 / 右对齐到单位列左侧
+
+#define DISPLAY_LABEL_X    6
+#define DISPLAY_VALUE_GAP  (6 * 2)  // 数值与单位列之间的空隙（像素）
+#define DISPLAY_UNIT_CHARS 7        // 单位列宽（数据字号的字符数）
+#define DISPLAY_TEXT_CAP   12       // 数值文字上限（含结尾 0），暖复位保留按此定长
+
+struct DisplayWidget {
+  const char *label;        // 标签，nullptr 为无
+  const char *unit;         // 单位，nullptr 为无
+  bool degree;              // 单位前画度符号（单位文字右移 8 像素）
+  uint16_t color;
+  uint8_t font;             // DisplayFont
+  uint8_t align;            // DisplayAlign
+  uint8_t maxChars;         // 数值最长字符数
+  const char *placeholder;  // 还没有读数时显示；nullptr 表示开机即有值（日期，取 initDisplayLayout 的 day）
+  String (*format)(float v);
+  uint8_t tag;              // DisplayCostTag
+};
+
+static inline String displayFmtDate(float day) {
+  char buf[11];
+  wallFormatDate(buf, (int32_t)day);
+  return String(buf);
+}
+static inline String displayFmtInt(float v) { return String((uint32_t)v); }
+static inline String displayFmtFixed1(float v) { return String(v, 1); }
+
+// 渲染开销按行归类（ST7789_AVR::setCostTag），驱动按图元/标签累计字节、地址窗口、事务与耗时
+enum DisplayCostTag : uint8_t { DTAG_NONE = 0, DTAG_LAYOUT, DTAG_DATE, DTAG_CO2, DTAG_TEMP, DTAG_HUM, DTAG_ALERT, DTAG_COUNT };
+
+static inline const char *displayTagName(uint8_t t) {
+  static const char *const names[DTAG_COUNT] = { "other", "layout", "date", "co2", "temp", "hum", "alert" };
+  return t < DTAG_COUNT ? names[t] : "?";
+}
+
+static_assert(DTAG_COUNT <= ST_TAG_COUNT, "display cost tags exceed ST_TAG_COUNT");
+
+static constexpr DisplayWidget kDisplayWidgets[DW_COUNT] = {
+  //  label     unit   deg    color    font         align          max  placeholder  format            tag
+  { nullptr,  nullptr, false, WHITE,   DFONT_TITLE, DALIGN_CENTER, 10,  nullptr,     displayFmtDate,   DTAG_DATE },
+  { "CO2 : ", "ppm",   false, YELLOW,  DFONT_DATA,  DALIGN_RIGHT,  5,   "----",      displayFmtInt,    DTAG_CO2 },
+  { "Temp: ", "C",     true,  CYAN,    DFONT_DATA,  DALIGN_RIGHT,  5,   "--.-",      displayFmtFixed1, DTAG_TEMP },
+  { "Humi: ", "%",     false, MAGENTA, DFONT_DATA,  DALIGN_RIGHT,  5,   "--.-",      displayFmtFixed1, DTAG_HUM },
 };
 
+static constexpr size_t displayStrLen(const char *s) { return s && *s ? 1 + displayStrLen(s + 1) : 0; }
+static constexpr bool displayWidgetsFit(uint8_t i = 0) {
+  return i >= DW_COUNT ||
+         (kDisplayWidgets[i].maxChars < DISPLAY_TEXT_CAP &&
+          displayStrLen(kDisplayWidgets[i].placeholder) <= kDisplayWidgets[i].maxChars &&
+          displayStrLen(kDisplayWidgets[i].unit) + (kDisplayWidgets[i].degree ? 2 : 0) <= DISPLAY_UNIT_CHARS &&
+          (i == DW_DATE ? kDisplayWidgets[i].placeholder == nullptr : kDisplayWidgets[i].placeholder != nullptr) &&
+          displayWidgetsFit(i + 1));
+}
+static_assert(displayWidgetsFit(), "display widget table: value, placeholder or unit does not fit");
+
+static inline uint8_t displayFontSize(uint8_t font) { return font == DFONT_TITLE ? gFirstLineSize : gOtherLineSize; }
+
+// 布局（computeDisplayLayout 按控件表填写）
+struct DisplayLayout {
+  int16_t y[DW_COUNT];  // 各行顶部
+  int16_t yLine;        // 标题下的分割线
+  int16_t xUnit;        // 单位列左边界
+  int16_t spacing;      // 行距
+};
+
+static inline DisplayLayout &displayLayout() {
+  static DisplayLayout layout;
+  return layout;
+}
+
+// 显示状态记录：屏上每个控件的数值与文字
+struct DisplayState {
+  float val[DW_COUNT];              // 日期为天数（自 1970-01-01）；无占位的控件初始为 NAN，首次必画
+  String text[DW_COUNT];
+  bool alert = false;               // CO2 告警横幅在屏上
+  DisplayState() {
+    for (uint8_t i = 0; i < DW_COUNT; i++) {
+      val[i] = kDisplayWidgets[i].placeholder ? 0.0f : NAN;
+      text[i] = kDisplayWidgets[i].placeholder ? kDisplayWidgets[i].placeholder : "";
+    }
+  }
+};
 
 extern DisplayState displayState;
-extern int16_t yDate, yLine, yCo2, yTemp, yHum, xUnit;
 
-// 初始化布局（只绘制静态内容）
-static inline void initDisplayLayout(const String& date) {
+
+// 一次 updateDisplay 的开销：合计与按行（ST7789_STATS 为 0 时全为 0）
+struct DisplayFrameCost {
+  ST7789Cost total;
+  ST7789Cost row[DTAG_COUNT];
+};
+
+// "bytes=.. win=.. txn=.. us=.." 形式
+static inline int displayCostFormat(char *out, size_t cap, const ST7789Cost &c) {
+  return snprintf(out, cap, "bytes=%lu win=%lu txn=%lu calls=%lu us=%lu", (unsigned long)c.bytes,
+                  (unsigned long)c.windows, (unsigned long)c.transactions, (unsigned long)c.calls, (unsigned long)c.us);
+}
+
+// 单行摘要：合计 + 有开销的行（"co2:bytes/us"）
+static inline size_t displayFrameCostLine(char *out, size_t cap, const DisplayFrameCost &fc) {
+  int k = displayCostFormat(out, cap, fc.total);
+  for (uint8_t t = 0; t < DTAG_COUNT && k > 0 && (size_t)k < cap; t++) {
+    if (!fc.row[t].calls) continue;
+    k += snprintf(out + k, cap - k, " %s:%lu/%luus", displayTagName(t), (unsigned long)fc.row[t].bytes,
+                  (unsigned long)fc.row[t].us);
+  }
+  return k < 0 ? 0 : ((size_t)k < cap ? (size_t)k : cap - 1);
+}
+
+// 抗锯齿数字：数值与日期字符用 drawCharAA 整格刷新（一个地址窗口，4 位覆盖度经 LUT 混到黑底），
+// 总线字节不超过"清格 + 逐点画字"；运行时可切换（busgolden 用它对比两种画法的预算）
+#ifndef DISPLAY_AA_TEXT
+#define DISPLAY_AA_TEXT 0
+#endif
+static inline bool &displayAaText() {
+  static bool on = DISPLAY_AA_TEXT && ST7789_LINEBUF;
+  return on;
+}
+
+// 数值/日期文字：抗锯齿时逐字整格画，否则按经典字体打印；cleared=底色已是黑（刚清屏），抗锯齿只画有墨部分
+static inline void displayPrintValue(int16_t x, int16_t y, uint16_t color, const char *s, uint8_t size,
+                                     bool cleared = false) {
+#if ST7789_LINEBUF
+  if (displayAaText()) {
+    for (; *s; s++, x += 6 * size) tft.drawCharAA(x, y, (unsigned char)*s, color, BLACK, size, cleared);
+    return;
+  }
+#endif
+  tft.setTextSize(size);
+  tft.setTextColor(color);
+  tft.setCursor(x, y);
+  tft.print(s);
+}
+
+// CO2 告警横幅：超过 DISPLAY_ALERT_PPM 时在湿度行上叠一条半透明红色横幅写 "VENTILATE"，低于阈值减回差后撤掉。
+// 横幅按行合成（drawRows）：黑底 + 该行控件（与屏上同一字体重建）-> 红色按 alpha 着色 -> 抗锯齿白字，不需要帧缓冲
+#if !ST7789_LINEBUF
+#undef DISPLAY_ALERT
+#define DISPLAY_ALERT 0
+#endif
+#ifndef DISPLAY_ALERT
+#define DISPLAY_ALERT 1
+#endif
+#define DISPLAY_ALERT_SRC   DW_CO2   // 看哪个控件的数值
+#define DISPLAY_ALERT_ROW   DW_HUM   // 横幅盖在哪一行
+#define DISPLAY_ALERT_PPM   1500
+#define DISPLAY_ALERT_HYST  100
+#define DISPLAY_ALERT_ALPHA 176
+#define DISPLAY_ALERT_COLOR RED
+#define DISPLAY_ALERT_TEXT  "VENTILATE"
+
+// 计算各行位置（不绘制）；暖复位恢复时屏上已有布局，只需要这些坐标。
+// 行距 = 余下高度均分到各行上下；标题与分割线之间只留半个行距
+static inline void computeDisplayLayout() {
+  DisplayLayout &l = displayLayout();
+  uint16_t w = tft.width(), h = tft.height();
+  int16_t used = 2;  // 分割线
+  for (uint8_t i = 0; i < DW_COUNT; i++) used += 8 * displayFontSize(kDisplayWidgets[i].font);
+  l.spacing = (h - used) / (DW_COUNT + 1);
+
+  int16_t y = l.spacing;
+  for (uint8_t i = 0; i < DW_COUNT; i++) {
+    l.y[i] = y;
+    y += 8 * displayFontSize(kDisplayWidgets[i].font);
+    if (i == DW_DATE) {
+      l.yLine = y + l.spacing / 2;
+      y = l.yLine + 2 + l.spacing;
+    } else {
+      y += l.spacing;
+    }
+  }
+  l.xUnit = w - DISPLAY_UNIT_CHARS * 6 * gOtherLineSize;
+}
+
+// 控件数值的左边界（len 个字符）
+static inline int16_t displayValueX(uint8_t id, uint16_t len) {
+  const DisplayWidget &wd = kDisplayWidgets[id];
+  int16_t textW = (int16_t)len * 6 * displayFontSize(wd.font);
+  int16_t x = wd.align == DALIGN_CENTER ? (tft.width() - textW) / 2 : displayLayout().xUnit - textW - DISPLAY_VALUE_GAP;
+  return x < 0 ? 0 : x;
+}
+
+// 度符号（6x6 圆环）上的点
+static inline bool displayDegreeDot(int dx, int dy) {
+  int rx = dx - 3, ry = dy - 3;
+  return rx * rx + ry * ry >= 3 && rx * rx + ry * ry <= 6;
+}
+
+// 画一个控件的整行：标签、单位（静态）和当前数值；cleared=该行底色已是黑
+static inline void displayWidgetDraw(uint8_t id, bool cleared) {
+  const DisplayWidget &wd = kDisplayWidgets[id];
+  const DisplayLayout &l = displayLayout();
+  const uint8_t sz = displayFontSize(wd.font);
+  const int16_t y = l.y[id];
+  const String &text = displayState.text[id];
+  tft.setTextSize(sz);
+  tft.setTextColor(wd.color);
+  if (wd.label) {
+    tft.setCursor(DISPLAY_LABEL_X, y);
+    tft.print(wd.label);
+  }
+  displayPrintValue(displayValueX(id, text.length()), y, wd.color, text.c_str(), sz, cleared);
+  if (wd.degree) {
+    for (int dy = 0; dy < 6; dy++)
+      for (int dx = 0; dx < 6; dx++)
+        if (displayDegreeDot(dx, dy)) tft.drawPixel(l.xUnit + dx, y + dy, wd.color);
+  }
+  if (wd.unit) {
+    tft.setCursor(l.xUnit + (wd.degree ? 8 : 0), y);
+    tft.print(wd.unit);
+  }
+}
+
+// 初始化布局：清屏后按控件表画出每一行（有占位的显示占位，日期按 day 显示）
+static inline void initDisplayLayout(int32_t day) {
   if (layoutInited) return;
   
-  uint16_t w = tft.width(), h = tft.height();
+  tft.setCostTag(DTAG_LAYOUT);
+  uint16_t w = tft.width();
   tft.fillScreen(BLACK);
-  // tft.fillRect(0,0,w,h,GREEN);
   
   // 计算布局
-  uint8_t titleH = 8 * gFirstLineSize;
-  uint8_t dataH = 8 * gOtherLineSize;
-  int16_t spacing = (h - (titleH + 3 * dataH + 2)) / 5;
-  
-  yDate = spacing;
-  yLine = yDate + titleH + spacing/2;
-  yCo2 = yLine + 2 + spacing;
-  yTemp = yCo2 + dataH + spacing;
-  yHum = yTemp + dataH + spacing;
-  xUnit = w - 7 * 6 * gOtherLineSize; // 单位固定位置,6个字符
+  computeDisplayLayout();
+  const DisplayLayout &l = displayLayout();
   
-  // 绘制静态标签和单位（只绘制一次）
-  tft.setTextSize(gFirstLineSize);
-  tft.setTextColor(WHITE);
-  int16_t dateX = (w - date.length() * 6 * gFirstLineSize) / 2;
-  tft.setCursor(dateX < 0 ? 0 : dateX, yDate);
-  tft.print(date);
-  displayState.date = date;
-  
-  // 分割线
-  tft.drawFastHLine(0, yLine, w, GREY);
-  tft.drawFastHLine(0, yLine+1, w, GREY);
-  
-  // 数据行标签和单位（静态，只绘制一次）
-  tft.setTextSize(gOtherLineSize);
-  
-  // CO2行
-  tft.setCursor(6, yCo2); 
-  tft.setTextColor(YELLOW); 
-  tft.print("CO2 : ");
-  int16_t co2InitX = xUnit - 4 * 6 * gOtherLineSize - 6 * 2; // 初始显示位置
-  tft.setCursor(co2InitX, yCo2);
-  tft.print("----"); // 初始显示"----"
-  tft.setCursor(xUnit, yCo2); 
-  tft.print("ppm");
-  
-  
-  // 温度行
-  tft.setCursor(6, yTemp); 
-  tft.setTextColor(CYAN); 
-  tft.print("Temp: ");
-  tft.setCursor(xUnit, yTemp);
-  int16_t tempInitX = xUnit - 4 * 6 * gOtherLineSize - 6 * 2; // 初始显示位置
-  tft.setCursor(tempInitX, yTemp);
-  tft.print("--.-"); // 初始显示"--.-"
-  // 温度度符号
-  for (int dy = 0; dy < 6; dy++) {
-    for (int dx = 0; dx < 6; dx++) {
-      int rx = dx-3, ry = dy-3;
-      if (rx*rx + ry*ry >= 3 && rx*rx + ry*ry <= 6) {
-        tft.drawPixel(xUnit+dx, yTemp+dy, CYAN);
-      }
+  for (uint8_t i = 0; i < DW_COUNT; i++) {
+    if (!kDisplayWidgets[i].placeholder) {
+      displayState.val[i] = (float)day;
+      displayState.text[i] = kDisplayWidgets[i].format((float)day);
+    }
+    displayWidgetDraw(i, true);
+    if (i == DW_DATE) {
+      // 分割线
+      tft.drawFastHLine(0, l.yLine, w, GREY);
+      tft.drawFastHLine(0, l.yLine + 1, w, GREY);
     }
   }
-  tft.setCursor(xUnit+8, yTemp); 
-  tft.print("C");
-  
-  // 湿度行
-  tft.setCursor(6, yHum); 
-  tft.setTextColor(MAGENTA); 
-  tft.print("Humi: ");
-  int16_t humInitX = xUnit - 4 * 6 * gOtherLineSize - 6 * 2; // 初始显示位置
-  tft.setCursor(humInitX, yHum);
-  tft.print("--.-"); // 初始显示"--.-"
-  tft.setCursor(xUnit, yHum); 
-  tft.print("%");
   
+  tft.setCostTag(DTAG_NONE);
   layoutInited = true;
 }
 
 // 更新单个字符（位级更新）
 static inline void updateChar(int16_t x, int16_t y, uint16_t color, char oldChar, char newChar, uint8_t textSize = 1) {
   if (oldChar != newChar) {
+#if ST7789_LINEBUF
+    if (displayAaText()) {
+      tft.drawCharAA(x, y, newChar, color, BLACK, textSize);
+      return;
+    }
+#endif
     int charW = 6 * textSize;
     int charH = 8 * textSize;
     tft.fillRect(x, y, charW, charH, BLACK);
@@ -117,78 +283,239 @@ static inline void updateChar(int16_t x, int16_t y, uint16_t color, char oldChar
   }
 }
 
-// 更新数值显示（位级更新）
-static inline void updateValue(int16_t x, int16_t y, uint16_t color, const String& oldStr, const String& newStr, uint8_t textSize) {
+// 新旧数值合起来占的列 [x0, x1)；长度相同时只取变化的字符
+static inline void displayValueSpan(uint8_t id, const String &oldStr, const String &newStr, int16_t &x0, int16_t &x1) {
+  const int16_t charW = 6 * displayFontSize(kDisplayWidgets[id].font);
+  int16_t ox = displayValueX(id, oldStr.length()), nx = displayValueX(id, newStr.length());
+  x0 = min(ox, nx);
+  x1 = max(ox + (int16_t)oldStr.length() * charW, nx + (int16_t)newStr.length() * charW);
+  if (oldStr.length() == newStr.length() && oldStr != newStr) {
+    int16_t first = 0, last = newStr.length() - 1;
+    while (oldStr[first] == newStr[first]) first++;
+    while (oldStr[last] == newStr[last]) last--;
+    x0 = nx + first * charW;
+    x1 = nx + (last + 1) * charW;
+  }
+}
+
+// 更新控件数值（位级更新）
+static inline void updateValue(uint8_t id, const String& oldStr, const String& newStr) {
+  const DisplayWidget &wd = kDisplayWidgets[id];
+  const uint8_t textSize = displayFontSize(wd.font);
+  const int16_t y = displayLayout().y[id];
   int charW = 6 * textSize;
   int charH = 8 * textSize;
-  // int maxChars = 6; // 最大字符数
+  int16_t x = displayValueX(id, newStr.length());
   
   if (oldStr.length() != newStr.length()) {
     // 长度变化，整块更新
-    int maxChars = max(oldStr.length(), newStr.length())  * charW;
-    tft.fillRect(xUnit - maxChars - 6 * 2, y, maxChars, charH, BLACK);
-    tft.setTextColor(color);
+    int16_t x0, x1;
+    displayValueSpan(id, oldStr, newStr, x0, x1);
+#if ST7789_LINEBUF
+    if (displayAaText()) {
+      // 新字符整格覆盖，只清两侧空出的部分
+      int16_t xEnd = x + (int16_t)newStr.length() * charW;
+      if (x > x0) tft.fillRect(x0, y, x - x0, charH, BLACK);
+      if (x1 > xEnd) tft.fillRect(xEnd, y, x1 - xEnd, charH, BLACK);
+      displayPrintValue(x, y, wd.color, newStr.c_str(), textSize);
+      return;
+    }
+#endif
+    tft.fillRect(x0, y, x1 - x0, charH, BLACK);
+    tft.setTextColor(wd.color);
     tft.setCursor(x, y);
     tft.print(newStr);
   } else {
     // 长度相同，逐字符更新
-    for (int i = 0; i < newStr.length(); i++) {
+    for (unsigned i = 0; i < newStr.length(); i++) {
       if (oldStr[i] != newStr[i]) {
-        updateChar(x + i * charW, y, color, oldStr[i], newStr[i], textSize);
+        updateChar(x + i * charW, y, wd.color, oldStr[i], newStr[i], textSize);
       }
     }
   }
 }
 
-// 主更新函数 - 日期每1小时更新一次，其他数值位级更新
-static inline void updateDisplay(const String& date, uint32_t co2, float temp, float hum) {
-  if (!layoutInited) initDisplayLayout(date);
-  
-  int charW = 6 * gOtherLineSize;
-  unsigned long currentTime = millis();
-  
-  // 1. 更新日期（每1小时检查一次，位级更新）
-  if (date != displayState.date && (currentTime - displayState.lastDateUpdate >= 3600000)) {
-    int16_t dateX = (tft.width() - date.length() * 6 * gFirstLineSize) / 2;
-    int16_t oldDateX = (tft.width() - displayState.date.length() * 6 * gFirstLineSize) / 2;    
-    updateValue(dateX, yDate, WHITE, displayState.date, date, gFirstLineSize);
-    
-    displayState.date = date;
-    displayState.lastDateUpdate = currentTime;
+#if DISPLAY_ALERT
+static_assert(DISPLAY_ALERT_ROW != DW_DATE, "alert banner must cover a data row");
+
+// 横幅覆盖该行及其上下各半个行距
+static inline void displayAlertBand(int16_t &y0, int16_t &h) {
+  const DisplayLayout &l = displayLayout();
+  int16_t pad = l.spacing / 2;
+  y0 = l.y[DISPLAY_ALERT_ROW] - pad;
+  h = 8 * displayFontSize(kDisplayWidgets[DISPLAY_ALERT_ROW].font) + 2 * pad;
+  if (y0 + h > tft.height()) h = tft.height() - y0;
+}
+
+// drawRows 回调：合成横幅的一行（native RGB565），控件按 displayWidgetDraw 的画法重建
+static void displayAlertRow(uint16_t *row, int16_t x, int16_t y, uint16_t w, void *) {
+  static Rgb565TintLut tint;
+  static bool tintReady = false;
+  if (!tintReady) {
+    rgb565TintLutInit(tint, DISPLAY_ALERT_COLOR, DISPLAY_ALERT_ALPHA);
+    tintReady = true;
   }
-  
-  // 2. 更新CO2（数值右对齐，位级更新）
-  if (co2 != displayState.co2 ) {
-    String newCo2 = String(co2);
-    int digitsW = newCo2.length() * charW;
-    int co2X = xUnit - digitsW - 6 * 2;
-    
-    updateValue(co2X, yCo2, YELLOW, displayState.co2Str, newCo2, gOtherLineSize);
-    displayState.co2 = co2;
-    displayState.co2Str = newCo2;
+  const DisplayWidget &wd = kDisplayWidgets[DISPLAY_ALERT_ROW];
+  const DisplayLayout &l = displayLayout();
+  const String &text = displayState.text[DISPLAY_ALERT_ROW];
+  const uint8_t sz = displayFontSize(wd.font);
+  const int16_t ty = y - l.y[DISPLAY_ALERT_ROW];
+  rgb565Fill(row, BLACK, w);
+  if (wd.label) rgb565TextRow(row, x, w, DISPLAY_LABEL_X, ty, wd.label, sz, wd.color, false);
+  rgb565TextRow(row, x, w, displayValueX(DISPLAY_ALERT_ROW, text.length()), ty, text.c_str(), sz, wd.color,
+                displayAaText());
+  if (wd.degree && ty >= 0 && ty < 6) {
+    for (int dx = 0; dx < 6; dx++) {
+      int16_t px = l.xUnit + dx - x;
+      if (px >= 0 && px < w && displayDegreeDot(dx, ty)) row[px] = wd.color;
+    }
   }
+  if (wd.unit) rgb565TextRow(row, x, w, l.xUnit + (wd.degree ? 8 : 0), ty, wd.unit, sz, wd.color, false);
+  rgb565TintRow(row, w, tint);
+  int16_t tx = (tft.width() - (int16_t)strlen(DISPLAY_ALERT_TEXT) * 6 * sz) / 2;
+  rgb565TextRow(row, x, w, tx, ty, DISPLAY_ALERT_TEXT, sz, WHITE, true);
+}
+
+// 重合成横幅的 [x, x+w) 列
+static inline void displayAlertDraw(int16_t x, int16_t w) {
+  int16_t y0, h;
+  displayAlertBand(y0, h);
+  tft.drawRows(x, y0, w, h, displayAlertRow, nullptr);
+}
+
+// 撤掉横幅：清掉横幅区域，重画该行控件
+static inline void displayAlertClear() {
+  int16_t y0, h;
+  displayAlertBand(y0, h);
+  tft.fillRect(0, y0, tft.width(), h, BLACK);
+  displayWidgetDraw(DISPLAY_ALERT_ROW, true);
+}
+#endif
+
+// 主更新函数：控件数值变了才格式化（日期即跨日时），文字位级更新；v 按 DisplayWidgetId 排列。返回本次刷新的总线开销
+static inline DisplayFrameCost updateDisplayValues(const float v[DW_COUNT]) {
+#if ST7789_STATS
+  const ST7789Stats before = tft.renderStats();
+#endif
+  if (!layoutInited) initDisplayLayout((int32_t)v[DW_DATE]);
   
-  // 3. 更新温度（位级更新）
-  if (temp != displayState.temp) {
-    String newTemp = String(temp, 1);
-    int digitsW = newTemp.length() * charW;
-    int tempX = xUnit - digitsW - 6 * 2;
-    
-    updateValue(tempX, yTemp, CYAN, displayState.tempStr, newTemp, gOtherLineSize);
-    displayState.temp = temp;
-    displayState.tempStr = newTemp;
+  for (uint8_t i = 0; i < DW_COUNT; i++) {
+    if (v[i] == displayState.val[i]) continue;
+    const DisplayWidget &wd = kDisplayWidgets[i];
+    String newStr = wd.format(v[i]);
+    String &oldStr = displayState.text[i];
+    tft.setCostTag(wd.tag);
+#if DISPLAY_ALERT
+    if (i == DISPLAY_ALERT_ROW && displayState.alert) {
+      // 横幅盖着这一行：只重合成变化的字符列（长度变化时为新旧数值的整块）
+      if (oldStr != newStr) {
+        int16_t x0, x1;
+        displayValueSpan(i, oldStr, newStr, x0, x1);
+        oldStr = newStr;
+        displayAlertDraw(x0, x1 - x0);
+      }
+    } else
+#endif
+    updateValue(i, oldStr, newStr);
+    displayState.val[i] = v[i];
+    oldStr = newStr;
   }
-  
-  // 4. 更新湿度（位级更新）
-  if (hum != displayState.hum) {
-    String newHum = String(hum, 1);
-    int digitsW = newHum.length() * charW;
-    int humX = xUnit - digitsW - 6 * 2;
-    
-    updateValue(humX, yHum, MAGENTA, displayState.humStr, newHum, gOtherLineSize);
-    displayState.hum = hum;
-    displayState.humStr = newHum;
+
+#if DISPLAY_ALERT
+  // 告警横幅（带回差）；数值为 0 表示还没有读数
+  float src = v[DISPLAY_ALERT_SRC];
+  bool alert = displayState.alert ? src + DISPLAY_ALERT_HYST >= DISPLAY_ALERT_PPM : src >= DISPLAY_ALERT_PPM;
+  if (alert != displayState.alert) {
+    tft.setCostTag(DTAG_ALERT);
+    displayState.alert = alert;
+    if (alert) displayAlertDraw(0, tft.width());
+    else displayAlertClear();
+  }
+#endif
+  tft.setCostTag(DTAG_NONE);
+
+  DisplayFrameCost fc;
+#if ST7789_STATS
+  const ST7789Stats &after = tft.renderStats();
+  fc.total = after.total.minus(before.total);
+  for (uint8_t t = 0; t < DTAG_COUNT; t++) fc.row[t] = after.tag[t].minus(before.tag[t]);
+#endif
+  return fc;
+}
+
+// 当前传感器的入口（顺序同 DisplayWidgetId）
+static_assert(DW_COUNT == 4, "updateDisplay() passes one value per widget");
+static inline DisplayFrameCost updateDisplay(int32_t day, uint32_t co2, float temp, float hum) {
+  const float v[DW_COUNT] = { (float)day, (float)co2, temp, hum };
+  return updateDisplayValues(v);
+}
+
+// ---- 暖复位保留屏幕 ----
+// 只有 MCU 复位（软件重启、看门狗、panic）时面板一直带电，显存内容还在。把"屏上现在显示什么"存进 RTC 内存，
+// 重启后签名吻合就直接恢复 displayState，跳过整屏重绘，之后照常按位更新。
+// 签名包含尺寸、旋转、字号和固件构建时间，换了固件或布局参数都会整屏重绘。
+#define DISPLAY_RETAIN_MAGIC 0x33505344UL   // "DSP3"
+
+struct DisplayRetained {
+  uint32_t magic;
+  uint32_t layoutSig;
+  char text[DW_COUNT][DISPLAY_TEXT_CAP];
+  float val[DW_COUNT];
+  uint32_t alert;
+  uint32_t crc;
+};
+
+static inline uint32_t displayFnv(uint32_t h, const void *p, size_t n) {
+  const uint8_t *b = (const uint8_t *)p;
+  while (n--) { h ^= *b++; h *= 16777619u; }
+  return h;
+}
+
+static inline uint32_t displayLayoutSig(const char *build) {
+  int16_t geo[2] = { tft.width(), tft.height() };
+  uint8_t fmt[3] = { tft.getRotation(), gFirstLineSize, gOtherLineSize };
+  uint32_t h = displayFnv(2166136261u, geo, sizeof(geo));
+  h = displayFnv(h, fmt, sizeof(fmt));
+  return displayFnv(h, build, strlen(build));
+}
+
+static inline uint32_t displayRetainCrc(const DisplayRetained &r) {
+  return displayFnv(2166136261u, &r, offsetof(DisplayRetained, crc));
+}
+
+static inline bool displayCopyStr(char *dst, size_t cap, const String &s) {
+  if (s.length() >= cap) return false;
+  memset(dst, 0, cap);
+  memcpy(dst, s.c_str(), s.length());
+  return true;
+}
+
+// 每次刷新后调用，记录屏上内容；布局未画或文本放不下时置为无效
+static inline void displayRetain(DisplayRetained &r, uint32_t sig) {
+  r.magic = 0;
+  if (!layoutInited) return;
+  for (uint8_t i = 0; i < DW_COUNT; i++) {
+    if (!displayCopyStr(r.text[i], sizeof(r.text[i]), displayState.text[i])) return;
+    r.val[i] = displayState.val[i];
+  }
+  r.layoutSig = sig;
+  r.alert = displayState.alert ? 1 : 0;
+  r.magic = DISPLAY_RETAIN_MAGIC;
+  r.crc = displayRetainCrc(r);
+}
+
+// 暖启动：签名与校验都吻合时恢复 displayState 并视为布局已绘制，返回 false 时调用方照常 initDisplayLayout
+static inline bool displayRestore(const DisplayRetained &r, uint32_t sig) {
+  if (r.magic != DISPLAY_RETAIN_MAGIC || r.layoutSig != sig || r.crc != displayRetainCrc(r)) return false;
+  computeDisplayLayout();
+  displayState = DisplayState();
+  for (uint8_t i = 0; i < DW_COUNT; i++) {
+    displayState.text[i] = String(r.text[i]);
+    displayState.val[i] = r.val[i];
   }
+  displayState.alert = r.alert != 0;
+  layoutInited = true;
+  return true;
 }
 
-#endif // DISPLAY_OPTIMIZED_H
\ No newline at end of file
+#endif // DISPLAY_OPTIMIZED_H
@@ -0,0 +1,390 @@
+// 追加式闪存样本日志：页批量写入、扇区轮转均衡磨损、掉电后按校验头恢复、按时间范围读取
+#ifndef FLASH_LOG_H
+#define FLASH_LOG_H
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include "co2_crc.h"
+#include "telemetry_codec.h"
+#if defined(ARDUINO_ARCH_ESP32)
+#include <esp_partition.h>
+#endif
+
+// 布局：分区按扇区划为段，段内 = 段头 + 连续记录（4 字节对齐）。
+// 每条记录是一块 telemetry_codec 编码的样本，在 RAM 中攒满一页再写入。
+// 段按环形顺序使用，每个段每轮只擦一次，磨损天然均匀。
+#define FLASH_LOG_SECTOR     4096
+#define FLASH_LOG_PAGE       256
+#define FLASH_LOG_MAX_SEGS   1024
+#define FLASH_LOG_SEG_MAGIC  0x31474C53UL   // "SLG1"
+#define FLASH_LOG_REC_MAGIC  0xA55A
+#define FLASH_LOG_MIN_REC    64             // 段内剩余空间不足时直接换段
+
+// 闪存抽象（NOR 语义：写只能把 1 变 0，擦除后全为 0xFF）
+class FlashDevice {
+ public:
+  virtual ~FlashDevice() {}
+  virtual uint32_t size() const = 0;
+  virtual bool read(uint32_t addr, void *dst, uint32_t len) = 0;
+  virtual bool write(uint32_t addr, const void *src, uint32_t len) = 0;
+  virtual bool eraseSector(uint32_t addr) = 0;
+};
+
+#if defined(ARDUINO_ARCH_ESP32)
+// 专用数据分区（partitions_samplelog.csv 中的 samplelog）
+class EspPartitionFlash : public FlashDevice {
+ public:
+  bool begin(const char *label = "samplelog") {
+    part = esp_partition_find_first(ESP_PARTITION_TYPE_DATA, ESP_PARTITION_SUBTYPE_ANY, label);
+    return part != nullptr;
+  }
+  uint32_t size() const override { return part ? part->size : 0; }
+  bool read(uint32_t addr, void *dst, uint32_t len) override { return esp_partition_read(part, addr, dst, len) == ESP_OK; }
+  bool write(uint32_t addr, const void *src, uint32_t len) override { return esp_partition_write(part, addr, src, len) == ESP_OK; }
+  bool eraseSector(uint32_t addr) override { return esp_partition_erase_range(part, addr, FLASH_LOG_SECTOR) == ESP_OK; }
+
+ private:
+  const esp_partition_t *part = nullptr;
+};
+#else
+// 主机端（native_sim）：同名分区以进程内 RAM 模拟，大小与 partitions_samplelog.csv 一致，初始为擦除态
+#ifndef FLASH_LOG_HOST_PART_BYTES
+#define FLASH_LOG_HOST_PART_BYTES 0x360000
+#endif
+
+class EspPartitionFlash : public FlashDevice {
+ public:
+  ~EspPartitionFlash() { free(mem); }
+  bool begin(const char *label = "samplelog") {
+    (void)label;
+    if (!mem) mem = (uint8_t *)malloc(FLASH_LOG_HOST_PART_BYTES);
+    if (!mem) return false;
+    memset(mem, 0xFF, FLASH_LOG_HOST_PART_BYTES);
+    return true;
+  }
+  uint32_t size() const override { return mem ? FLASH_LOG_HOST_PART_BYTES : 0; }
+  bool read(uint32_t addr, void *dst, uint32_t len) override {
+    if (!inRange(addr, len)) return false;
+    memcpy(dst, mem + addr, len);
+    return true;
+  }
+  // NOR 语义：按位与
+  bool write(uint32_t addr, const void *src, uint32_t len) override {
+    if (!inRange(addr, len)) return false;
+    const uint8_t *p = (const uint8_t *)src;
+    for (uint32_t i = 0; i < len; i++) mem[addr + i] &= p[i];
+    programmed += len;
+    return true;
+  }
+  bool eraseSector(uint32_t addr) override {
+    if (addr % FLASH_LOG_SECTOR || !inRange(addr, FLASH_LOG_SECTOR)) return false;
+    memset(mem + addr, 0xFF, FLASH_LOG_SECTOR);
+    erases++;
+    return true;
+  }
+
+  uint64_t programmed = 0;
+  uint32_t erases = 0;
+
+ private:
+  bool inRange(uint32_t addr, uint32_t len) const { return mem && addr <= FLASH_LOG_HOST_PART_BYTES && len <= FLASH_LOG_HOST_PART_BYTES - addr; }
+  uint8_t *mem = nullptr;
+};
+#endif
+
+struct FlashSegHdr {
+  uint32_t magic;
+  uint32_t seq;          // 单调递增，最大者为当前写入段
+  uint32_t eraseCount;   // 本扇区累计擦除次数
+  uint16_t reserved;
+  uint16_t crc;          // 前 14 字节的 CRC16
+};
+
+// 记录头：crc 覆盖 len 起到负载结束
+struct FlashRecHdr {
+  uint16_t magic;
+  uint16_t crc;
+  uint16_t len;          // 负载字节数（不含头和对齐填充）
+  uint16_t count;        // 样本数
+  uint32_t firstT;
+  uint32_t lastT;
+};
+
+struct FlashLogStats {
+  uint32_t samplesAppended = 0;
+  uint32_t recordsWritten = 0;
+  uint32_t payloadBytes = 0;      // 编码后的样本字节
+  uint32_t programmedBytes = 0;   // 实际写入闪存的字节（含记录头/段头/填充）
+  uint32_t sectorsErased = 0;
+  uint32_t writeErrors = 0;       // 编程/擦除失败次数（写失败的批次留在 RAM，换段重试）
+  uint32_t recoveredRecords = 0;  // 启动时恢复的有效记录数
+  bool tailDirty = false;         // 启动时发现残缺尾部（掉电写到一半）
+};
+
+class FlashLog {
+ public:
+  // 挂载并恢复：读取所有段头，扫描当前段的记录找到写入位置
+  bool begin(FlashDevice *dev) {
+    this->dev = dev;
+    segCount = dev->size() / FLASH_LOG_SECTOR;
+    if (segCount > FLASH_LOG_MAX_SEGS) segCount = FLASH_LOG_MAX_SEGS;
+    if (segCount < 2) return false;
+    stats = FlashLogStats();
+    batchCount = 0;
+    segDirty = false;
+
+    uint32_t maxSeq = 0;
+    bool any = false;
+    for (uint16_t i = 0; i < segCount; i++) {
+      FlashSegHdr h;
+      SegIndex &ix = index[i];
+      ix.valid = readSegHdr(i, h);
+      ix.seq = ix.valid ? h.seq : 0;
+      ix.eraseCount = ix.valid ? h.eraseCount : 0;
+      ix.firstT = UINT32_MAX;
+      ix.lastT = 0;
+      if (ix.valid) {
+        FlashRecHdr r;
+        if (dev->read(segBase(i) + sizeof(FlashSegHdr), &r, sizeof(r)) && r.magic == FLASH_LOG_REC_MAGIC) ix.firstT = r.firstT;
+        if (!any || h.seq > maxSeq) { maxSeq = h.seq; active = i; }
+        any = true;
+      }
+    }
+    if (!any) return openSegment(0, 1);
+
+    // 扫描当前段：遇到第一条无效记录即停止
+    writeOff = sizeof(FlashSegHdr);
+    SegIndex &ax = index[active];
+    while (writeOff + sizeof(FlashRecHdr) <= FLASH_LOG_SECTOR) {
+      FlashRecHdr r;
+      if (!readRecord(active, writeOff, r, pageBuf)) break;
+      if (ax.firstT == UINT32_MAX) ax.firstT = r.firstT;
+      ax.lastT = r.lastT;
+      stats.recoveredRecords++;
+      writeOff = align4(writeOff + sizeof(FlashRecHdr) + r.len);
+    }
+    lastT = ax.lastT;
+    if (!lastT) {
+      uint16_t prev = (uint16_t)((active + segCount - 1) % segCount);
+      if (index[prev].valid) lastT = scanLastT(prev);
+    }
+    // 尾部必须是擦除态，否则是掉电时写了一半，放弃本段剩余空间
+    if (!tailErased(active, writeOff)) {
+      stats.tailDirty = true;
+      return rotate();
+    }
+    return true;
+  }
+
+  // 追加一个样本到 RAM 批次，批次满一页时写入闪存
+  bool append(const TelemetrySample &s) {
+    if (!dev) return false;
+    if (batchCount == 0 && !startBatch()) return false;
+    if (!enc.append(s)) {
+      if (!flush() || !startBatch()) return false;
+      if (!enc.append(s)) return false;
+    }
+    if (batchCount == 0) batchFirstT = s.t;
+    batchLastT = s.t;
+    batchCount++;
+    stats.samplesAppended++;
+    return true;
+  }
+
+  // 立即写出当前批次（不足一页也写），返回是否成功。
+  // 写失败时该处可能已部分编程，不能再写：本段作废、换到下一段重试一次；仍失败则批次留在 RAM，下次再试
+  bool flush() {
+    if (!batchCount) return true;
+    size_t blockLen = enc.finish();
+    FlashRecHdr *r = (FlashRecHdr *)pageBuf;
+    r->magic = FLASH_LOG_REC_MAGIC;
+    r->len = (uint16_t)blockLen;
+    r->count = batchCount;
+    r->firstT = batchFirstT;
+    r->lastT = batchLastT;
+    r->crc = recordCrc(pageBuf, blockLen);
+    uint32_t total = align4(sizeof(FlashRecHdr) + blockLen);
+    memset(pageBuf + sizeof(FlashRecHdr) + blockLen, 0xFF, total - sizeof(FlashRecHdr) - blockLen);
+    bool written = false;
+    for (int attempt = 0; attempt < 2 && !written; attempt++) {
+      if (segDirty && !rotate()) return false;
+      written = dev->write(segBase(active) + writeOff, pageBuf, total);
+      if (!written) { stats.writeErrors++; segDirty = true; }
+    }
+    if (!written) return false;
+    batchCount = 0;
+    SegIndex &ax = index[active];
+    if (ax.firstT == UINT32_MAX) ax.firstT = r->firstT;
+    ax.lastT = r->lastT;
+    lastT = r->lastT;
+    writeOff += total;
+    stats.recordsWritten++;
+    stats.payloadBytes += blockLen;
+    stats.programmedBytes += total;
+    return true;
+  }
+
+  // 批次最早样本距今超过 maxAgeSec 时写出，限制掉电丢失的数据量
+  bool flushIfOlder(uint32_t nowT, uint32_t maxAgeSec) {
+    if (batchCount && nowT - batchFirstT >= maxAgeSec) return flush();
+    return true;
+  }
+
+  // 读取 [t0, t1] 内的样本（含未写出的批次），按时间升序，返回个数。
+  // 按段索引定位起点，记录按头部 firstT/lastT 跳过，只解码相交的记录。
+  size_t read(uint32_t t0, uint32_t t1, TelemetrySample *out, size_t maxOut) {
+    size_t n = 0;
+    if (!dev || t1 < t0) return 0;
+    // 逻辑顺序：active+1 .. active（环形，最旧到最新）；起点为最后一个 firstT <= t0 的段，
+    // 只查 RAM 中的段索引，不读闪存
+    uint16_t start = 0;
+    for (uint16_t k = 0; k < segCount; k++) {
+      const SegIndex &ix = index[logicalSeg(k)];
+      if (ix.valid && ix.firstT != UINT32_MAX && ix.firstT <= t0) start = k;
+    }
+    for (uint16_t k = start; k < segCount && n < maxOut; k++) {
+      uint16_t seg = logicalSeg(k);
+      const SegIndex &ix = index[seg];
+      if (!ix.valid || ix.firstT == UINT32_MAX) continue;
+      if (ix.firstT > t1) break;
+      uint32_t off = sizeof(FlashSegHdr);
+      uint32_t end = seg == active ? writeOff : FLASH_LOG_SECTOR;
+      while (off + sizeof(FlashRecHdr) <= end && n < maxOut) {
+        FlashRecHdr r;
+        if (!dev->read(segBase(seg) + off, &r, sizeof(r)) || r.magic != FLASH_LOG_REC_MAGIC) break;
+        if (r.firstT > t1) return n;
+        if (r.lastT >= t0) {
+          if (!readRecord(seg, off, r, recBuf)) break;
+          n += decodeRange(recBuf + sizeof(FlashRecHdr), r.len, t0, t1, out + n, maxOut - n);
+        }
+        off = align4(off + sizeof(FlashRecHdr) + r.len);
+      }
+    }
+    if (batchCount && n < maxOut && batchLastT >= t0 && batchFirstT <= t1) {
+      n += decodeRange(pageBuf + sizeof(FlashRecHdr), enc.finish(), t0, t1, out + n, maxOut - n);
+    }
+    return n;
+  }
+
+  const FlashLogStats &getStats() const { return stats; }
+  uint16_t segments() const { return segCount; }
+  uint32_t segmentEraseCount(uint16_t seg) const { return index[seg].eraseCount; }
+  uint32_t pendingSamples() const { return batchCount; }
+  // 最近一个样本的时间（含未写出的批次），用于跨重启保持时间单调
+  uint32_t lastTime() const { return batchCount ? batchLastT : lastT; }
+
+  // 记录校验（rec 指向记录头），主机端离线分析分区镜像时复用
+  static uint16_t recordCrc(const uint8_t *rec, uint32_t payloadLen) {
+    return modbus_calcuCRC(rec + 4, (uint16_t)(sizeof(FlashRecHdr) - 4 + payloadLen));
+  }
+
+ private:
+  struct SegIndex {
+    uint32_t seq;
+    uint32_t firstT;
+    uint32_t lastT;
+    uint32_t eraseCount;
+    bool valid;
+  };
+
+  static uint32_t align4(uint32_t v) { return (v + 3) & ~3UL; }
+  static uint32_t segBase(uint16_t seg) { return (uint32_t)seg * FLASH_LOG_SECTOR; }
+  uint16_t logicalSeg(uint16_t k) const { return (uint16_t)((active + 1 + k) % segCount); }
+
+  bool readSegHdr(uint16_t seg, FlashSegHdr &h) {
+    if (!dev->read(segBase(seg), &h, sizeof(h))) return false;
+    return h.magic == FLASH_LOG_SEG_MAGIC && h.crc == modbus_calcuCRC((const uint8_t *)&h, sizeof(h) - 2);
+  }
+
+  // 读取并校验 off 处的一条记录到 buf
+  bool readRecord(uint16_t seg, uint32_t off, FlashRecHdr &r, uint8_t *buf) {
+    if (!dev->read(segBase(seg) + off, &r, sizeof(r))) return false;
+    if (r.magic != FLASH_LOG_REC_MAGIC || r.len > FLASH_LOG_PAGE - sizeof(FlashRecHdr)) return false;
+    if (off + sizeof(FlashRecHdr) + r.len > FLASH_LOG_SECTOR) return false;
+    if (!dev->read(segBase(seg) + off, buf, sizeof(FlashRecHdr) + r.len)) return false;
+    return recordCrc(buf, r.len) == r.crc;
+  }
+
+  uint32_t scanLastT(uint16_t seg) {
+    uint32_t off = sizeof(FlashSegHdr), t = 0;
+    FlashRecHdr r;
+    while (off + sizeof(FlashRecHdr) <= FLASH_LOG_SECTOR && readRecord(seg, off, r, recBuf)) {
+      t = r.lastT;
+      off = align4(off + sizeof(FlashRecHdr) + r.len);
+    }
+    return t;
+  }
+
+  bool tailErased(uint16_t seg, uint32_t off) {
+    uint8_t tmp[64];
+    while (off < FLASH_LOG_SECTOR) {
+      uint32_t n = FLASH_LOG_SECTOR - off < sizeof(tmp) ? FLASH_LOG_SECTOR - off : sizeof(tmp);
+      if (!dev->read(segBase(seg) + off, tmp, n)) return false;
+      for (uint32_t i = 0; i < n; i++) if (tmp[i] != 0xFF) return false;
+      off += n;
+    }
+    return true;
+  }
+
+  // 擦除并启用 seg 段（其中旧数据被丢弃）
+  bool openSegment(uint16_t seg, uint32_t seq) {
+    FlashSegHdr old;
+    uint32_t erases = readSegHdr(seg, old) ? old.eraseCount : index[seg].eraseCount;
+    if (!dev->eraseSector(segBase(seg))) { stats.writeErrors++; return false; }
+    stats.sectorsErased++;
+    FlashSegHdr h = { FLASH_LOG_SEG_MAGIC, seq, erases + 1, 0xFFFF, 0 };
+    h.crc = modbus_calcuCRC((const uint8_t *)&h, sizeof(h) - 2);
+    if (!dev->write(segBase(seg), &h, sizeof(h))) { stats.writeErrors++; return false; }
+    stats.programmedBytes += sizeof(h);
+    SegIndex &ix = index[seg];
+    ix.valid = true; ix.seq = seq; ix.eraseCount = h.eraseCount;
+    ix.firstT = UINT32_MAX; ix.lastT = 0;
+    active = seg;
+    writeOff = sizeof(FlashSegHdr);
+    segDirty = false;
+    return true;
+  }
+
+  bool rotate() {
+    return openSegment((uint16_t)((active + 1) % segCount), index[active].seq + 1);
+  }
+
+  // 在 pageBuf 中开始新批次，容量取页大小与本段剩余空间的较小者；需要换段而换段失败时返回 false
+  bool startBatch() {
+    if ((segDirty || FLASH_LOG_SECTOR - writeOff < FLASH_LOG_MIN_REC) && !rotate()) return false;
+    uint32_t cap = FLASH_LOG_SECTOR - writeOff;
+    if (cap > FLASH_LOG_PAGE) cap = FLASH_LOG_PAGE;
+    cap = cap & ~3UL;
+    enc = TelemetryEncoder(pageBuf + sizeof(FlashRecHdr), cap - sizeof(FlashRecHdr));
+    batchCount = 0;
+    return true;
+  }
+
+  static size_t decodeRange(const uint8_t *block, size_t len, uint32_t t0, uint32_t t1, TelemetrySample *out, size_t maxOut) {
+    TelemetryDecoder dec(block, len);
+    TelemetrySample s;
+    size_t n = 0;
+    while (n < maxOut && dec.next(s)) {
+      if (s.t > t1) break;
+      if (s.t >= t0) out[n++] = s;
+    }
+    return n;
+  }
+
+  FlashDevice *dev = nullptr;
+  SegIndex index[FLASH_LOG_MAX_SEGS];
+  uint16_t segCount = 0;
+  uint16_t active = 0;
+  uint32_t writeOff = 0;
+  bool segDirty = false;             // 本段写入位置之后有写失败留下的残片，下次写前换段
+  uint32_t lastT = 0;
+  uint8_t pageBuf[FLASH_LOG_PAGE];   // 当前批次：记录头 + 编码块
+  uint8_t recBuf[FLASH_LOG_PAGE];    // 读取时的记录缓冲
+  TelemetryEncoder enc = TelemetryEncoder(pageBuf, 0);
+  uint16_t batchCount = 0;
+  uint32_t batchFirstT = 0, batchLastT = 0;
+  FlashLogStats stats;
+};
+
+#endif // FLASH_LOG_H
@@ -0,0 +1,224 @@
+// 多分辨率历史数据：1 秒原始值保存 1 小时，1 分钟聚合保存 1 周，1 小时聚合保存 1 年
+#ifndef HISTORY_STORE_H
+#define HISTORY_STORE_H
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#if defined(ARDUINO_ARCH_ESP32)
+#include <esp_heap_caps.h>
+#endif
+
+// 各级容量（槽位数）与槽宽（秒）
+#define HIST_RAW_SLOTS     3600    // 1 s x 3600 = 1 小时
+#define HIST_MIN_SLOTS     10080   // 60 s x 10080 = 7 天
+#define HIST_HOUR_SLOTS    8760    // 3600 s x 8760 = 365 天
+
+// 无数据标记（定点值域内不会出现）
+#define HIST_NO_DATA       0xFFFF
+
+// 原始记录：定点 CO2 ppm / 0.01°C / 0.01%RH，时间戳由槽位推算，6 字节
+struct __attribute__((packed)) HistRaw {
+  uint16_t co2;
+  int16_t temp;
+  uint16_t hum;
+};
+
+// 聚合记录：每通道 min/max/mean，18 字节
+struct __attribute__((packed)) HistAgg {
+  uint16_t co2Min, co2Max, co2Mean;
+  int16_t tempMin, tempMax, tempMean;
+  uint16_t humMin, humMax, humMean;
+};
+
+enum HistLevel : uint8_t { HIST_RAW = 0, HIST_MINUTE = 1, HIST_HOUR = 2 };
+
+// 读取结果：统一用聚合格式表示，原始点 min=max=mean
+struct HistPoint {
+  uint32_t t;      // 槽起始时间（秒）
+  HistAgg v;
+};
+
+// 聚合累加器：按原始样本累加，保证高层均值是全部样本的均值
+struct HistAccum {
+  int32_t co2Sum, tempSum, humSum;
+  uint16_t count;
+  uint16_t co2Min, co2Max;
+  int16_t tempMin, tempMax;
+  uint16_t humMin, humMax;
+
+  void reset() {
+    co2Sum = tempSum = humSum = 0; count = 0;
+    co2Min = UINT16_MAX; co2Max = 0;
+    tempMin = INT16_MAX; tempMax = INT16_MIN;
+    humMin = UINT16_MAX; humMax = 0;
+  }
+  void add(const HistRaw &r) {
+    co2Sum += r.co2; tempSum += r.temp; humSum += r.hum; count++;
+    if (r.co2 < co2Min) co2Min = r.co2;
+    if (r.co2 > co2Max) co2Max = r.co2;
+    if (r.temp < tempMin) tempMin = r.temp;
+    if (r.temp > tempMax) tempMax = r.temp;
+    if (r.hum < humMin) humMin = r.hum;
+    if (r.hum > humMax) humMax = r.hum;
+  }
+  // 合并低层累加器（sum 以 int32 保存，3600 个样本不会溢出）
+  void merge(const HistAccum &a) {
+    if (!a.count) return;
+    co2Sum += a.co2Sum; tempSum += a.tempSum; humSum += a.humSum; count += a.count;
+    if (a.co2Min < co2Min) co2Min = a.co2Min;
+    if (a.co2Max > co2Max) co2Max = a.co2Max;
+    if (a.tempMin < tempMin) tempMin = a.tempMin;
+    if (a.tempMax > tempMax) tempMax = a.tempMax;
+    if (a.humMin < humMin) humMin = a.humMin;
+    if (a.humMax > humMax) humMax = a.humMax;
+  }
+  HistAgg toAgg() const {
+    HistAgg g;
+    if (!count) { memset(&g, 0xFF, sizeof(g)); return g; }
+    g.co2Min = co2Min; g.co2Max = co2Max; g.co2Mean = (uint16_t)(co2Sum / count);
+    g.tempMin = tempMin; g.tempMax = tempMax; g.tempMean = (int16_t)(tempSum / count);
+    g.humMin = humMin; g.humMax = humMax; g.humMean = (uint16_t)(humSum / count);
+    return g;
+  }
+};
+
+class HistoryStore {
+ public:
+  // 一次性分配全部缓冲区（ESP32 上优先放在 PSRAM），失败返回 false
+  bool begin() {
+    if (raw) return true;
+    raw = (HistRaw *)histAlloc(sizeof(HistRaw) * HIST_RAW_SLOTS);
+    minute = (HistAgg *)histAlloc(sizeof(HistAgg) * HIST_MIN_SLOTS);
+    hour = (HistAgg *)histAlloc(sizeof(HistAgg) * HIST_HOUR_SLOTS);
+    if (!raw || !minute || !hour) { end(); return false; }
+    memset(raw, 0xFF, sizeof(HistRaw) * HIST_RAW_SLOTS);
+    memset(minute, 0xFF, sizeof(HistAgg) * HIST_MIN_SLOTS);
+    memset(hour, 0xFF, sizeof(HistAgg) * HIST_HOUR_SLOTS);
+    minAcc.reset(); hourAcc.reset();
+    lastT = 0; hasData = false;
+    return true;
+  }
+
+  void end() {
+    free(raw); free(minute); free(hour);
+    raw = nullptr; minute = nullptr; hour = nullptr;
+  }
+
+  static size_t memoryBytes() {
+    return sizeof(HistRaw) * HIST_RAW_SLOTS + sizeof(HistAgg) * (HIST_MIN_SLOTS + HIST_HOUR_SLOTS);
+  }
+
+  // 写入 1 个样本（t 为秒，需单调递增，同一秒的重复样本被忽略）。
+  // 逐级累加，分钟/小时边界时把累加结果写入上一层，每次插入 O(1)（跨越空档时按经过的槽位摊还）。
+  bool insert(uint32_t t, uint16_t co2, int16_t temp, uint16_t hum) {
+    if (!raw) return false;
+    if (hasData && t <= lastT) return false;
+    if (hasData) {
+      // 关闭已结束的分钟/小时
+      if (t / 60 != lastT / 60) closeMinute(lastT, t);
+      // 空档内的原始槽位标记为无数据
+      uint32_t gap = t - lastT - 1;
+      if (gap > HIST_RAW_SLOTS) gap = HIST_RAW_SLOTS;
+      for (uint32_t i = 1; i <= gap; i++) markNoData(raw[(lastT + i) % HIST_RAW_SLOTS]);
+    } else {
+      firstT = t;
+    }
+    HistRaw r = { co2, temp, hum };
+    raw[t % HIST_RAW_SLOTS] = r;
+    minAcc.add(r);
+    lastT = t;
+    hasData = true;
+    inserts++;
+    return true;
+  }
+
+  // 读取 [t0, t1] 内的点（按时间升序），返回写入 out 的个数。
+  // 只访问落在窗口与保留期交集内的槽位，耗时与返回点数成正比；空槽跳过。
+  size_t read(HistLevel lv, uint32_t t0, uint32_t t1, HistPoint *out, size_t maxOut) const {
+    if (!raw || !hasData || t1 < t0) return 0;
+    uint32_t period = levelPeriod(lv), slots = levelSlots(lv);
+    // 当前未结束的分钟/小时尚未写入，最新可读槽是上一个
+    uint32_t newest = lv == HIST_RAW ? lastT / period : lastT / period - 1;
+    if (lv != HIST_RAW && lastT / period == 0) return 0;
+    uint32_t oldest = newest >= slots - 1 ? newest - (slots - 1) : 0;
+    if (oldest < firstT / period) oldest = firstT / period;
+    uint32_t s0 = t0 / period, s1 = t1 / period;
+    if (s0 < oldest) s0 = oldest;
+    if (s1 > newest) s1 = newest;
+    size_t n = 0;
+    for (uint32_t s = s0; s <= s1 && n < maxOut; s++) {
+      HistPoint &p = out[n];
+      if (lv == HIST_RAW) {
+        const HistRaw &r = raw[s % slots];
+        if (r.co2 == HIST_NO_DATA) continue;
+        p.v.co2Min = p.v.co2Max = p.v.co2Mean = r.co2;
+        p.v.tempMin = p.v.tempMax = p.v.tempMean = r.temp;
+        p.v.humMin = p.v.humMax = p.v.humMean = r.hum;
+      } else {
+        const HistAgg &g = (lv == HIST_MINUTE ? minute : hour)[s % slots];
+        if (g.co2Mean == HIST_NO_DATA) continue;
+        p.v = g;
+      }
+      p.t = s * period;
+      n++;
+    }
+    return n;
+  }
+
+  // 为图表选择最细且点数不超过 maxPoints 的分辨率
+  HistLevel pickLevel(uint32_t spanSec, uint32_t maxPoints) const {
+    if (spanSec <= HIST_RAW_SLOTS && spanSec <= maxPoints) return HIST_RAW;
+    if (spanSec / 60 <= HIST_MIN_SLOTS && spanSec / 60 <= maxPoints) return HIST_MINUTE;
+    return HIST_HOUR;
+  }
+
+  uint32_t lastTime() const { return lastT; }
+  uint32_t insertCount() const { return inserts; }
+
+  static uint32_t levelPeriod(HistLevel lv) { return lv == HIST_RAW ? 1 : (lv == HIST_MINUTE ? 60 : 3600); }
+  static uint32_t levelSlots(HistLevel lv) { return lv == HIST_RAW ? HIST_RAW_SLOTS : (lv == HIST_MINUTE ? HIST_MIN_SLOTS : HIST_HOUR_SLOTS); }
+
+ private:
+  static void *histAlloc(size_t n) {
+#if defined(ARDUINO_ARCH_ESP32)
+    void *p = heap_caps_malloc(n, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+    if (p) return p;
+#endif
+    return malloc(n);
+  }
+
+  static void markNoData(HistRaw &r) { r.co2 = HIST_NO_DATA; }
+  static void markNoData(HistAgg &g) { memset(&g, 0xFF, sizeof(g)); }
+
+  // 上一样本所在分钟已结束：写分钟槽，必要时写小时槽，并清空中间跳过的槽位
+  void closeMinute(uint32_t prevT, uint32_t t) {
+    uint32_t m = prevT / 60, mNow = t / 60;
+    minute[m % HIST_MIN_SLOTS] = minAcc.toAgg();
+    hourAcc.merge(minAcc);
+    minAcc.reset();
+    uint32_t gap = mNow - m - 1;
+    if (gap > HIST_MIN_SLOTS) gap = HIST_MIN_SLOTS;
+    for (uint32_t i = 1; i <= gap; i++) markNoData(minute[(m + i) % HIST_MIN_SLOTS]);
+
+    uint32_t h = prevT / 3600, hNow = t / 3600;
+    if (h != hNow) {
+      hour[h % HIST_HOUR_SLOTS] = hourAcc.toAgg();
+      hourAcc.reset();
+      uint32_t hgap = hNow - h - 1;
+      if (hgap > HIST_HOUR_SLOTS) hgap = HIST_HOUR_SLOTS;
+      for (uint32_t i = 1; i <= hgap; i++) markNoData(hour[(h + i) % HIST_HOUR_SLOTS]);
+    }
+  }
+
+  HistRaw *raw = nullptr;
+  HistAgg *minute = nullptr;
+  HistAgg *hour = nullptr;
+  HistAccum minAcc, hourAcc;
+  uint32_t firstT = 0;
+  uint32_t lastT = 0;
+  uint32_t inserts = 0;
+  bool hasData = false;
+};
+
+#endif // HISTORY_STORE_H
@@ -0,0 +1,225 @@
+// 热路径微基准：驱动图元、位级更新、RGB565 行缓冲内核、CO2 帧解析与 CRC16，主机（虚拟面板）与板上共用同一组用例，
+// 结果按 JSON 逐行输出（每个用例一行），不同固件版本的结果可用主机端 microbench --compare 对比
+#ifndef HOTPATH_BENCH_H
+#define HOTPATH_BENCH_H
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include "co2_crc.h"
+#include "co2_frame.h"
+#include "display_helper.h"
+#include "rgb565_simd.h"
+#include "sample_pipeline.h"
+#if !defined(ARDUINO_ARCH_ESP32)
+#include <chrono>
+#endif
+
+// 计时：板上用 CPU 周期计数器（Xtensa CCOUNT），主机端用 steady_clock 纳秒
+#if defined(ARDUINO_ARCH_ESP32)
+#define HOTPATH_UNIT "cycles"
+static inline uint32_t hotpathTicks() { return ESP.getCycleCount(); }
+#else
+#define HOTPATH_UNIT "ns"
+static inline uint32_t hotpathTicks() {
+  return (uint32_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+      std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+#endif
+
+#define HOTPATH_SAMPLES 25       // 每个用例的采样次数，取中位数与最小值
+#define HOTPATH_LINE    224
+
+struct HotpathResult {
+  const char *name;
+  uint32_t ops = 0;              // 每次采样执行的操作数
+  uint32_t median = 0, min = 0, mean = 0;   // 每次操作的 ticks
+  uint32_t busBytes = 0;         // 每次操作的总线字节（ST7789_STATS）
+  uint32_t windows = 0;          // 每次操作的地址窗口数
+  uint32_t busUs = 0;            // 主机端：每次操作的虚拟总线时间（按 SPI 时钟折算），板上为 0
+};
+
+static inline uint64_t hotpathBusNowUs() {
+#if defined(ARDUINO_ARCH_ESP32)
+  return 0;   // 板上的 ticks 已包含总线等待
+#else
+  return hostMicros64();
+#endif
+}
+
+// fn(i) 为第 i 次操作；每次采样连续执行 ops 次，抵消计时开销
+template <typename Fn>
+static inline HotpathResult hotpathMeasure(const char *name, uint32_t ops, Fn fn) {
+  HotpathResult r;
+  r.name = name;
+  r.ops = ops;
+  uint32_t s[HOTPATH_SAMPLES];
+  uint64_t sum = 0;
+#if ST7789_STATS
+  const ST7789Cost before = tft.renderStats().total;
+#endif
+  uint64_t bus0 = hotpathBusNowUs();
+  uint32_t i = 0;
+  for (uint8_t k = 0; k < HOTPATH_SAMPLES; k++) {
+    uint32_t t0 = hotpathTicks();
+    for (uint32_t n = 0; n < ops; n++) fn(i++);
+    s[k] = (hotpathTicks() - t0) / ops;
+    sum += s[k];
+  }
+  uint64_t total = (uint64_t)ops * HOTPATH_SAMPLES;
+  r.busUs = (uint32_t)((hotpathBusNowUs() - bus0) / total);
+#if ST7789_STATS
+  ST7789Cost c = tft.renderStats().total.minus(before);
+  r.busBytes = (uint32_t)(c.bytes / total);
+  r.windows = (uint32_t)(c.windows / total);
+#endif
+  for (uint8_t a = 1; a < HOTPATH_SAMPLES; a++) {
+    uint32_t v = s[a];
+    uint8_t b = a;
+    for (; b > 0 && s[b - 1] > v; b--) s[b] = s[b - 1];
+    s[b] = v;
+  }
+  r.min = s[0];
+  r.median = s[HOTPATH_SAMPLES / 2];
+  r.mean = (uint32_t)(sum / HOTPATH_SAMPLES);
+  return r;
+}
+
+// Out 需提供 write(const uint8_t*, size_t)；每行整体写出，与其它任务的串口输出不会在行内交错
+template <typename Out>
+static inline void hotpathEmit(Out &out, const char *line, int n) {
+  if (n > 0) out.write((const uint8_t *)line, (size_t)(n < HOTPATH_LINE ? n : HOTPATH_LINE - 1));
+}
+
+template <typename Out>
+static inline void hotpathEmitResult(Out &out, const HotpathResult &r, bool last) {
+  char line[HOTPATH_LINE];
+  int n = snprintf(line, sizeof(line),
+                   "{\"name\":\"%s\",\"ops\":%lu,\"median\":%lu,\"min\":%lu,\"mean\":%lu,\"bus_bytes\":%lu,"
+                   "\"windows\":%lu,\"bus_us\":%lu}%s\n",
+                   r.name, (unsigned long)r.ops, (unsigned long)r.median, (unsigned long)r.min, (unsigned long)r.mean,
+                   (unsigned long)r.busBytes, (unsigned long)r.windows, (unsigned long)r.busUs, last ? "" : ",");
+  hotpathEmit(out, line, n);
+}
+
+// 32x32 渐变色图块（RGB565），drawImageF 用例的素材
+static inline const uint16_t *hotpathImage() {
+  static uint16_t img[32 * 32];
+  if (!img[1]) {
+    for (uint16_t y = 0; y < 32; y++)
+      for (uint16_t x = 0; x < 32; x++) img[y * 32 + x] = RGBto565(x * 8, y * 8, (x ^ y) * 8);
+  }
+  return img;
+}
+
+// 跑完全部用例并输出 JSON；会覆盖屏幕内容并重置 displayState，调用方之后需重画布局。
+// build 为固件版本标识（例如 __DATE__ " " __TIME__），target 为 "host" / "esp32"
+template <typename Out>
+static inline void hotpathBenchRun(Out &out, const char *target, const char *build) {
+  char line[HOTPATH_LINE];
+  int n = snprintf(line, sizeof(line),
+                   "{\"suite\":\"hotpath\",\"target\":\"%s\",\"build\":\"%s\",\"unit\":\"%s\",\"samples\":%u,"
+                   "\"kernels\":\"%s\",\"results\":[\n",
+                   target, build, HOTPATH_UNIT, (unsigned)HOTPATH_SAMPLES, rgb565ImplName(rgb565GetImpl()));
+  hotpathEmit(out, line, n);
+
+  layoutInited = false;
+  displayState = DisplayState();
+  initDisplayLayout(0);
+  const uint8_t sz = gOtherLineSize;
+  const int16_t cw = 6 * sz, ch = 8 * sz;
+
+  hotpathEmitResult(out, hotpathMeasure("fillRect_digit", 64, [&](uint32_t i) {
+    tft.fillRect(40 + (i & 7) * cw, displayLayout().y[DW_CO2], cw, ch, (i & 1) ? BLACK : YELLOW);
+  }), false);
+  hotpathEmitResult(out, hotpathMeasure("fillRect_screen", 2, [&](uint32_t i) {
+    tft.fillRect(0, 0, tft.width(), tft.height(), (i & 1) ? BLACK : DBLUE);
+  }), false);
+  tft.setTextColor(WHITE);
+  tft.setTextSize(1);
+  hotpathEmitResult(out, hotpathMeasure("drawChar_s1", 64, [&](uint32_t i) {
+    tft.setCursor(6 * (i & 31), 0);
+    tft.write((uint8_t)('0' + i % 10));
+  }), false);
+  tft.setTextSize(3);
+  hotpathEmitResult(out, hotpathMeasure("drawChar_s3", 16, [&](uint32_t i) {
+    tft.setCursor(18 * (i & 7), 24);
+    tft.write((uint8_t)('0' + i % 10));
+  }), false);
+  const uint16_t *img = hotpathImage();
+  hotpathEmitResult(out, hotpathMeasure("drawImageF_32x32", 8, [&](uint32_t i) {
+    tft.drawImageF(32 * (i & 3), 64, 32, 32, img);
+  }), false);
+
+  // 位级更新：最好情况只换一个字符（450<->451），最坏情况位数变化整块重画（999<->1000）
+  layoutInited = false;
+  initDisplayLayout(0);
+  static const String best[2] = { String("450"), String("451") };
+  static const String worst[2] = { String("999"), String("1000") };
+  hotpathEmitResult(out, hotpathMeasure("updateValue_best", 16, [&](uint32_t i) {
+    const String &a = best[i & 1], &b = best[(i + 1) & 1];
+    updateValue(DW_CO2, a, b);
+  }), false);
+  hotpathEmitResult(out, hotpathMeasure("updateValue_worst", 16, [&](uint32_t i) {
+    const String &a = worst[i & 1], &b = worst[(i + 1) & 1];
+    updateValue(DW_CO2, a, b);
+  }), false);
+
+  // 行缓冲内核：一行 320 像素，当前路径（PIE/SSE2/SWAR）与标量参考各测一遍；不走总线
+  static uint16_t kLine[320] __attribute__((aligned(16)));
+  static uint16_t kSrc[320] __attribute__((aligned(16)));
+  static uint8_t kMask[320];
+  for (uint16_t k = 0; k < 320; k++) {
+    kSrc[k] = (uint16_t)(k * 0x9E37u);
+    kMask[k] = (uint8_t)(k * 7);
+  }
+  const uint8_t kImpl = rgb565GetImpl();
+  for (uint8_t pass = 0; pass < 2; pass++) {
+    rgb565SetImpl(pass ? (uint8_t)RGB565_SCALAR : kImpl);
+    hotpathEmitResult(out, hotpathMeasure(pass ? "rgb565_fill_320_ref" : "rgb565_fill_320", 16, [&](uint32_t i) {
+      rgb565Fill(kLine, (uint16_t)i, 320);
+    }), false);
+    hotpathEmitResult(out, hotpathMeasure(pass ? "rgb565_swap_320_ref" : "rgb565_swap_320", 16, [&](uint32_t) {
+      rgb565SwapCopy(kLine, kSrc, 320);
+    }), false);
+    hotpathEmitResult(out, hotpathMeasure(pass ? "rgb565_blend_320_ref" : "rgb565_blend_320", 16, [&](uint32_t i) {
+      rgb565Blend(kLine, (uint16_t)(i * 0x1234u), kMask, 320);
+    }), false);
+  }
+  rgb565SetImpl(kImpl);
+
+  // processCo2Buffer 的核心：字节流重同步 + 校验 + 流水线。每次操作 = 一帧，前面夹带 0~15 个噪声字节，
+  // 每 8 帧有一帧校验错误
+  static SamplePipeline pipe;
+  Co2FrameParser parser;
+  uint32_t rng = 0x12345678;
+  hotpathEmitResult(out, hotpathMeasure("co2_parse_noise", 64, [&](uint32_t i) {
+    uint8_t f[CO2_FRAME_LEN] = { CO2_FRAME_HDR0, CO2_FRAME_HDR1, 0x00, 0x1C };
+    uint16_t ppm = (uint16_t)(420 + (i & 511));
+    f[6] = (uint8_t)(ppm >> 8);
+    f[7] = (uint8_t)ppm;
+    f[CO2_FRAME_LEN - 1] = co2FrameChecksum(f) ^ ((i & 7) == 7 ? 0x55 : 0);
+    rng ^= rng << 13; rng ^= rng >> 17; rng ^= rng << 5;
+    for (uint8_t k = rng & 15; k; k--) parser.push((uint8_t)(rng >> (k & 7)));
+    parser.feed(f, sizeof(f));
+    uint8_t frame[CO2_FRAME_LEN];
+    while (parser.next(frame)) pipe.pushCo2Frame(frame, i * 1000);
+  }), false);
+
+  static uint8_t crcBuf[256];
+  for (uint16_t k = 0; k < sizeof(crcBuf); k++) crcBuf[k] = (uint8_t)(k * 37 + 11);
+  volatile uint16_t crcSink = 0;
+  hotpathEmitResult(out, hotpathMeasure("modbus_crc16_16B", 256, [&](uint32_t i) {
+    crcSink = modbus_calcuCRC(crcBuf + (i & 63), 16);
+  }), false);
+  hotpathEmitResult(out, hotpathMeasure("modbus_crc16_256B", 16, [&](uint32_t) {
+    crcSink = modbus_calcuCRC(crcBuf, sizeof(crcBuf));
+  }), true);
+  (void)crcSink;
+
+  hotpathEmit(out, "]}\n", 3);
+  layoutInited = false;
+  displayState = DisplayState();
+}
+
+#endif // HOTPATH_BENCH_H
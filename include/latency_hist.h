@@ -0,0 +1,118 @@
+// 热路径延迟直方图：固定 log2 分桶，记录 O(1)、无锁，给出 p50/p99/max，供串口 stats 命令输出
+#ifndef LATENCY_HIST_H
+#define LATENCY_HIST_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <atomic>
+#if defined(ARDUINO_ARCH_ESP32)
+#include <esp_timer.h>
+#else
+#include <chrono>
+#endif
+
+// 桶 0 = 0 us，桶 k (k ≥ 1) = [2^(k-1), 2^k) us，最后一桶收容 ≥ 2^30 us（约 18 分钟）的值。
+// 分位数按桶上界给出（"p99 ≤ X us"），相对误差最多 2 倍，足以区分 10 us 的串口处理与 25 ms 的 DHT 阻塞；max 是精确值。
+// 每个直方图只允许一个写者（计数用 relaxed load+store），读者可在其它任务/核心读取，看到的是近似一致的快照。
+#define LAT_HIST_BUCKETS 32
+
+static inline uint32_t latNowUs() {
+#if defined(ARDUINO_ARCH_ESP32)
+  return (uint32_t)esp_timer_get_time();
+#else
+  return (uint32_t)std::chrono::duration_cast<std::chrono::microseconds>(
+      std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+}
+
+class LatencyHist {
+ public:
+  explicit LatencyHist(const char *name = "") : histName(name) { reset(); }
+
+  static uint8_t bucketOf(uint32_t us) {
+    if (!us) return 0;
+    uint8_t b = (uint8_t)(32 - __builtin_clz(us));
+    return b < LAT_HIST_BUCKETS ? b : LAT_HIST_BUCKETS - 1;
+  }
+  // 桶的上界（含），用于报告分位数
+  static uint32_t bucketUpper(uint8_t b) {
+    if (!b) return 0;
+    return b >= LAT_HIST_BUCKETS - 1 ? UINT32_MAX : (uint32_t)((1ull << b) - 1);
+  }
+
+  void record(uint32_t us) {
+    bump(buckets[bucketOf(us)]);
+    bump(n);
+    uint64_t s = sum.load(std::memory_order_relaxed) + us;
+    sum.store(s, std::memory_order_relaxed);
+    if (us > maxUs.load(std::memory_order_relaxed)) maxUs.store(us, std::memory_order_relaxed);
+  }
+
+  // 从 t0（latNowUs()）到现在的耗时
+  void since(uint32_t t0) { record(latNowUs() - t0); }
+
+  // q 为千分位（500 = p50，990 = p99），返回该分位所在桶的上界，再以 max 封顶
+  uint32_t percentile(uint32_t q) const {
+    uint32_t total = count();
+    if (!total) return 0;
+    uint64_t rank = ((uint64_t)total * q + 999) / 1000;
+    if (!rank) rank = 1;
+    uint64_t acc = 0;
+    for (uint8_t b = 0; b < LAT_HIST_BUCKETS; b++) {
+      acc += buckets[b].load(std::memory_order_relaxed);
+      if (acc >= rank) {
+        uint32_t up = bucketUpper(b), mx = max();
+        return up < mx ? up : mx;
+      }
+    }
+    return max();
+  }
+
+  uint32_t count() const { return n.load(std::memory_order_relaxed); }
+  uint32_t max() const { return maxUs.load(std::memory_order_relaxed); }
+  uint32_t mean() const { uint32_t c = count(); return c ? (uint32_t)(sum.load(std::memory_order_relaxed) / c) : 0; }
+  uint32_t bucket(uint8_t b) const { return buckets[b].load(std::memory_order_relaxed); }
+  const char *name() const { return histName; }
+
+  // 复位应由写者所在任务执行，或接受与并发 record 交错造成的少量计数误差
+  void reset() {
+    for (auto &b : buckets) b.store(0, std::memory_order_relaxed);
+    n.store(0, std::memory_order_relaxed);
+    sum.store(0, std::memory_order_relaxed);
+    maxUs.store(0, std::memory_order_relaxed);
+  }
+
+  // 一行摘要："<name> n=.. mean=..us p50<=..us p99<=..us max=..us"
+  size_t summary(char *out, size_t cap) const {
+    int k = snprintf(out, cap, "%s n=%lu mean=%luus p50<=%luus p99<=%luus max=%luus", histName,
+                     (unsigned long)count(), (unsigned long)mean(), (unsigned long)percentile(500),
+                     (unsigned long)percentile(990), (unsigned long)max());
+    return k < 0 ? 0 : ((size_t)k < cap ? (size_t)k : cap - 1);
+  }
+
+  // 非空桶："<上界>:<计数>" 列表，便于离线画分布
+  size_t bucketLine(char *out, size_t cap) const {
+    size_t k = 0;
+    if (cap) out[0] = 0;
+    for (uint8_t b = 0; b < LAT_HIST_BUCKETS && k + 1 < cap; b++) {
+      uint32_t c = bucket(b);
+      if (!c) continue;
+      int w = snprintf(out + k, cap - k, "%s%lu:%lu", k ? " " : "", (unsigned long)bucketUpper(b), (unsigned long)c);
+      if (w < 0) break;
+      k += (size_t)w < cap - k ? (size_t)w : cap - k - 1;
+    }
+    return k;
+  }
+
+ private:
+  static void bump(std::atomic<uint32_t> &c) { c.store(c.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed); }
+
+  const char *histName;
+  std::atomic<uint32_t> buckets[LAT_HIST_BUCKETS];
+  std::atomic<uint32_t> n;
+  std::atomic<uint64_t> sum;
+  std::atomic<uint32_t> maxUs;
+};
+
+#endif // LATENCY_HIST_H
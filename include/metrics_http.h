@@ -0,0 +1,352 @@
+// HTTP 指标端点：当前读数与滚动聚合以 Prometheus 文本（/metrics）和 JSON（/json）输出。
+// 完整响应（含头）只在样本变化时重建进固定缓冲，抓取只是把现成的字节写进套接字；
+// 连接槽固定、非阻塞 BSD 套接字 + select，不分配堆。ESP32 上走 lwIP，主机上用同一份代码跑回环测试
+#ifndef METRICS_HTTP_H
+#define METRICS_HTTP_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include "sensor_snapshot.h"
+#if defined(ARDUINO_ARCH_ESP32)
+#include <lwip/sockets.h>
+#else
+#include <sys/socket.h>
+#include <sys/select.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+#ifndef MSG_NOSIGNAL
+#define MSG_NOSIGNAL 0   // lwIP 没有 SIGPIPE
+#endif
+
+#define METRICS_MAX_CLIENTS  8      // 同时服务的连接数，超出的连接回 503
+#define METRICS_REQ_MAX      256    // 只需要请求行，其余头部读到空行为止即丢弃
+#define METRICS_RESP_MAX     2048   // 单个响应（头 + 体）上限，Prometheus 文本约 1.5 KB
+#define METRICS_HDR_RESERVE  128    // 响应头预留：体先写在其后，头再贴到体前面，体不用搬动
+#define METRICS_IDLE_MS      3000   // 连接无进展超过该时间即关闭
+
+// 一次发布的内容：采集侧从 sensorStage 与流水线聚合中填写
+struct MetricsSample {
+  uint32_t version = 0;       // 快照版本，变化才重建响应
+  uint32_t co2 = 0;           // ppm
+  float temp = 0;             // °C
+  float hum = 0;              // %RH
+  uint8_t flags = 0;          // SNAP_*_VALID
+  int32_t co2Mean1m = 0, co2Mean1h = 0, co2Mean24h = 0;
+  int32_t co2Min1h = 0, co2Max1h = 0;
+  uint32_t co2Accepted = 0, co2Rejected = 0, dhtRejected = 0;
+  uint32_t uptimeS = 0;
+  uint32_t bootCount = 0;
+  uint32_t epoch = 0;         // 墙上时钟（本地时间秒数）
+};
+
+struct MetricsServerStats {
+  uint32_t accepted = 0;      // 接受的连接
+  uint32_t served = 0;        // 完整发出的 200 响应
+  uint32_t notFound = 0;
+  uint32_t busy = 0;          // 槽满回 503
+  uint32_t timeouts = 0;
+  uint32_t rebuilds = 0;      // 响应重建次数（≈ 样本变化次数，与抓取次数无关）
+  uint32_t deferred = 0;      // 两份缓冲都有连接在读，重建推迟到下一轮
+  uint16_t peakClients = 0;
+};
+
+enum MetricsKind : uint8_t { METRICS_PROM = 0, METRICS_JSON, METRICS_KINDS };
+
+class MetricsServer {
+ public:
+  // port 为 0 时由系统分配（主机测试用），loopback 只监听 127.0.0.1
+  bool begin(uint16_t port, bool loopback = false) {
+    listenFd = socket(AF_INET, SOCK_STREAM, 0);
+    if (listenFd < 0) return false;
+    int one = 1;
+    setsockopt(listenFd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+    struct sockaddr_in a;
+    memset(&a, 0, sizeof(a));
+    a.sin_family = AF_INET;
+    a.sin_port = htons(port);
+    a.sin_addr.s_addr = htonl(loopback ? INADDR_LOOPBACK : INADDR_ANY);
+    if (bind(listenFd, (struct sockaddr *)&a, sizeof(a)) < 0 || listen(listenFd, METRICS_MAX_CLIENTS) < 0 ||
+        !setNonBlocking(listenFd)) {
+      close(listenFd);
+      listenFd = -1;
+      return false;
+    }
+    socklen_t len = sizeof(a);
+    getsockname(listenFd, (struct sockaddr *)&a, &len);
+    boundPort = ntohs(a.sin_port);
+    for (auto &c : conns) c.fd = -1;
+    return true;
+  }
+
+  bool listening() const { return listenFd >= 0; }
+  uint16_t port() const { return boundPort; }
+  const MetricsServerStats &stats() const { return st; }
+  uint8_t clients() const { uint8_t n = 0; for (auto &c : conns) n += c.fd >= 0; return n; }
+
+  // 发布新样本：版本未变则什么都不做；空闲缓冲可用时立即重建，否则记下，等在读的连接发完再建
+  void publish(const MetricsSample &s) {
+    if (s.version == published && hasBuilt) return;
+    pending = s;
+    dirty = true;
+    tryRebuild();
+  }
+
+  // 处理监听与所有连接；waitMs 为 select 最长等待（固件里传 0，由调度器控制节奏）
+  void poll(uint32_t nowMs, uint32_t waitMs = 0) {
+    if (listenFd < 0) return;
+    fd_set rd, wr;
+    FD_ZERO(&rd);
+    FD_ZERO(&wr);
+    int maxFd = listenFd;
+    FD_SET(listenFd, &rd);
+    for (auto &c : conns) {
+      if (c.fd < 0) continue;
+      FD_SET(c.fd, c.out ? &wr : &rd);
+      if (c.fd > maxFd) maxFd = c.fd;
+    }
+    struct timeval tv = { (long)(waitMs / 1000), (long)(waitMs % 1000) * 1000 };
+    int n = select(maxFd + 1, &rd, &wr, nullptr, &tv);
+    if (n > 0 && FD_ISSET(listenFd, &rd)) acceptAll(nowMs);
+    for (auto &c : conns) {
+      if (c.fd < 0) continue;
+      if (n > 0 && !c.out && FD_ISSET(c.fd, &rd)) readRequest(c, nowMs);
+      else if (n > 0 && c.out && FD_ISSET(c.fd, &wr)) sendSome(c, nowMs);
+      if (c.fd >= 0 && nowMs - c.lastMs > METRICS_IDLE_MS) { st.timeouts++; drop(c); }
+    }
+    if (dirty) tryRebuild();
+  }
+
+  // 当前响应（测试/调试用）
+  const char *response(uint8_t kind, uint16_t &len) const {
+    len = gens[cur].len[kind];
+    return gens[cur].start[kind];
+  }
+
+ private:
+  struct Gen {
+    char buf[METRICS_KINDS][METRICS_RESP_MAX];
+    const char *start[METRICS_KINDS] = { nullptr, nullptr };
+    uint16_t len[METRICS_KINDS] = { 0, 0 };
+    uint8_t pins = 0;       // 正在发送这份响应的连接数
+  };
+
+  struct Conn {
+    int fd = -1;
+    char req[METRICS_REQ_MAX];
+    uint16_t reqLen = 0;
+    const char *out = nullptr;   // 非空 = 发送阶段
+    uint16_t outLen = 0, sent = 0;
+    int8_t gen = -1;             // 钉住的缓冲，-1 = 静态错误响应
+    bool ok = false;
+    uint32_t lastMs = 0;
+  };
+
+  static bool setNonBlocking(int fd) {
+    int fl = fcntl(fd, F_GETFL, 0);
+    return fl >= 0 && fcntl(fd, F_SETFL, fl | O_NONBLOCK) >= 0;
+  }
+
+  void acceptAll(uint32_t nowMs) {
+    for (;;) {
+      int fd = accept(listenFd, nullptr, nullptr);
+      if (fd < 0) return;
+      st.accepted++;
+      Conn *slot = nullptr;
+      for (auto &c : conns) if (c.fd < 0) { slot = &c; break; }
+      if (!slot || !setNonBlocking(fd)) {
+        // 槽满：尽力回一个 503 后立即关闭，不占槽位
+        static const char busy[] = "HTTP/1.0 503 Service Unavailable\r\nContent-Length: 0\r\nConnection: close\r\n\r\n";
+        send(fd, busy, sizeof(busy) - 1, MSG_NOSIGNAL | MSG_DONTWAIT);
+        close(fd);
+        st.busy++;
+        continue;
+      }
+      slot->fd = fd;
+      slot->reqLen = 0;
+      slot->out = nullptr;
+      slot->gen = -1;
+      slot->lastMs = nowMs;
+      uint8_t k = clients();
+      if (k > st.peakClients) st.peakClients = k;
+    }
+  }
+
+  void readRequest(Conn &c, uint32_t nowMs) {
+    int r = recv(c.fd, c.req + c.reqLen, METRICS_REQ_MAX - 1 - c.reqLen, 0);
+    if (r <= 0) {
+      if (r < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) return;
+      drop(c);
+      return;
+    }
+    c.reqLen += (uint16_t)r;
+    c.req[c.reqLen] = 0;
+    c.lastMs = nowMs;
+    // 等到头部结束；请求超长时按已有的请求行处理
+    if (!strstr(c.req, "\r\n\r\n") && !strstr(c.req, "\n\n") && c.reqLen < METRICS_REQ_MAX - 1) return;
+    int kind = route(c.req);
+    if (kind < 0 || !hasBuilt) {
+      static const char nf[] = "HTTP/1.0 404 Not Found\r\nContent-Type: text/plain\r\nContent-Length: 10\r\n"
+                               "Connection: close\r\n\r\nnot found\n";
+      st.notFound++;
+      c.out = nf;
+      c.outLen = sizeof(nf) - 1;
+      c.gen = -1;
+      c.ok = false;
+    } else {
+      c.gen = (int8_t)cur;
+      gens[cur].pins++;
+      c.out = gens[cur].start[kind];
+      c.outLen = gens[cur].len[kind];
+      c.ok = true;
+    }
+    c.sent = 0;
+    sendSome(c, nowMs);
+  }
+
+  // "GET /metrics" -> Prometheus，"GET /json" 或 "GET /" -> JSON
+  static int route(const char *req) {
+    if (strncmp(req, "GET ", 4)) return -1;
+    const char *p = req + 4;
+    size_t n = strcspn(p, " ?\r\n");
+    if (n == 8 && !strncmp(p, "/metrics", 8)) return METRICS_PROM;
+    if ((n == 5 && !strncmp(p, "/json", 5)) || (n == 1 && *p == '/')) return METRICS_JSON;
+    return -1;
+  }
+
+  void sendSome(Conn &c, uint32_t nowMs) {
+    while (c.sent < c.outLen) {
+      int w = send(c.fd, c.out + c.sent, c.outLen - c.sent, MSG_NOSIGNAL);
+      if (w < 0) {
+        if (errno == EAGAIN || errno == EWOULDBLOCK) return;
+        drop(c);
+        return;
+      }
+      c.sent += (uint16_t)w;
+      c.lastMs = nowMs;
+    }
+    if (c.ok) st.served++;
+    drop(c);
+  }
+
+  void drop(Conn &c) {
+    if (c.gen >= 0) gens[c.gen].pins--;
+    c.gen = -1;
+    c.out = nullptr;
+    close(c.fd);
+    c.fd = -1;
+  }
+
+  // 写进没有连接在读的那份缓冲，再切换为当前
+  void tryRebuild() {
+    uint8_t next = hasBuilt ? cur ^ 1 : cur;
+    if (gens[next].pins) { st.deferred++; return; }
+    build(gens[next], pending);
+    cur = next;
+    published = pending.version;
+    hasBuilt = true;
+    dirty = false;
+    st.rebuilds++;
+  }
+
+  static void build(Gen &g, const MetricsSample &s) {
+    buildOne(g, METRICS_PROM, "text/plain; version=0.0.4", s);
+    buildOne(g, METRICS_JSON, "application/json", s);
+  }
+
+  static void buildOne(Gen &g, uint8_t kind, const char *type, const MetricsSample &s) {
+    char *body = g.buf[kind] + METRICS_HDR_RESERVE;
+    size_t cap = METRICS_RESP_MAX - METRICS_HDR_RESERVE;
+    int n = kind == METRICS_PROM ? formatProm(body, cap, s) : formatJson(body, cap, s);
+    if (n < 0) n = 0;
+    if ((size_t)n >= cap) n = (int)cap - 1;   // 截断：静态上限应保证不会发生
+    char hdr[METRICS_HDR_RESERVE];
+    int h = snprintf(hdr, sizeof(hdr), "HTTP/1.0 200 OK\r\nContent-Type: %s\r\nContent-Length: %d\r\nConnection: close\r\n\r\n",
+                     type, n);
+    if (h < 0 || h >= (int)sizeof(hdr)) h = 0;
+    char *start = body - h;
+    memcpy(start, hdr, (size_t)h);
+    g.start[kind] = start;
+    g.len[kind] = (uint16_t)(h + n);
+  }
+
+  static int formatProm(char *out, size_t cap, const MetricsSample &s) {
+    return snprintf(out, cap,
+        "# HELP airmon_co2_ppm CO2 concentration (median filtered).\n"
+        "# TYPE airmon_co2_ppm gauge\n"
+        "airmon_co2_ppm %lu\n"
+        "# HELP airmon_co2_mean_ppm Rolling mean CO2 concentration.\n"
+        "# TYPE airmon_co2_mean_ppm gauge\n"
+        "airmon_co2_mean_ppm{window=\"1m\"} %ld\n"
+        "airmon_co2_mean_ppm{window=\"1h\"} %ld\n"
+        "airmon_co2_mean_ppm{window=\"24h\"} %ld\n"
+        "# HELP airmon_co2_range_ppm CO2 minimum and maximum over the last hour.\n"
+        "# TYPE airmon_co2_range_ppm gauge\n"
+        "airmon_co2_range_ppm{window=\"1h\",bound=\"min\"} %ld\n"
+        "airmon_co2_range_ppm{window=\"1h\",bound=\"max\"} %ld\n"
+        "# HELP airmon_temperature_celsius Air temperature.\n"
+        "# TYPE airmon_temperature_celsius gauge\n"
+        "airmon_temperature_celsius %.2f\n"
+        "# HELP airmon_humidity_percent Relative humidity.\n"
+        "# TYPE airmon_humidity_percent gauge\n"
+        "airmon_humidity_percent %.2f\n"
+        "# HELP airmon_sensor_valid Whether the sensor has produced a valid reading since boot.\n"
+        "# TYPE airmon_sensor_valid gauge\n"
+        "airmon_sensor_valid{sensor=\"co2\"} %d\n"
+        "airmon_sensor_valid{sensor=\"temperature\"} %d\n"
+        "airmon_sensor_valid{sensor=\"humidity\"} %d\n"
+        "# HELP airmon_co2_frames_total CO2 sensor frames by result.\n"
+        "# TYPE airmon_co2_frames_total counter\n"
+        "airmon_co2_frames_total{result=\"accepted\"} %lu\n"
+        "airmon_co2_frames_total{result=\"rejected\"} %lu\n"
+        "# HELP airmon_dht_rejected_total Rejected DHT readings.\n"
+        "# TYPE airmon_dht_rejected_total counter\n"
+        "airmon_dht_rejected_total %lu\n"
+        "# HELP airmon_uptime_seconds Seconds since boot.\n"
+        "# TYPE airmon_uptime_seconds gauge\n"
+        "airmon_uptime_seconds %lu\n"
+        "# HELP airmon_boot_count Boots since power-on.\n"
+        "# TYPE airmon_boot_count gauge\n"
+        "airmon_boot_count %lu\n"
+        "# HELP airmon_clock_epoch_seconds Device wall clock (local time).\n"
+        "# TYPE airmon_clock_epoch_seconds gauge\n"
+        "airmon_clock_epoch_seconds %lu\n",
+        (unsigned long)s.co2, (long)s.co2Mean1m, (long)s.co2Mean1h, (long)s.co2Mean24h, (long)s.co2Min1h,
+        (long)s.co2Max1h, (double)s.temp, (double)s.hum, (s.flags & SNAP_CO2_VALID) ? 1 : 0, (s.flags & SNAP_TEMP_VALID) ? 1 : 0,
+        (s.flags & SNAP_HUM_VALID) ? 1 : 0, (unsigned long)s.co2Accepted, (unsigned long)s.co2Rejected,
+        (unsigned long)s.dhtRejected, (unsigned long)s.uptimeS, (unsigned long)s.bootCount, (unsigned long)s.epoch);
+  }
+
+  static int formatJson(char *out, size_t cap, const MetricsSample &s) {
+    return snprintf(out, cap,
+        "{\"version\":%lu,\"co2\":%lu,\"temp\":%.2f,\"hum\":%.2f,"
+        "\"valid\":{\"co2\":%s,\"temp\":%s,\"hum\":%s},"
+        "\"co2_mean\":{\"1m\":%ld,\"1h\":%ld,\"24h\":%ld},\"co2_1h\":{\"min\":%ld,\"max\":%ld},"
+        "\"co2_frames\":{\"accepted\":%lu,\"rejected\":%lu},\"dht_rejected\":%lu,"
+        "\"uptime_s\":%lu,\"boot_count\":%lu,\"epoch\":%lu}\n",
+        (unsigned long)s.version, (unsigned long)s.co2, (double)s.temp, (double)s.hum,
+        (s.flags & SNAP_CO2_VALID) ? "true" : "false", (s.flags & SNAP_TEMP_VALID) ? "true" : "false",
+        (s.flags & SNAP_HUM_VALID) ? "true" : "false",
+        (long)s.co2Mean1m, (long)s.co2Mean1h, (long)s.co2Mean24h, (long)s.co2Min1h, (long)s.co2Max1h,
+        (unsigned long)s.co2Accepted, (unsigned long)s.co2Rejected, (unsigned long)s.dhtRejected,
+        (unsigned long)s.uptimeS, (unsigned long)s.bootCount, (unsigned long)s.epoch);
+  }
+
+  int listenFd = -1;
+  uint16_t boundPort = 0;
+  Conn conns[METRICS_MAX_CLIENTS];
+  Gen gens[2];
+  uint8_t cur = 0;
+  bool hasBuilt = false, dirty = false;
+  uint32_t published = 0;
+  MetricsSample pending;
+  MetricsServerStats st;
+};
+
+#endif // METRICS_HTTP_H
@@ -0,0 +1,405 @@
+// MQTT 批量上报：每个周期把新样本编码成一条 telemetry_codec 块（约 1 字节/样本）用 QoS 1 发布，
+// 不再一条读数一条消息。样本本身就在闪存日志（或 PSRAM 历史）里，发布器只维护"已送达到哪个时间"的游标：
+// 断线期间游标不动，积压自然留在日志中；重连后按 drainIntervalMs 限速逐批补发，追上后回到正常周期。
+// 客户端是最小的 MQTT 3.1.1 子集（CONNECT/PUBLISH QoS1/PINGREQ），非阻塞套接字，ESP32 上走 lwIP
+#ifndef MQTT_PUBLISHER_H
+#define MQTT_PUBLISHER_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <errno.h>
+#include "telemetry_codec.h"
+#if defined(ARDUINO_ARCH_ESP32)
+#include <lwip/sockets.h>
+#else
+#include <sys/socket.h>
+#include <sys/select.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+#ifndef MSG_NOSIGNAL
+#define MSG_NOSIGNAL 0   // lwIP 没有 SIGPIPE
+#endif
+
+#define MQTT_TX_MAX          1280   // 一个 PUBLISH 报文（固定头 + 主题 + 报文 ID + 负载）
+#define MQTT_RX_MAX          16     // 只收 CONNACK/PUBACK/PINGRESP，其余报文跳过
+#define MQTT_BACKOFF_MIN_MS  1000
+#define MQTT_BACKOFF_MAX_MS  60000
+#define MQTT_CONNECT_TIMEOUT_MS 10000
+
+enum MqttState : uint8_t {
+  MQTT_DISCONNECTED = 0,   // 等待退避结束后重连
+  MQTT_TCP_CONNECTING,
+  MQTT_CONNACK_WAIT,
+  MQTT_CONNECTED,
+};
+
+struct MqttClientStats {
+  uint32_t connects = 0;       // 成功（收到 CONNACK 0）
+  uint32_t failures = 0;       // 连接失败或断线
+  uint32_t publishes = 0;
+  uint32_t acks = 0;
+  uint64_t txBytes = 0;
+};
+
+class MqttClient {
+ public:
+  // host 为点分 IPv4；字符串须在客户端生命周期内有效
+  void configure(const char *host, uint16_t port, const char *clientId, const char *user = nullptr,
+                 const char *pass = nullptr, uint16_t keepAliveS = 60) {
+    brokerIp = host;
+    brokerPort = port;
+    id = clientId;
+    username = user;
+    password = pass;
+    keepAlive = keepAliveS;
+  }
+
+  // 推进连接状态机、收发与保活；不阻塞
+  void poll(uint32_t nowMs) {
+    now = nowMs;
+    switch (state) {
+      case MQTT_DISCONNECTED:
+        if ((int32_t)(nowMs - retryAt) >= 0) startConnect();
+        return;
+      case MQTT_TCP_CONNECTING: {
+        int err = 0;
+        if (!ready(true, err)) {
+          if (err || nowMs - stateMs > MQTT_CONNECT_TIMEOUT_MS) fail();
+          return;
+        }
+        sendConnect();
+        setState(MQTT_CONNACK_WAIT);
+        break;
+      }
+      default:
+        break;
+    }
+    flushTx();
+    if (fd >= 0) receive();
+    if (state == MQTT_CONNACK_WAIT && nowMs - stateMs > MQTT_CONNECT_TIMEOUT_MS) fail();
+    if (state != MQTT_CONNECTED) return;
+    // 保活：空闲半个周期发 PINGREQ，1.5 个周期没有任何回应视为断线
+    uint32_t ka = (uint32_t)keepAlive * 1000;
+    if (ka && nowMs - lastRxMs > ka + ka / 2) { fail(); return; }
+    if (ka && !txLen && nowMs - lastTxMs > ka / 2) {
+      static const uint8_t ping[2] = { 0xC0, 0x00 };
+      queue(ping, sizeof(ping));
+      flushTx();
+    }
+  }
+
+  bool connected() const { return state == MQTT_CONNECTED; }
+  MqttState getState() const { return state; }
+  const MqttClientStats &stats() const { return st; }
+
+  // QoS 1 发布；发送缓冲有未发完的数据或报文过大时返回 false。packetId 用于 acked()
+  bool publish(const char *topic, const uint8_t *payload, size_t len, uint16_t &packetId) {
+    size_t tl = strlen(topic);
+    size_t rem = 2 + tl + 2 + len;
+    if (state != MQTT_CONNECTED || txLen || rem > MQTT_TX_MAX - 5) return false;
+    if (++nextId == 0) nextId = 1;
+    packetId = nextId;
+    uint8_t *p = txBuf;
+    *p++ = 0x32;   // PUBLISH, QoS 1
+    p += putVarint(p, (uint32_t)rem);
+    *p++ = (uint8_t)(tl >> 8); *p++ = (uint8_t)tl;
+    memcpy(p, topic, tl); p += tl;
+    *p++ = (uint8_t)(packetId >> 8); *p++ = (uint8_t)packetId;
+    memcpy(p, payload, len); p += len;
+    txLen = (size_t)(p - txBuf);
+    txOff = 0;
+    st.publishes++;
+    flushTx();
+    return true;
+  }
+
+  // 该报文 ID 的 PUBACK 是否已到（只跟踪最近一个，发布器同一时刻只有一条在途）
+  bool acked(uint16_t packetId) const { return lastAckId == packetId; }
+
+  // 主动断开（如等待 PUBACK 超时），按退避重连
+  void drop() { if (state != MQTT_DISCONNECTED) fail(); }
+
+ private:
+  static size_t putVarint(uint8_t *p, uint32_t v) {
+    size_t n = 0;
+    do {
+      uint8_t b = v & 0x7F;
+      v >>= 7;
+      p[n++] = (uint8_t)(b | (v ? 0x80 : 0));
+    } while (v);
+    return n;
+  }
+
+  void setState(MqttState s) { state = s; stateMs = now; }
+
+  void startConnect() {
+    fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (fd < 0) { fail(); return; }
+    int fl = fcntl(fd, F_GETFL, 0);
+    fcntl(fd, F_SETFL, fl | O_NONBLOCK);
+    int one = 1;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    struct sockaddr_in a;
+    memset(&a, 0, sizeof(a));
+    a.sin_family = AF_INET;
+    a.sin_port = htons(brokerPort);
+    a.sin_addr.s_addr = inet_addr(brokerIp);
+    txLen = txOff = 0;
+    rxLen = 0;
+    skip = 0;
+    lastAckId = 0;
+    if (connect(fd, (struct sockaddr *)&a, sizeof(a)) < 0 && errno != EINPROGRESS) { fail(); return; }
+    setState(MQTT_TCP_CONNECTING);
+  }
+
+  // 非阻塞 connect 是否完成（可写），err 为 SO_ERROR
+  bool ready(bool forWrite, int &err) {
+    fd_set s;
+    FD_ZERO(&s);
+    FD_SET(fd, &s);
+    struct timeval tv = { 0, 0 };
+    if (select(fd + 1, forWrite ? nullptr : &s, forWrite ? &s : nullptr, nullptr, &tv) <= 0) return false;
+    socklen_t l = sizeof(err);
+    getsockopt(fd, SOL_SOCKET, SO_ERROR, &err, &l);
+    return err == 0;
+  }
+
+  void sendConnect() {
+    uint8_t pkt[128];
+    size_t il = strlen(id), ul = username ? strlen(username) : 0, pl = password ? strlen(password) : 0;
+    size_t rem = 10 + 2 + il + (username ? 2 + ul : 0) + (password ? 2 + pl : 0);
+    if (rem + 5 > sizeof(pkt)) { fail(); return; }
+    uint8_t *p = pkt;
+    *p++ = 0x10;
+    p += putVarint(p, (uint32_t)rem);
+    static const uint8_t proto[7] = { 0x00, 0x04, 'M', 'Q', 'T', 'T', 0x04 };
+    memcpy(p, proto, sizeof(proto)); p += sizeof(proto);
+    *p++ = (uint8_t)(0x02 | (username ? 0x80 : 0) | (password ? 0x40 : 0));   // clean session
+    *p++ = (uint8_t)(keepAlive >> 8); *p++ = (uint8_t)keepAlive;
+    p = putStr(p, id, il);
+    if (username) p = putStr(p, username, ul);
+    if (password) p = putStr(p, password, pl);
+    queue(pkt, (size_t)(p - pkt));
+  }
+
+  static uint8_t *putStr(uint8_t *p, const char *s, size_t n) {
+    *p++ = (uint8_t)(n >> 8); *p++ = (uint8_t)n;
+    memcpy(p, s, n);
+    return p + n;
+  }
+
+  void queue(const uint8_t *b, size_t n) {
+    if (txLen + n > sizeof(txBuf)) return;
+    memcpy(txBuf + txLen, b, n);
+    txLen += n;
+  }
+
+  void flushTx() {
+    while (fd >= 0 && txOff < txLen) {
+      int w = send(fd, txBuf + txOff, txLen - txOff, MSG_NOSIGNAL);
+      if (w < 0) {
+        if (errno != EAGAIN && errno != EWOULDBLOCK) fail();
+        return;
+      }
+      txOff += (size_t)w;
+      st.txBytes += (uint64_t)w;
+      lastTxMs = now;
+    }
+    if (txOff == txLen) txLen = txOff = 0;
+  }
+
+  void receive() {
+    uint8_t tmp[64];
+    for (;;) {
+      int r = recv(fd, tmp, sizeof(tmp), MSG_DONTWAIT);
+      if (r == 0) { fail(); return; }
+      if (r < 0) {
+        if (errno != EAGAIN && errno != EWOULDBLOCK) fail();
+        return;
+      }
+      lastRxMs = now;
+      for (int i = 0; i < r && fd >= 0; i++) rxByte(tmp[i]);
+    }
+  }
+
+  // 逐字节拼报文：[类型][剩余长度 varint][内容]；超过 MQTT_RX_MAX 的报文只计数跳过
+  void rxByte(uint8_t b) {
+    if (skip) { skip--; return; }
+    rxBuf[rxLen++] = b;
+    if (rxLen < 2) return;
+    uint32_t rem = 0, mul = 1;
+    size_t i = 1;
+    for (; i < rxLen; i++) {
+      rem += (rxBuf[i] & 0x7F) * mul;
+      mul <<= 7;
+      if (!(rxBuf[i] & 0x80)) break;
+      if (i == 4) { fail(); return; }
+    }
+    if (i == rxLen) return;   // 长度字段未收全
+    size_t hdr = i + 1;
+    if (hdr + rem > MQTT_RX_MAX) { skip = hdr + rem - rxLen; rxLen = 0; return; }
+    if (rxLen < hdr + rem) return;
+    handle(rxBuf[0] >> 4, rxBuf + hdr, rem);
+    rxLen = 0;
+  }
+
+  void handle(uint8_t type, const uint8_t *p, uint32_t n) {
+    if (type == 2 && n >= 2) {   // CONNACK
+      if (p[1] != 0) { fail(); return; }
+      setState(MQTT_CONNECTED);
+      backoff = MQTT_BACKOFF_MIN_MS;
+      st.connects++;
+    } else if (type == 4 && n >= 2) {   // PUBACK
+      lastAckId = (uint16_t)(p[0] << 8 | p[1]);
+      st.acks++;
+    }
+  }
+
+  void fail() {
+    if (fd >= 0) close(fd);
+    fd = -1;
+    st.failures++;
+    setState(MQTT_DISCONNECTED);
+    retryAt = now + backoff;
+    backoff = backoff * 2 > MQTT_BACKOFF_MAX_MS ? MQTT_BACKOFF_MAX_MS : backoff * 2;
+    txLen = txOff = 0;
+  }
+
+  const char *brokerIp = "127.0.0.1";
+  uint16_t brokerPort = 1883;
+  const char *id = "airmon";
+  const char *username = nullptr;
+  const char *password = nullptr;
+  uint16_t keepAlive = 60;
+
+  int fd = -1;
+  MqttState state = MQTT_DISCONNECTED;
+  uint32_t now = 0, stateMs = 0, retryAt = 0, lastRxMs = 0, lastTxMs = 0;
+  uint32_t backoff = MQTT_BACKOFF_MIN_MS;
+  uint8_t txBuf[MQTT_TX_MAX];
+  size_t txLen = 0, txOff = 0;
+  uint8_t rxBuf[MQTT_RX_MAX];
+  size_t rxLen = 0;
+  uint32_t skip = 0;
+  uint16_t nextId = 0, lastAckId = 0;
+  MqttClientStats st;
+};
+
+// ---- 批量发布器 ----
+#define MQTT_BATCH_CAP    240    // 单批样本上限（编码后约 300 字节）
+#define MQTT_PAYLOAD_MAX  1024
+
+struct MqttBatchConfig {
+  uint32_t batchIntervalMs = 60000;   // 追上后每周期发一批
+  uint16_t batchMax = 120;            // 每批最多样本数（≤ MQTT_BATCH_CAP）
+  uint32_t drainIntervalMs = 1000;    // 有积压时批与批的最小间隔（补发限速）
+  uint32_t maxBacklogSec = 7 * 86400; // 更早的积压直接放弃
+  uint32_t ackTimeoutMs = 10000;      // PUBACK 超时即断线重连，从游标处重发
+};
+
+struct MqttBatchStats {
+  uint32_t batches = 0;        // 已确认的批
+  uint32_t samples = 0;        // 已确认的样本
+  uint64_t payloadBytes = 0;
+  uint32_t resends = 0;        // 超时/断线后重发的批
+  uint32_t skippedSec = 0;     // 超出 maxBacklogSec 被放弃的时间跨度
+  uint32_t backlogSec = 0;     // 当前积压（最新样本时间 - 游标）
+  uint32_t peakBacklogSec = 0;
+};
+
+// Source 需提供 size_t read(uint32_t t0, uint32_t t1, TelemetrySample *out, size_t maxOut)（FlashLog 即可）
+template <typename Source>
+class MqttBatchPublisher {
+ public:
+  MqttBatchPublisher(MqttClient &c, Source &s) : client(c), src(s) {}
+
+  // cursor：此前已送达的最后样本时间（冷启动传当前最新时间即不补发开机前的数据）
+  void begin(const char *batchTopic, uint32_t cursor, const MqttBatchConfig &c = MqttBatchConfig()) {
+    topic = batchTopic;
+    delivered = cursor;
+    setConfig(c);
+  }
+
+  void setConfig(const MqttBatchConfig &c) {
+    cfg = c;
+    if (!cfg.batchMax || cfg.batchMax > MQTT_BATCH_CAP) cfg.batchMax = MQTT_BATCH_CAP;
+  }
+  const MqttBatchConfig &config() const { return cfg; }
+
+  // latestT：数据源中最新样本的时间。返回 true 表示本次发出了一批
+  bool tick(uint32_t nowMs, uint32_t latestT) {
+    client.poll(nowMs);
+    st.backlogSec = latestT > delivered ? latestT - delivered : 0;
+    if (st.backlogSec > st.peakBacklogSec) st.peakBacklogSec = st.backlogSec;
+    if (inflight) {
+      if (client.acked(inflightId)) {
+        delivered = inflightLastT;
+        inflight = false;
+        st.batches++;
+        st.samples += inflightCount;
+        st.payloadBytes += inflightBytes;
+      } else if (!client.connected() || nowMs - sentMs > cfg.ackTimeoutMs) {
+        // 没有确认：游标不动，重连后从同一位置重发（至少一次，接收端按时间戳去重）
+        inflight = false;
+        st.resends++;
+        if (client.connected()) client.drop();
+        return false;
+      } else {
+        return false;
+      }
+    }
+    if (!client.connected() || latestT <= delivered) return false;
+    if (latestT - delivered > cfg.maxBacklogSec) {
+      st.skippedSec += latestT - delivered - cfg.maxBacklogSec;
+      delivered = latestT - cfg.maxBacklogSec;
+    }
+    // 积压超过一个周期的量按补发节奏，否则按正常周期
+    bool behind = latestT - delivered > cfg.batchIntervalMs / 1000 + 1;
+    uint32_t gap = behind ? cfg.drainIntervalMs : cfg.batchIntervalMs;
+    if (hasSent && nowMs - lastSendMs < gap) return false;
+    return sendBatch(nowMs, latestT);
+  }
+
+  uint32_t cursor() const { return delivered; }
+  const MqttBatchStats &stats() const { return st; }
+
+ private:
+  bool sendBatch(uint32_t nowMs, uint32_t latestT) {
+    size_t n = src.read(delivered + 1, latestT, samples, cfg.batchMax);
+    if (!n) { delivered = latestT; return false; }   // 区间内没有样本（停机空档）
+    TelemetryEncoder enc(payload, sizeof(payload));
+    size_t k = 0;
+    while (k < n && enc.append(samples[k])) k++;
+    if (!k) { delivered = samples[0].t; return false; }   // 无法编码的样本（时间倒退）跳过
+    size_t len = enc.finish();
+    if (!client.publish(topic, payload, len, inflightId)) return false;
+    inflight = true;
+    inflightLastT = samples[k - 1].t;
+    inflightCount = (uint32_t)k;
+    inflightBytes = (uint32_t)len;
+    sentMs = lastSendMs = nowMs;
+    hasSent = true;
+    return true;
+  }
+
+  MqttClient &client;
+  Source &src;
+  const char *topic = "airmon/batch";
+  MqttBatchConfig cfg;
+  MqttBatchStats st;
+  uint32_t delivered = 0;
+  bool inflight = false, hasSent = false;
+  uint16_t inflightId = 0;
+  uint32_t inflightLastT = 0, inflightCount = 0, inflightBytes = 0;
+  uint32_t sentMs = 0, lastSendMs = 0;
+  TelemetrySample samples[MQTT_BATCH_CAP];
+  uint8_t payload[MQTT_PAYLOAD_MAX];
+};
+
+#endif // MQTT_PUBLISHER_H
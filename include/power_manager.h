@@ -0,0 +1,171 @@
+// 低功耗：按调度空闲与 CO2 帧到达预测进入 light sleep，串口/定时器唤醒；读数稳定时屏幕降功耗；统计唤醒延迟与占空比
+#ifndef POWER_MANAGER_H
+#define POWER_MANAGER_H
+
+#include <stdint.h>
+#include "sensor_snapshot.h"
+#if defined(ARDUINO_ARCH_ESP32)
+#include <esp_sleep.h>
+#include <esp_timer.h>
+#include <driver/uart.h>
+#endif
+
+// light sleep 期间 UART 不接收数据，唤醒 CPU 的那几个字节也会丢失（ESP-IDF 的限制），
+// 所以不能"睡到有字节再说"：CO2 传感器每秒一帧，按已收到帧的时间预测下一帧，
+// 只在两帧之间的空隙里睡，帧窗口前 guard 毫秒醒来轮询。串口唤醒只是预测失准时的兜底，
+// 此时那一帧会因缺字节被解析器丢弃，计入 lost 并加大 guard。
+#define POWER_FRAME_PERIOD_MS   1000
+#define POWER_GUARD_MIN_MS      60      // ≥ 串口轮询周期 20 ms + 一帧传输时间约 17 ms + 余量
+#define POWER_GUARD_MAX_MS      250
+#define POWER_MIN_SLEEP_MS      15      // 太短的空闲不值得进出 light sleep（进出开销约 1 ms 量级）
+#define POWER_UART_WAKE_EDGES   3       // 串口唤醒阈值（RX 边沿数，ESP32-S3 最小为 3）
+
+enum PowerWakeCause : uint8_t { POWER_WAKE_TIMER = 0, POWER_WAKE_UART = 1, POWER_WAKE_OTHER = 2 };
+
+// 帧到达预测：周期用帧间隔的指数平均跟踪传感器时钟偏差，时间为轮询到整帧的时刻
+class Co2FramePredictor {
+ public:
+  void onFrame(uint32_t now) {
+    if (valid) {
+      uint32_t gap = now - lastMs;
+      if (gap > periodMs + periodMs / 2) {
+        // 中间缺帧：按平均周期估计丢了几帧
+        lost += (gap + periodMs / 2) / periodMs - 1;
+      } else if (gap > periodMs / 2) {
+        periodMs = (periodMs * 7 + gap + 4) / 8;
+        if (guardMs > POWER_GUARD_MIN_MS) guardMs--;   // 连续按时到达，慢慢收紧
+      }
+    }
+    lastMs = now;
+    valid = true;
+    frames++;
+  }
+
+  // 预测失准：帧在睡眠中到达把 CPU 唤醒
+  void onEarlyArrival() {
+    guardMs = guardMs * 2 > POWER_GUARD_MAX_MS ? POWER_GUARD_MAX_MS : guardMs * 2;
+  }
+
+  // 距下一帧窗口开始还有多少毫秒；未同步（开机或连续丢帧）时返回 0，保持清醒直到重新对上
+  uint32_t msUntilWindow(uint32_t now) const {
+    if (!valid || now - lastMs > 2 * periodMs) return 0;
+    int32_t d = (int32_t)(lastMs + periodMs - guardMs - now);
+    return d > 0 ? (uint32_t)d : 0;
+  }
+
+  // 本次空闲可睡多久：不超过调度空闲，也不跨进帧窗口；太短或不该睡时返回 0
+  uint32_t sleepBudget(uint32_t idleMs, uint32_t now) const {
+    uint32_t w = msUntilWindow(now);
+    uint32_t b = idleMs < w ? idleMs : w;
+    return b >= POWER_MIN_SLEEP_MS ? b : 0;
+  }
+
+  uint32_t period() const { return periodMs; }
+  uint32_t guard() const { return guardMs; }
+  uint32_t framesSeen() const { return frames; }
+  uint32_t framesLost() const { return lost; }
+
+ private:
+  uint32_t lastMs = 0;
+  uint32_t periodMs = POWER_FRAME_PERIOD_MS;
+  uint32_t guardMs = POWER_GUARD_MIN_MS;
+  uint32_t frames = 0;
+  uint32_t lost = 0;
+  bool valid = false;
+};
+
+// 一个统计窗口内的睡眠记录；唤醒延迟 = 实际睡眠时长 - 请求时长（仅定时器唤醒，含进出睡眠开销）
+struct PowerStats {
+  uint32_t windowStartUs = 0;
+  uint32_t sleeps = 0;
+  uint32_t wakes[3] = { 0, 0, 0 };   // 按 PowerWakeCause
+  uint64_t sleptUs = 0;
+  uint64_t latSumUs = 0;
+  uint32_t latMaxUs = 0;
+
+  void record(uint8_t cause, uint32_t requestedUs, uint32_t sleptUsNow) {
+    sleeps++;
+    wakes[cause < 3 ? cause : (uint8_t)POWER_WAKE_OTHER]++;
+    sleptUs += sleptUsNow;
+    if (cause == POWER_WAKE_TIMER) {
+      uint32_t lat = sleptUsNow > requestedUs ? sleptUsNow - requestedUs : 0;
+      latSumUs += lat;
+      if (lat > latMaxUs) latMaxUs = lat;
+    }
+  }
+
+  // 清醒时间占比（千分比）
+  uint32_t awakePermille(uint32_t nowUs) const {
+    uint32_t total = nowUs - windowStartUs;
+    if (!total) return 1000;
+    uint64_t slept = sleptUs < total ? sleptUs : total;
+    return (uint32_t)((total - slept) * 1000 / total);
+  }
+
+  uint32_t latMeanUs() const { return wakes[POWER_WAKE_TIMER] ? (uint32_t)(latSumUs / wakes[POWER_WAKE_TIMER]) : 0; }
+
+  void reset(uint32_t nowUs) { *this = PowerStats(); windowStartUs = nowUs; }
+};
+
+// 屏幕功耗：读数在参考值附近保持 stableMs 后降为 DIM（idle 8 色模式 + 省电 + 低亮度），
+// 任一读数离开容差带立即回到 FULL 并以新读数为参考。只决定级别，面板命令由渲染侧下发（SPI 归渲染核心）
+enum PanelPowerLevel : uint8_t { PANEL_FULL = 0, PANEL_DIM = 1 };
+
+#define PANEL_STABLE_MS        60000
+#define PANEL_CO2_BAND_PPM     50
+#define PANEL_TEMP_BAND_C      0.3f
+#define PANEL_HUM_BAND_PCT     2.0f
+
+class PanelPowerPolicy {
+ public:
+  uint8_t update(const SensorSnapshot &s, uint32_t now) {
+    if (!haveRef || moved(s)) {
+      ref = s;
+      haveRef = true;
+      since = now;
+      lv = PANEL_FULL;
+    } else if (lv == PANEL_FULL && now - since >= PANEL_STABLE_MS) {
+      lv = PANEL_DIM;
+    }
+    return lv;
+  }
+
+  uint8_t level() const { return lv; }
+
+ private:
+  static float absf(float v) { return v < 0 ? -v : v; }
+  bool moved(const SensorSnapshot &s) const {
+    int32_t dc = (int32_t)s.co2 - (int32_t)ref.co2;
+    return dc >= PANEL_CO2_BAND_PPM || dc <= -PANEL_CO2_BAND_PPM || absf(s.temp - ref.temp) >= PANEL_TEMP_BAND_C ||
+           absf(s.hum - ref.hum) >= PANEL_HUM_BAND_PCT;
+  }
+
+  SensorSnapshot ref;
+  bool haveRef = false;
+  uint32_t since = 0;
+  uint8_t lv = PANEL_FULL;
+};
+
+#if defined(ARDUINO_ARCH_ESP32)
+// 串口唤醒只需配置一次；uartNum 为 CO2 传感器所在 UART
+static inline void lightSleepInit(int uartNum) {
+  uart_set_wakeup_threshold((uart_port_t)uartNum, POWER_UART_WAKE_EDGES);
+  esp_sleep_enable_uart_wakeup(uartNum);
+}
+
+// 进入 light sleep 最多 ms 毫秒（另一个核心同时暂停），返回唤醒原因，sleptUs 为实际睡眠时长。
+// esp_timer 与 millis() 在 light sleep 后仍然连续，调度器无需补偿
+static inline uint8_t lightSleepFor(uint32_t ms, uint32_t &sleptUs) {
+  esp_sleep_enable_timer_wakeup((uint64_t)ms * 1000);
+  int64_t t0 = esp_timer_get_time();
+  esp_light_sleep_start();
+  sleptUs = (uint32_t)(esp_timer_get_time() - t0);
+  switch (esp_sleep_get_wakeup_cause()) {
+    case ESP_SLEEP_WAKEUP_TIMER: return POWER_WAKE_TIMER;
+    case ESP_SLEEP_WAKEUP_UART: return POWER_WAKE_UART;
+    default: return POWER_WAKE_OTHER;
+  }
+}
+#endif
+
+#endif // POWER_MANAGER_H
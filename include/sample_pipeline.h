@@ -0,0 +1,274 @@
+// 采样流水线：无效帧剔除、中值去尖峰、O(1) 滚动统计（1 分钟 / 1 小时 / 24 小时）
+#ifndef SAMPLE_PIPELINE_H
+#define SAMPLE_PIPELINE_H
+
+#include <stdint.h>
+#include <math.h>
+#include "co2_frame.h"
+
+// 定点格式：CO2 单位 ppm；温度、湿度放大 100 倍（0.01°C / 0.01%RH）
+#define SAMPLE_FP_SCALE 100
+
+// 合理范围，超出视为无效读数
+#define CO2_PPM_MIN     1
+#define CO2_PPM_MAX     10000
+#define TEMP_C_MIN      (-40)
+#define TEMP_C_MAX      80
+#define HUM_PCT_MIN     0
+#define HUM_PCT_MAX     100
+
+// 中值滤波窗口（奇数）
+#ifndef SAMPLE_MEDIAN_N
+#define SAMPLE_MEDIAN_N 5
+#endif
+
+// 中值滤波：保存最近 N 个原始值，输出其中值，单点尖峰不会传到输出
+template <uint8_t N>
+class MedianFilter {
+ public:
+  int32_t push(int32_t v) {
+    buf[idx] = v;
+    idx = (idx + 1) % N;
+    if (count < N) count++;
+    // N 很小，拷贝后插入排序
+    int32_t tmp[N];
+    for (uint8_t i = 0; i < count; i++) {
+      int32_t x = buf[i];
+      int8_t j = (int8_t)i - 1;
+      while (j >= 0 && tmp[j] > x) { tmp[j + 1] = tmp[j]; j--; }
+      tmp[j + 1] = x;
+    }
+    return tmp[count / 2];
+  }
+  void reset() { count = 0; idx = 0; }
+
+ private:
+  int32_t buf[N];
+  uint8_t count = 0;
+  uint8_t idx = 0;
+};
+
+// 单个窗口的统计结果
+struct WindowStat {
+  int32_t min = 0;
+  int32_t max = 0;
+  int32_t mean = 0;
+  uint32_t count = 0;   // 窗口内样本数，0 表示无数据
+};
+
+// 滚动窗口：窗口由 B 个时间桶组成（当前桶 + 最近 B-1 个已关闭的桶），
+// 桶内累加和/最小/最大，桶间用单调双端队列维护最小/最大值。
+// 每个样本摊还 O(1)，内存与样本率无关；窗口边界精度为一个桶宽。
+// 时间为回绕扩展后的 64 位毫秒（SamplePipeline 负责扩展），millis() 回绕时桶号继续递增。
+// 桶号不新于当前桶的时刻（调用方先后取 millis() 造成的略早时间戳）不回头改动已关闭的桶：
+// 样本记入当前桶，advance 不做任何事。
+template <uint16_t B>
+class RollingWindow {
+ public:
+  explicit RollingWindow(uint32_t bucketMs) : bucketMs(bucketMs) {}
+
+  void push(uint64_t nowMs, int32_t v) {
+    moveTo((uint32_t)(nowMs / bucketMs));
+    Bucket &c = ring[curId % B];
+    c.sum += v;
+    c.count++;
+    if (v < c.min) c.min = v;
+    if (v > c.max) c.max = v;
+  }
+
+  // 合并已关闭桶与当前桶，O(1)
+  WindowStat stat() const {
+    WindowStat s;
+    int64_t sum = winSum;
+    uint32_t n = winCount;
+    bool any = false;
+    if (minLen) { s.min = ring[minQ[minHead] % B].min; s.max = ring[maxQ[maxHead] % B].max; any = true; }
+    if (hasCur) {
+      const Bucket &c = ring[curId % B];
+      if (c.count) {
+        if (!any || c.min < s.min) s.min = c.min;
+        if (!any || c.max > s.max) s.max = c.max;
+        sum += c.sum;
+        n += c.count;
+      }
+    }
+    s.count = n;
+    if (n) s.mean = (int32_t)((sum >= 0 ? sum + n / 2 : sum - (int64_t)(n / 2)) / (int64_t)n);
+    return s;
+  }
+
+  // 推进时间（无新样本时让过期桶离开窗口）
+  void advance(uint64_t nowMs) { moveTo((uint32_t)(nowMs / bucketMs)); }
+
+ private:
+  struct Bucket {
+    int64_t sum;
+    uint32_t count;
+    int32_t min, max;
+    uint32_t id;
+  };
+
+  // 进入更新的桶：关闭当前桶、移出过期桶、开新桶；不新于当前桶时不动
+  void moveTo(uint32_t id) {
+    if (hasCur && (int32_t)(id - curId) <= 0) return;
+    if (hasCur) closeBucket();
+    evictBefore(id - (B - 1));
+    openBucket(id);
+  }
+
+  void openBucket(uint32_t id) {
+    Bucket &c = ring[id % B];
+    c.sum = 0; c.count = 0; c.min = INT32_MAX; c.max = INT32_MIN; c.id = id;
+    curId = id;
+    hasCur = true;
+  }
+
+  void closeBucket() {
+    hasCur = false;
+    const Bucket &c = ring[curId % B];
+    if (!c.count) return;
+    winSum += c.sum;
+    winCount += c.count;
+    // 单调队列：minQ 桶最小值递增，maxQ 桶最大值递减
+    while (minLen && ring[minQ[(minHead + minLen - 1) % B] % B].min >= c.min) minLen--;
+    minQ[(minHead + minLen++) % B] = curId;
+    while (maxLen && ring[maxQ[(maxHead + maxLen - 1) % B] % B].max <= c.max) maxLen--;
+    maxQ[(maxHead + maxLen++) % B] = curId;
+    closedQ[(closedHead + closedLen++) % B] = curId;
+  }
+
+  // 移除 id < firstId 的已关闭桶（回绕安全的比较）
+  void evictBefore(uint32_t firstId) {
+    while (closedLen && (int32_t)(closedQ[closedHead] - firstId) < 0) {
+      const Bucket &c = ring[closedQ[closedHead] % B];
+      winSum -= c.sum;
+      winCount -= c.count;
+      closedHead = (closedHead + 1) % B;
+      closedLen--;
+    }
+    while (minLen && (int32_t)(minQ[minHead] - firstId) < 0) { minHead = (minHead + 1) % B; minLen--; }
+    while (maxLen && (int32_t)(maxQ[maxHead] - firstId) < 0) { maxHead = (maxHead + 1) % B; maxLen--; }
+  }
+
+  Bucket ring[B];
+  uint32_t minQ[B], maxQ[B], closedQ[B];
+  uint16_t minHead = 0, minLen = 0;
+  uint16_t maxHead = 0, maxLen = 0;
+  uint16_t closedHead = 0, closedLen = 0;
+  int64_t winSum = 0;
+  uint32_t winCount = 0;
+  uint32_t bucketMs;
+  uint32_t curId = 0;
+  bool hasCur = false;
+};
+
+// 单通道：1 分钟(60x1s)、1 小时(60x1min)、24 小时(96x15min)
+class ChannelRolling {
+ public:
+  ChannelRolling() : w1m(1000UL), w1h(60000UL), w24h(900000UL) {}
+  void push(uint64_t nowMs, int32_t v) { w1m.push(nowMs, v); w1h.push(nowMs, v); w24h.push(nowMs, v); }
+  void advance(uint64_t nowMs) { w1m.advance(nowMs); w1h.advance(nowMs); w24h.advance(nowMs); }
+  RollingWindow<60> w1m;
+  RollingWindow<60> w1h;
+  RollingWindow<96> w24h;
+};
+
+struct ChannelStats {
+  int32_t last = 0;       // 中值滤波后的最新值（定点）
+  bool valid = false;     // 是否已收到有效样本
+  WindowStat w1m, w1h, w24h;
+};
+
+// 预先计算好的聚合结果，显示与导出直接读取，不再重复计算
+struct SampleAggregates {
+  ChannelStats co2;       // ppm
+  ChannelStats temp;      // 0.01°C
+  ChannelStats hum;       // 0.01%RH
+  uint32_t co2Accepted = 0;
+  uint32_t co2Rejected = 0;    // 帧头/校验/范围错误
+  uint32_t dhtRejected = 0;    // NaN 或超出范围
+  uint32_t updatedMs = 0;
+};
+
+class SamplePipeline {
+ public:
+  // 输入一帧 CO2 原始数据，校验失败或超出范围则丢弃
+  bool pushCo2Frame(const uint8_t *frame, uint32_t nowMs) {
+    if (!co2FrameValid(frame)) { agg.co2Rejected++; return false; }
+    uint16_t ppm = co2FramePpm(frame);
+    if (ppm < CO2_PPM_MIN || ppm > CO2_PPM_MAX) { agg.co2Rejected++; return false; }
+    agg.co2Accepted++;
+    accept(agg.co2, co2Med, co2Roll, ppm, nowMs);
+    return true;
+  }
+
+  // 输入一次 DHT 读数，温湿度分别校验；返回是否至少接受了一项
+  bool pushDht(float t, float h, uint32_t nowMs) {
+    bool any = false;
+    if (!isnan(t) && t >= TEMP_C_MIN && t <= TEMP_C_MAX) {
+      accept(agg.temp, tempMed, tempRoll, toFixed(t), nowMs);
+      any = true;
+    } else {
+      agg.dhtRejected++;
+    }
+    if (!isnan(h) && h >= HUM_PCT_MIN && h <= HUM_PCT_MAX) {
+      accept(agg.hum, humMed, humRoll, toFixed(h), nowMs);
+      any = true;
+    } else {
+      agg.dhtRejected++;
+    }
+    return any;
+  }
+
+  // 无新样本时推进窗口，使过期数据离开窗口
+  void tick(uint32_t nowMs) {
+    uint64_t t = extendMs(nowMs);
+    co2Roll.advance(t); tempRoll.advance(t); humRoll.advance(t);
+    refresh(agg.co2, co2Roll); refresh(agg.temp, tempRoll); refresh(agg.hum, humRoll);
+    agg.updatedMs = nowMs;
+  }
+
+  const SampleAggregates &aggregates() const { return agg; }
+
+  static int32_t toFixed(float v) { return (int32_t)lroundf(v * SAMPLE_FP_SCALE); }
+  static float fromFixed(int32_t v) { return (float)v / SAMPLE_FP_SCALE; }
+
+ private:
+  void accept(ChannelStats &cs, MedianFilter<SAMPLE_MEDIAN_N> &med, ChannelRolling &roll, int32_t v, uint32_t nowMs) {
+    cs.last = med.push(v);
+    cs.valid = true;
+    roll.push(extendMs(nowMs), cs.last);
+    refresh(cs, roll);
+    agg.updatedMs = nowMs;
+  }
+
+  // millis() 约 49.7 天回绕一次：按增量累加成 64 位。略早于上一次的时间戳（调用方取时刻的先后）按负增量处理，不会误当成回绕
+  uint64_t extendMs(uint32_t nowMs) {
+    if (!clockStarted) {
+      clockStarted = true;
+      lastMs = nowMs;
+      extMs = nowMs;
+      return extMs;
+    }
+    int32_t d = (int32_t)(nowMs - lastMs);
+    if (d < 0) return extMs - (uint64_t)(-(int64_t)d);
+    lastMs = nowMs;
+    extMs += (uint32_t)d;
+    return extMs;
+  }
+
+  static void refresh(ChannelStats &cs, const ChannelRolling &roll) {
+    cs.w1m = roll.w1m.stat();
+    cs.w1h = roll.w1h.stat();
+    cs.w24h = roll.w24h.stat();
+  }
+
+  SampleAggregates agg;
+  MedianFilter<SAMPLE_MEDIAN_N> co2Med, tempMed, humMed;
+  ChannelRolling co2Roll, tempRoll, humRoll;
+  uint64_t extMs = 0;
+  uint32_t lastMs = 0;
+  bool clockStarted = false;
+};
+
+#endif // SAMPLE_PIPELINE_H
@@ -0,0 +1,28 @@
+// 传感器快照：采集侧整体发布，显示/日志/导出等读者经 seqlock 取得一致、带时间戳的副本
+#ifndef SENSOR_SNAPSHOT_H
+#define SENSOR_SNAPSHOT_H
+
+#include <stdint.h>
+#include "seqlock.h"
+
+#define SNAP_CO2_VALID   0x01
+#define SNAP_TEMP_VALID  0x02
+#define SNAP_HUM_VALID   0x04
+
+struct SensorSnapshot {
+  uint32_t ms = 0;          // 最近一次发布时间
+  uint32_t co2Ms = 0;       // CO2 最近一次被接受的时间
+  uint32_t dhtMs = 0;       // 温湿度最近一次有效读数的时间
+  uint32_t co2 = 450;       // ppm（中值滤波后）
+  float temp = 25.3f;       // °C
+  float hum = 48.5f;        // %RH
+  int32_t co2Mean1m = 0;    // 1 分钟滚动均值
+  uint32_t co2Rejected = 0;
+  uint32_t dhtRejected = 0;
+  int32_t day = 0;          // 墙上时钟日期（自 1970-01-01 的天数），跨日时更新
+  uint8_t flags = 0;        // SNAP_*_VALID，未置位的字段仍是开机默认值
+};
+
+typedef Seqlock<SensorSnapshot> SensorSnapshotCell;
+
+#endif // SENSOR_SNAPSHOT_H
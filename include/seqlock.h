@@ -0,0 +1,65 @@
+// 顺序锁（seqlock）：单写者发布、多读者无锁读取一致副本，写者从不等待
+#ifndef SEQLOCK_H
+#define SEQLOCK_H
+
+#include <stdint.h>
+#include <string.h>
+#include <atomic>
+#include <type_traits>
+
+// 写：序号变奇数 -> 写数据 -> 序号变偶数；读：读序号 -> 拷贝 -> 再读序号，两次相同且为偶数才算一致。
+// 数据按 32 位字存放在 relaxed 原子变量里，读写重叠时不构成 C++ 数据竞争（在 ESP32 上就是普通读写）。
+// 只允许一个写者（或由调用方保证写者之间互斥）；读者可以在任意任务中调用，不可在写者被中断期间于 ISR 里无限重试，
+// ISR 中请用 tryRead。
+template <typename T>
+class Seqlock {
+  static_assert(std::is_trivially_copyable<T>::value, "Seqlock payload must be trivially copyable");
+  static const size_t kWords = (sizeof(T) + 3) / 4;
+
+ public:
+  Seqlock() {
+    for (size_t i = 0; i < kWords; i++) words[i].store(0, std::memory_order_relaxed);
+  }
+  explicit Seqlock(const T &init) : Seqlock() { write(init); }
+
+  void write(const T &v) {
+    uint32_t src[kWords] = {};
+    memcpy(src, &v, sizeof(T));
+    uint32_t s = seq.load(std::memory_order_relaxed);
+    seq.store(s + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    for (size_t i = 0; i < kWords; i++) words[i].store(src[i], std::memory_order_relaxed);
+    seq.store(s + 2, std::memory_order_release);
+  }
+
+  // 读取一致副本，返回该副本的版本号（偶数，每次写入加 2）
+  uint32_t read(T &out) const {
+    uint32_t v;
+    while (!tryRead(out, v)) {}
+    return v;
+  }
+
+  // 单次尝试：写入进行中或读到一半被覆盖时返回 false
+  bool tryRead(T &out, uint32_t &version) const {
+    uint32_t s1 = seq.load(std::memory_order_acquire);
+    if (s1 & 1) { retries.fetch_add(1, std::memory_order_relaxed); return false; }
+    uint32_t dst[kWords];
+    for (size_t i = 0; i < kWords; i++) dst[i] = words[i].load(std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (seq.load(std::memory_order_relaxed) != s1) { retries.fetch_add(1, std::memory_order_relaxed); return false; }
+    memcpy(&out, dst, sizeof(T));
+    version = s1;
+    return true;
+  }
+
+  uint32_t version() const { return seq.load(std::memory_order_acquire); }
+  // 读者因并发写入而重试的总次数
+  uint32_t readRetries() const { return retries.load(std::memory_order_relaxed); }
+
+ private:
+  std::atomic<uint32_t> seq{0};
+  std::atomic<uint32_t> words[kWords];
+  mutable std::atomic<uint32_t> retries{0};
+};
+
+#endif // SEQLOCK_H
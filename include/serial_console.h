@@ -0,0 +1,54 @@
+// 串口命令行：按行收集输入（CR/LF 结束），拆成命令与参数，由调用方分发
+#ifndef SERIAL_CONSOLE_H
+#define SERIAL_CONSOLE_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+#define CONSOLE_LINE_MAX 48
+
+class SerialConsole {
+ public:
+  // 非阻塞：读完当前可用字节，凑齐一行时返回 true，命令见 cmd()/arg()。
+  // In 需提供 available() / read()（HardwareSerial、HWCDC 即可）
+  template <typename In>
+  bool poll(In &in) {
+    while (in.available()) {
+      int c = in.read();
+      if (c < 0) break;
+      if (c == '\r' || c == '\n') {
+        if (!len) continue;      // 空行 / CRLF 的第二个字符
+        line[len] = 0;
+        len = 0;
+        if (overlong) { overlong = false; continue; }   // 超长行整行丢弃
+        split();
+        return true;
+      }
+      if (len < CONSOLE_LINE_MAX - 1) line[len++] = (char)c;
+      else overlong = true;
+    }
+    return false;
+  }
+
+  const char *cmd() const { return line; }
+  const char *arg() const { return argp; }
+  bool is(const char *name) const { return strcmp(line, name) == 0; }
+
+ private:
+  // 第一个空格处截断为命令，其后（跳过空格）为参数
+  void split() {
+    char *sp = strchr(line, ' ');
+    if (!sp) { argp = line + strlen(line); return; }
+    *sp++ = 0;
+    while (*sp == ' ') sp++;
+    argp = sp;
+  }
+
+  char line[CONSOLE_LINE_MAX];
+  size_t len = 0;
+  bool overlong = false;
+  const char *argp = "";
+};
+
+#endif // SERIAL_CONSOLE_H
@@ -0,0 +1,60 @@
+// 单生产者/单消费者无锁队列：采集核心写入、渲染核心读取，满时丢弃并计数
+#ifndef SPSC_QUEUE_H
+#define SPSC_QUEUE_H
+
+#include <stdint.h>
+#include <atomic>
+
+// head 只由生产者写、tail 只由消费者写，各自独占一个缓存行，避免两核来回争用。
+// 生产者发布元素用 release，消费者读取 head 用 acquire，无需锁和关中断。
+template <typename T, uint32_t N>
+class SpscQueue {
+  static_assert(N && (N & (N - 1)) == 0, "N must be a power of two");
+
+ public:
+  // 生产者：队列满时返回 false 并计入 overflows()，从不等待
+  bool push(const T &v) {
+    uint32_t h = head.load(std::memory_order_relaxed);
+    if (h - tail.load(std::memory_order_acquire) == N) {
+      overflow.store(overflow.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+      return false;
+    }
+    buf[h & (N - 1)] = v;
+    head.store(h + 1, std::memory_order_release);
+    return true;
+  }
+
+  // 消费者：取最早的一个元素
+  bool pop(T &v) {
+    uint32_t t = tail.load(std::memory_order_relaxed);
+    if (t == head.load(std::memory_order_acquire)) return false;
+    v = buf[t & (N - 1)];
+    tail.store(t + 1, std::memory_order_release);
+    return true;
+  }
+
+  // 消费者：取空队列只保留最新的元素（渲染只需要最新状态），返回取出的个数
+  uint32_t popLatest(T &v) {
+    uint32_t n = 0;
+    while (pop(v)) n++;
+    if (n > 1) coalesced.store(coalesced.load(std::memory_order_relaxed) + n - 1, std::memory_order_relaxed);
+    return n;
+  }
+
+  uint32_t size() const {
+    return head.load(std::memory_order_acquire) - tail.load(std::memory_order_acquire);
+  }
+  uint32_t pushed() const { return head.load(std::memory_order_relaxed); }
+  uint32_t overflows() const { return overflow.load(std::memory_order_relaxed); }
+  uint32_t coalescedCount() const { return coalesced.load(std::memory_order_relaxed); }
+  static constexpr uint32_t capacity() { return N; }
+
+ private:
+  alignas(64) std::atomic<uint32_t> head{0};
+  std::atomic<uint32_t> overflow{0};     // 仅生产者写
+  alignas(64) std::atomic<uint32_t> tail{0};
+  std::atomic<uint32_t> coalesced{0};    // 仅消费者写
+  alignas(64) T buf[N];
+};
+
+#endif // SPSC_QUEUE_H
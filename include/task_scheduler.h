@@ -0,0 +1,221 @@
+// 协作式定时调度器：时间轮管理周期/单次任务，统计超时（deadline miss），并给出可休眠时长
+#ifndef TASK_SCHEDULER_H
+#define TASK_SCHEDULER_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+// 时间由调用方传入（毫秒），不依赖 millis()，主机端可用虚拟时钟驱动。
+// 时间轮：SCHED_WHEEL_SLOTS 个槽，每槽 SCHED_TICK_MS；任务按到期 tick 挂在对应槽的链表上，
+// 超过一圈的任务按绝对到期 tick 判断，转到时才执行。推进时只扫描经过的槽，代价与任务总数无关。
+#define SCHED_MAX_TASKS    16
+#define SCHED_WHEEL_SLOTS  128      // 必须是 2 的幂
+#define SCHED_TICK_MS      10
+#define SCHED_NONE         0xFF
+#define SCHED_DEFAULT_DEADLINE_MS 50
+
+typedef void (*SchedFn)(void *ctx, uint32_t now);
+
+struct SchedTaskStats {
+  uint32_t runs = 0;
+  uint32_t misses = 0;       // 启动时已晚于 due + deadline 的次数
+  uint32_t skipped = 0;      // 周期任务因严重超时被跳过的周期数
+  uint32_t maxLateMs = 0;    // 最大启动延迟
+  uint32_t maxRunUs = 0;     // 最长单次执行时间（需要 usClock）
+  uint64_t totalRunUs = 0;
+};
+
+class TaskScheduler {
+ public:
+  // usClock 可选，用于统计任务执行耗时（固件传 micros）
+  explicit TaskScheduler(uint32_t (*usClock)() = nullptr) : usClock(usClock) {
+    for (int i = 0; i < SCHED_WHEEL_SLOTS; i++) wheel[i] = SCHED_NONE;
+  }
+
+  // 第一次在 now + phaseMs 执行，之后每 periodMs 一次（按原相位补偿，不累积漂移）
+  int addPeriodic(const char *name, uint32_t periodMs, SchedFn fn, void *ctx, uint32_t now,
+                  uint32_t phaseMs = 0, uint32_t deadlineMs = SCHED_DEFAULT_DEADLINE_MS) {
+    return add(name, periodMs ? periodMs : 1, fn, ctx, now, now + phaseMs, deadlineMs);
+  }
+
+  int addOneShot(const char *name, uint32_t delayMs, SchedFn fn, void *ctx, uint32_t now,
+                 uint32_t deadlineMs = SCHED_DEFAULT_DEADLINE_MS) {
+    return add(name, 0, fn, ctx, now, now + delayMs, deadlineMs);
+  }
+
+  void cancel(int id) {
+    if (!valid(id)) return;
+    unlink((uint8_t)id);
+    tasks[id].active = false;
+  }
+
+  // 修改下次到期时间（例如在数据到达后立即触发一次渲染）
+  void reschedule(int id, uint32_t due) {
+    if (!valid(id)) return;
+    unlink((uint8_t)id);
+    tasks[id].due = due;
+    link((uint8_t)id);
+  }
+
+  // 执行所有到期任务（按到期先后），返回执行个数
+  uint32_t runDue(uint32_t now) {
+    uint8_t ready[SCHED_MAX_TASKS];
+    uint8_t n = collect(now, ready);
+    for (uint8_t i = 0; i < n; i++) {
+      Task &t = tasks[ready[i]];
+      if (!t.active) continue;   // 被同批次更早的任务取消
+      uint32_t late = now - t.due;
+      if (late > t.st.maxLateMs) t.st.maxLateMs = late;
+      if (late > t.deadlineMs) t.st.misses++;
+      uint32_t us0 = usClock ? usClock() : 0;
+      t.fn(t.ctx, now);
+      if (usClock) {
+        uint32_t us = usClock() - us0;
+        if (us > t.st.maxRunUs) t.st.maxRunUs = us;
+        t.st.totalRunUs += us;
+      }
+      t.st.runs++;
+      if (!t.active || t.slotted) continue;   // 回调中取消或已重新安排
+      if (!t.period) { t.active = false; continue; }
+      t.due += t.period;
+      if ((int32_t)(t.due - now) <= 0) {
+        uint32_t k = (now - t.due) / t.period + 1;
+        t.st.skipped += k;
+        t.due += k * t.period;
+      }
+      link(ready[i]);
+    }
+    return n;
+  }
+
+  // 距离最近一个任务到期还有多少毫秒（0 = 已有到期任务），没有任务时返回 UINT32_MAX
+  uint32_t msUntilNext(uint32_t now) const {
+    uint32_t best = 0;
+    bool found = false;
+    for (uint32_t j = 0; j < SCHED_WHEEL_SLOTS && !found; j++) {
+      uint32_t tick = processedTick + 1 + j;
+      for (uint8_t i = wheel[tick & (SCHED_WHEEL_SLOTS - 1)]; i != SCHED_NONE; i = tasks[i].next) {
+        if (tasks[i].slotTick != tick) continue;
+        if (!found || (int32_t)(tasks[i].due - best) < 0) best = tasks[i].due;
+        found = true;
+      }
+    }
+    if (!found) {
+      // 一圈内没有任务到期：退回线性查找
+      for (uint8_t i = 0; i < SCHED_MAX_TASKS; i++) {
+        if (!tasks[i].active || !tasks[i].slotted) continue;
+        if (!found || (int32_t)(tasks[i].due - best) < 0) best = tasks[i].due;
+        found = true;
+      }
+      if (!found) return UINT32_MAX;
+    }
+    int32_t d = (int32_t)(best - now);
+    return d > 0 ? (uint32_t)d : 0;
+  }
+
+  const SchedTaskStats &stats(int id) const { return tasks[id].st; }
+  const char *name(int id) const { return tasks[id].name; }
+  uint32_t nextDue(int id) const { return tasks[id].due; }
+  bool active(int id) const { return valid(id); }
+  int taskCount() const { return SCHED_MAX_TASKS; }
+
+  uint32_t totalMisses() const {
+    uint32_t m = 0;
+    for (uint8_t i = 0; i < SCHED_MAX_TASKS; i++) m += tasks[i].st.misses;
+    return m;
+  }
+
+ private:
+  struct Task {
+    const char *name = nullptr;
+    SchedFn fn = nullptr;
+    void *ctx = nullptr;
+    uint32_t period = 0;        // 0 = 单次
+    uint32_t due = 0;
+    uint32_t deadlineMs = 0;
+    uint32_t slotTick = 0;      // 所在槽对应的绝对 tick
+    uint8_t next = SCHED_NONE;
+    bool active = false;
+    bool slotted = false;
+    SchedTaskStats st;
+  };
+
+  bool valid(int id) const { return id >= 0 && id < SCHED_MAX_TASKS && tasks[id].active; }
+
+  int add(const char *name, uint32_t period, SchedFn fn, void *ctx, uint32_t now, uint32_t due, uint32_t deadlineMs) {
+    if (!started) { nextTickMs = now - now % SCHED_TICK_MS; started = true; }
+    for (uint8_t i = 0; i < SCHED_MAX_TASKS; i++) {
+      if (tasks[i].active) continue;
+      Task &t = tasks[i];
+      t = Task();
+      t.name = name; t.fn = fn; t.ctx = ctx;
+      t.period = period; t.due = due; t.deadlineMs = deadlineMs;
+      t.active = true;
+      link(i);
+      return i;
+    }
+    return -1;
+  }
+
+  // 已处理过的 tick 不会再扫描，落在其中的到期时间挂到下一个待处理 tick
+  void link(uint8_t i) {
+    Task &t = tasks[i];
+    int32_t d = (int32_t)(t.due - nextTickMs);
+    uint32_t tick = processedTick + 1 + (d > 0 ? (uint32_t)d / SCHED_TICK_MS : 0);
+    t.slotTick = tick;
+    uint8_t &head = wheel[tick & (SCHED_WHEEL_SLOTS - 1)];
+    t.next = head;
+    head = i;
+    t.slotted = true;
+  }
+
+  void unlink(uint8_t i) {
+    Task &t = tasks[i];
+    if (!t.slotted) return;
+    uint8_t *p = &wheel[t.slotTick & (SCHED_WHEEL_SLOTS - 1)];
+    while (*p != SCHED_NONE && *p != i) p = &tasks[*p].next;
+    if (*p == i) *p = t.next;
+    t.slotted = false;
+  }
+
+  // 推进时间轮到 now，摘下所有到期任务并按到期时间排序
+  uint8_t collect(uint32_t now, uint8_t *ready) {
+    uint8_t n = 0;
+    int32_t d = (int32_t)(now - nextTickMs);
+    if (d < 0) return 0;
+    uint32_t span = (uint32_t)d / SCHED_TICK_MS + 1;   // 含当前 tick
+    // 停顿超过一圈时每个槽只需扫一遍
+    uint32_t steps = span < SCHED_WHEEL_SLOTS ? span : SCHED_WHEEL_SLOTS;
+    for (uint32_t j = 1; j <= steps; j++) {
+      uint32_t tick = processedTick + j;
+      uint8_t *p = &wheel[tick & (SCHED_WHEEL_SLOTS - 1)];
+      while (*p != SCHED_NONE) {
+        Task &t = tasks[*p];
+        if ((int32_t)(t.due - now) <= 0) {
+          uint8_t i = *p;
+          *p = t.next;
+          t.slotted = false;
+          uint8_t k = n++;
+          while (k && (int32_t)(tasks[ready[k - 1]].due - t.due) > 0) { ready[k] = ready[k - 1]; k--; }
+          ready[k] = i;
+        } else {
+          p = &t.next;
+        }
+      }
+    }
+    // 当前 tick 可能还有稍后到期的任务，下次再扫
+    processedTick += span - 1;
+    nextTickMs += (span - 1) * SCHED_TICK_MS;
+    return n;
+  }
+
+  Task tasks[SCHED_MAX_TASKS];
+  uint8_t wheel[SCHED_WHEEL_SLOTS];
+  // tick 编号与毫秒时间分开计数，毫秒回绕（约 49.7 天）不影响槽位计算
+  uint32_t processedTick = 0;   // 已扫描完的最后一个 tick
+  uint32_t nextTickMs = 0;      // processedTick + 1 的起始时间
+  bool started = false;
+  uint32_t (*usClock)();
+};
+
+#endif // TASK_SCHEDULER_H
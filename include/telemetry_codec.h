@@ -0,0 +1,203 @@
+// 遥测序列压缩编码（Gorilla 风格）：时间戳二阶差分 + 数值定点差分的 zig-zag 变长编码
+#ifndef TELEMETRY_CODEC_H
+#define TELEMETRY_CODEC_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+// 一个样本：时间（秒）+ 与 HistoryStore 相同的定点值（ppm / 0.01°C / 0.01%RH）
+struct TelemetrySample {
+  uint32_t t;
+  uint16_t co2;
+  int16_t temp;
+  uint16_t hum;
+};
+
+// 块格式：[u16 样本数, 小端][比特流]
+// 第一个样本原样写入（32+16+16+16 位），之后每个样本：
+//   时间戳二阶差分 dod：'0'=0，'10'+7 位，'110'+9 位，'1110'+12 位，'1111'+32 位
+//   每个数值差分：'0'=不变，'1'+zig-zag 半字节变长码（每组 3 位数据 + 1 位继续标志）
+// 数值变化缓慢时每个样本约 4~10 位，原始定点记录为 80 位
+#define TELEMETRY_BLOCK_HDR     2
+#define TELEMETRY_MAX_SAMPLE_BITS 112
+
+static inline uint32_t zigzagEncode(int32_t v) { return ((uint32_t)v << 1) ^ (uint32_t)(v >> 31); }
+static inline int32_t zigzagDecode(uint32_t v) { return (int32_t)(v >> 1) ^ -(int32_t)(v & 1); }
+
+class BitWriter {
+ public:
+  BitWriter(uint8_t *buf, size_t cap) : buf(buf), cap(cap) {}
+  // 写入 n 位（n <= 32），高位在前
+  void put(uint32_t v, uint8_t n) {
+    while (n) {
+      uint8_t room = 8 - (pos & 7);
+      uint8_t take = n < room ? n : room;
+      uint8_t chunk = (uint8_t)((v >> (n - take)) & ((1u << take) - 1));
+      if (room == 8) buf[pos >> 3] = 0;
+      buf[pos >> 3] |= (uint8_t)(chunk << (room - take));
+      pos += take;
+      n -= take;
+    }
+  }
+  size_t bits() const { return pos; }
+  size_t bytes() const { return (pos + 7) >> 3; }
+  size_t capacityBits() const { return cap * 8; }
+
+ private:
+  uint8_t *buf;
+  size_t cap;
+  size_t pos = 0;
+};
+
+class BitReader {
+ public:
+  BitReader(const uint8_t *buf, size_t len) : buf(buf), len(len) {}
+  uint32_t get(uint8_t n) {
+    uint32_t v = 0;
+    while (n) {
+      if ((pos >> 3) >= len) { overrun = true; return v; }
+      uint8_t room = 8 - (pos & 7);
+      uint8_t take = n < room ? n : room;
+      uint8_t chunk = (uint8_t)((buf[pos >> 3] >> (room - take)) & ((1u << take) - 1));
+      v = (v << take) | chunk;
+      pos += take;
+      n -= take;
+    }
+    return v;
+  }
+  bool bit() { return get(1) != 0; }
+  bool ok() const { return !overrun; }
+
+ private:
+  const uint8_t *buf;
+  size_t len;
+  size_t pos = 0;
+  bool overrun = false;
+};
+
+class TelemetryEncoder {
+ public:
+  TelemetryEncoder(uint8_t *buf, size_t cap)
+      : out(buf), bw(buf + TELEMETRY_BLOCK_HDR, cap > TELEMETRY_BLOCK_HDR ? cap - TELEMETRY_BLOCK_HDR : 0) {}
+
+  // 追加一个样本；缓冲区不足（按最坏情况估计）或时间倒退时返回 false，已写内容不受影响
+  bool append(const TelemetrySample &s) {
+    if (bw.bits() + TELEMETRY_MAX_SAMPLE_BITS > bw.capacityBits() || n == UINT16_MAX) return false;
+    if (n == 0) {
+      bw.put(s.t, 32);
+      bw.put(s.co2, 16);
+      bw.put((uint16_t)s.temp, 16);
+      bw.put(s.hum, 16);
+    } else {
+      if (s.t < prev.t) return false;
+      uint32_t delta = s.t - prev.t;
+      putDod((int32_t)(delta - prevDelta));
+      prevDelta = delta;
+      putDelta((int32_t)s.co2 - prev.co2);
+      putDelta((int32_t)s.temp - prev.temp);
+      putDelta((int32_t)s.hum - prev.hum);
+    }
+    prev = s;
+    n++;
+    return true;
+  }
+
+  // 写入块头，返回块总字节数
+  size_t finish() {
+    out[0] = (uint8_t)(n & 0xFF);
+    out[1] = (uint8_t)(n >> 8);
+    return TELEMETRY_BLOCK_HDR + bw.bytes();
+  }
+
+  uint16_t count() const { return n; }
+  size_t bits() const { return bw.bits(); }
+
+ private:
+  void putDod(int32_t d) {
+    if (d == 0) { bw.put(0, 1); return; }
+    uint32_t z = zigzagEncode(d);
+    if (z < (1u << 7)) { bw.put(0x2, 2); bw.put(z, 7); }
+    else if (z < (1u << 9)) { bw.put(0x6, 3); bw.put(z, 9); }
+    else if (z < (1u << 12)) { bw.put(0xE, 4); bw.put(z, 12); }
+    else { bw.put(0xF, 4); bw.put(z, 32); }
+  }
+
+  void putDelta(int32_t d) {
+    if (d == 0) { bw.put(0, 1); return; }
+    bw.put(1, 1);
+    // d != 0，z >= 1，先减 1 让 ±1 只占一个半字节
+    uint32_t z = zigzagEncode(d) - 1;
+    do {
+      uint8_t grp = z & 0x7;
+      z >>= 3;
+      bw.put((grp << 1) | (z ? 1 : 0), 4);
+    } while (z);
+  }
+
+  uint8_t *out;
+  BitWriter bw;
+  TelemetrySample prev = {};
+  uint32_t prevDelta = 0;
+  uint16_t n = 0;
+};
+
+class TelemetryDecoder {
+ public:
+  TelemetryDecoder(const uint8_t *buf, size_t len)
+      : br(buf + (len >= TELEMETRY_BLOCK_HDR ? TELEMETRY_BLOCK_HDR : len),
+           len >= TELEMETRY_BLOCK_HDR ? len - TELEMETRY_BLOCK_HDR : 0),
+        total(len >= TELEMETRY_BLOCK_HDR ? (uint16_t)(buf[0] | (buf[1] << 8)) : 0) {}
+
+  // 依次取出样本，结束或数据损坏时返回 false
+  bool next(TelemetrySample &s) {
+    if (idx >= total) return false;
+    if (idx == 0) {
+      prev.t = br.get(32);
+      prev.co2 = (uint16_t)br.get(16);
+      prev.temp = (int16_t)br.get(16);
+      prev.hum = (uint16_t)br.get(16);
+    } else {
+      prevDelta += (uint32_t)getDod();
+      prev.t += prevDelta;
+      prev.co2 = (uint16_t)(prev.co2 + getDelta());
+      prev.temp = (int16_t)(prev.temp + getDelta());
+      prev.hum = (uint16_t)(prev.hum + getDelta());
+    }
+    if (!br.ok()) return false;
+    idx++;
+    s = prev;
+    return true;
+  }
+
+  uint16_t count() const { return total; }
+
+ private:
+  int32_t getDod() {
+    if (!br.bit()) return 0;
+    if (!br.bit()) return zigzagDecode(br.get(7));
+    if (!br.bit()) return zigzagDecode(br.get(9));
+    if (!br.bit()) return zigzagDecode(br.get(12));
+    return zigzagDecode(br.get(32));
+  }
+
+  int32_t getDelta() {
+    if (!br.bit()) return 0;
+    uint32_t z = 0;
+    uint8_t shift = 0;
+    uint8_t nib;
+    do {
+      nib = (uint8_t)br.get(4);
+      z |= (uint32_t)(nib >> 1) << shift;
+      shift += 3;
+    } while ((nib & 1) && shift < 33 && br.ok());
+    return zigzagDecode(z + 1);
+  }
+
+  BitReader br;
+  TelemetrySample prev = {};
+  uint32_t prevDelta = 0;
+  uint16_t total;
+  uint16_t idx = 0;
+};
+
+#endif // TELEMETRY_CODEC_H
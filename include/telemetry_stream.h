@@ -0,0 +1,189 @@
+// 二进制遥测流：带类型和序号的记录，CRC16 校验，COBS 分帧（0x00 为帧界）
+#ifndef TELEMETRY_STREAM_H
+#define TELEMETRY_STREAM_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include "co2_crc.h"
+
+// 帧：0x00 + COBS([type u8][seq u16 小端][payload][crc16 小端]) + 0x00
+// 前导 0x00 让混在同一串口里的文本行自成一段，不会吞掉紧随其后的二进制帧；
+// 解码端对每段做 COBS 解码 + CRC 校验，失败的段（文本、残帧）计为跳过字节。
+// 负载结构按小端原样拷贝（ESP32 与 x86/ARM 主机一致）。
+#define TLM_REC_HDR      3
+#define TLM_REC_CRC      2
+#define TLM_MAX_PAYLOAD  64
+#define TLM_MAX_REC      (TLM_REC_HDR + TLM_MAX_PAYLOAD + TLM_REC_CRC)
+#define TLM_MAX_FRAME    (TLM_MAX_REC + TLM_MAX_REC / 254 + 1 + 2)
+
+enum TlmType : uint8_t {
+  TLM_SAMPLE    = 1,   // 每秒滤波结果
+  TLM_RAW_FRAME = 2,   // CO2 传感器原始 16 字节帧
+  TLM_CHECKSUM  = 3,   // 校验失败或超范围的帧
+  TLM_TIMING    = 4,   // loop() 耗时与计数器
+};
+
+#define TLM_SAMPLE_CO2_VALID  0x01
+#define TLM_SAMPLE_TEMP_VALID 0x02
+#define TLM_SAMPLE_HUM_VALID  0x04
+
+// 定点单位同 HistoryStore：ppm / 0.01°C / 0.01%RH
+struct __attribute__((packed)) TlmSample {
+  uint32_t ms;
+  uint16_t co2;
+  int16_t temp;
+  uint16_t hum;
+  uint16_t co2Mean1m;
+  uint8_t flags;
+};
+
+struct __attribute__((packed)) TlmRawFrame {
+  uint32_t ms;
+  uint8_t frame[16];
+};
+
+struct __attribute__((packed)) TlmChecksum {
+  uint32_t ms;
+  uint8_t expected;
+  uint8_t got;
+  uint16_t ppm;
+  uint8_t rangeError;   // 1 = 校验正确但浓度超范围
+};
+
+struct __attribute__((packed)) TlmTiming {
+  uint32_t ms;
+  uint32_t loops;         // 统计周期内 loop() 次数
+  uint32_t loopMaxUs;
+  uint32_t loopMeanUs;
+  uint32_t co2Accepted;   // 以下为开机以来累计
+  uint32_t co2Rejected;
+  uint32_t dhtRejected;
+  uint32_t logDropped;
+};
+
+// COBS 编码，out 至少 n + n/254 + 1 字节；返回编码长度（不含帧界）
+static inline size_t cobsEncode(const uint8_t *in, size_t n, uint8_t *out) {
+  size_t codeIdx = 0, k = 1;
+  uint8_t code = 1;
+  for (size_t i = 0; i < n; i++) {
+    if (in[i]) {
+      out[k++] = in[i];
+      if (++code < 0xFF) continue;
+    }
+    out[codeIdx] = code;   // 遇到 0 或满 254 个非零字节时结束当前块
+    codeIdx = k++;
+    code = 1;
+  }
+  out[codeIdx] = code;
+  return k;
+}
+
+// COBS 解码，返回解码长度；格式错误返回 (size_t)-1
+static inline size_t cobsDecode(const uint8_t *in, size_t n, uint8_t *out, size_t cap) {
+  size_t i = 0, k = 0;
+  while (i < n) {
+    uint8_t code = in[i++];
+    if (!code || i + code - 1 > n) return (size_t)-1;
+    for (uint8_t j = 1; j < code; j++) {
+      if (!in[i] || k >= cap) return (size_t)-1;
+      out[k++] = in[i++];
+    }
+    if (code < 0xFF && i < n) {
+      if (k >= cap) return (size_t)-1;
+      out[k++] = 0;
+    }
+  }
+  return k;
+}
+
+// 设备端：组帧并维护序号
+class TelemetryStream {
+ public:
+  // out 至少 TLM_MAX_FRAME 字节，返回帧长
+  size_t frame(uint8_t type, const void *payload, uint8_t len, uint8_t *out) {
+    if (len > TLM_MAX_PAYLOAD) len = TLM_MAX_PAYLOAD;
+    uint8_t rec[TLM_MAX_REC];
+    rec[0] = type;
+    rec[1] = (uint8_t)seq;
+    rec[2] = (uint8_t)(seq >> 8);
+    memcpy(rec + TLM_REC_HDR, payload, len);
+    uint16_t crc = modbus_calcuCRC(rec, TLM_REC_HDR + len);
+    rec[TLM_REC_HDR + len] = (uint8_t)crc;
+    rec[TLM_REC_HDR + len + 1] = (uint8_t)(crc >> 8);
+    seq++;
+    out[0] = 0;
+    size_t n = cobsEncode(rec, TLM_REC_HDR + len + TLM_REC_CRC, out + 1);
+    out[1 + n] = 0;
+    return n + 2;
+  }
+
+  uint16_t nextSeq() const { return seq; }
+
+ private:
+  uint16_t seq = 0;
+};
+
+struct TlmRecord {
+  uint8_t type;
+  uint16_t seq;
+  uint8_t len;
+  uint8_t payload[TLM_MAX_PAYLOAD];
+};
+
+struct TlmDeframerStats {
+  uint64_t records = 0;
+  uint64_t badFrames = 0;     // COBS 或 CRC 错误的段（通常是混入的文本行）
+  uint64_t skippedBytes = 0;  // 上述段的字节数
+  uint64_t seqGaps = 0;       // 序号跳变次数（丢帧或设备重启）
+  uint64_t lostRecords = 0;   // 按序号推算的丢失记录数
+};
+
+// 主机端：逐字节喂入，凑齐一帧且校验通过时返回 true
+class TelemetryDeframer {
+ public:
+  bool push(uint8_t b, TlmRecord &r) {
+    if (b) {
+      if (len < sizeof(seg)) seg[len] = b;
+      len++;
+      return false;
+    }
+    size_t n = len;
+    len = 0;
+    if (!n) return false;
+    uint8_t rec[TLM_MAX_REC];
+    size_t k = n <= sizeof(seg) ? cobsDecode(seg, n, rec, sizeof(rec)) : (size_t)-1;
+    if (k == (size_t)-1 || k < TLM_REC_HDR + TLM_REC_CRC ||
+        modbus_calcuCRC(rec, (uint16_t)(k - TLM_REC_CRC)) != (uint16_t)(rec[k - 2] | (rec[k - 1] << 8))) {
+      st.badFrames++;
+      st.skippedBytes += n;
+      lastBad = n <= sizeof(seg) ? n : sizeof(seg);
+      return false;
+    }
+    r.type = rec[0];
+    r.seq = (uint16_t)(rec[1] | (rec[2] << 8));
+    r.len = (uint8_t)(k - TLM_REC_HDR - TLM_REC_CRC);
+    memcpy(r.payload, rec + TLM_REC_HDR, r.len);
+    if (st.records && r.seq != (uint16_t)(lastSeq + 1)) {
+      st.seqGaps++;
+      st.lostRecords += (uint16_t)(r.seq - lastSeq - 1);
+    }
+    lastSeq = r.seq;
+    st.records++;
+    return true;
+  }
+
+  // 最近一个未通过校验的段（可能是文本行），供调用方回显
+  const uint8_t *lastBadSegment(size_t &n) const { n = lastBad; return seg; }
+  void clearBadSegment() { lastBad = 0; }
+  const TlmDeframerStats &stats() const { return st; }
+
+ private:
+  uint8_t seg[2 * TLM_MAX_FRAME + 256];
+  size_t len = 0;
+  size_t lastBad = 0;
+  uint16_t lastSeq = 0;
+  TlmDeframerStats st;
+};
+
+#endif // TELEMETRY_STREAM_H
@@ -0,0 +1,83 @@
+// 现场录制/主机回放的 trace 记录格式
+#ifndef TRACE_FORMAT_H
+#define TRACE_FORMAT_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+// 记录：[type u8][len u8][millis u32 小端][payload len 字节]
+// 设备端以 "T:" + 十六进制 + 换行 的文本行输出，可与普通串口日志混在同一份抓包里
+#define TRACE_LINE_PREFIX   "T:"
+#define TRACE_HDR_LEN       6
+#define TRACE_MAX_PAYLOAD   64
+#define TRACE_MAX_RECORD    (TRACE_HDR_LEN + TRACE_MAX_PAYLOAD)
+
+enum TraceType : uint8_t {
+  TRACE_BOOT = 1,   // u32 bootCount, u8 resetReason, char date[10]
+  TRACE_UART = 2,   // 本次 loop 从 CO2 串口读到的原始字节
+  TRACE_DHT  = 3,   // float t, float h（原始读数，可能为 NaN）；同时标记一次每秒更新
+};
+
+struct TraceRecord {
+  uint8_t type;
+  uint8_t len;
+  uint32_t ms;
+  uint8_t payload[TRACE_MAX_PAYLOAD];
+};
+
+struct __attribute__((packed)) TraceBoot {
+  uint32_t bootCount;
+  uint8_t resetReason;
+  char date[10];    // YYYY-MM-DD，不含结尾 0
+};
+
+static inline size_t traceEncode(uint8_t *out, uint8_t type, uint32_t ms, const void *payload, uint8_t len) {
+  if (len > TRACE_MAX_PAYLOAD) len = TRACE_MAX_PAYLOAD;
+  out[0] = type;
+  out[1] = len;
+  out[2] = (uint8_t)ms; out[3] = (uint8_t)(ms >> 8); out[4] = (uint8_t)(ms >> 16); out[5] = (uint8_t)(ms >> 24);
+  memcpy(out + TRACE_HDR_LEN, payload, len);
+  return TRACE_HDR_LEN + len;
+}
+
+static inline bool traceDecode(const uint8_t *in, size_t n, TraceRecord &r) {
+  if (n < TRACE_HDR_LEN || in[1] > TRACE_MAX_PAYLOAD || n < (size_t)TRACE_HDR_LEN + in[1]) return false;
+  r.type = in[0];
+  r.len = in[1];
+  r.ms = (uint32_t)in[2] | ((uint32_t)in[3] << 8) | ((uint32_t)in[4] << 16) | ((uint32_t)in[5] << 24);
+  memcpy(r.payload, in + TRACE_HDR_LEN, r.len);
+  return true;
+}
+
+// 编码为文本行（含前缀和换行），out 至少 2*TRACE_MAX_RECORD+4 字节
+static inline size_t traceToHexLine(const uint8_t *rec, size_t n, char *out) {
+  static const char hexd[] = "0123456789ABCDEF";
+  size_t k = 0;
+  out[k++] = 'T'; out[k++] = ':';
+  for (size_t i = 0; i < n; i++) { out[k++] = hexd[rec[i] >> 4]; out[k++] = hexd[rec[i] & 0xF]; }
+  out[k++] = '\n';
+  out[k] = 0;
+  return k;
+}
+
+// 解析一行文本，非 trace 行返回 0
+static inline size_t traceFromHexLine(const char *line, uint8_t *out, size_t cap) {
+  const char *p = strstr(line, TRACE_LINE_PREFIX);
+  if (!p) return 0;
+  p += 2;
+  size_t n = 0;
+  while (n < cap) {
+    int v = 0;
+    for (int i = 0; i < 2; i++, p++) {
+      char c = *p;
+      int d = (c >= '0' && c <= '9') ? c - '0' : (c >= 'A' && c <= 'F') ? c - 'A' + 10 : (c >= 'a' && c <= 'f') ? c - 'a' + 10 : -1;
+      if (d < 0) return i == 0 ? n : 0;
+      v = (v << 4) | d;
+    }
+    out[n++] = (uint8_t)v;
+  }
+  return n;
+}
+
+#endif // TRACE_FORMAT_H
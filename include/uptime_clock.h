@@ -0,0 +1,25 @@
+// 开机以来的单调时间。millis() 约 49.7 天回绕一次，凡是要求跨越回绕仍然单调的时间轴
+// （闪存日志时间、PSRAM 历史、MQTT 游标、/metrics 的 uptime）都从这里取秒数，不要自己用 millis() / 1000。
+// ESP32 上读 64 位的 esp_timer（任意任务/核心可调用）；主机替身读虚拟时钟的 64 位微秒
+#ifndef UPTIME_CLOCK_H
+#define UPTIME_CLOCK_H
+
+#include <stdint.h>
+#if defined(ARDUINO_ARCH_ESP32)
+#include <esp_timer.h>
+#else
+#include <Arduino.h>
+#endif
+
+static inline uint64_t uptimeUs() {
+#if defined(ARDUINO_ARCH_ESP32)
+  return (uint64_t)esp_timer_get_time();
+#else
+  return hostMicros64();
+#endif
+}
+
+// 32 位秒数约 136 年才回绕
+static inline uint32_t uptimeSec() { return (uint32_t)(uptimeUs() / 1000000); }
+
+#endif // UPTIME_CLOCK_H
@@ -0,0 +1,186 @@
+// 墙上时钟：编译日期在编译期解析为秒数；运行时按 millis() 增量推进，跨日作为整数事件上报，
+// 状态存 RTC 内存，热复位后接续。时间为本地时间的秒数（不含时区），0 = 1970-01-01 00:00:00
+#ifndef WALL_CLOCK_H
+#define WALL_CLOCK_H
+
+#include <stdint.h>
+
+#define WALL_SECS_PER_DAY 86400u
+
+// ---- 公历 <-> 天数（自 1970-01-01），H. Hinnant 的 days_from_civil / civil_from_days ----
+struct CivilDate {
+  int16_t year;
+  uint8_t month;   // 1..12
+  uint8_t day;     // 1..31
+};
+
+constexpr int32_t wallDaysFromCivil(int32_t y, uint32_t m, uint32_t d) {
+  y -= m <= 2;
+  const int32_t era = (y >= 0 ? y : y - 399) / 400;
+  const uint32_t yoe = (uint32_t)(y - era * 400);
+  const uint32_t doy = (153 * (m > 2 ? m - 3 : m + 9) + 2) / 5 + d - 1;
+  const uint32_t doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+  return era * 146097 + (int32_t)doe - 719468;
+}
+
+constexpr CivilDate wallCivilFromDays(int32_t z) {
+  z += 719468;
+  const int32_t era = (z >= 0 ? z : z - 146096) / 146097;
+  const uint32_t doe = (uint32_t)(z - era * 146097);
+  const uint32_t yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+  const int32_t y = (int32_t)yoe + era * 400;
+  const uint32_t doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+  const uint32_t mp = (5 * doy + 2) / 153;
+  const uint32_t d = doy - (153 * mp + 2) / 5 + 1;
+  const uint32_t m = mp < 10 ? mp + 3 : mp - 9;
+  return CivilDate{ (int16_t)(y + (m <= 2)), (uint8_t)m, (uint8_t)d };
+}
+
+// ---- 编译期解析 __DATE__ ("Mmm dd yyyy"，日为个位时补空格) 与 __TIME__ ("hh:mm:ss") ----
+constexpr uint32_t wallDigit(char c) { return c == ' ' ? 0 : (uint32_t)(c - '0'); }
+
+constexpr uint32_t wallMonthOf(const char *d) {
+  return d[0] == 'J' ? (d[1] == 'a' ? 1 : (d[2] == 'n' ? 6 : 7))
+       : d[0] == 'F' ? 2
+       : d[0] == 'M' ? (d[2] == 'r' ? 3 : 5)
+       : d[0] == 'A' ? (d[1] == 'p' ? 4 : 8)
+       : d[0] == 'S' ? 9
+       : d[0] == 'O' ? 10
+       : d[0] == 'N' ? 11 : 12;
+}
+
+constexpr uint32_t wallEpochOf(const char *date, const char *time) {
+  return (uint32_t)wallDaysFromCivil((int32_t)(wallDigit(date[7]) * 1000 + wallDigit(date[8]) * 100 +
+                                               wallDigit(date[9]) * 10 + wallDigit(date[10])),
+                                     wallMonthOf(date), wallDigit(date[4]) * 10 + wallDigit(date[5])) *
+             WALL_SECS_PER_DAY +
+         (wallDigit(time[0]) * 10 + wallDigit(time[1])) * 3600 + (wallDigit(time[3]) * 10 + wallDigit(time[4])) * 60 +
+         wallDigit(time[6]) * 10 + wallDigit(time[7]);
+}
+
+static constexpr uint32_t WALL_BUILD_EPOCH = wallEpochOf(__DATE__, __TIME__);
+
+static_assert(wallDaysFromCivil(1970, 1, 1) == 0, "civil epoch");
+static_assert(wallDaysFromCivil(2000, 3, 1) - wallDaysFromCivil(2000, 2, 28) == 2, "leap year 2000");
+static_assert(wallCivilFromDays(wallDaysFromCivil(2024, 2, 29)).day == 29, "civil round trip");
+static_assert(wallEpochOf("Feb  9 2025", "13:05:07") == 1739106307u, "build date parse");
+
+// "YYYY-MM-DD"，out 至少 11 字节
+static inline void wallFormatDate(char *out, int32_t day) {
+  CivilDate c = wallCivilFromDays(day);
+  uint32_t y = (uint32_t)c.year;
+  out[0] = (char)('0' + y / 1000 % 10); out[1] = (char)('0' + y / 100 % 10);
+  out[2] = (char)('0' + y / 10 % 10);   out[3] = (char)('0' + y % 10);
+  out[4] = '-';
+  out[5] = (char)('0' + c.month / 10);  out[6] = (char)('0' + c.month % 10);
+  out[7] = '-';
+  out[8] = (char)('0' + c.day / 10);    out[9] = (char)('0' + c.day % 10);
+  out[10] = 0;
+}
+
+// 解析 "YYYY-MM-DD"，格式不对返回 false
+static inline bool wallParseDate(const char *s, int32_t &day) {
+  for (int i = 0; i < 10; i++) {
+    bool sep = i == 4 || i == 7;
+    if (sep ? s[i] != '-' : (s[i] < '0' || s[i] > '9')) return false;
+  }
+  uint32_t m = wallDigit(s[5]) * 10 + wallDigit(s[6]), d = wallDigit(s[8]) * 10 + wallDigit(s[9]);
+  if (m < 1 || m > 12 || d < 1 || d > 31) return false;
+  day = wallDaysFromCivil((int32_t)(wallDigit(s[0]) * 1000 + wallDigit(s[1]) * 100 + wallDigit(s[2]) * 10 + wallDigit(s[3])), m, d);
+  return true;
+}
+
+// ---- 运行时时钟 ----
+enum WallClockSource : uint8_t {
+  WALL_SRC_BUILD = 0,   // 冷启动：编译时间（只保证日期大致正确、单调）
+  WALL_SRC_RETAINED,    // 热复位：接续 RTC 内存中的时间，停机时间忽略不计
+  WALL_SRC_HOST,        // 主机经串口设置
+};
+
+#define WALL_RETAIN_MAGIC 0x314B4C43UL   // "CLK1"
+
+// 放在 RTC_DATA_ATTR 变量里，每次 tick 更新
+struct WallClockRetained {
+  uint32_t magic;
+  uint32_t epoch;
+  uint8_t source;
+  uint32_t check;
+};
+
+class WallClock {
+ public:
+  // keep 可为空（主机工具）；保留状态有效则接续，否则从 fallback 起步
+  void begin(WallClockRetained *keep, uint32_t nowMs, uint32_t fallback = WALL_BUILD_EPOCH) {
+    retained = keep;
+    if (keep && keep->magic == WALL_RETAIN_MAGIC && keep->check == checkOf(*keep)) {
+      // 主机设置过的时间热复位后仍算主机来源
+      secs = keep->epoch;
+      src = keep->source == WALL_SRC_HOST ? WALL_SRC_HOST : WALL_SRC_RETAINED;
+    } else {
+      secs = fallback;
+      src = WALL_SRC_BUILD;
+    }
+    // 接续的时间早于本固件的编译时间说明保留值来自旧固件且早已过时
+    if (secs < fallback && src != WALL_SRC_HOST) { secs = fallback; src = WALL_SRC_BUILD; }
+    lastMs = nowMs;
+    subMs = 0;
+    curDay = (int32_t)(secs / WALL_SECS_PER_DAY);
+    save();
+  }
+
+  // 设置当前时间；日期变化在下一次 tick 作为跨日事件上报
+  void set(uint32_t epoch, uint32_t nowMs, uint8_t source = WALL_SRC_HOST) {
+    secs = epoch;
+    lastMs = nowMs;
+    subMs = 0;
+    src = source;
+    save();
+  }
+
+  // 推进到 nowMs（两次调用间隔须小于 49 天），日期变化时返回 true。
+  // 略早于上次的 nowMs（同一轮调度里先后取的时刻）忽略，不能当成 49 天的增量
+  bool tick(uint32_t nowMs) {
+    if ((int32_t)(nowMs - lastMs) < 0) return false;
+    uint32_t acc = subMs + (nowMs - lastMs);
+    lastMs = nowMs;
+    secs += acc / 1000;
+    subMs = acc % 1000;
+    save();
+    int32_t d = (int32_t)(secs / WALL_SECS_PER_DAY);
+    if (d == curDay) return false;
+    curDay = d;
+    dayChanges++;
+    return true;
+  }
+
+  uint32_t epoch() const { return secs; }
+  int32_t day() const { return curDay; }   // 上一次 tick 时的日期，与跨日事件一致
+  uint32_t secondOfDay() const { return secs % WALL_SECS_PER_DAY; }
+  uint8_t source() const { return src; }
+  uint32_t rollovers() const { return dayChanges; }
+
+  static const char *sourceName(uint8_t s) {
+    return s == WALL_SRC_HOST ? "host" : s == WALL_SRC_RETAINED ? "retained" : "build";
+  }
+
+ private:
+  static uint32_t checkOf(const WallClockRetained &r) { return ~(r.epoch ^ WALL_RETAIN_MAGIC) ^ ((uint32_t)r.source << 24); }
+
+  void save() {
+    if (!retained) return;
+    retained->magic = WALL_RETAIN_MAGIC;
+    retained->epoch = secs;
+    retained->source = src;
+    retained->check = checkOf(*retained);
+  }
+
+  WallClockRetained *retained = nullptr;
+  uint32_t secs = 0;
+  uint32_t lastMs = 0;
+  uint32_t subMs = 0;
+  int32_t curDay = 0;
+  uint8_t src = WALL_SRC_BUILD;
+  uint32_t dayChanges = 0;
+};
+
+#endif // WALL_CLOCK_H
@@ -0,0 +1,106 @@
+// 主机端 Arduino 核心替身实现
+#include "Arduino.h"
+
+static uint64_t gNowNs = 0;
+static HostPinListener gPinListener = nullptr;
+static uint8_t gPinState[256];
+static bool gSerialQuiet = false;
+static HostSerialTap gSerialTap = nullptr;
+static HardwareSerial *gUarts[HOST_UART_COUNT];
+
+HostSerial Serial;
+
+uint64_t hostMicros64() { return gNowNs / 1000; }
+void hostSetMicros(uint64_t us) { gNowNs = us * 1000; }
+void hostAdvanceMicros(uint64_t us) { gNowNs += us * 1000; }
+void hostAdvanceNanos(uint64_t ns) { gNowNs += ns; }
+
+uint32_t millis() { return (uint32_t)(gNowNs / 1000000); }
+uint32_t micros() { return (uint32_t)(gNowNs / 1000); }
+void delay(uint32_t ms) { gNowNs += (uint64_t)ms * 1000000; }
+void delayMicroseconds(uint32_t us) { gNowNs += (uint64_t)us * 1000; }
+
+void hostSetPinListener(HostPinListener fn) { gPinListener = fn; }
+void pinMode(uint8_t pin, uint8_t mode) { (void)pin; (void)mode; }
+void digitalWrite(uint8_t pin, uint8_t val) {
+  gPinState[pin] = val;
+  if (gPinListener) gPinListener(pin, val);
+}
+int digitalRead(uint8_t pin) { return gPinState[pin]; }
+
+void hostSerialQuiet(bool quiet) { gSerialQuiet = quiet; }
+void hostSerialTap(HostSerialTap fn) { gSerialTap = fn; }
+void hostSerialFeed(const char *s) { Serial.feed(s, strlen(s)); }
+
+size_t HostSerial::write(uint8_t c) {
+  bytesWritten++;
+  if (gSerialTap) gSerialTap(&c, 1);
+  if (!gSerialQuiet) fputc(c, stdout);
+  return 1;
+}
+
+size_t HostSerial::write(const uint8_t *buf, size_t n) {
+  bytesWritten += n;
+  if (gSerialTap) gSerialTap(buf, n);
+  if (!gSerialQuiet) fwrite(buf, 1, n, stdout);
+  return n;
+}
+
+void HostSerial::feed(const char *s, size_t n) {
+  // 已读部分不再需要，顺手回收
+  if (rxPos == rx.size()) { rx.clear(); rxPos = 0; }
+  rx.append(s, n);
+}
+
+HardwareSerial::HardwareSerial(int uartNum) {
+  if (uartNum >= 0 && uartNum < HOST_UART_COUNT) gUarts[uartNum] = this;
+}
+
+HardwareSerial *hostUart(int num) { return num >= 0 && num < HOST_UART_COUNT ? gUarts[num] : nullptr; }
+
+void HardwareSerial::begin(unsigned long baud, uint32_t config, int8_t rxPin, int8_t txPin) {
+  (void)config; (void)rxPin; (void)txPin;
+  byteUs = baud ? (uint32_t)(10000000UL / baud) : 1042;
+  started = true;
+}
+
+size_t HardwareSerial::settle() {
+  uint64_t now = hostMicros64();
+  uint32_t arrived = 0;
+  while (qHead + arrived != qTail && at(qHead + arrived).us <= now) arrived++;
+  if (!started) {
+    qHead += arrived;
+    rxDropped += arrived;
+    return 0;
+  }
+  if (arrived > HOST_UART_RX_BUF) {
+    // 缓冲满之后到达的字节丢失，先到的保留：把尚未到达的部分前移接在缓冲之后
+    uint32_t lost = arrived - HOST_UART_RX_BUF;
+    for (uint32_t i = qHead + arrived; i != qTail; i++) at(i - lost) = at(i);
+    qTail -= lost;
+    rxOverflow += lost;
+    arrived = HOST_UART_RX_BUF;
+  }
+  return arrived;
+}
+
+int HardwareSerial::available() { return (int)settle(); }
+
+int HardwareSerial::peek() { return settle() ? at(qHead).b : -1; }
+
+int HardwareSerial::read() {
+  if (!settle()) return -1;
+  uint8_t b = at(qHead++).b;
+  rxBytes++;
+  return b;
+}
+
+void HardwareSerial::hostFeed(const uint8_t *p, size_t n, uint64_t startUs) {
+  uint64_t t = startUs > lastUs ? startUs : lastUs;
+  for (size_t i = 0; i < n; i++) {
+    t += byteUs;   // 停止位收完才进 FIFO
+    if (qTail - qHead == HOST_UART_QUEUE) { rxDropped++; continue; }
+    at(qTail++) = RxByte{ t, p[i] };
+  }
+  lastUs = t;
+}
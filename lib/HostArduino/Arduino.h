@@ -0,0 +1,203 @@
+// 主机端 Arduino 核心替身：虚拟时钟、GPIO、String、Print、Serial（仅 native 环境）
+#ifndef HOST_ARDUINO_H
+#define HOST_ARDUINO_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <algorithm>
+#include <string>
+
+typedef bool boolean;
+typedef uint8_t byte;
+
+#define PROGMEM
+#define pgm_read_byte(addr) (*(const uint8_t *)(addr))
+#define pgm_read_word(addr) (*(const uint16_t *)(addr))
+
+#define HIGH   1
+#define LOW    0
+#define INPUT  0
+#define OUTPUT 1
+#define INPUT_PULLUP 2
+
+#define DEC 10
+#define HEX 16
+
+// ESP32 专有修饰：主机端进程内没有“复位后保留”的概念，按普通静态变量处理
+#define RTC_DATA_ATTR
+#define SERIAL_8N1 0x800001c
+
+using std::min;
+using std::max;
+
+// ---- 虚拟时钟：delay() 只推进时间，不真正等待 ----
+uint32_t millis();
+uint32_t micros();
+void delay(uint32_t ms);
+void delayMicroseconds(uint32_t us);
+uint64_t hostMicros64();
+void hostSetMicros(uint64_t us);
+void hostAdvanceMicros(uint64_t us);
+void hostAdvanceNanos(uint64_t ns);   // SPI 等按字节计时的外设使用
+
+// ---- GPIO：写操作转发给已注册的监听者（虚拟面板用来跟踪 DC/CS） ----
+typedef void (*HostPinListener)(uint8_t pin, uint8_t val);
+void hostSetPinListener(HostPinListener fn);
+void pinMode(uint8_t pin, uint8_t mode);
+void digitalWrite(uint8_t pin, uint8_t val);
+int digitalRead(uint8_t pin);
+
+class String {
+ public:
+  String() {}
+  String(const char *s) : s(s ? s : "") {}
+  String(const std::string &s) : s(s) {}
+  String(char c) : s(1, c) {}
+  String(int v, unsigned char base = DEC) { fromLong(v, base); }
+  String(unsigned int v, unsigned char base = DEC) { fromULong(v, base); }
+  String(long v, unsigned char base = DEC) { fromLong(v, base); }
+  String(unsigned long v, unsigned char base = DEC) { fromULong(v, base); }
+  String(float v, unsigned char decimals = 2) { fromDouble(v, decimals); }
+  String(double v, unsigned char decimals = 2) { fromDouble(v, decimals); }
+
+  unsigned int length() const { return (unsigned int)s.size(); }
+  const char *c_str() const { return s.c_str(); }
+  char operator[](unsigned int i) const { return i < s.size() ? s[i] : 0; }
+  char charAt(unsigned int i) const { return (*this)[i]; }
+  bool operator==(const String &o) const { return s == o.s; }
+  bool operator!=(const String &o) const { return s != o.s; }
+  bool operator==(const char *o) const { return s == o; }
+  bool operator!=(const char *o) const { return s != o; }
+  String &operator+=(const String &o) { s += o.s; return *this; }
+  String &operator+=(const char *o) { s += o; return *this; }
+  String &operator+=(char c) { s += c; return *this; }
+  friend String operator+(const String &a, const String &b) { return String(a.s + b.s); }
+  bool concat(const String &o) { s += o.s; return true; }
+  int toInt() const { return atoi(s.c_str()); }
+  float toFloat() const { return (float)atof(s.c_str()); }
+
+ private:
+  void fromLong(long v, unsigned char base) {
+    if (v < 0 && base == DEC) { s = "-"; fromULongAppend((unsigned long)(-v), base); }
+    else fromULong((unsigned long)v, base);
+  }
+  void fromULong(unsigned long v, unsigned char base) { s.clear(); fromULongAppend(v, base); }
+  void fromULongAppend(unsigned long v, unsigned char base) {
+    char buf[34];
+    int i = sizeof(buf) - 1;
+    buf[i] = 0;
+    do { int d = v % base; buf[--i] = (char)(d < 10 ? '0' + d : 'A' + d - 10); v /= base; } while (v);
+    s += &buf[i];
+  }
+  void fromDouble(double v, unsigned char decimals) {
+    char buf[48];
+    snprintf(buf, sizeof(buf), "%.*f", decimals, v);
+    s = buf;
+  }
+
+  std::string s;
+};
+
+class Print {
+ public:
+  virtual ~Print() {}
+  virtual size_t write(uint8_t c) = 0;
+  virtual size_t write(const uint8_t *buf, size_t n) {
+    size_t k = 0;
+    while (n--) k += write(*buf++);
+    return k;
+  }
+  size_t write(const char *s) { return s ? write((const uint8_t *)s, strlen(s)) : 0; }
+
+  size_t print(const char *s) { return write(s); }
+  size_t print(const String &s) { return write((const uint8_t *)s.c_str(), s.length()); }
+  size_t print(char c) { return write((uint8_t)c); }
+  size_t print(unsigned char v, int base = DEC) { return print((unsigned long)v, base); }
+  size_t print(int v, int base = DEC) { return print((long)v, base); }
+  size_t print(unsigned int v, int base = DEC) { return print((unsigned long)v, base); }
+  size_t print(long v, int base = DEC) { return print(String(v, (unsigned char)base)); }
+  size_t print(unsigned long v, int base = DEC) { return print(String(v, (unsigned char)base)); }
+  size_t print(double v, int digits = 2) { return print(String(v, (unsigned char)digits)); }
+
+  size_t println() { return write((const uint8_t *)"\r\n", 2); }
+  template <typename T> size_t println(const T &v) { size_t n = print(v); return n + println(); }
+  template <typename T> size_t println(const T &v, int fmt) { size_t n = print(v, fmt); return n + println(); }
+};
+
+// 标准输出上的 Serial；hostSerialQuiet(true) 时丢弃输出（回放/仿真时避免刷屏）。
+// 输入由 hostSerialFeed 注入（仿真脚本向串口控制台发命令），写出的字节另可经 hostSerialTap 旁路给主机程序
+class HostSerial : public Print {
+ public:
+  void begin(unsigned long baud) { (void)baud; }
+  void end() {}
+  int available() { return (int)(rx.size() - rxPos); }
+  int read() { return rxPos < rx.size() ? (uint8_t)rx[rxPos++] : -1; }
+  void flush() { fflush(stdout); }
+  size_t write(uint8_t c) override;
+  size_t write(const uint8_t *buf, size_t n) override;
+  using Print::write;
+  operator bool() const { return true; }
+  uint64_t bytesWritten = 0;
+
+  void feed(const char *s, size_t n);
+
+ private:
+  std::string rx;
+  size_t rxPos = 0;
+};
+
+extern HostSerial Serial;
+void hostSerialQuiet(bool quiet);
+typedef void (*HostSerialTap)(const uint8_t *buf, size_t n);
+void hostSerialTap(HostSerialTap fn);
+void hostSerialFeed(const char *s);
+
+// ---- 硬件串口（外接传感器）：接收端是带到达时间的字节队列 ----
+// hostFeed 按波特率逐字节排定到达时间（10 位/字节），虚拟时钟走到后 available()/read() 才看得到；
+// 已到达但超出接收缓冲（HOST_UART_RX_BUF）的字节按硬件行为丢弃并计入 rxOverflow。
+// 待到达队列是固定大小的环（HOST_UART_QUEUE），运行中不分配内存，不干扰仿真的堆统计
+#define HOST_UART_COUNT  3
+#define HOST_UART_RX_BUF 256
+#define HOST_UART_QUEUE  1024   // 必须是 2 的幂
+
+class HardwareSerial : public Print {
+ public:
+  explicit HardwareSerial(int uartNum);
+  void begin(unsigned long baud, uint32_t config = SERIAL_8N1, int8_t rxPin = -1, int8_t txPin = -1);
+  void end() { started = false; }
+  int available();
+  int read();
+  int peek();
+  void flush() {}
+  size_t write(uint8_t c) override { (void)c; txBytes++; return 1; }
+  using Print::write;
+  operator bool() const { return started; }
+
+  // 从 startUs 起（不早于上一字节之后）排入 n 个字节
+  void hostFeed(const uint8_t *p, size_t n, uint64_t startUs);
+  size_t hostPending() const { return qTail - qHead; }
+  uint64_t rxBytes = 0;       // 已被 read() 取走
+  uint64_t rxOverflow = 0;    // 接收缓冲满丢弃
+  uint64_t rxDropped = 0;     // 未 begin() 时到达、或待到达队列已满而丢弃
+  uint64_t txBytes = 0;
+
+ private:
+  struct RxByte { uint64_t us; uint8_t b; };
+  size_t settle();            // 丢弃溢出字节，返回已到达的字节数
+  RxByte &at(uint32_t i) { return q[i & (HOST_UART_QUEUE - 1)]; }
+
+  RxByte q[HOST_UART_QUEUE];
+  uint32_t qHead = 0, qTail = 0;
+  uint64_t lastUs = 0;
+  uint32_t byteUs = 1042;     // 9600 8N1
+  bool started = false;
+};
+
+// 按编号取已构造的串口实例（固件里的全局 HardwareSerial），未构造时为 nullptr
+HardwareSerial *hostUart(int num);
+
+#endif // HOST_ARDUINO_H
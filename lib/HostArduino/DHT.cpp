@@ -0,0 +1,33 @@
+// 主机端 DHT 替身实现
+#include "DHT.h"
+
+static HostDhtSource gDhtSource = nullptr;
+
+void hostDhtSource(HostDhtSource fn) { gDhtSource = fn; }
+
+void DHT::begin(uint8_t usec) {
+  (void)usec;
+  pinMode(pin, INPUT_PULLUP);
+  lastReadMs = millis() - DHT_HOST_MIN_INTERVAL_MS;   // 第一次调用即真正读取
+}
+
+bool DHT::read(bool force) {
+  uint32_t now = millis();
+  if (!force && now - lastReadMs < DHT_HOST_MIN_INTERVAL_MS) return lastResult;
+  lastReadMs = now;
+  busReads++;
+  hostAdvanceMicros(DHT_HOST_READ_US);
+  lastResult = gDhtSource && gDhtSource(now, &t, &h);
+  if (!lastResult) { t = NAN; h = NAN; failures++; }
+  return lastResult;
+}
+
+float DHT::readTemperature(bool S, bool force) {
+  if (!read(force)) return NAN;
+  return S ? t * 1.8f + 32.0f : t;
+}
+
+float DHT::readHumidity(bool force) {
+  if (!read(force)) return NAN;
+  return h;
+}
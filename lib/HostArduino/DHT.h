@@ -0,0 +1,40 @@
+// 主机端 DHT 替身（接口同 Adafruit DHT）：读数来自主机程序注册的数据源，时序按 DHT22 推进虚拟时钟
+#ifndef HOST_DHT_H
+#define HOST_DHT_H
+
+#include "Arduino.h"
+
+#define DHT11  11
+#define DHT12  12
+#define DHT21  21
+#define DHT22  22
+#define AM2301 21
+
+// 与库相同：两次真正的总线读取至少间隔 2 s，期间返回上一次结果
+#define DHT_HOST_MIN_INTERVAL_MS 2000
+// 一次读取的阻塞时间：1.1 ms 起始信号 + 约 4 ms 的 40 位数据
+#define DHT_HOST_READ_US 5200
+
+// 数据源：返回 false 表示本次读取失败（超时/校验错），读数为 NaN
+typedef bool (*HostDhtSource)(uint32_t ms, float *tempC, float *hum);
+void hostDhtSource(HostDhtSource fn);
+
+class DHT {
+ public:
+  DHT(uint8_t pin, uint8_t type, uint8_t count = 6) : pin(pin), type(type) { (void)count; }
+  void begin(uint8_t usec = 55);
+  float readTemperature(bool S = false, bool force = false);
+  float readHumidity(bool force = false);
+  bool read(bool force = false);
+
+  uint32_t busReads = 0;   // 真正访问总线的次数
+  uint32_t failures = 0;
+
+ private:
+  uint8_t pin, type;
+  uint32_t lastReadMs = 0;
+  bool lastResult = false;
+  float t = NAN, h = NAN;
+};
+
+#endif // HOST_DHT_H
@@ -0,0 +1,16 @@
+// 主机端 SPI 替身实现
+#include "SPI.h"
+
+SPIClass SPI;
+
+void SPIClass::beginTransaction(const SPISettings &s) {
+  transactions++;
+  nsPerByte = s.clock ? (uint32_t)(8000000000ULL / s.clock) : 500;
+}
+
+uint8_t SPIClass::transfer(uint8_t b) {
+  bytes++;
+  hostAdvanceNanos(nsPerByte);
+  if (sink) sink(b);
+  return 0;
+}
@@ -0,0 +1,46 @@
+// 主机端 SPI 替身：字节转发给虚拟面板，并按时钟频率推进虚拟时间
+#ifndef HOST_SPI_H
+#define HOST_SPI_H
+
+#include "Arduino.h"
+
+#define MSBFIRST  1
+#define LSBFIRST  0
+#define SPI_MODE0 0
+#define SPI_MODE1 1
+#define SPI_MODE2 2
+#define SPI_MODE3 3
+
+class SPISettings {
+ public:
+  SPISettings() {}
+  SPISettings(uint32_t clock, uint8_t bitOrder, uint8_t dataMode) : clock(clock), bitOrder(bitOrder), dataMode(dataMode) {}
+  uint32_t clock = 1000000;
+  uint8_t bitOrder = MSBFIRST;
+  uint8_t dataMode = SPI_MODE0;
+};
+
+typedef void (*HostSpiSink)(uint8_t b);
+
+class SPIClass {
+ public:
+  void begin() {}
+  void begin(int8_t sck, int8_t miso, int8_t mosi, int8_t ss) { (void)sck; (void)miso; (void)mosi; (void)ss; }
+  void end() {}
+  void beginTransaction(const SPISettings &s);
+  void endTransaction() {}
+  uint8_t transfer(uint8_t b);
+  void writeBytes(const uint8_t *data, uint32_t n) { while (n--) transfer(*data++); }
+
+  void setSink(HostSpiSink fn) { sink = fn; }
+  uint64_t bytes = 0;            // 累计传输字节
+  uint64_t transactions = 0;     // beginTransaction 次数
+
+ private:
+  HostSpiSink sink = nullptr;
+  uint32_t nsPerByte = 500;      // 默认 16 MHz
+};
+
+extern SPIClass SPI;
+
+#endif // HOST_SPI_H
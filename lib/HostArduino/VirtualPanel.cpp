@@ -0,0 +1,120 @@
+// 虚拟 ST7789 面板实现
+#include <string.h>
+#include "VirtualPanel.h"
+#include "Arduino.h"
+#include "SPI.h"
+
+VirtualPanel *hostPanel = nullptr;
+
+static void panelSpiSink(uint8_t b) { if (hostPanel) hostPanel->onByte(b); }
+static void panelPinListener(uint8_t pin, uint8_t val) { if (hostPanel) hostPanel->onPin(pin, val); }
+
+void hostAttachPanel(VirtualPanel *p, uint8_t dcPin, int8_t csPin) {
+  hostPanel = p;
+  p->attach(dcPin, csPin);
+  SPI.setSink(panelSpiSink);
+  hostSetPinListener(panelPinListener);
+}
+
+void VirtualPanel::attach(uint8_t dcPin, int8_t csPin) {
+  dc = dcPin;
+  cs = csPin;
+  reset();
+}
+
+void VirtualPanel::reset() {
+  memset(fb, 0, sizeof(fb));
+  st = VirtualPanelStats();
+  dcData = true; csLow = false;
+  cmd = 0; argIdx = 0;
+  xs = ys = 0; xe = VPANEL_W - 1; ye = VPANEL_H - 1;
+  cx = cy = 0; hiByte = true;
+  mad = 0; sleepIn = true; dispOn = false;
+}
+
+void VirtualPanel::onPin(uint8_t pin, uint8_t val) {
+  if (pin == dc) dcData = val != 0;
+  if (cs >= 0 && pin == (uint8_t)cs) {
+    bool low = val == 0;
+    if (low && !csLow) st.transactions++;
+    csLow = low;
+  }
+}
+
+void VirtualPanel::onByte(uint8_t b) {
+  st.bytes++;
+  if (dcData) { st.dataBytes++; data(b); }
+  else { st.cmdBytes++; command(b); }
+}
+
+void VirtualPanel::command(uint8_t c) {
+  st.commands++;
+  cmd = c;
+  argIdx = 0;
+  switch (c) {
+    case 0x01: mad = 0; sleepIn = true; dispOn = false; break;   // SWRESET
+    case 0x10: sleepIn = true; break;                            // SLPIN
+    case 0x11: sleepIn = false; break;                           // SLPOUT
+    case 0x28: dispOn = false; break;                            // DISPOFF
+    case 0x29: dispOn = true; break;                             // DISPON
+    case 0x2C:                                                   // RAMWR
+      st.windows++;
+      cx = xs; cy = ys; hiByte = true;
+      break;
+    default: break;
+  }
+}
+
+void VirtualPanel::data(uint8_t d) {
+  switch (cmd) {
+    case 0x2A:   // CASET
+    case 0x2B:   // RASET
+      if (argIdx < 4) args[argIdx++] = d;
+      if (argIdx == 4) {
+        uint16_t s = (uint16_t)(args[0] << 8 | args[1]), e = (uint16_t)(args[2] << 8 | args[3]);
+        if (cmd == 0x2A) { xs = s; xe = e; } else { ys = s; ye = e; }
+        argIdx = 5;
+      }
+      break;
+    case 0x36:   // MADCTL
+      mad = d;
+      break;
+    case 0x2C:   // RAMWR：高字节在前，窗口内按行填充并回绕
+      if (hiByte) { pix = (uint16_t)(d << 8); hiByte = false; break; }
+      pix |= d;
+      hiByte = true;
+      if (cx < VPANEL_W && cy < VPANEL_H) fb[cy][cx] = pix;
+      st.pixels++;
+      if (++cx > xe) { cx = xs; if (++cy > ye) cy = ys; }
+      break;
+    default:
+      break;
+  }
+}
+
+uint32_t VirtualPanel::hash(uint16_t x0, uint16_t y0, uint16_t w, uint16_t h) const {
+  uint32_t hv = 2166136261u;
+  for (uint16_t y = y0; y < y0 + h && y < VPANEL_H; y++) {
+    for (uint16_t x = x0; x < x0 + w && x < VPANEL_W; x++) {
+      uint16_t p = fb[y][x];
+      hv = (hv ^ (p & 0xFF)) * 16777619u;
+      hv = (hv ^ (p >> 8)) * 16777619u;
+    }
+  }
+  return hv;
+}
+
+bool VirtualPanel::savePpm(const char *path, uint16_t x0, uint16_t y0, uint16_t w, uint16_t h) const {
+  FILE *f = fopen(path, "wb");
+  if (!f) return false;
+  fprintf(f, "P6\n%u %u\n255\n", w, h);
+  for (uint16_t y = y0; y < y0 + h; y++) {
+    for (uint16_t x = x0; x < x0 + w; x++) {
+      uint16_t p = (x < VPANEL_W && y < VPANEL_H) ? fb[y][x] : 0;
+      uint8_t rgb[3] = { (uint8_t)((p >> 8) & 0xF8), (uint8_t)((p >> 3) & 0xFC), (uint8_t)((p << 3) & 0xF8) };
+      fwrite(rgb, 1, 3, f);
+    }
+  }
+  fclose(f);
+  return true;
+}
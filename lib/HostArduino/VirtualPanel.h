@@ -0,0 +1,69 @@
+// 虚拟 ST7789 面板：解析 SPI 命令/数据流（CASET/RASET/RAMWR/MADCTL），维护显存并统计总线流量
+#ifndef HOST_VIRTUAL_PANEL_H
+#define HOST_VIRTUAL_PANEL_H
+
+#include <stdint.h>
+#include <stdio.h>
+
+#define VPANEL_W 320   // 地址空间按 320x320 保存，覆盖所有旋转与偏移
+#define VPANEL_H 320
+
+struct VirtualPanelStats {
+  uint64_t bytes = 0;          // 总线总字节
+  uint64_t cmdBytes = 0;       // 命令字节（DC=0）
+  uint64_t dataBytes = 0;      // 参数与像素字节（DC=1）
+  uint64_t pixels = 0;         // 写入显存的像素数
+  uint64_t windows = 0;        // RAMWR 次数（每次对应一个地址窗口）
+  uint64_t transactions = 0;   // CS 拉低次数
+  uint64_t commands = 0;       // 命令总数
+};
+
+class VirtualPanel {
+ public:
+  // dcPin/csPin 与固件中 ST7789_AVR 构造参数一致
+  void attach(uint8_t dcPin, int8_t csPin);
+  void reset();
+
+  const VirtualPanelStats &stats() const { return st; }
+  void resetStats() { st = VirtualPanelStats(); }
+
+  uint16_t pixel(uint16_t x, uint16_t y) const { return fb[y][x]; }
+  // 地址空间内 [x0,x0+w) x [y0,y0+h) 区域的 FNV-1a 哈希
+  uint32_t hash(uint16_t x0, uint16_t y0, uint16_t w, uint16_t h) const;
+  // 以 PPM（RGB888）保存区域截图
+  bool savePpm(const char *path, uint16_t x0, uint16_t y0, uint16_t w, uint16_t h) const;
+  bool sleeping() const { return sleepIn; }
+  bool displayOn() const { return dispOn; }
+  uint8_t madctl() const { return mad; }
+
+  // 供 SPI/GPIO 替身调用
+  void onByte(uint8_t b);
+  void onPin(uint8_t pin, uint8_t val);
+
+ private:
+  void command(uint8_t c);
+  void data(uint8_t d);
+
+  uint16_t fb[VPANEL_H][VPANEL_W];
+  VirtualPanelStats st;
+  uint8_t dc = 16;
+  int8_t cs = -1;
+  bool dcData = true;
+  bool csLow = false;
+  uint8_t cmd = 0;
+  uint8_t argIdx = 0;
+  uint8_t args[4];
+  uint16_t xs = 0, xe = 0, ys = 0, ye = 0;
+  uint16_t cx = 0, cy = 0;
+  bool hiByte = true;
+  uint16_t pix = 0;
+  uint8_t mad = 0;
+  bool sleepIn = true;
+  bool dispOn = false;
+};
+
+// 当前连接到 SPI/GPIO 替身的面板
+extern VirtualPanel *hostPanel;
+void hostAttachPanel(VirtualPanel *p, uint8_t dcPin, int8_t csPin);
+
+#endif // HOST_VIRTUAL_PANEL_H
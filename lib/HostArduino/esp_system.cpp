@@ -0,0 +1,7 @@
+// 主机端 esp_system 替身实现
+#include "esp_system.h"
+
+static esp_reset_reason_t gResetReason = ESP_RST_POWERON;
+
+esp_reset_reason_t esp_reset_reason() { return gResetReason; }
+void hostSetResetReason(esp_reset_reason_t r) { gResetReason = r; }
@@ -3,6 +3,10 @@
 
 #include "ST7789_AVR.h"
 #include <SPI.h>
+#if ST7789_LINEBUF
+#include "rgb565_simd.h"
+#include "rgb565_compose.h"
+#endif
 
 /*
 Changes:
@@ -12,6 +16,10 @@ Changes:
 - fixed fillRect for w*h>64k
 - added support for 240x280 and 170x320
 - added clipping for negative x,y
+- added render cost accounting (ST7789_STATS)
+- added non-blocking initAsync()/initPoll() with datasheet timing and warm (no reset) path
+- image copies and large fills go through a line buffer (rgb565_simd kernels + SPI.writeBytes), ST7789_LINEBUF
+- added drawMask/drawCharAA/drawRows: alpha-blended masks and composited rows on the line-buffer path
 */
 
 #define ST7789_NOP     0x00
@@ -80,12 +88,47 @@ static const uint8_t PROGMEM init_240x240[] = {
 			20
 };
 
+#if ST7789_STATS
+#define ST_COST_BEGIN(p)  costBegin(p)
+#define ST_COST_END       costEnd()
+#define ST_COUNT(f,n)     run.f+=(n)
+#else
+#define ST_COST_BEGIN(p)
+#define ST_COST_END
+#define ST_COUNT(f,n)
+#endif
+
+// fast init (initAsync): hardware reset replaces SWRESET, then only the waits the datasheet requires -
+// 120 ms after reset before SLPOUT, 5 ms after SLPOUT before the next command
+#define ST7789_RESET_WAIT_US   120000
+#define ST7789_SLPOUT_WAIT_MS  5
+static const uint8_t PROGMEM init_fast[] = {
+		8,
+		ST7789_SLPOUT ,   ST_CMD_DELAY,
+			ST7789_SLPOUT_WAIT_MS,
+		ST7789_COLMOD , 1,
+			0x55,
+		ST7789_MADCTL , 1,
+			0x00,
+		ST7789_CASET  , 4,
+			0x00, ST7789_240x240_XSTART,
+			(ST7789_TFTWIDTH+ST7789_240x240_XSTART) >> 8,
+			(ST7789_TFTWIDTH+ST7789_240x240_XSTART) & 0xFF,
+		ST7789_RASET  , 4,
+			0x00, ST7789_240x240_YSTART,
+			(ST7789_TFTHEIGHT+ST7789_240x240_YSTART) >> 8,
+			(ST7789_TFTHEIGHT+ST7789_240x240_YSTART) & 0xFF,
+		ST7789_INVON  , 0,
+		ST7789_NORON  , 0,
+		ST7789_DISPON , 0
+};
+
 #ifdef COMPATIBILITY_MODE
 static SPISettings spiSettings;
-#define SPI_START  SPI.beginTransaction(spiSettings)
+#define SPI_START  ST_COUNT(transactions,1); SPI.beginTransaction(spiSettings)
 #define SPI_END    SPI.endTransaction()
 #else
-#define SPI_START
+#define SPI_START  ST_COUNT(transactions,1)
 #define SPI_END
 #endif
 
@@ -107,6 +150,7 @@ static SPISettings spiSettings;
 #endif
 
 inline void ST7789_AVR::writeSPI(uint8_t c) {
+	ST_COUNT(bytes,1);
 #ifdef COMPATIBILITY_MODE
 	SPI.transfer(c);
 #else
@@ -119,31 +163,76 @@ inline void ST7789_AVR::writeSPI(uint8_t c) {
 }
 
 inline void ST7789_AVR::writeMulti(uint16_t color, uint16_t num) {
+	ST_COUNT(bytes,2u*(num ? num : 0x10000u));   // num==0 sends 64k pixels (see fillRect)
 #ifdef COMPATIBILITY_MODE
+#if ST7789_LINEBUF
+	if(!num || num>=8) {
+		uint16_t buf[ST7789_LINEBUF] __attribute__((aligned(16)));
+		uint32_t n=num ? num : 0x10000u, k=n<ST7789_LINEBUF ? n : ST7789_LINEBUF;
+		rgb565Fill(buf,rgb565Swap(color),k);
+		while(n) { k=n<ST7789_LINEBUF ? n : ST7789_LINEBUF; SPI.writeBytes((uint8_t*)buf,2*k); n-=k; }
+		return;
+	}
+#endif
 	while(num--) { SPI.transfer(color>>8); SPI.transfer(color); }
 #else
 	// AVR optimized path omitted for ESP32
 #endif
 }
 
+#if ST7789_LINEBUF
+// byte-swap into a line buffer, send whole chunks (bytes are counted by the caller)
+void ST7789_AVR::copyPixels(const uint16_t *img, uint32_t num) {
+	uint16_t buf[ST7789_LINEBUF] __attribute__((aligned(16)));
+	while(num) { uint32_t k=num<ST7789_LINEBUF ? num : ST7789_LINEBUF; rgb565SwapCopy(buf,img,k); SPI.writeBytes((uint8_t*)buf,2*k); img+=k; num-=k; }
+}
+#endif
+
 inline void ST7789_AVR::copyMulti(uint8_t *img, uint16_t num) {
+	ST_COUNT(bytes,2u*(num ? num : 0x10000u));
 #ifdef COMPATIBILITY_MODE
+#if ST7789_LINEBUF
+	copyPixels((const uint16_t*)img,num ? num : 0x10000u);
+#else
 	while(num--) { SPI.transfer(*(img+1)); SPI.transfer(*img); img+=2; }
+#endif
 #else
 	// AVR optimized path omitted
 #endif
 }
 
 void ST7789_AVR::writeCmd(uint8_t c) {
-	DC_COMMAND; CS_ACTIVE; SPI_START; writeSPI(c); CS_IDLE; SPI_END;
+	ST_COST_BEGIN(ST_PRIM_CMD); DC_COMMAND; CS_ACTIVE; SPI_START; writeSPI(c); CS_IDLE; SPI_END; ST_COST_END;
 }
 
 void ST7789_AVR::writeData(uint8_t d8) {
-	DC_DATA; CS_ACTIVE; SPI_START; writeSPI(d8); CS_IDLE; SPI_END;
+	ST_COST_BEGIN(ST_PRIM_CMD); DC_DATA; CS_ACTIVE; SPI_START; writeSPI(d8); CS_IDLE; SPI_END; ST_COST_END;
 }
 
 void ST7789_AVR::writeData16(uint16_t d16) {
-	DC_DATA; CS_ACTIVE; SPI_START; writeMulti(d16,1); CS_IDLE; SPI_END;
+	ST_COST_BEGIN(ST_PRIM_CMD); DC_DATA; CS_ACTIVE; SPI_START; writeMulti(d16,1); CS_IDLE; SPI_END; ST_COST_END;
+}
+
+#if ST7789_STATS
+void ST7789_AVR::costBegin(uint8_t prim) {
+	if(costDepth++) return;
+	costPrim=prim; runAtBegin=run; usAtBegin=micros();
+}
+
+void ST7789_AVR::costEnd() {
+	if(--costDepth) return;
+	ST7789Cost d=run.minus(runAtBegin); d.calls=1; d.us=micros()-usAtBegin;
+	stats.prim[costPrim].add(d); stats.tag[costTag].add(d); stats.total.add(d);
+}
+
+const char *ST7789_AVR::primName(uint8_t p) {
+	static const char *const names[ST_PRIM_COUNT]={ "cmd", "fillRect", "line", "pixel", "glyph", "image", "mask" };
+	return p<ST_PRIM_COUNT ? names[p] : "?";
+}
+#endif
+
+size_t ST7789_AVR::write(uint8_t c) {
+	ST_COST_BEGIN(ST_PRIM_GLYPH); size_t n=Adafruit_GFX::write(c); ST_COST_END; return n;
 }
 
 ST7789_AVR::ST7789_AVR(int8_t dc, int8_t rst, int8_t cs) : Adafruit_GFX(ST7789_TFTWIDTH, ST7789_TFTHEIGHT) {
@@ -152,13 +241,51 @@ ST7789_AVR::ST7789_AVR(int8_t dc, int8_t rst, int8_t cs) : Adafruit_GFX(ST7789_T
 
 void ST7789_AVR::init(uint16_t wd, uint16_t ht) {
 	commonST7789Init(NULL);
+	initGeometry(wd,ht);
+	displayInit(init_240x240); setRotation(2);
+}
+
+void ST7789_AVR::initGeometry(uint16_t wd, uint16_t ht) {
 	if(wd==240 && ht==280) { xstart=0; ystart=20; xend=0; yend=20; }
 	else if(wd==240 && ht==240) { xstart=0; ystart=80; xend=0; yend=0; }
 	else if(wd==170 && ht==320) { xstart=35; ystart=0; xend=35; yend=0; }
 	else if(wd==172 && ht==320) { xstart=34; ystart=0; xend=34; yend=0; }
 	else { xstart=0; ystart=0; xend=0; yend=0; }
 	xoffs=yoffs=0; _width=_widthIni=wd; _height=_heightIni=ht;
-	displayInit(init_240x240); setRotation(2);
+}
+
+void ST7789_AVR::initAsync(uint16_t wd, uint16_t ht, bool warm) {
+	initPins();
+	initGeometry(wd,ht);
+	initPtr=init_fast; initLeft=pgm_read_byte(initPtr++);
+	initWaitFrom=micros(); initWaitUs=0;
+	if(warm) { initPhase=ST_INIT_TABLE; return; }
+	if(rstPin!=-1) {
+		pinMode(rstPin,OUTPUT); digitalWrite(rstPin,LOW); delayMicroseconds(20); digitalWrite(rstPin,HIGH);
+		initPhase=ST_INIT_RESET; initWaitUs=ST7789_RESET_WAIT_US;
+	} else {
+		initPhase=ST_INIT_SWRESET;
+	}
+}
+
+bool ST7789_AVR::initPoll() {
+	while(initPhase!=ST_INIT_DONE) {
+		if(micros()-initWaitFrom < initWaitUs) return false;
+		initWaitFrom=micros(); initWaitUs=0;
+		switch(initPhase) {
+			case ST_INIT_SWRESET: writeCmd(ST7789_SWRESET); initWaitUs=ST7789_RESET_WAIT_US; initPhase=ST_INIT_TABLE; break;
+			case ST_INIT_RESET: initPhase=ST_INIT_TABLE; break;
+			default: {
+				if(!initLeft) { setRotation(2); initPhase=ST_INIT_DONE; break; }
+				initLeft--;
+				writeCmd(pgm_read_byte(initPtr++)); uint8_t numArgs=pgm_read_byte(initPtr++); uint8_t ms=numArgs & ST_CMD_DELAY; numArgs &= ~ST_CMD_DELAY;
+				while(numArgs--) writeData(pgm_read_byte(initPtr++));
+				if(ms) initWaitUs=(uint32_t)pgm_read_byte(initPtr++)*1000;
+				break;
+			}
+		}
+	}
+	return true;
 }
 
 void ST7789_AVR::displayInit(const uint8_t *addr) {
@@ -168,8 +295,11 @@ void ST7789_AVR::displayInit(const uint8_t *addr) {
 		while(numArgs--) writeData(pgm_read_byte(addr++)); if(ms){ ms=pgm_read_byte(addr++); if(ms==255) ms=500; delay(ms);} }
 }
 
-void ST7789_AVR::commonST7789Init(const uint8_t *cmdList) {
+void ST7789_AVR::initPins() {
 	pinMode(dcPin,OUTPUT);
+#if ST7789_LINEBUF
+	rgb565Check();   // vector path that disagrees with the scalar reference falls back to SWAR
+#endif
 #ifndef CS_ALWAYS_LOW
 	pinMode(csPin,OUTPUT);
 #endif
@@ -178,6 +308,10 @@ void ST7789_AVR::commonST7789Init(const uint8_t *cmdList) {
 	spiSettings = SPISettings(16000000, MSBFIRST, SPI_MODE3);
 #endif
 	if(csPin>=0) { pinMode(csPin,OUTPUT); digitalWrite(csPin,LOW); }
+}
+
+void ST7789_AVR::commonST7789Init(const uint8_t *cmdList) {
+	initPins();
 	if(rstPin!=-1){ pinMode(rstPin,OUTPUT); digitalWrite(rstPin,HIGH); delay(50); digitalWrite(rstPin,LOW); delay(50); digitalWrite(rstPin,HIGH); delay(50); }
 	if(cmdList) displayInit(cmdList);
 }
@@ -188,23 +322,29 @@ void ST7789_AVR::setRotation(uint8_t m) {
 }
 
 void ST7789_AVR::setAddrWindow(uint16_t xs, uint16_t ys, uint16_t xe, uint16_t ye) {
-	xs+=xoffs; xe+=xoffs; ys+=yoffs; ye+=yoffs; CS_ACTIVE; SPI_START; DC_COMMAND; writeSPI(ST7789_CASET); DC_DATA; writeSPI(xs>>8); writeSPI(xs); writeSPI(xe>>8); writeSPI(xe); DC_COMMAND; writeSPI(ST7789_RASET); DC_DATA; writeSPI(ys>>8); writeSPI(ys); writeSPI(ye>>8); writeSPI(ye); DC_COMMAND; writeSPI(ST7789_RAMWR); DC_DATA; }
+	ST_COUNT(windows,1); xs+=xoffs; xe+=xoffs; ys+=yoffs; ye+=yoffs; CS_ACTIVE; SPI_START; DC_COMMAND; writeSPI(ST7789_CASET); DC_DATA; writeSPI(xs>>8); writeSPI(xs); writeSPI(xe>>8); writeSPI(xe); DC_COMMAND; writeSPI(ST7789_RASET); DC_DATA; writeSPI(ys>>8); writeSPI(ys); writeSPI(ye>>8); writeSPI(ye); DC_COMMAND; writeSPI(ST7789_RAMWR); DC_DATA; }
 
-void ST7789_AVR::pushColor(uint16_t color) { SPI_START; CS_ACTIVE; writeSPI(color>>8); writeSPI(color); CS_IDLE; SPI_END; }
+void ST7789_AVR::pushColor(uint16_t color) { ST_COST_BEGIN(ST_PRIM_PIXEL); SPI_START; CS_ACTIVE; writeSPI(color>>8); writeSPI(color); CS_IDLE; SPI_END; ST_COST_END; }
 
-void ST7789_AVR::drawPixel(int16_t x,int16_t y,uint16_t color){ if(x<0||x>=_width||y<0||y>=_height) return; setAddrWindow(x,y,x,y); writeSPI(color>>8); writeSPI(color); CS_IDLE; SPI_END; }
+void ST7789_AVR::drawPixel(int16_t x,int16_t y,uint16_t color){ if(x<0||x>=_width||y<0||y>=_height) return; ST_COST_BEGIN(ST_PRIM_PIXEL); setAddrWindow(x,y,x,y); writeSPI(color>>8); writeSPI(color); CS_IDLE; SPI_END; ST_COST_END; }
 
-void ST7789_AVR::drawFastVLine(int16_t x,int16_t y,int16_t h,uint16_t color){ if(x>=_width||y>=_height||h<=0) return; if(y+h>_height) h=_height-y; if(y<0){h+=y; y=0;} if(h<=0) return; setAddrWindow(x,y,x,y+h-1); writeMulti(color,h); CS_IDLE; SPI_END; }
+void ST7789_AVR::drawFastVLine(int16_t x,int16_t y,int16_t h,uint16_t color){ if(x>=_width||y>=_height||h<=0) return; if(y+h>_height) h=_height-y; if(y<0){h+=y; y=0;} if(h<=0) return; ST_COST_BEGIN(ST_PRIM_LINE); setAddrWindow(x,y,x,y+h-1); writeMulti(color,h); CS_IDLE; SPI_END; ST_COST_END; }
 
-void ST7789_AVR::drawFastHLine(int16_t x,int16_t y,int16_t w,uint16_t color){ if(x>=_width||y>=_height||w<=0) return; if(x+w>_width) w=_width-x; if(x<0){w+=x; x=0;} if(w<=0) return; setAddrWindow(x,y,x+w-1,y); writeMulti(color,w); CS_IDLE; SPI_END; }
+void ST7789_AVR::drawFastHLine(int16_t x,int16_t y,int16_t w,uint16_t color){ if(x>=_width||y>=_height||w<=0) return; if(x+w>_width) w=_width-x; if(x<0){w+=x; x=0;} if(w<=0) return; ST_COST_BEGIN(ST_PRIM_LINE); setAddrWindow(x,y,x+w-1,y); writeMulti(color,w); CS_IDLE; SPI_END; ST_COST_END; }
 
-void ST7789_AVR::fillRect(int16_t x,int16_t y,int16_t w,int16_t h,uint16_t color){ if(x>=_width||y>=_height||w<=0||h<=0) return; if(x+w>_width) w=_width-x; if(y+h>_height) h=_height-y; if(x<0){w+=x; x=0;} if(w<=0) return; if(y<0){h+=y; y=0;} if(h<=0) return; setAddrWindow(x,y,x+w-1,y+h-1); if((long)w*h>0x10000) writeMulti(color,0); writeMulti(color,w*h); CS_IDLE; SPI_END; }
+void ST7789_AVR::fillRect(int16_t x,int16_t y,int16_t w,int16_t h,uint16_t color){ if(x>=_width||y>=_height||w<=0||h<=0) return; if(x+w>_width) w=_width-x; if(y+h>_height) h=_height-y; if(x<0){w+=x; x=0;} if(w<=0) return; if(y<0){h+=y; y=0;} if(h<=0) return; ST_COST_BEGIN(ST_PRIM_FILLRECT); setAddrWindow(x,y,x+w-1,y+h-1); if((long)w*h>0x10000) writeMulti(color,0); writeMulti(color,w*h); CS_IDLE; SPI_END; ST_COST_END; }
 
 void ST7789_AVR::fillScreen(uint16_t color){ fillRect(0,0,_width,_height,color); }
 
-void ST7789_AVR::drawImage(int16_t x,int16_t y,int16_t w,int16_t h,uint16_t *img16){ if(w<=0||h<=0) return; setAddrWindow(x,y,x+w-1,y+h-1); copyMulti((uint8_t*)img16,w*h); CS_IDLE; SPI_END; }
+void ST7789_AVR::drawImage(int16_t x,int16_t y,int16_t w,int16_t h,uint16_t *img16){ if(w<=0||h<=0) return; ST_COST_BEGIN(ST_PRIM_IMAGE); setAddrWindow(x,y,x+w-1,y+h-1); copyMulti((uint8_t*)img16,w*h); CS_IDLE; SPI_END; ST_COST_END; }
 
-void ST7789_AVR::drawImageF(int16_t x,int16_t y,int16_t w,int16_t h,const uint16_t *img16){ if(x>=_width||y>=_height||w<=0||h<=0) return; setAddrWindow(x,y,x+w-1,y+h-1); uint32_t num=(uint32_t)w*h; uint16_t num16=num>>3; uint8_t *img=(uint8_t*)img16; while(num16--){ for(uint8_t i=0;i<8;i++){ writeSPI(pgm_read_byte(img+1)); writeSPI(pgm_read_byte(img)); img+=2; } } uint8_t num8=num & 0x7; while(num8--){ writeSPI(pgm_read_byte(img+1)); writeSPI(pgm_read_byte(img)); img+=2; } CS_IDLE; SPI_END; }
+void ST7789_AVR::drawImageF(int16_t x,int16_t y,int16_t w,int16_t h,const uint16_t *img16){ if(x>=_width||y>=_height||w<=0||h<=0) return; ST_COST_BEGIN(ST_PRIM_IMAGE); setAddrWindow(x,y,x+w-1,y+h-1); uint32_t num=(uint32_t)w*h;
+#if ST7789_LINEBUF
+	ST_COUNT(bytes,2*num); copyPixels(img16,num);
+#else
+	uint16_t num16=num>>3; uint8_t *img=(uint8_t*)img16; while(num16--){ for(uint8_t i=0;i<8;i++){ writeSPI(pgm_read_byte(img+1)); writeSPI(pgm_read_byte(img)); img+=2; } } uint8_t num8=num & 0x7; while(num8--){ writeSPI(pgm_read_byte(img+1)); writeSPI(pgm_read_byte(img)); img+=2; }
+#endif
+	CS_IDLE; SPI_END; ST_COST_END; }
 
 uint16_t ST7789_AVR::Color565(uint8_t r,uint8_t g,uint8_t b){ return ((r & 0xF8) << 8) | ((g & 0xFC) << 3) | (b >> 3); }
 
@@ -221,3 +361,63 @@ void ST7789_AVR::setBrightness(uint8_t br){ int val=0x04; writeCmd(ST7789_WRCTRL
 void ST7789_AVR::powerSave(uint8_t mode){ if(mode==0){ writeCmd(ST7789_POWSAVE); writeData(0xec|3); writeCmd(ST7789_DLPOFFSAVE); writeData(0xff); return; } int is=(mode&1)?0:1; int ns=(mode&2)?0:2; writeCmd(ST7789_POWSAVE); writeData(0xec|ns|is); if(mode&4){ writeCmd(ST7789_DLPOFFSAVE); writeData(0xfe); } }
 void ST7789_AVR::rgbWheel(int idx,uint8_t *_r,uint8_t *_g,uint8_t *_b){ idx &= 0x1ff; if(idx < 85){ *_r=255; *_g=idx*3; *_b=0; return; } else if(idx < 85*2){ idx -= 85*1; *_r=255-idx*3; *_g=255; *_b=0; return; } else if(idx < 85*3){ idx -= 85*2; *_r=0; *_g=255; *_b=idx*3; return; } else if(idx < 85*4){ idx -= 85*3; *_r=0; *_g=255-idx*3; *_b=255; return; } else if(idx < 85*5){ idx -= 85*4; *_r=idx*3; *_g=0; *_b=255; return; } else { idx -= 85*5; if(idx>85) idx=85; *_r=255; *_g=0; *_b=255-idx*3; return; } }
 uint16_t ST7789_AVR::rgbWheel(int idx){ uint8_t r,g,b; rgbWheel(idx,&r,&g,&b); return RGBto565(r,g,b); }
+
+#if ST7789_LINEBUF
+// clip (x,y,w,h) to the screen; dx/dy = pixels cut from the left/top
+static bool clipRect(int16_t &x, int16_t &y, int16_t &w, int16_t &h, int16_t sw, int16_t sh, int16_t &dx, int16_t &dy) {
+	dx=x<0 ? -x : 0; dy=y<0 ? -y : 0; x+=dx; y+=dy; w-=dx; h-=dy;
+	if(x+w>sw) w=sw-x;
+	if(y+h>sh) h=sh-y;
+	return w>0 && h>0;
+}
+
+// w x h of the mask starting at mask pixel (mx,my)
+void ST7789_AVR::maskRect(int16_t x,int16_t y,int16_t w,int16_t h,const uint8_t *mask,uint16_t stride,int16_t mx,int16_t my,uint8_t bpp,uint16_t fg,uint16_t bg) {
+	int16_t dx,dy;
+	if(!clipRect(x,y,w,h,_width,_height,dx,dy)) return;
+	mx+=dx; my+=dy;
+	const Rgb565Lut &lut=rgb565LutFor(fg,bg,bpp);
+	ST_COST_BEGIN(ST_PRIM_MASK); setAddrWindow(x,y,x+w-1,y+h-1); ST_COUNT(bytes,2u*w*h);
+	uint16_t buf[ST7789_LINEBUF] __attribute__((aligned(16)));
+	for(int16_t r=0;r<h;r++) {
+		const uint8_t *row=mask+(uint32_t)(r+my)*stride;
+		for(int16_t c=0;c<w;) { uint16_t k=w-c<ST7789_LINEBUF ? w-c : ST7789_LINEBUF; rgb565MaskRowSolid(buf,row,mx+c,k,lut); SPI.writeBytes((uint8_t*)buf,2*k); c+=k; }
+	}
+	CS_IDLE; SPI_END; ST_COST_END;
+}
+
+void ST7789_AVR::drawMask(int16_t x,int16_t y,int16_t w,int16_t h,const uint8_t *mask,uint8_t bpp,uint16_t fg,uint16_t bg) {
+	maskRect(x,y,w,h,mask,rgb565MaskStride(w,bpp),0,0,bpp,fg,bg);
+}
+
+void ST7789_AVR::drawCharAA(int16_t x,int16_t y,unsigned char c,uint16_t fg,uint16_t bg,uint8_t size,bool trim) {
+	if(size>RGB565_GLYPH_MAX_SIZE) { drawChar(x,y,c,fg,bg,size); return; }
+	int16_t w=6*size, h=8*size, x0=0, y0=0, x1=w-1, y1=h-1;
+	uint16_t stride=rgb565MaskStride(w,4);
+	const uint8_t *m=rgb565GlyphMask(c,size);
+	if(trim) {
+		x0=w; y0=h; x1=y1=-1;
+		for(int16_t r=0;r<h;r++) for(int16_t i=0;i<w;i++) if(rgb565MaskAt(m+(uint32_t)r*stride,4,i)) {
+			if(i<x0) x0=i;
+			if(i>x1) x1=i;
+			if(r<y0) y0=r;
+			y1=r;
+		}
+		if(x1<0) return;
+	}
+	maskRect(x+x0,y+y0,x1-x0+1,y1-y0+1,m,stride,x0,y0,4,fg,bg);
+}
+
+void ST7789_AVR::drawRows(int16_t x,int16_t y,int16_t w,int16_t h,RowFn fn,void *ctx) {
+	int16_t dx,dy;
+	if(w>ST7789_ROWBUF) w=ST7789_ROWBUF;
+	if(!clipRect(x,y,w,h,_width,_height,dx,dy)) return;
+	ST_COST_BEGIN(ST_PRIM_MASK); setAddrWindow(x,y,x+w-1,y+h-1); ST_COUNT(bytes,2u*w*h);
+	uint16_t row[ST7789_ROWBUF] __attribute__((aligned(16)));
+	for(int16_t r=0;r<h;r++) {
+		fn(row,x,y+r,w,ctx);
+		copyPixels(row,w);
+	}
+	CS_IDLE; SPI_END; ST_COST_END;
+}
+#endif
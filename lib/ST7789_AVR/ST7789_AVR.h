@@ -13,6 +13,42 @@
 #include <Arduino.h>
 #include <Adafruit_GFX.h>
 
+// pixels per line buffer for image copies and large fills: byte-swapped/filled with the rgb565_simd kernels
+// and sent with SPI.writeBytes. 0 = byte by byte (AVR SPI has no writeBytes)
+#ifndef ST7789_LINEBUF
+#ifdef __AVR__
+#define ST7789_LINEBUF 0
+#else
+#define ST7789_LINEBUF 64
+#endif
+#endif
+// widest row drawRows() composes (stack buffer)
+#ifndef ST7789_ROWBUF
+#define ST7789_ROWBUF 320
+#endif
+
+// render cost accounting: bytes sent, address windows, SPI transactions, calls and microseconds,
+// broken down by primitive and by caller tag (setCostTag). Nested calls (e.g. fillRect inside a glyph)
+// are charged to the outermost primitive. Define ST7789_STATS 0 to compile it out.
+#ifndef ST7789_STATS
+#define ST7789_STATS 1
+#endif
+
+enum ST7789Prim { ST_PRIM_CMD=0, ST_PRIM_FILLRECT, ST_PRIM_LINE, ST_PRIM_PIXEL, ST_PRIM_GLYPH, ST_PRIM_IMAGE, ST_PRIM_MASK, ST_PRIM_COUNT };
+#define ST_TAG_COUNT 8    // tag 0 = untagged
+
+struct ST7789Cost {
+	uint32_t bytes=0, windows=0, transactions=0, calls=0, us=0;
+	void add(const ST7789Cost &c) { bytes+=c.bytes; windows+=c.windows; transactions+=c.transactions; calls+=c.calls; us+=c.us; }
+	ST7789Cost minus(const ST7789Cost &c) const { ST7789Cost d; d.bytes=bytes-c.bytes; d.windows=windows-c.windows; d.transactions=transactions-c.transactions; d.calls=calls-c.calls; d.us=us-c.us; return d; }
+};
+
+struct ST7789Stats {
+	ST7789Cost prim[ST_PRIM_COUNT];
+	ST7789Cost tag[ST_TAG_COUNT];
+	ST7789Cost total;
+};
+
 #define ST7789_TFTWIDTH 	240
 #define ST7789_TFTHEIGHT 	240
 
@@ -41,6 +77,12 @@ class ST7789_AVR : public Adafruit_GFX {
 	void init(uint16_t wd, uint16_t ht);
 	void begin() { init(ST7789_TFTWIDTH,ST7789_TFTHEIGHT); }
 	void init() { init(ST7789_TFTWIDTH,ST7789_TFTHEIGHT); }
+	// non-blocking init with datasheet timing instead of fixed delays: call initAsync(), then initPoll()
+	// until it returns true; other peripherals can be brought up in between.
+	// warm=true: the panel kept power and configuration (MCU-only reset) - no reset, no sleep-out wait
+	void initAsync(uint16_t wd, uint16_t ht, bool warm=false);
+	bool initPoll();
+	bool initDone() const { return initPhase==ST_INIT_DONE; }
 	void setAddrWindow(uint16_t xs, uint16_t ys, uint16_t xe, uint16_t ye);
 	void pushColor(uint16_t color);
 	void fillScreen(uint16_t color=BLACK);
@@ -69,6 +111,29 @@ class ST7789_AVR : public Adafruit_GFX {
 	uint16_t color565(uint8_t r, uint8_t g, uint8_t b) { return Color565(r, g, b); } 
 	void rgbWheel(int idx, uint8_t *_r, uint8_t *_g, uint8_t *_b);
 	uint16_t rgbWheel(int idx);
+	size_t write(uint8_t c);   // text goes through here: charged as ST_PRIM_GLYPH
+	using Adafruit_GFX::write;
+#if ST7789_LINEBUF
+	// alpha masks (rgb565_compose.h), one address window each, rows blended through a per-colour LUT in the
+	// line buffer: never more bus bytes than an opaque fill of the same rectangle
+	void drawMask(int16_t x, int16_t y, int16_t w, int16_t h, const uint8_t *mask, uint8_t bpp, uint16_t fg, uint16_t bg);
+	// anti-aliased classic-font cell, same 6x8*size footprint as drawChar with an opaque background;
+	// trim: only the inked box of the cell, for a background that is already bg (freshly cleared screen)
+	void drawCharAA(int16_t x, int16_t y, unsigned char c, uint16_t fg, uint16_t bg, uint8_t size, bool trim=false);
+	// software-composited rectangle: fn fills row[0..w-1] (native RGB565) for screen row y, x is the left edge
+	typedef void (*RowFn)(uint16_t *row, int16_t x, int16_t y, uint16_t w, void *ctx);
+	void drawRows(int16_t x, int16_t y, int16_t w, int16_t h, RowFn fn, void *ctx);
+#endif
+#if ST7789_STATS
+	void setCostTag(uint8_t tag) { costTag = tag < ST_TAG_COUNT ? tag : 0; }
+	uint8_t getCostTag() const { return costTag; }
+	const ST7789Stats &renderStats() const { return stats; }
+	void resetRenderStats() { stats = ST7789Stats(); }
+	static const char *primName(uint8_t p);
+#else
+	void setCostTag(uint8_t tag) { (void)tag; }
+	uint8_t getCostTag() const { return 0; }
+#endif
  protected:
 	uint8_t xstart, ystart, xend, yend, xoffs, yoffs;
 	uint16_t _widthIni, _heightIni;
@@ -76,10 +141,29 @@ class ST7789_AVR : public Adafruit_GFX {
 	void writeSPI(uint8_t);
 	void writeMulti(uint16_t color, uint16_t num);
 	void copyMulti(uint8_t *img, uint16_t num);
+#if ST7789_LINEBUF
+	void copyPixels(const uint16_t *img, uint32_t num);
+	void maskRect(int16_t x, int16_t y, int16_t w, int16_t h, const uint8_t *mask, uint16_t stride, int16_t mx, int16_t my, uint8_t bpp, uint16_t fg, uint16_t bg);
+#endif
 	void writeCmd(uint8_t c);
 	void writeData(uint8_t d8);
 	void writeData16(uint16_t d16);
 	void commonST7789Init(const uint8_t *cmdList);
+	void initPins();
+	void initGeometry(uint16_t wd, uint16_t ht);
+	enum { ST_INIT_DONE=0, ST_INIT_RESET, ST_INIT_SWRESET, ST_INIT_TABLE };
+	uint8_t initPhase=ST_INIT_DONE, initLeft=0;
+	const uint8_t *initPtr=NULL;
+	uint32_t initWaitFrom=0, initWaitUs=0;
+#if ST7789_STATS
+	void costBegin(uint8_t prim);
+	void costEnd();
+	ST7789Stats stats;
+	ST7789Cost run;          // running counters, sampled at costBegin/costEnd
+	ST7789Cost runAtBegin;
+	uint32_t usAtBegin=0;
+	uint8_t costDepth=0, costPrim=0, costTag=0;
+#endif
  private:
 	int8_t  csPin, dcPin, rstPin;
 	uint8_t  csMask, dcMask;
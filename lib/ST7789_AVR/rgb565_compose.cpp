@@ -0,0 +1,183 @@
+// RGB565 compositing (see rgb565_compose.h)
+
+#include "rgb565_compose.h"
+#include <Arduino.h>
+#include <string.h>
+
+// classic 5x7 font (0x20..0x7E), 5 columns per glyph, LSB at the top; other codes render blank
+static const uint8_t font5x7[95][5] PROGMEM = {
+	{0x00,0x00,0x00,0x00,0x00}, {0x00,0x00,0x5F,0x00,0x00}, {0x00,0x07,0x00,0x07,0x00}, {0x14,0x7F,0x14,0x7F,0x14},
+	{0x24,0x2A,0x7F,0x2A,0x12}, {0x23,0x13,0x08,0x64,0x62}, {0x36,0x49,0x56,0x20,0x50}, {0x00,0x08,0x07,0x03,0x00},
+	{0x00,0x1C,0x22,0x41,0x00}, {0x00,0x41,0x22,0x1C,0x00}, {0x2A,0x1C,0x7F,0x1C,0x2A}, {0x08,0x08,0x3E,0x08,0x08},
+	{0x00,0x80,0x70,0x30,0x00}, {0x08,0x08,0x08,0x08,0x08}, {0x00,0x00,0x60,0x60,0x00}, {0x20,0x10,0x08,0x04,0x02},
+	{0x3E,0x51,0x49,0x45,0x3E}, {0x00,0x42,0x7F,0x40,0x00}, {0x72,0x49,0x49,0x49,0x46}, {0x21,0x41,0x49,0x4D,0x33},
+	{0x18,0x14,0x12,0x7F,0x10}, {0x27,0x45,0x45,0x45,0x39}, {0x3C,0x4A,0x49,0x49,0x31}, {0x41,0x21,0x11,0x09,0x07},
+	{0x36,0x49,0x49,0x49,0x36}, {0x46,0x49,0x49,0x29,0x1E}, {0x00,0x00,0x14,0x00,0x00}, {0x00,0x40,0x34,0x00,0x00},
+	{0x00,0x08,0x14,0x22,0x41}, {0x14,0x14,0x14,0x14,0x14}, {0x00,0x41,0x22,0x14,0x08}, {0x02,0x01,0x59,0x09,0x06},
+	{0x3E,0x41,0x5D,0x59,0x4E}, {0x7C,0x12,0x11,0x12,0x7C}, {0x7F,0x49,0x49,0x49,0x36}, {0x3E,0x41,0x41,0x41,0x22},
+	{0x7F,0x41,0x41,0x41,0x3E}, {0x7F,0x49,0x49,0x49,0x41}, {0x7F,0x09,0x09,0x09,0x01}, {0x3E,0x41,0x41,0x51,0x73},
+	{0x7F,0x08,0x08,0x08,0x7F}, {0x00,0x41,0x7F,0x41,0x00}, {0x20,0x40,0x41,0x3F,0x01}, {0x7F,0x08,0x14,0x22,0x41},
+	{0x7F,0x40,0x40,0x40,0x40}, {0x7F,0x02,0x1C,0x02,0x7F}, {0x7F,0x04,0x08,0x10,0x7F}, {0x3E,0x41,0x41,0x41,0x3E},
+	{0x7F,0x09,0x09,0x09,0x06}, {0x3E,0x41,0x51,0x21,0x5E}, {0x7F,0x09,0x19,0x29,0x46}, {0x26,0x49,0x49,0x49,0x32},
+	{0x03,0x01,0x7F,0x01,0x03}, {0x3F,0x40,0x40,0x40,0x3F}, {0x1F,0x20,0x40,0x20,0x1F}, {0x3F,0x40,0x38,0x40,0x3F},
+	{0x63,0x14,0x08,0x14,0x63}, {0x03,0x04,0x78,0x04,0x03}, {0x61,0x59,0x49,0x4D,0x43}, {0x00,0x7F,0x41,0x41,0x41},
+	{0x02,0x04,0x08,0x10,0x20}, {0x00,0x41,0x41,0x41,0x7F}, {0x04,0x02,0x01,0x02,0x04}, {0x40,0x40,0x40,0x40,0x40},
+	{0x00,0x03,0x07,0x08,0x00}, {0x20,0x54,0x54,0x78,0x40}, {0x7F,0x28,0x44,0x44,0x38}, {0x38,0x44,0x44,0x44,0x28},
+	{0x38,0x44,0x44,0x28,0x7F}, {0x38,0x54,0x54,0x54,0x18}, {0x00,0x08,0x7E,0x09,0x02}, {0x18,0xA4,0xA4,0x9C,0x78},
+	{0x7F,0x08,0x04,0x04,0x78}, {0x00,0x44,0x7D,0x40,0x00}, {0x20,0x40,0x40,0x3D,0x00}, {0x7F,0x10,0x28,0x44,0x00},
+	{0x00,0x41,0x7F,0x40,0x00}, {0x7C,0x04,0x78,0x04,0x78}, {0x7C,0x08,0x04,0x04,0x78}, {0x38,0x44,0x44,0x44,0x38},
+	{0xFC,0x18,0x24,0x24,0x18}, {0x18,0x24,0x24,0x18,0xFC}, {0x7C,0x08,0x04,0x04,0x08}, {0x48,0x54,0x54,0x54,0x24},
+	{0x04,0x04,0x3F,0x44,0x24}, {0x3C,0x40,0x40,0x20,0x7C}, {0x1C,0x20,0x40,0x20,0x1C}, {0x3C,0x40,0x30,0x40,0x3C},
+	{0x44,0x28,0x10,0x28,0x44}, {0x4C,0x90,0x90,0x90,0x7C}, {0x44,0x64,0x54,0x4C,0x44}, {0x00,0x08,0x36,0x41,0x00},
+	{0x00,0x00,0x77,0x00,0x00}, {0x00,0x41,0x36,0x08,0x00}, {0x02,0x01,0x02,0x04,0x02},
+};
+
+static inline uint8_t mixChan(uint32_t f, uint32_t b, uint8_t a) {
+	uint32_t v=f*a+b*(255u-a)+128; return (uint8_t)((v+(v>>8))>>8);
+}
+
+// ---- solid background ----
+
+void rgb565LutInit(Rgb565Lut &l, uint16_t fg, uint16_t bg, uint8_t bpp) {
+	l.fg=fg; l.bg=bg; l.bpp=bpp;
+	uint16_t levels=bpp==4 ? 16 : 256;
+	for(uint16_t i=0;i<levels;i++) l.px[i]=rgb565Swap(rgb565Mix(fg,bg,(uint8_t)(bpp==4 ? i*17 : i)));
+}
+
+const Rgb565Lut &rgb565LutFor(uint16_t fg, uint16_t bg, uint8_t bpp) {
+	static Rgb565Lut cache[4];
+	static bool used[4];
+	static uint8_t next=0;
+	for(uint8_t i=0;i<4;i++) if(used[i] && cache[i].fg==fg && cache[i].bg==bg && cache[i].bpp==bpp) return cache[i];
+	uint8_t i=next; next=(next+1)&3;
+	rgb565LutInit(cache[i],fg,bg,bpp); used[i]=true;
+	return cache[i];
+}
+
+void rgb565MaskRowSolid(uint16_t *out, const uint8_t *maskRow, uint16_t x0, uint16_t n, const Rgb565Lut &l) {
+	if(l.bpp!=4) { maskRow+=x0; while(n--) *out++=l.px[*maskRow++]; return; }
+	if(n && (x0 & 1)) { *out++=l.px[maskRow[x0>>1] & 15]; x0++; n--; }
+	const uint8_t *m=maskRow+(x0>>1);
+	for(; n>=2; n-=2, m++) { *out++=l.px[*m>>4]; *out++=l.px[*m & 15]; }
+	if(n) *out=l.px[*m>>4];
+}
+
+// ---- translucent fill over any background ----
+
+void rgb565TintLutInit(Rgb565TintLut &t, uint16_t c, uint8_t alpha) {
+	for(uint8_t v=0;v<32;v++) { t.r[v]=mixChan(c>>11,v,alpha); t.b[v]=mixChan(c&31,v,alpha); }
+	for(uint8_t v=0;v<64;v++) t.g[v]=mixChan((c>>5)&63,v,alpha);
+}
+
+void rgb565TintRow(uint16_t *row, uint16_t n, const Rgb565TintLut &t) {
+	for(; n; n--, row++) { uint16_t p=*row; *row=(uint16_t)((t.r[p>>11]<<11)|(t.g[(p>>5)&63]<<5)|t.b[p&31]); }
+}
+
+// ---- 4-bit coverage over any background ----
+
+void rgb565MaskLutInit(Rgb565MaskLut &m, uint16_t fg) {
+	m.fg=fg;
+	for(uint8_t l=0;l<16;l++) {
+		uint8_t a=l*17;
+		for(uint8_t v=0;v<32;v++) { m.r[l][v]=mixChan(fg>>11,v,a); m.b[l][v]=mixChan(fg&31,v,a); }
+		for(uint8_t v=0;v<64;v++) m.g[l][v]=mixChan((fg>>5)&63,v,a);
+	}
+}
+
+const Rgb565MaskLut &rgb565MaskLutFor(uint16_t fg) {
+	static Rgb565MaskLut cache[3];
+	static bool used[3];
+	static uint8_t next=0;
+	for(uint8_t i=0;i<3;i++) if(used[i] && cache[i].fg==fg) return cache[i];
+	uint8_t i=next; next=next==2 ? 0 : next+1;
+	rgb565MaskLutInit(cache[i],fg); used[i]=true;
+	return cache[i];
+}
+
+void rgb565MaskRowOver(uint16_t *row, const uint8_t *maskRow, uint16_t x0, uint16_t n, const Rgb565MaskLut &m) {
+	for(uint16_t i=0;i<n;i++, row++) {
+		uint8_t l=rgb565MaskAt(maskRow,4,x0+i);
+		if(!l) continue;
+		if(l==15) { *row=m.fg; continue; }
+		uint16_t p=*row;
+		*row=(uint16_t)((m.r[l][p>>11]<<11)|(m.g[l][(p>>5)&63]<<5)|m.b[l][p&31]);
+	}
+}
+
+// ---- anti-aliased glyph masks ----
+
+static inline bool fontBit(const uint8_t *g, int8_t col, int8_t row) {
+	if(col<0 || col>4 || row<0 || row>7) return false;
+	return (pgm_read_byte(&g[col])>>row) & 1;
+}
+
+// font dots are squares; a set dot loses an outer corner triangle when both neighbours and the diagonal are
+// clear, a clear dot gains an inner triangle where two set neighbours meet across a clear diagonal
+static bool glyphCovered(const uint8_t *g, int8_t i, int8_t j, float a, float b) {
+	bool L=fontBit(g,i-1,j), R=fontBit(g,i+1,j), T=fontBit(g,i,j-1), B=fontBit(g,i,j+1);
+	bool TL=fontBit(g,i-1,j-1), TR=fontBit(g,i+1,j-1), BL=fontBit(g,i-1,j+1), BR=fontBit(g,i+1,j+1);
+	if(fontBit(g,i,j))
+		return !((!L && !T && !TL && a+b<0.5f) || (!R && !T && !TR && (1-a)+b<0.5f) ||
+			(!L && !B && !BL && a+(1-b)<0.5f) || (!R && !B && !BR && (1-a)+(1-b)<0.5f));
+	return (L && T && !TL && a+b<0.5f) || (R && T && !TR && (1-a)+b<0.5f) ||
+		(L && B && !BL && a+(1-b)<0.5f) || (R && B && !BR && (1-a)+(1-b)<0.5f);
+}
+
+static void glyphRender(uint8_t *out, unsigned char c, uint8_t size) {
+	const uint8_t *g=font5x7[(c>=0x20 && c<=0x7E) ? c-0x20 : 0];
+	uint16_t w=6*size, h=8*size, stride=rgb565MaskStride(w,4), ss=4*size;
+	memset(out,0,stride*h);
+	for(uint16_t py=0;py<h;py++) for(uint16_t px=0;px<w;px++) {
+		uint8_t cnt=0;
+		for(uint8_t sy=0;sy<4;sy++) for(uint8_t sx=0;sx<4;sx++) {
+			uint16_t u=px*4+sx, v=py*4+sy;
+			cnt+=glyphCovered(g,u/ss,v/ss,((u%ss)+0.5f)/ss,((v%ss)+0.5f)/ss);
+		}
+		uint8_t l=(uint8_t)((cnt*15+8)/16);
+		out[py*stride+(px>>1)]|=(px & 1) ? l : (uint8_t)(l<<4);
+	}
+}
+
+#define RGB565_GLYPH_BYTES (((6*RGB565_GLYPH_MAX_SIZE+1)/2)*8*RGB565_GLYPH_MAX_SIZE)
+
+struct GlyphSlot {
+	unsigned char c;
+	uint8_t size;      // 0 = empty
+	uint32_t used;
+	uint8_t mask[RGB565_GLYPH_BYTES];
+};
+
+const uint8_t *rgb565GlyphMask(unsigned char c, uint8_t size) {
+	static GlyphSlot slots[RGB565_GLYPH_CACHE];
+	static uint32_t clock=0;
+	if(size<1) size=1;
+	if(size>RGB565_GLYPH_MAX_SIZE) size=RGB565_GLYPH_MAX_SIZE;
+	GlyphSlot *victim=&slots[0];
+	for(uint8_t i=0;i<RGB565_GLYPH_CACHE;i++) {
+		GlyphSlot &s=slots[i];
+		if(s.size==size && s.c==c) { s.used=++clock; return s.mask; }
+		if(s.used<victim->used) victim=&s;
+	}
+	glyphRender(victim->mask,c,size);
+	victim->c=c; victim->size=size; victim->used=++clock;
+	return victim->mask;
+}
+
+void rgb565TextRow(uint16_t *row, int16_t rowX, uint16_t n, int16_t textX, int16_t ty, const char *s, uint8_t size,
+	uint16_t color, bool aa) {
+	if(aa && size>RGB565_GLYPH_MAX_SIZE) aa=false;
+	int16_t cw=6*size;
+	if(ty<0 || ty>=8*size) return;
+	for(int16_t cx=textX; *s; s++, cx+=cw) {
+		int16_t x0=cx>rowX ? cx : rowX, x1=cx+cw<rowX+(int16_t)n ? cx+cw : rowX+(int16_t)n;
+		if(x0>=x1) continue;
+		if(aa) {
+			const uint8_t *m=rgb565GlyphMask((unsigned char)*s,size)+ty*rgb565MaskStride(cw,4);
+			rgb565MaskRowOver(row+(x0-rowX),m,x0-cx,x1-x0,rgb565MaskLutFor(color));
+		} else {
+			unsigned char c=(unsigned char)*s;
+			const uint8_t *g=font5x7[(c>=0x20 && c<=0x7E) ? c-0x20 : 0];
+			for(int16_t x=x0;x<x1;x++) if(fontBit(g,(x-cx)/size,ty/size)) row[x-rowX]=color;
+		}
+	}
+}
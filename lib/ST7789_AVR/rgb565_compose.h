@@ -0,0 +1,61 @@
+// RGB565 compositing for the line-buffer path: alpha masks (4-bit or 8-bit coverage) blended onto a solid
+// background or onto rows already in a line buffer, through per-colour lookup tables instead of per-pixel
+// multiplies. Anti-aliased masks of the classic 5x7 font come from the same module.
+// Mask rows: bpp 8 = one byte per pixel; bpp 4 = two pixels per byte, high nibble first, rows padded to a byte.
+// 4-bit level L is alpha L*17.
+
+#ifndef _RGB565_COMPOSE_H_
+#define _RGB565_COMPOSE_H_
+
+#include <stdint.h>
+#include "rgb565_simd.h"
+
+// solid background: coverage level -> final pixel, already in panel (big-endian) order
+struct Rgb565Lut {
+	uint16_t fg, bg;
+	uint8_t bpp;
+	uint16_t px[256];
+};
+
+// fixed colour at a fixed alpha over any background, one table per channel (translucent fills)
+struct Rgb565TintLut {
+	uint8_t r[32], g[64], b[32];
+};
+
+// fixed colour through 4-bit coverage over any background: per level, per channel (anti-aliased text on rows)
+struct Rgb565MaskLut {
+	uint16_t fg;
+	uint8_t r[16][32], g[16][64], b[16][32];
+};
+
+static inline uint16_t rgb565MaskStride(uint16_t w, uint8_t bpp) { return bpp==4 ? (w+1)>>1 : w; }
+static inline uint8_t rgb565MaskAt(const uint8_t *row, uint8_t bpp, uint16_t x) {
+	return bpp==4 ? (uint8_t)((row[x>>1]>>((~x & 1)<<2)) & 15) : row[x];
+}
+
+void rgb565LutInit(Rgb565Lut &l, uint16_t fg, uint16_t bg, uint8_t bpp);
+// small cache of solid LUTs (text is drawn in a handful of colour pairs)
+const Rgb565Lut &rgb565LutFor(uint16_t fg, uint16_t bg, uint8_t bpp);
+// n mask pixels starting at pixel x0 of maskRow -> panel-order pixels
+void rgb565MaskRowSolid(uint16_t *out, const uint8_t *maskRow, uint16_t x0, uint16_t n, const Rgb565Lut &l);
+
+void rgb565TintLutInit(Rgb565TintLut &t, uint16_t c, uint8_t alpha);
+void rgb565TintRow(uint16_t *row, uint16_t n, const Rgb565TintLut &t);
+
+void rgb565MaskLutInit(Rgb565MaskLut &m, uint16_t fg);
+const Rgb565MaskLut &rgb565MaskLutFor(uint16_t fg);
+// 4-bit mask over native-order row pixels (8-bit masks: rgb565Blend)
+void rgb565MaskRowOver(uint16_t *row, const uint8_t *maskRow, uint16_t x0, uint16_t n, const Rgb565MaskLut &m);
+
+// anti-aliased 4-bit mask of a classic-font cell, (6*size) x (8*size), supersampled 4x4 with rounded diagonals;
+// cached, valid until the cache entry is reused (RGB565_GLYPH_CACHE entries, sizes up to RGB565_GLYPH_MAX_SIZE)
+#define RGB565_GLYPH_CACHE    16
+#define RGB565_GLYPH_MAX_SIZE 4
+const uint8_t *rgb565GlyphMask(unsigned char c, uint8_t size);
+
+// draw text into one row of a native-order line buffer: the row covers screen x [rowX, rowX+n), the text starts
+// at textX and ty is the row's offset from the top of the text (0..8*size-1). aa: anti-aliased masks, else crisp
+void rgb565TextRow(uint16_t *row, int16_t rowX, uint16_t n, int16_t textX, int16_t ty, const char *s, uint8_t size,
+	uint16_t color, bool aa);
+
+#endif
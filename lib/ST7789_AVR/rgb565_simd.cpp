@@ -0,0 +1,311 @@
+// RGB565 line-buffer kernels (see rgb565_simd.h)
+
+#include "rgb565_simd.h"
+#include <string.h>
+#if RGB565_SSE2
+#include <emmintrin.h>
+#endif
+#if RGB565_PIE
+#include <soc/soc.h>
+#endif
+
+// ---- scalar reference ----
+
+static void fillRef(uint16_t *d, uint16_t v, uint32_t n) { while(n--) *d++=v; }
+static void swapRef(uint16_t *d, const uint16_t *s, uint32_t n) { while(n--) *d++=rgb565Swap(*s++); }
+static void blendRef(uint16_t *d, uint16_t fg, const uint8_t *a, uint32_t n) {
+	for(; n; n--, d++, a++) { if(*a==255) *d=fg; else if(*a) *d=rgb565Mix(fg,*d,*a); }
+}
+
+// ---- 32-bit SWAR: two pixels per word (memcpy keeps it alias- and alignment-safe) ----
+
+static void fillSwar(uint16_t *d, uint16_t v, uint32_t n) {
+	if(n && ((uintptr_t)d & 2)) { *d++=v; n--; }
+	uint32_t w=v|((uint32_t)v<<16);
+	for(; n>=2; n-=2, d+=2) memcpy(d,&w,4);
+	if(n) *d=v;
+}
+
+static void swapSwar(uint16_t *d, const uint16_t *s, uint32_t n) {
+	if(n && ((uintptr_t)d & 2)) { *d++=rgb565Swap(*s++); n--; }
+	for(; n>=2; n-=2, d+=2, s+=2) {
+		uint32_t x; memcpy(&x,s,4);
+		x=((x & 0x00FF00FFu)<<8) | ((x>>8) & 0x00FF00FFu);
+		memcpy(d,&x,4);
+	}
+	if(n) *d=rgb565Swap(*s);
+}
+
+// ---- SSE2 (x86 hosts): eight pixels per step ----
+
+#if RGB565_SSE2
+static void fillSse(uint16_t *d, uint16_t v, uint32_t n) {
+	__m128i x=_mm_set1_epi16((short)v);
+	for(; n>=8; n-=8, d+=8) _mm_storeu_si128((__m128i*)d,x);
+	fillRef(d,v,n);
+}
+
+static void swapSse(uint16_t *d, const uint16_t *s, uint32_t n) {
+	for(; n>=8; n-=8, d+=8, s+=8) {
+		__m128i x=_mm_loadu_si128((const __m128i*)s);
+		_mm_storeu_si128((__m128i*)d,_mm_or_si128(_mm_slli_epi16(x,8),_mm_srli_epi16(x,8)));
+	}
+	swapRef(d,s,n);
+}
+
+// all intermediate values stay below 0x4000, so 16-bit lanes are exact
+static inline __m128i mixChannelSse(__m128i f, __m128i b, __m128i a, __m128i ia) {
+	__m128i v=_mm_add_epi16(_mm_add_epi16(_mm_mullo_epi16(f,a),_mm_mullo_epi16(b,ia)),_mm_set1_epi16(128));
+	return _mm_srli_epi16(_mm_add_epi16(v,_mm_srli_epi16(v,8)),8);
+}
+
+static void blendSse(uint16_t *d, uint16_t fg, const uint8_t *a, uint32_t n) {
+	const __m128i fr=_mm_set1_epi16(fg>>11), fgc=_mm_set1_epi16((fg>>5)&63), fb=_mm_set1_epi16(fg&31);
+	const __m128i m6=_mm_set1_epi16(63), m5=_mm_set1_epi16(31), k255=_mm_set1_epi16(255), zero=_mm_setzero_si128();
+	for(; n>=8; n-=8, d+=8, a+=8) {
+		__m128i al=_mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i*)a),zero), ia=_mm_sub_epi16(k255,al);
+		__m128i p=_mm_loadu_si128((const __m128i*)d);
+		__m128i r=mixChannelSse(fr,_mm_srli_epi16(p,11),al,ia);
+		__m128i g=mixChannelSse(fgc,_mm_and_si128(_mm_srli_epi16(p,5),m6),al,ia);
+		__m128i b=mixChannelSse(fb,_mm_and_si128(p,m5),al,ia);
+		_mm_storeu_si128((__m128i*)d,_mm_or_si128(_mm_or_si128(_mm_slli_epi16(r,11),_mm_slli_epi16(g,5)),b));
+	}
+	blendRef(d,fg,a,n);
+}
+#endif
+
+// ---- ESP32-S3 PIE: 128-bit q registers, aligned loads/stores only ----
+// ee.vmul.u16 shifts the products right by SAR, so with a multiplier of 1 it doubles as a lane-exact
+// right shift; the blend follows the scalar formula step by step in 16-bit lanes
+
+#if RGB565_PIE
+static inline bool pieAligned(const void *p) { return !((uintptr_t)p & 15); }
+// vector loads go through the data bus: keep them to internal SRAM (images in flash use SWAR)
+static inline bool pieInternal(const void *p) { return (uintptr_t)p>=SOC_DRAM_LOW && (uintptr_t)p<SOC_DRAM_HIGH; }
+
+static void fillPie(uint16_t *d, uint16_t v, uint32_t n) {
+	while(n && !pieAligned(d)) { *d++=v; n--; }
+	uint32_t blocks=n>>3;
+	if(blocks) {
+		asm volatile(
+			"ee.vldbc.16 q0, %[v]\n"
+			"1:\n"
+			"ee.vst.128.ip q0, %[d], 16\n"
+			"addi %[n], %[n], -1\n"
+			"bnez %[n], 1b\n"
+			: [d]"+r"(d), [n]"+r"(blocks) : [v]"r"(&v) : "memory");
+	}
+	fillRef(d,v,n & 7);
+}
+
+static void swapPie(uint16_t *d, const uint16_t *s, uint32_t n) {
+	while(n && !pieAligned(d)) { *d++=rgb565Swap(*s++); n--; }
+	if(!pieAligned(s) || !pieInternal(s)) { swapSwar(d,s,n); return; }
+	uint32_t blocks=n>>4;
+	if(blocks) {
+		// unzip 32 bytes into low/high bytes, zip back high-first
+		asm volatile(
+			"1:\n"
+			"ee.vld.128.ip q0, %[s], 16\n"
+			"ee.vld.128.ip q1, %[s], 16\n"
+			"ee.vunzip.8 q0, q1\n"
+			"ee.vzip.8 q1, q0\n"
+			"ee.vst.128.ip q1, %[d], 16\n"
+			"ee.vst.128.ip q0, %[d], 16\n"
+			"addi %[n], %[n], -1\n"
+			"bnez %[n], 1b\n"
+			: [d]"+r"(d), [s]"+r"(s), [n]"+r"(blocks) : : "memory");
+	}
+	swapSwar(d,s,n & 15);
+}
+
+// one block of 8 pixels; k = { 1, 255, fr,128,2048, 63,fg,128,32, 31,fb,128 } consumed in order
+static inline void blendPie8(uint16_t *d, const uint16_t *a16, const uint16_t *k) {
+	asm volatile(
+		"ee.vld.128.ip q0, %[d], 0\n"
+		"ee.vld.128.ip q1, %[a], 0\n"
+		"ee.vldbc.16.ip q7, %[k], 2\n"
+		"ee.vldbc.16.ip q6, %[k], 2\n"
+		"ee.vsubs.s16 q2, q6, q1\n"
+		// red
+		"ssai 11\n"
+		"ee.vmul.u16 q3, q0, q7\n"
+		"ssai 0\n"
+		"ee.vmul.u16 q3, q3, q2\n"
+		"ee.vldbc.16.ip q6, %[k], 2\n"
+		"ee.vmul.u16 q4, q6, q1\n"
+		"ee.vadds.s16 q3, q3, q4\n"
+		"ee.vldbc.16.ip q6, %[k], 2\n"
+		"ee.vadds.s16 q3, q3, q6\n"
+		"ssai 8\n"
+		"ee.vmul.u16 q4, q3, q7\n"
+		"ee.vadds.s16 q3, q3, q4\n"
+		"ee.vmul.u16 q3, q3, q7\n"
+		"ssai 0\n"
+		"ee.vldbc.16.ip q6, %[k], 2\n"
+		"ee.vmul.u16 q5, q3, q6\n"
+		// green
+		"ssai 5\n"
+		"ee.vmul.u16 q3, q0, q7\n"
+		"ee.vldbc.16.ip q6, %[k], 2\n"
+		"ee.andq q3, q3, q6\n"
+		"ssai 0\n"
+		"ee.vmul.u16 q3, q3, q2\n"
+		"ee.vldbc.16.ip q6, %[k], 2\n"
+		"ee.vmul.u16 q4, q6, q1\n"
+		"ee.vadds.s16 q3, q3, q4\n"
+		"ee.vldbc.16.ip q6, %[k], 2\n"
+		"ee.vadds.s16 q3, q3, q6\n"
+		"ssai 8\n"
+		"ee.vmul.u16 q4, q3, q7\n"
+		"ee.vadds.s16 q3, q3, q4\n"
+		"ee.vmul.u16 q3, q3, q7\n"
+		"ssai 0\n"
+		"ee.vldbc.16.ip q6, %[k], 2\n"
+		"ee.vmul.u16 q3, q3, q6\n"
+		"ee.orq q5, q5, q3\n"
+		// blue
+		"ee.vldbc.16.ip q6, %[k], 2\n"
+		"ee.andq q3, q0, q6\n"
+		"ee.vmul.u16 q3, q3, q2\n"
+		"ee.vldbc.16.ip q6, %[k], 2\n"
+		"ee.vmul.u16 q4, q6, q1\n"
+		"ee.vadds.s16 q3, q3, q4\n"
+		"ee.vldbc.16.ip q6, %[k], 2\n"
+		"ee.vadds.s16 q3, q3, q6\n"
+		"ssai 8\n"
+		"ee.vmul.u16 q4, q3, q7\n"
+		"ee.vadds.s16 q3, q3, q4\n"
+		"ee.vmul.u16 q3, q3, q7\n"
+		"ee.orq q5, q5, q3\n"
+		"ee.vst.128.ip q5, %[d], 0\n"
+		: [k]"+r"(k) : [d]"r"(d), [a]"r"(a16) : "memory");
+}
+
+static void blendPie(uint16_t *d, uint16_t fg, const uint8_t *a, uint32_t n) {
+	while(n && !pieAligned(d)) { blendRef(d,fg,a,1); d++; a++; n--; }
+	const uint16_t k[12] __attribute__((aligned(16)))={ 1, 255, (uint16_t)(fg>>11), 128, 2048,
+		63, (uint16_t)((fg>>5)&63), 128, 32, 31, (uint16_t)(fg&31), 128 };
+	uint16_t a16[8] __attribute__((aligned(16)));
+	for(; n>=8; n-=8, d+=8, a+=8) {
+		for(uint8_t i=0;i<8;i++) a16[i]=a[i];
+		blendPie8(d,a16,k);
+	}
+	blendRef(d,fg,a,n);
+}
+#endif
+
+// ---- dispatch ----
+
+static bool implOff[RGB565_IMPL_COUNT];
+
+static uint8_t bestImpl() {
+	if(RGB565_PIE && !implOff[RGB565_PIE_IMPL]) return RGB565_PIE_IMPL;
+	if(RGB565_SSE2 && !implOff[RGB565_SSE2_IMPL]) return RGB565_SSE2_IMPL;
+	return RGB565_SWAR;
+}
+
+static uint8_t impl=bestImpl();
+
+bool rgb565ImplAvailable(uint8_t i) {
+	if(i>=RGB565_IMPL_COUNT || implOff[i]) return false;
+	if(i==RGB565_SSE2_IMPL) return RGB565_SSE2;
+	if(i==RGB565_PIE_IMPL) return RGB565_PIE;
+	return true;
+}
+
+bool rgb565SetImpl(uint8_t i) { if(!rgb565ImplAvailable(i)) return false; impl=i; return true; }
+uint8_t rgb565GetImpl() { return impl; }
+
+const char *rgb565ImplName(uint8_t i) {
+	static const char *const names[RGB565_IMPL_COUNT]={ "scalar", "swar", "sse2", "pie" };
+	return i<RGB565_IMPL_COUNT ? names[i] : "?";
+}
+
+void rgb565Fill(uint16_t *dst, uint16_t v, uint32_t n) {
+	switch(impl) {
+#if RGB565_PIE
+		case RGB565_PIE_IMPL: fillPie(dst,v,n); return;
+#endif
+#if RGB565_SSE2
+		case RGB565_SSE2_IMPL: fillSse(dst,v,n); return;
+#endif
+		case RGB565_SWAR: fillSwar(dst,v,n); return;
+		default: fillRef(dst,v,n); return;
+	}
+}
+
+void rgb565SwapCopy(uint16_t *dst, const uint16_t *src, uint32_t n) {
+	switch(impl) {
+#if RGB565_PIE
+		case RGB565_PIE_IMPL: swapPie(dst,src,n); return;
+#endif
+#if RGB565_SSE2
+		case RGB565_SSE2_IMPL: swapSse(dst,src,n); return;
+#endif
+		case RGB565_SWAR: swapSwar(dst,src,n); return;
+		default: swapRef(dst,src,n); return;
+	}
+}
+
+void rgb565Blend(uint16_t *dst, uint16_t fg, const uint8_t *alpha, uint32_t n) {
+	switch(impl) {
+#if RGB565_PIE
+		case RGB565_PIE_IMPL: blendPie(dst,fg,alpha,n); return;
+#endif
+#if RGB565_SSE2
+		case RGB565_SSE2_IMPL: blendSse(dst,fg,alpha,n); return;
+#endif
+		default: blendRef(dst,fg,alpha,n); return;   // no exact SWAR form for the /255 blend
+	}
+}
+
+// ---- self check ----
+
+#define RGB565_CHECK_PX 96
+static uint16_t chkSrc[RGB565_CHECK_PX] __attribute__((aligned(16)));
+static uint16_t chkRef[RGB565_CHECK_PX] __attribute__((aligned(16)));
+static uint16_t chkOut[RGB565_CHECK_PX] __attribute__((aligned(16)));
+static uint8_t chkAlpha[RGB565_CHECK_PX];
+
+static bool checkImpl(uint8_t i) {
+	static const uint8_t lens[]={ 0, 1, 2, 3, 7, 8, 9, 15, 16, 17, 31, 33, 64, 71 };
+	uint32_t rng=0x9E3779B9u;
+	for(uint8_t k=0;k<RGB565_CHECK_PX;k++) {
+		rng^=rng<<13; rng^=rng>>17; rng^=rng<<5;
+		chkSrc[k]=(uint16_t)rng; chkAlpha[k]=(uint8_t)(rng>>16);
+	}
+	chkAlpha[0]=0; chkAlpha[1]=255; chkAlpha[9]=1; chkAlpha[10]=254;
+	const uint16_t fgs[]={ 0xFFFF, 0x0000, 0xF81F, 0x7BEF };
+	for(uint8_t li=0; li<sizeof(lens); li++) {
+		uint32_t n=lens[li];
+		for(uint8_t od=0; od<8; od++) {
+			uint8_t os=(od*3)&7;   // source offset differs from destination offset for some cases
+			uint16_t v=chkSrc[n];
+			memset(chkRef,0xA5,sizeof(chkRef)); memset(chkOut,0xA5,sizeof(chkOut));
+			fillRef(chkRef+od,v,n);
+			impl=i; rgb565Fill(chkOut+od,v,n);
+			if(memcmp(chkRef,chkOut,sizeof(chkRef))) return false;
+			swapRef(chkRef+od,chkSrc+os,n);
+			rgb565SwapCopy(chkOut+od,chkSrc+os,n);
+			if(memcmp(chkRef,chkOut,sizeof(chkRef))) return false;
+			uint16_t fg=fgs[(li+od)&3];
+			memcpy(chkRef,chkSrc,sizeof(chkRef)); memcpy(chkOut,chkSrc,sizeof(chkOut));
+			blendRef(chkRef+od,fg,chkAlpha+os,n);
+			rgb565Blend(chkOut+od,fg,chkAlpha+os,n);
+			if(memcmp(chkRef,chkOut,sizeof(chkRef))) return false;
+		}
+	}
+	return true;
+}
+
+bool rgb565Check() {
+	uint8_t keep=impl;
+	bool ok=true;
+	for(uint8_t i=RGB565_SWAR; i<RGB565_IMPL_COUNT; i++) {
+		if(!rgb565ImplAvailable(i)) continue;
+		if(!checkImpl(i)) { implOff[i]=true; ok=false; }
+	}
+	impl=rgb565ImplAvailable(keep) ? keep : bestImpl();
+	return ok;
+}
@@ -0,0 +1,54 @@
+// RGB565 line-buffer kernels: pattern fill, byte-swap copy (native -> panel big-endian order)
+// and alpha blend of a solid colour through an 8-bit coverage mask.
+// Paths: scalar reference, 32-bit SWAR (any target), SSE2 (x86 hosts), PIE 128-bit EE.* (ESP32-S3).
+// Every path is bit-exact with the scalar reference; rgb565Check() verifies that at runtime and
+// drops a disagreeing vector path back to SWAR.
+
+#ifndef _RGB565_SIMD_H_
+#define _RGB565_SIMD_H_
+
+#include <stdint.h>
+
+// define RGB565_PIE 0 to build the ESP32-S3 without the PIE kernels
+#if defined(CONFIG_IDF_TARGET_ESP32S3) && !defined(RGB565_PIE)
+#define RGB565_PIE 1
+#endif
+#ifndef RGB565_PIE
+#define RGB565_PIE 0
+#endif
+#if defined(__SSE2__) && !defined(RGB565_SSE2)
+#define RGB565_SSE2 1
+#endif
+#ifndef RGB565_SSE2
+#define RGB565_SSE2 0
+#endif
+
+enum Rgb565Impl { RGB565_SCALAR=0, RGB565_SWAR, RGB565_SSE2_IMPL, RGB565_PIE_IMPL, RGB565_IMPL_COUNT };
+
+static inline uint16_t rgb565Swap(uint16_t c) { return (uint16_t)((c<<8)|(c>>8)); }
+
+// blend per channel: round((fg*a + bg*(255-a)) / 255), a=255 gives fg, a=0 leaves bg
+static inline uint16_t rgb565Mix(uint16_t fg, uint16_t bg, uint8_t a) {
+	uint32_t ia=255-a;
+	uint32_t r=(fg>>11)*a+(bg>>11)*ia+128, g=((fg>>5)&63)*a+((bg>>5)&63)*ia+128, b=(fg&31)*a+(bg&31)*ia+128;
+	r=(r+(r>>8))>>8; g=(g+(g>>8))>>8; b=(b+(b>>8))>>8;
+	return (uint16_t)((r<<11)|(g<<5)|b);
+}
+
+// dst[i]=v (store v already swapped for a panel-order buffer)
+void rgb565Fill(uint16_t *dst, uint16_t v, uint32_t n);
+// dst[i]=rgb565Swap(src[i]); dst and src must not overlap
+void rgb565SwapCopy(uint16_t *dst, const uint16_t *src, uint32_t n);
+// dst[i]=rgb565Mix(fg,dst[i],alpha[i]) on native-order pixels
+void rgb565Blend(uint16_t *dst, uint16_t fg, const uint8_t *alpha, uint32_t n);
+
+// select a path explicitly (benchmarks, checks); returns false if it is not built in or was disabled
+bool rgb565SetImpl(uint8_t impl);
+uint8_t rgb565GetImpl();
+bool rgb565ImplAvailable(uint8_t impl);
+const char *rgb565ImplName(uint8_t impl);
+// compare every available path with the scalar reference (odd lengths, all alignments);
+// a failing vector path is disabled and the best remaining one selected. Returns true if all agreed
+bool rgb565Check();
+
+#endif
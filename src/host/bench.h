@@ -0,0 +1,38 @@
+// 主机端基准测试公共工具（仅 native 环境编译）
+#ifndef HOST_BENCH_H
+#define HOST_BENCH_H
+
+#include <stdint.h>
+#include <stdio.h>
+#include <chrono>
+
+static inline uint64_t benchNowNs() {
+  return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+      std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// 防止编译器把被测结果优化掉
+template <typename T>
+static inline void benchKeep(const T &v) { asm volatile("" : : "g"(&v) : "memory"); }
+
+static inline void benchReport(const char *name, uint64_t ops, uint64_t ns) {
+  printf("%-32s %12llu ops %10.1f ns/op %12.0f ops/s\n", name, (unsigned long long)ops,
+         ops ? (double)ns / ops : 0.0, ns ? ops * 1e9 / ns : 0.0);
+}
+
+void benchHistory();
+void benchCodec();
+void benchFlashLog();
+void benchLog();
+void benchTlm();
+void benchSched();
+void benchPipeline();
+void benchRolling();
+void benchSeqlock();
+void benchPower();
+void benchLatHist();
+void benchClock();
+void benchHttp();
+void benchMqtt();
+
+#endif // HOST_BENCH_H
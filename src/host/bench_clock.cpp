@@ -0,0 +1,102 @@
+// 墙上时钟：公历换算往返校验、跨 millis() 回绕的逐秒推进与跨日事件、略早时刻的 tick，以及与旧版每秒 sscanf/snprintf 格式化的开销对比
+#include <stdio.h>
+#include <string.h>
+#include "bench.h"
+#include "wall_clock.h"
+
+static bool isLeap(int y) { return (y % 4 == 0 && y % 100 != 0) || y % 400 == 0; }
+
+// 旧版 formatDate()：每秒解析 __DATE__ 并格式化，再与上一次的字符串比较
+static bool legacyDateChanged(char *prev) {
+  const char *dateStr = __DATE__;
+  char monStr[4];
+  int day, year;
+  sscanf(dateStr, "%3s %d %d", monStr, &day, &year);
+  const char *months = "JanFebMarAprMayJunJulAugSepOctNovDec";
+  int monthNum = (int)(strstr(months, monStr) - months) / 3 + 1;
+  char buf[32];
+  snprintf(buf, sizeof(buf), "%04d-%02d-%02d", year, monthNum, day);
+  bool changed = strcmp(buf, prev) != 0;
+  if (changed) strcpy(prev, buf);
+  return changed;
+}
+
+void benchClock() {
+  printf("== clock ==\n");
+
+  // 1900..2199 每一天：天数连续，往返换算一致
+  static const uint8_t mdays[12] = { 31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31 };
+  bool civilOk = true;
+  int32_t expect = wallDaysFromCivil(1900, 1, 1);
+  uint32_t days = 0;
+  for (int y = 1900; y < 2200; y++)
+    for (uint32_t m = 1; m <= 12; m++)
+      for (uint32_t d = 1; d <= (uint32_t)(mdays[m - 1] + (m == 2 && isLeap(y))); d++) {
+        int32_t z = wallDaysFromCivil(y, m, d);
+        CivilDate c = wallCivilFromDays(z);
+        civilOk = civilOk && z == expect && c.year == y && c.month == m && c.day == d;
+        expect++;
+        days++;
+      }
+  char s[11];
+  int32_t parsed = 0;
+  wallFormatDate(s, wallDaysFromCivil(2024, 2, 29));
+  civilOk = civilOk && !strcmp(s, "2024-02-29") && wallParseDate(s, parsed) && parsed == wallDaysFromCivil(2024, 2, 29);
+  char build[11];
+  wallFormatDate(build, (int32_t)(WALL_BUILD_EPOCH / WALL_SECS_PER_DAY));
+  printf("civil round trip %u days 1900..2199 -> %s, build date %s\n", days, civilOk ? "OK" : "MISMATCH", build);
+
+  // 3 天逐秒推进（调度抖动 ±3 ms，合计为 0），中途 millis() 回绕；每天恰好一次跨日事件、秒数不丢
+  WallClockRetained keep;
+  memset(&keep, 0, sizeof(keep));
+  WallClock clk;
+  uint32_t start = wallDaysFromCivil(2025, 12, 31) * WALL_SECS_PER_DAY + 86400 - 3600;   // 跨年前 1 小时
+  uint32_t ms = 0xFFFFFFFFu - 5000;
+  clk.begin(&keep, ms, start);
+  uint32_t events = 0;
+  const uint32_t ticks = 3 * 86400;
+  uint64_t t0 = benchNowNs();
+  for (uint32_t i = 1; i <= ticks; i++) {
+    ms += i % 2 ? 1003 : 997;
+    if (clk.tick(ms)) events++;
+  }
+  uint64_t dt = benchNowNs() - t0;
+  benchReport("tick", ticks, dt);
+  wallFormatDate(s, clk.day());
+  bool tickOk = events == 3 && clk.epoch() == start + ticks && !strcmp(s, "2026-01-03");
+  // 热复位：从保留状态接续
+  WallClock warm;
+  warm.begin(&keep, 0, start);
+  tickOk = tickOk && warm.epoch() == clk.epoch() && warm.source() == WALL_SRC_RETAINED;
+  printf("tick 3 days across millis wrap: rollovers=%u now %s, warm resume %s -> %s\n", events, s,
+         WallClock::sourceName(warm.source()), tickOk ? "OK" : "MISMATCH");
+
+  // 同一轮调度里 "time" 命令先 set 了较晚的 millis()，随后 tick 拿到的是本轮开始时略早的 now
+  WallClock host;
+  host.begin(nullptr, 0, start);
+  host.set(start, 1000);
+  bool early = host.tick(999);
+  uint32_t afterEarly = host.epoch();
+  host.tick(2000);
+  bool lateOk = !early && afterEarly == start && host.epoch() == start + 1 && host.rollovers() == 0;
+  printf("tick 1 ms before set: epoch %+ld s, then %+ld s, rollovers=%u -> %s\n", (long)(afterEarly - start),
+         (long)(host.epoch() - start), host.rollovers(), lateOk ? "OK" : "MISMATCH");
+
+  // 每秒日期检查：旧版字符串解析+比较 vs 整数天数比较
+  char prev[32] = "";
+  const uint32_t n = 200000;
+  t0 = benchNowNs();
+  uint32_t changed = 0;
+  for (uint32_t i = 0; i < n; i++) changed += legacyDateChanged(prev);
+  benchReport("legacy formatDate+strcmp", n, benchNowNs() - t0);
+  benchKeep(changed);
+  int32_t shown = INT32_MIN;
+  t0 = benchNowNs();
+  for (uint32_t i = 0; i < n; i++) {
+    int32_t d = clk.day();
+    benchKeep(d);
+    if (d != shown) { shown = d; changed++; }
+  }
+  benchReport("day compare", n, benchNowNs() - t0);
+  benchKeep(changed);
+}
@@ -0,0 +1,58 @@
+// 遥测编码：压缩率与编码/解码吞吐
+#include <stdlib.h>
+#include <vector>
+#include "bench.h"
+#include "telemetry_codec.h"
+
+// 生成缓慢变化的 1 Hz 序列（CO2 随机游走，温湿度 DHT22 精度 0.1）
+static void makeSeries(std::vector<TelemetrySample> &v, size_t n) {
+  srand(7);
+  TelemetrySample s = { 1700000000UL, 620, 2350, 4800 };
+  for (size_t i = 0; i < n; i++) {
+    s.t += ((rand() % 200) == 0) ? 2 : 1;  // 偶发漏采
+    if (rand() % 3 == 0) s.co2 = (uint16_t)(s.co2 + (rand() % 5) - 2);
+    if (rand() % 20 == 0) s.temp = (int16_t)(s.temp + ((rand() % 3) - 1) * 10);
+    if (rand() % 15 == 0) s.hum = (uint16_t)(s.hum + ((rand() % 3) - 1) * 10);
+    v.push_back(s);
+  }
+}
+
+void benchCodec() {
+  printf("== codec ==\n");
+  const size_t total = 1u << 20;
+  const size_t perBlock = 3600;      // 每块 1 小时
+  std::vector<TelemetrySample> in;
+  makeSeries(in, total);
+  static uint8_t blocks[(total / perBlock + 1)][perBlock * TELEMETRY_MAX_SAMPLE_BITS / 8 + 8];
+  static size_t blockLen[total / perBlock + 1];
+
+  uint64_t t0 = benchNowNs();
+  size_t nb = 0, encBytes = 0;
+  for (size_t i = 0; i < total; i += perBlock, nb++) {
+    TelemetryEncoder enc(blocks[nb], sizeof(blocks[nb]));
+    size_t end = i + perBlock < total ? i + perBlock : total;
+    for (size_t j = i; j < end; j++) enc.append(in[j]);
+    blockLen[nb] = enc.finish();
+    encBytes += blockLen[nb];
+  }
+  uint64_t dt = benchNowNs() - t0;
+  benchReport("encode", total, dt);
+
+  std::vector<TelemetrySample> out(total);
+  t0 = benchNowNs();
+  size_t k = 0;
+  for (size_t b = 0; b < nb; b++) {
+    TelemetryDecoder dec(blocks[b], blockLen[b]);
+    while (k < total && dec.next(out[k])) k++;
+  }
+  dt = benchNowNs() - t0;
+  benchReport("decode", k, dt);
+
+  bool same = k == total;
+  for (size_t i = 0; same && i < total; i++) {
+    same = in[i].t == out[i].t && in[i].co2 == out[i].co2 && in[i].temp == out[i].temp && in[i].hum == out[i].hum;
+  }
+  // 对比基准：定点记录 10 字节（u32 时间 + 3 x u16），float 记录 14 字节
+  printf("roundtrip %s, %.2f bits/sample, ratio vs 10B fixed-point %.1fx, vs 14B float %.1fx\n",
+         same ? "OK" : "MISMATCH", encBytes * 8.0 / total, total * 10.0 / encBytes, total * 14.0 / encBytes);
+}
@@ -0,0 +1,131 @@
+// FlashLog 写放大、擦除均衡、写失败与掉电恢复（文件模拟闪存）
+#include <stdlib.h>
+#include <stdio.h>
+#include <vector>
+#include "bench.h"
+#include "file_flash.h"
+
+static const char *kImage = "flashlog_bench.bin";
+static const uint32_t kImageBytes = 64 * FLASH_LOG_SECTOR;
+
+static TelemetrySample makeSample(uint32_t t) {
+  TelemetrySample s = { t, (uint16_t)(600 + (t / 7) % 40), (int16_t)(2300 + ((t / 60) % 20) * 10), (uint16_t)(4800 + ((t / 90) % 10) * 10) };
+  return s;
+}
+
+static void benchAmplification() {
+  remove(kImage);
+  FileFlash ff;
+  ff.open(kImage, kImageBytes);
+  static FlashLog log;
+  log.begin(&ff);
+  const uint32_t seconds = 30UL * 24 * 3600;
+  uint64_t t0 = benchNowNs();
+  for (uint32_t t = 1; t <= seconds; t++) {
+    log.append(makeSample(t));
+    log.flushIfOlder(t, 300);    // 与固件相同：最多丢失 5 分钟
+  }
+  log.flush();
+  uint64_t dt = benchNowNs() - t0;
+  benchReport("append (30 days @1Hz, file flash)", seconds, dt);
+
+  const FlashLogStats &st = log.getStats();
+  uint32_t emin = UINT32_MAX, emax = 0;
+  for (uint16_t i = 0; i < log.segments(); i++) {
+    uint32_t e = log.segmentEraseCount(i);
+    if (e < emin) emin = e;
+    if (e > emax) emax = e;
+  }
+  printf("records=%u payload=%u programmed=%u (%.2fx of encoded payload, %.2f B/sample vs 10 B raw)\n",
+         st.recordsWritten, st.payloadBytes, st.programmedBytes,
+         (double)st.programmedBytes / st.payloadBytes, (double)st.programmedBytes / seconds);
+  printf("sector erases=%u, per-sector min/max=%u/%u, retention=%.1f h in %u KiB\n",
+         st.sectorsErased, emin, emax, (double)seconds * (log.segments() - 1) / st.sectorsErased / 3600, kImageBytes / 1024);
+
+  static TelemetrySample out[4096];
+  t0 = benchNowNs();
+  size_t n = 0;
+  const int iters = 200;
+  for (int i = 0; i < iters; i++) n = log.read(seconds - 3600, seconds, out, 4096);
+  dt = benchNowNs() - t0;
+  benchReport("read last 1h", (uint64_t)iters * n, dt);
+  remove(kImage);
+}
+
+// 在随机字节处掉电，重新挂载后检查：已确认写出的样本都能读回，且日志可继续追加
+static void benchRecovery() {
+  const int trials = 300;
+  int ok = 0, dirty = 0;
+  srand(11);
+  static FlashLog log;
+  static TelemetrySample out[20000];
+  for (int trial = 0; trial < trials; trial++) {
+    remove(kImage);
+    uint32_t durable = 0, t = 0;
+    {
+      FileFlash ff;
+      ff.open(kImage, kImageBytes);
+      log.begin(&ff);
+      ff.cutPowerAfter(rand() % (kImageBytes / 2));
+      while (!ff.powerLost() && t < 19000) {
+        t++;
+        log.append(makeSample(t));
+        if (t % 60 == 0 && log.flush()) durable = t;
+      }
+    }
+    FileFlash ff;
+    ff.open(kImage, kImageBytes);
+    bool pass = log.begin(&ff);
+    if (log.getStats().tailDirty) dirty++;
+    size_t n = log.read(0, UINT32_MAX, out, 20000);
+    pass = pass && n >= durable;
+    for (size_t i = 0; pass && i < n; i++) pass = out[i].t == i + 1 && out[i].co2 == makeSample(i + 1).co2;
+    // 恢复后继续写
+    uint32_t next = log.lastTime() + 1;
+    pass = pass && log.append(makeSample(next)) && log.flush();
+    pass = pass && log.read(next, next, out, 1) == 1;
+    if (pass) ok++;
+  }
+  printf("power-cut recovery: %d/%d ok (%d with torn tail)\n", ok, trials, dirty);
+  remove(kImage);
+}
+
+// 写失败（只编程了一半）：批次不丢，换段重写，残片不影响之后的记录；重新挂载后全部读回
+static void benchWriteFailure() {
+  remove(kImage);
+  static FlashLog log;
+  static TelemetrySample out[8000];
+  FileFlash ff;
+  ff.open(kImage, kImageBytes);
+  log.begin(&ff);
+  const uint32_t n = 7200;
+  uint32_t failed = 0;
+  for (uint32_t t = 1; t <= n; t++) {
+    if (t == 1800) ff.failNextWrites(1);   // 换段重试成功
+    if (t == 3600) ff.failNextWrites(2);   // 重试也失败：批次留在 RAM，下次写出
+    if (t == 5400) ff.failNextWrites(1);
+    if (!log.append(makeSample(t))) failed++;
+    log.flushIfOlder(t, 300);
+  }
+  bool pass = log.flush() && !failed && log.getStats().writeErrors == 4;
+  auto readsAll = [&]() {
+    size_t got = log.read(0, UINT32_MAX, out, 8000);
+    bool ok = got == n;
+    for (size_t i = 0; ok && i < got; i++) ok = out[i].t == i + 1 && out[i].co2 == makeSample(i + 1).co2;
+    return ok;
+  };
+  pass = pass && readsAll();
+  ff.close();
+  ff.open(kImage, kImageBytes);
+  pass = pass && log.begin(&ff) && readsAll();
+  printf("write failures: %u injected, %u samples read back before and after remount -> %s\n",
+         4u, n, pass ? "OK" : "MISMATCH");
+  remove(kImage);
+}
+
+void benchFlashLog() {
+  printf("== flashlog ==\n");
+  benchAmplification();
+  benchWriteFailure();
+  benchRecovery();
+}
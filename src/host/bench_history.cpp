@@ -0,0 +1,100 @@
+// HistoryStore 内存占用、插入与窗口读取耗时；插入一年数据后逐点核对三级存储的内容
+#include <stdlib.h>
+#include <map>
+#include "bench.h"
+#include "history_store.h"
+
+static bool histSame(const HistAgg &a, const HistAgg &b) { return !memcmp(&a, &b, sizeof(HistAgg)); }
+
+// 读出 [t0, t1] 的某一级，与参考逐点比较（时间与 min/max/mean），返回不一致的点数
+static uint32_t histCheckLevel(const HistoryStore &hs, HistLevel lv, uint32_t t0, uint32_t t1,
+                               const std::map<uint32_t, HistAccum> &ref, uint32_t &points) {
+  static HistPoint out[HIST_MIN_SLOTS];
+  size_t n = hs.read(lv, t0, t1, out, HIST_MIN_SLOTS);
+  uint32_t period = HistoryStore::levelPeriod(lv), bad = 0;
+  auto it = ref.lower_bound(t0 / period);
+  for (size_t i = 0; i < n; i++, ++it) {
+    if (it == ref.end() || it->first * period != out[i].t || !histSame(it->second.toAgg(), out[i].v)) bad++;
+    if (it == ref.end()) break;
+  }
+  // 参考中还有窗口内的点没读出来
+  for (; it != ref.end() && it->first <= t1 / period; ++it) bad++;
+  points = (uint32_t)n;
+  return bad;
+}
+
+void benchHistory() {
+  printf("== history ==\n");
+  printf("record bytes: raw=%u agg=%u\n", (unsigned)sizeof(HistRaw), (unsigned)sizeof(HistAgg));
+  printf("memory: raw=%u minute=%u hour=%u total=%u bytes\n",
+         (unsigned)(sizeof(HistRaw) * HIST_RAW_SLOTS), (unsigned)(sizeof(HistAgg) * HIST_MIN_SLOTS),
+         (unsigned)(sizeof(HistAgg) * HIST_HOUR_SLOTS), (unsigned)HistoryStore::memoryBytes());
+
+  static HistoryStore hs;
+  if (!hs.begin()) { printf("alloc failed\n"); return; }
+
+  // 模拟一年 1 Hz 数据（含少量空档）
+  const uint32_t seconds = 365UL * 24 * 3600;
+  uint32_t co2 = 600;
+  srand(1);
+  uint32_t t = 0;
+  static HistRaw samples[365UL * 24 * 3600];
+  static uint32_t times[365UL * 24 * 3600];
+  for (uint32_t i = 0; i < seconds; i++) {
+    t++;
+    if ((rand() & 0xFFFF) == 0) t += 30;  // 偶发断线
+    co2 += (rand() % 3) - 1;
+    if (co2 < 400 || co2 > 5000) co2 = 600;   // 不让随机游走碰到 HIST_NO_DATA
+    samples[i] = { (uint16_t)co2, (int16_t)(2300 + (i % 500)), (uint16_t)(4500 + (i % 300)) };
+    times[i] = t;
+  }
+  uint64_t t0 = benchNowNs();
+  for (uint32_t i = 0; i < seconds; i++) hs.insert(times[i], samples[i].co2, samples[i].temp, samples[i].hum);
+  uint64_t dt = benchNowNs() - t0;
+  benchReport("insert (1 year @1Hz)", seconds, dt);
+
+  // 参考：按秒 / 分钟 / 小时累加保留期内的样本；当前未结束的分钟与小时不可读，不计入
+  std::map<uint32_t, HistAccum> refRaw, refMin, refHour;
+  const uint32_t last = hs.lastTime();
+  for (uint32_t i = 0; i < seconds; i++) {
+    uint32_t ts = times[i];
+    HistAccum *lv[3] = { ts + HIST_RAW_SLOTS > last ? &refRaw[ts] : nullptr,
+                         ts / 60 != last / 60 && ts / 60 + HIST_MIN_SLOTS >= last / 60 ? &refMin[ts / 60] : nullptr,
+                         ts / 3600 != last / 3600 && ts / 3600 + HIST_HOUR_SLOTS >= last / 3600 ? &refHour[ts / 3600] : nullptr };
+    for (HistAccum *a : lv) {
+      if (!a) continue;
+      if (!a->count) a->reset();
+      a->add(samples[i]);
+    }
+  }
+  uint32_t pts[3], bad = histCheckLevel(hs, HIST_RAW, 0, last, refRaw, pts[0]) +
+                         histCheckLevel(hs, HIST_MINUTE, 0, last, refMin, pts[1]) +
+                         histCheckLevel(hs, HIST_HOUR, 0, last, refHour, pts[2]);
+  // 时间倒退与同一秒的重复样本被拒绝，不改变内容
+  bool rejected = !hs.insert(last, 1, 1, 1) && !hs.insert(last - 100, 1, 1, 1) && hs.lastTime() == last;
+  printf("contents: raw=%u minute=%u hour=%u points, %u mismatches, stale inserts %s -> %s\n", pts[0], pts[1], pts[2],
+         bad, rejected ? "rejected" : "ACCEPTED", (!bad && rejected) ? "OK" : "MISMATCH");
+
+  static HistPoint out[HIST_MIN_SLOTS];
+  struct { const char *name; HistLevel lv; uint32_t span; } q[] = {
+    { "read raw 1h", HIST_RAW, 3600 },
+    { "read raw 5min", HIST_RAW, 300 },
+    { "read minute 24h", HIST_MINUTE, 24 * 3600 },
+    { "read minute 7d", HIST_MINUTE, 7 * 24 * 3600 },
+    { "read hour 365d", HIST_HOUR, 365UL * 24 * 3600 },
+  };
+  for (auto &e : q) {
+    const int iters = 2000;
+    size_t n = 0;
+    t0 = benchNowNs();
+    for (int i = 0; i < iters; i++) {
+      n = hs.read(e.lv, hs.lastTime() - e.span, hs.lastTime(), out, HIST_MIN_SLOTS);
+      benchKeep(out[0]);
+    }
+    dt = benchNowNs() - t0;
+    char name[48];
+    snprintf(name, sizeof(name), "%s (%u pts)", e.name, (unsigned)n);
+    benchReport(name, (uint64_t)iters * (n ? n : 1), dt);
+  }
+  hs.end();
+}
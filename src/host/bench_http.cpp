@@ -0,0 +1,117 @@
+// 指标端点：回环套接字上 16 个并发抓取者对 8 个连接槽，采集侧持续发布新样本；
+// 校验每个响应完整（状态行、Content-Length 与体长度一致、内容可识别），并对比重建与抓取的开销
+#include <stdlib.h>
+#include <string.h>
+#include <atomic>
+#include <thread>
+#include <vector>
+#include "bench.h"
+#include "metrics_http.h"
+
+static MetricsSample makeSample(uint32_t v) {
+  MetricsSample s;
+  s.version = v;
+  s.co2 = 600 + v % 400;
+  s.temp = 21.5f + (float)(v % 30) / 10;
+  s.hum = 40.0f + (float)(v % 50) / 10;
+  s.flags = SNAP_CO2_VALID | SNAP_TEMP_VALID | SNAP_HUM_VALID;
+  s.co2Mean1m = 610; s.co2Mean1h = 640; s.co2Mean24h = 700;
+  s.co2Min1h = 420; s.co2Max1h = 1200;
+  s.co2Accepted = v; s.co2Rejected = v / 100; s.dhtRejected = v / 1000;
+  s.uptimeS = v; s.bootCount = 3; s.epoch = 1760000000u + v;
+  return s;
+}
+
+// 阻塞式客户端：一次请求，读到对端关闭；返回 HTTP 状态码，0 = 连接/解析失败
+static int scrape(uint16_t port, const char *path, bool prom, bool &bodyOk) {
+  bodyOk = false;
+  int fd = socket(AF_INET, SOCK_STREAM, 0);
+  if (fd < 0) return 0;
+  struct sockaddr_in a;
+  memset(&a, 0, sizeof(a));
+  a.sin_family = AF_INET;
+  a.sin_port = htons(port);
+  a.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  if (connect(fd, (struct sockaddr *)&a, sizeof(a)) < 0) { close(fd); return 0; }
+  char req[64];
+  int n = snprintf(req, sizeof(req), "GET %s HTTP/1.0\r\nHost: bench\r\n\r\n", path);
+  if (send(fd, req, (size_t)n, MSG_NOSIGNAL) != n) { close(fd); return 0; }
+  char resp[METRICS_RESP_MAX + 64];
+  size_t len = 0;
+  for (;;) {
+    ssize_t r = recv(fd, resp + len, sizeof(resp) - 1 - len, 0);
+    if (r <= 0) break;
+    len += (size_t)r;
+  }
+  close(fd);
+  resp[len] = 0;
+  int code = 0;
+  if (sscanf(resp, "HTTP/1.0 %d", &code) != 1) return 0;
+  const char *cl = strstr(resp, "Content-Length: ");
+  const char *body = strstr(resp, "\r\n\r\n");
+  if (!cl || !body) return code;
+  body += 4;
+  size_t want = (size_t)atoi(cl + 16);
+  bodyOk = want == len - (size_t)(body - resp) &&
+           (code != 200 || (prom ? strstr(body, "airmon_co2_ppm ") && strstr(body, "airmon_clock_epoch_seconds")
+                                 : body[0] == '{' && strstr(body, "\"epoch\":") && body[want - 2] == '}'));
+  return code;
+}
+
+void benchHttp() {
+  printf("== http ==\n");
+  static MetricsServer srv;
+  if (!srv.begin(0, true)) { printf("listen failed\n"); return; }
+
+  // 重建开销：两种格式化 + 贴头
+  const uint32_t nb = 20000;
+  uint64_t t0 = benchNowNs();
+  for (uint32_t v = 1; v <= nb; v++) srv.publish(makeSample(v));
+  benchReport("rebuild (prom+json)", nb, benchNowNs() - t0);
+  uint16_t promLen, jsonLen;
+  srv.response(METRICS_PROM, promLen);
+  srv.response(METRICS_JSON, jsonLen);
+  printf("response bytes prom=%u json=%u (cap %u)\n", promLen, jsonLen, METRICS_RESP_MAX);
+
+  // 服务线程：每 ~5 ms 发布一次新样本，其余时间处理连接
+  std::atomic<bool> stop{false};
+  std::thread server([&] {
+    uint32_t v = nb;
+    uint64_t lastPub = 0;
+    while (!stop.load(std::memory_order_relaxed)) {
+      uint64_t ns = benchNowNs();
+      if (ns - lastPub > 5000000) { srv.publish(makeSample(++v)); lastPub = ns; }
+      srv.poll((uint32_t)(ns / 1000000), 2);
+    }
+  });
+
+  const int clients = 16, perClient = 150;
+  std::atomic<uint32_t> ok{0}, busy{0}, bad{0};
+  std::vector<std::thread> ths;
+  uint32_t rebuilds0 = srv.stats().rebuilds;
+  t0 = benchNowNs();
+  for (int c = 0; c < clients; c++) {
+    ths.emplace_back([&, c] {
+      for (int i = 0; i < perClient; i++) {
+        bool prom = (i + c) % 2 == 0, bodyOk;
+        int code = scrape(srv.port(), prom ? "/metrics" : "/json", prom, bodyOk);
+        if (code == 200 && bodyOk) ok++;
+        else if (code == 503) { busy++; i--; std::this_thread::yield(); }   // 槽满：重试
+        else bad++;
+      }
+    });
+  }
+  for (auto &t : ths) t.join();
+  uint64_t dt = benchNowNs() - t0;
+  bool nf, nfOk;
+  int code404 = scrape(srv.port(), "/nope", false, nf);
+  nfOk = code404 == 404 && nf;
+  stop = true;
+  server.join();
+
+  const MetricsServerStats &st = srv.stats();
+  benchReport("scrape (loopback, end to end)", ok.load(), dt);
+  printf("scrapes ok=%u busy-retried=%u bad=%u, rebuilds during run=%u deferred=%u peak clients=%u timeouts=%u\n",
+         ok.load(), busy.load(), bad.load(), st.rebuilds - rebuilds0, st.deferred, st.peakClients, st.timeouts);
+  printf("http responses %s\n", ok.load() == (uint32_t)(clients * perClient) && !bad.load() && nfOk ? "OK" : "MISMATCH");
+}
@@ -0,0 +1,51 @@
+// 延迟直方图：记录开销，以及 log2 分桶分位数与精确排序分位数的对比（上界、封顶不超过 max）
+#include <stdlib.h>
+#include <algorithm>
+#include <vector>
+#include "bench.h"
+#include "latency_hist.h"
+
+void benchLatHist() {
+  printf("== lathist ==\n");
+  static LatencyHist h("sim");
+
+  // 模拟 loop 耗时分布：多数 20~80 us 的串口处理，每秒一次 ~1.2 ms 的刷屏，偶发 25 ms 的 DHT 阻塞
+  const uint32_t n = 2000000;
+  std::vector<uint32_t> v(n);
+  srand(11);
+  for (uint32_t i = 0; i < n; i++) {
+    uint32_t r = (uint32_t)rand();
+    if (i % 5000 == 0) v[i] = 24000 + r % 3000;
+    else if (i % 50 == 0) v[i] = 1100 + r % 300;
+    else v[i] = 20 + r % 60;
+  }
+
+  uint64_t t0 = benchNowNs();
+  for (uint32_t i = 0; i < n; i++) h.record(v[i]);
+  benchReport("record", n, benchNowNs() - t0);
+
+  t0 = benchNowNs();
+  uint32_t p = 0;
+  for (int i = 0; i < 10000; i++) { p += h.percentile(990); benchKeep(p); }
+  benchReport("percentile", 10000, benchNowNs() - t0);
+
+  std::vector<uint32_t> sorted(v);
+  std::sort(sorted.begin(), sorted.end());
+  bool ok = true;
+  const uint32_t qs[] = { 500, 900, 990, 999, 1000 };
+  for (uint32_t q : qs) {
+    uint32_t exact = sorted[(uint64_t)(n - 1) * q / 1000];
+    uint32_t est = h.percentile(q);
+    // 估计值是所在桶的上界：不小于精确值，且不超过精确值的 2 倍（或 max）
+    bool good = est >= exact && (est <= 2 * exact + 1 || est == h.max());
+    ok = ok && good;
+    printf("p%-5.1f exact=%6u us  hist<=%6u us %s\n", q / 10.0, exact, est, good ? "" : "<- out of bound");
+  }
+  ok = ok && h.max() == sorted[n - 1] && h.count() == n;
+  char line[160];
+  h.summary(line, sizeof(line));
+  printf("%s\n", line);
+  h.bucketLine(line, sizeof(line));
+  printf("buckets %s\n", line);
+  printf("histogram bounds %s\n", ok ? "OK" : "MISMATCH");
+}
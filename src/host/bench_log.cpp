@@ -0,0 +1,119 @@
+// 延迟日志：生产者开销、多生产者无锁正确性、丢弃计数与编译期级别裁剪
+#include <stdlib.h>
+#include <string.h>
+#include <atomic>
+#include <thread>
+#include <vector>
+#include "bench.h"
+#include "deferred_log.h"
+
+DeferredLog deferredLog;
+
+struct NullSink {
+  uint64_t bytes = 0;
+  size_t write(const uint8_t *, size_t n) { bytes += n; return n; }
+};
+
+// 按行解析 "p<id> <seq>"，检查每个生产者的序号严格递增（允许因丢弃出现跳号）
+struct CheckSink {
+  static const int kMaxProducers = 8;
+  char line[LOG_SLOT_TEXT + 1];
+  size_t len = 0;
+  long last[kMaxProducers];
+  uint64_t lines = 0, bad = 0, notes = 0;
+  CheckSink() { for (int i = 0; i < kMaxProducers; i++) last[i] = -1; }
+  size_t write(const uint8_t *p, size_t n) {
+    for (size_t i = 0; i < n; i++) {
+      if (p[i] != '\n') { if (len < LOG_SLOT_TEXT) line[len++] = (char)p[i]; continue; }
+      line[len] = 0;
+      len = 0;
+      unsigned id; long seq;
+      if (!strncmp(line, "[log] dropped", 13)) { notes++; continue; }
+      if (sscanf(line, "p%u %ld", &id, &seq) != 2 || id >= kMaxProducers || seq <= last[id]) { bad++; continue; }
+      last[id] = seq;
+      lines++;
+    }
+    return n;
+  }
+};
+
+static int evalCount = 0;
+static int expensiveArg() { evalCount++; return 42; }
+
+void benchLog() {
+  printf("== log ==\n");
+
+  // 单生产者：每 16 条排空一次，只计入队时间
+  {
+    DeferredLog lg;
+    NullSink sink;
+    const uint32_t n = 1u << 20;
+    uint64_t enqNs = 0, drainNs = 0;
+    for (uint32_t i = 0; i < n; i += 16) {
+      uint64_t t0 = benchNowNs();
+      for (uint32_t j = 0; j < 16; j++) lg.printf(LOG_LEVEL_INFO, "Heartbeat @%lu", (unsigned long)(i + j));
+      uint64_t t1 = benchNowNs();
+      lg.drainAll(sink);
+      drainNs += benchNowNs() - t1;
+      enqNs += t1 - t0;
+    }
+    benchReport("enqueue printf line", n, enqNs);
+    benchReport("drain to sink", n, drainNs);
+    // 9600 8N1：每字节 10 bit
+    double lineBytes = (double)sink.bytes / n;
+    printf("avg line %.1f B; direct Serial @9600 would block %.0f us per line\n", lineBytes, lineBytes * 10 * 1e6 / 9600);
+  }
+
+  // 突发写满：无消费者时丢弃计数与说明行
+  {
+    DeferredLog lg;
+    NullSink sink;
+    for (int i = 0; i < 100; i++) lg.printf(LOG_LEVEL_INFO, "burst %d", i);
+    size_t out = lg.drainAll(sink);
+    DeferredLogStats st = lg.getStats();
+    printf("burst 100 into %d slots: written=%lu dropped=%lu highWater=%lu (%zu bytes out)\n", LOG_RING_SLOTS,
+           (unsigned long)st.written, (unsigned long)st.dropped, (unsigned long)st.highWater, out);
+  }
+
+  // 多生产者 + 一个消费者线程：满了就让出 CPU 重试，要求每条恰好收到一次、丢弃数等于失败次数
+  {
+    static DeferredLog lg;
+    CheckSink sink;
+    const int producers = 4;
+    const long perProducer = 200000;
+    std::atomic<bool> done{false};
+    std::atomic<uint64_t> fails{0};
+    std::thread consumer([&] {
+      while (!done.load()) if (!lg.drain(sink, 256)) std::this_thread::yield();
+      lg.drainAll(sink);
+    });
+    uint64_t t0 = benchNowNs();
+    std::vector<std::thread> ths;
+    for (int p = 0; p < producers; p++) {
+      ths.emplace_back([p, perProducer, &fails] {
+        for (long i = 0; i < perProducer; i++) {
+          while (!lg.printf(LOG_LEVEL_INFO, "p%d %ld", p, i)) { fails++; std::this_thread::yield(); }
+        }
+      });
+    }
+    for (auto &t : ths) t.join();
+    uint64_t dt = benchNowNs() - t0;
+    done = true;
+    consumer.join();
+    DeferredLogStats st = lg.getStats();
+    uint64_t produced = (uint64_t)producers * perProducer;
+    benchReport("4 producers printf", produced, dt);
+    bool ok = sink.lines == produced && sink.bad == 0 && st.dropped == fails.load() && (sink.notes > 0) == (st.dropped > 0);
+    printf("mpsc: produced=%llu received=%llu full-retries=%lu bad=%llu highWater=%lu -> %s\n",
+           (unsigned long long)produced, (unsigned long long)sink.lines, (unsigned long)st.dropped,
+           (unsigned long long)sink.bad, (unsigned long)st.highWater, ok ? "OK" : "MISMATCH");
+  }
+
+  // 编译期裁剪：默认 LOG_LEVEL=INFO，LOGD 的参数不应被求值
+  LOGD("debug %d", expensiveArg());
+  LOGI("info %d", expensiveArg());
+  NullSink sink;
+  deferredLog.drainAll(sink);
+  printf("LOG_LEVEL=%d: LOGD args evaluated %s, LOGI %s\n", LOG_LEVEL, evalCount == 1 ? "no" : "YES",
+         evalCount >= 1 ? "yes" : "no");
+}
@@ -0,0 +1,22 @@
+// 主机端基准入口：pio run -e native_bench -t exec
+#include <string.h>
+#include "bench.h"
+
+int main(int argc, char **argv) {
+  const char *only = argc > 1 ? argv[1] : nullptr;
+  if (!only || !strcmp(only, "history")) benchHistory();
+  if (!only || !strcmp(only, "codec")) benchCodec();
+  if (!only || !strcmp(only, "flashlog")) benchFlashLog();
+  if (!only || !strcmp(only, "log")) benchLog();
+  if (!only || !strcmp(only, "tlm")) benchTlm();
+  if (!only || !strcmp(only, "sched")) benchSched();
+  if (!only || !strcmp(only, "pipeline")) benchPipeline();
+  if (!only || !strcmp(only, "rolling")) benchRolling();
+  if (!only || !strcmp(only, "seqlock")) benchSeqlock();
+  if (!only || !strcmp(only, "power")) benchPower();
+  if (!only || !strcmp(only, "lathist")) benchLatHist();
+  if (!only || !strcmp(only, "clock")) benchClock();
+  if (!only || !strcmp(only, "http")) benchHttp();
+  if (!only || !strcmp(only, "mqtt")) benchMqtt();
+  return 0;
+}
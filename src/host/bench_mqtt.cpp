@@ -0,0 +1,188 @@
+// MQTT 批量上报：本地替身 broker（CONNECT/PUBLISH QoS1/PINGREQ）+ 文件模拟闪存日志，仿真 2 小时 1 Hz 采样，
+// 第 30~60 分钟 broker 下线。校验每个样本至少送达一次且去重后有序，统计消息数、字节/样本与补发节奏
+#include <stdio.h>
+#include <string.h>
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "bench.h"
+#include "file_flash.h"
+#include "mqtt_publisher.h"
+
+static const char *kImage = "mqtt_bench.bin";
+
+// 单连接替身 broker：下线时关闭监听与连接，上线时在同一端口重新监听
+struct StandInBroker {
+  std::atomic<bool> online{true}, stop{false};
+  uint16_t port = 0;
+  std::mutex mu;
+  std::vector<uint32_t> times;          // 收到的样本时间（按到达顺序）
+  uint32_t connects = 0, publishes = 0;
+
+  int listenOn(uint16_t p) {
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    int one = 1;
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+    struct sockaddr_in a;
+    memset(&a, 0, sizeof(a));
+    a.sin_family = AF_INET;
+    a.sin_port = htons(p);
+    a.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    if (bind(fd, (struct sockaddr *)&a, sizeof(a)) < 0 || listen(fd, 4) < 0) { close(fd); return -1; }
+    socklen_t len = sizeof(a);
+    getsockname(fd, (struct sockaddr *)&a, &len);
+    port = ntohs(a.sin_port);
+    return fd;
+  }
+
+  static bool waitReadable(int fd, int ms) {
+    fd_set s;
+    FD_ZERO(&s);
+    FD_SET(fd, &s);
+    struct timeval tv = { 0, ms * 1000 };
+    return select(fd + 1, &s, nullptr, nullptr, &tv) > 0;
+  }
+
+  // 处理缓冲中的完整报文，返回消耗的字节数；-1 = 断开
+  int handle(int cfd, const uint8_t *b, size_t n) {
+    size_t used = 0;
+    while (n - used >= 2) {
+      uint32_t rem = 0, mul = 1;
+      size_t i = used + 1;
+      for (; i < n; i++) {
+        rem += (b[i] & 0x7F) * mul;
+        mul <<= 7;
+        if (!(b[i] & 0x80)) break;
+      }
+      if (i >= n || n - (i + 1) < rem) break;
+      const uint8_t *p = b + i + 1;
+      uint8_t type = b[used] >> 4;
+      if (type == 1) {   // CONNECT
+        static const uint8_t ack[4] = { 0x20, 0x02, 0x00, 0x00 };
+        send(cfd, ack, sizeof(ack), MSG_NOSIGNAL);
+        connects++;
+      } else if (type == 3) {   // PUBLISH QoS 1
+        uint16_t tl = (uint16_t)(p[0] << 8 | p[1]);
+        const uint8_t *id = p + 2 + tl;
+        TelemetryDecoder dec(id + 2, rem - 4 - tl);
+        TelemetrySample s;
+        {
+          std::lock_guard<std::mutex> g(mu);
+          while (dec.next(s)) times.push_back(s.t);
+          publishes++;
+        }
+        uint8_t ack[4] = { 0x40, 0x02, id[0], id[1] };
+        send(cfd, ack, sizeof(ack), MSG_NOSIGNAL);
+      } else if (type == 12) {   // PINGREQ
+        static const uint8_t pong[2] = { 0xD0, 0x00 };
+        send(cfd, pong, sizeof(pong), MSG_NOSIGNAL);
+      } else if (type == 14) {
+        return -1;
+      }
+      used = i + 1 + rem;
+    }
+    return (int)used;
+  }
+
+  void run() {
+    int lfd = listenOn(0), cfd = -1;
+    uint8_t buf[4096];
+    size_t len = 0;
+    while (!stop.load()) {
+      if (!online.load()) {
+        if (cfd >= 0) { close(cfd); cfd = -1; }
+        if (lfd >= 0) { close(lfd); lfd = -1; }
+        std::this_thread::yield();
+        continue;
+      }
+      if (lfd < 0) lfd = listenOn(port);
+      if (cfd < 0) {
+        if (lfd >= 0 && waitReadable(lfd, 1)) { cfd = accept(lfd, nullptr, nullptr); len = 0; }
+        continue;
+      }
+      if (!waitReadable(cfd, 1)) continue;
+      ssize_t r = recv(cfd, buf + len, sizeof(buf) - len, 0);
+      if (r <= 0) { close(cfd); cfd = -1; continue; }
+      len += (size_t)r;
+      int used = handle(cfd, buf, len);
+      if (used < 0) { close(cfd); cfd = -1; continue; }
+      memmove(buf, buf + used, len - (size_t)used);
+      len -= (size_t)used;
+    }
+    if (cfd >= 0) close(cfd);
+    if (lfd >= 0) close(lfd);
+  }
+};
+
+void benchMqtt() {
+  printf("== mqtt ==\n");
+  static StandInBroker broker;
+  broker.port = 0;
+  std::thread bt([] { broker.run(); });
+  while (!broker.port) std::this_thread::yield();
+
+  remove(kImage);
+  FileFlash ff;
+  ff.open(kImage, 64 * FLASH_LOG_SECTOR);
+  static FlashLog log;
+  log.begin(&ff);
+
+  static MqttClient client;
+  char host[] = "127.0.0.1";
+  client.configure(host, broker.port, "bench", nullptr, nullptr, 60);
+  static MqttBatchPublisher<FlashLog> pub(client, log);
+  MqttBatchConfig cfg;
+  cfg.batchIntervalMs = 60000;
+  cfg.batchMax = 120;
+  cfg.drainIntervalMs = 1000;
+  pub.begin("airmon/bench/batch", 0, cfg);
+
+  // 仿真时间：每轮 100 ms，每 10 轮一个样本；broker 在 [1800 s, 3600 s) 下线
+  const uint32_t simSec = 2 * 3600, outageFrom = 1800, outageTo = 3600;
+  uint32_t lastT = 0, drainStart = 0, drainEnd = 0, sent = 0;
+  uint64_t t0 = benchNowNs();
+  for (uint32_t step = 1; step <= simSec * 10 + 3000; step++) {
+    uint32_t simMs = step * 100;
+    uint32_t sec = simMs / 1000;
+    if (step % 10 == 0 && sec <= simSec) {
+      TelemetrySample s = { sec, (uint16_t)(600 + (sec / 7) % 40), (int16_t)(2300 + (sec / 60) % 20 * 10),
+                            (uint16_t)(4800 + (sec / 90) % 10 * 10) };
+      log.append(s);
+      log.flushIfOlder(sec, 300);
+      lastT = sec;
+    }
+    broker.online = !(sec >= outageFrom && sec < outageTo);
+    if (pub.tick(simMs, lastT)) {
+      sent++;
+      if (sec >= outageTo && !drainStart) drainStart = sec;
+    }
+    if (drainStart && !drainEnd && pub.stats().backlogSec <= 61) drainEnd = sec;
+    std::this_thread::yield();   // 单核环境下让 broker 线程跑
+  }
+  uint64_t dt = benchNowNs() - t0;
+  broker.stop = true;
+  bt.join();
+
+  // 校验：1..simSec 每个样本至少一次；去掉重发造成的重复后严格递增
+  std::vector<uint32_t> seen(simSec + 1, 0);
+  uint32_t dups = 0, order = 0, prev = 0;
+  for (uint32_t t : broker.times) {
+    if (t <= simSec && seen[t]++) { dups++; continue; }
+    if (t <= prev) order++;
+    prev = t;
+  }
+  uint32_t missing = 0;
+  for (uint32_t t = 1; t <= simSec; t++) missing += !seen[t];
+
+  const MqttBatchStats &st = pub.stats();
+  const MqttClientStats &cs = client.stats();
+  printf("sim %u s (%.2f s wall): broker got %u publishes for %zu samples (%.2f B/sample payload), connects=%u failures=%u\n",
+         simSec, dt / 1e9, broker.publishes, broker.times.size(), st.samples ? (double)st.payloadBytes / st.samples : 0.0,
+         cs.connects, cs.failures);
+  printf("outage %u..%u s: peak backlog %u s, drained from %u s to %u s (%u batches/s cap), resends=%u\n", outageFrom,
+         outageTo, st.peakBacklogSec, drainStart, drainEnd, 1000 / cfg.drainIntervalMs, st.resends);
+  printf("delivery missing=%u duplicates=%u out-of-order=%u -> %s\n", missing, dups, order,
+         !missing && !order ? "OK" : "MISMATCH");
+  remove(kImage);
+}
@@ -0,0 +1,120 @@
+// 双核流水线：SPSC 队列吞吐、推送到取出的延迟分布、慢速渲染下的溢出/合并计数（std::thread 代替两个核心）
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <vector>
+#include "bench.h"
+#include "spsc_queue.h"
+
+struct PipeSample {
+  uint64_t seq;
+  uint64_t stampNs;
+  uint32_t co2;
+  float temp;
+  float hum;
+};
+
+static void spinUntil(uint64_t ns) {
+  while (benchNowNs() < ns) std::this_thread::yield();
+}
+
+void benchPipeline() {
+  printf("== pipeline == (%u hardware threads; latency is OS-scheduling bound on 1)\n", std::thread::hardware_concurrency());
+
+  // 吞吐：生产者满时自旋重试，检查顺序与无丢失
+  {
+    static SpscQueue<PipeSample, 1024> q;
+    const uint64_t n = 5000000;
+    std::atomic<bool> ok{true};
+    std::thread consumer([&] {
+      PipeSample s;
+      uint64_t expect = 0;
+      while (expect < n) {
+        if (!q.pop(s)) { std::this_thread::yield(); continue; }
+        if (s.seq != expect) ok = false;
+        expect++;
+      }
+    });
+    uint64_t t0 = benchNowNs();
+    for (uint64_t i = 0; i < n; i++) {
+      PipeSample s = { i, 0, 600, 23.5f, 48.0f };
+      while (!q.push(s)) std::this_thread::yield();
+    }
+    consumer.join();
+    uint64_t dt = benchNowNs() - t0;
+    benchReport("spsc push+pop", n, dt);
+    printf("order %s, full-retries=%u\n", ok ? "OK" : "MISMATCH", q.overflows());
+  }
+
+  // 延迟：生产者每 5 us 推送一个带时间戳的样本，消费者忙轮询
+  {
+    static SpscQueue<PipeSample, 64> q;
+    const uint32_t n = 200000;
+    std::vector<uint32_t> lat;
+    lat.reserve(n);
+    std::thread consumer([&] {
+      PipeSample s;
+      uint32_t got = 0;
+      while (got < n) {
+        if (!q.pop(s)) { std::this_thread::yield(); continue; }
+        lat.push_back((uint32_t)(benchNowNs() - s.stampNs));
+        got++;
+      }
+    });
+    uint64_t next = benchNowNs();
+    for (uint32_t i = 0; i < n; i++) {
+      next += 5000;
+      spinUntil(next);
+      PipeSample s = { i, benchNowNs(), 600, 23.5f, 48.0f };
+      while (!q.push(s)) std::this_thread::yield();
+    }
+    consumer.join();
+    std::sort(lat.begin(), lat.end());
+    printf("push->pop latency ns: p50=%u p99=%u p99.9=%u max=%u\n", lat[n / 2], lat[n * 99 / 100], lat[n * 999 / 1000],
+           lat[n - 1]);
+  }
+
+  // 固件场景（时间缩放 10 倍）：采集 100 Hz，渲染每次 25 ms，偶发 200 ms，队列长 8；
+  // 生产者从不等待，渲染只画最新一份，所有样本都应计入 渲染 / 合并 / 溢出 之一
+  {
+    static SpscQueue<PipeSample, 8> q;
+    const uint32_t n = 400;
+    std::atomic<bool> done{false};
+    uint32_t rendered = 0;
+    uint64_t lastSeq = 0;
+    std::thread render([&] {
+      PipeSample s = {};
+      for (;;) {
+        bool fin = done.load();
+        uint32_t k = q.popLatest(s);
+        if (k) {
+          rendered++;
+          lastSeq = s.seq;
+          // 第 5 次模拟一次 200 ms 的整屏重绘，让队列溢出
+          std::this_thread::sleep_for(std::chrono::milliseconds(rendered == 5 ? 200 : 25));
+        } else if (fin) {
+          break;
+        } else {
+          std::this_thread::sleep_for(std::chrono::microseconds(200));
+        }
+      }
+    });
+    uint64_t maxPushNs = 0;
+    uint64_t next = benchNowNs();
+    for (uint32_t i = 0; i < n; i++) {
+      next += 10000000;
+      std::this_thread::sleep_until(std::chrono::steady_clock::time_point(std::chrono::nanoseconds(next)));
+      PipeSample s = { i, benchNowNs(), 600 + i % 50, 23.5f, 48.0f };
+      uint64_t t0 = benchNowNs();
+      q.push(s);
+      uint64_t d = benchNowNs() - t0;
+      if (d > maxPushNs) maxPushNs = d;
+    }
+    done = true;
+    render.join();
+    uint32_t accounted = rendered + q.coalescedCount() + q.overflows();
+    printf("slow render: produced=%u rendered=%u coalesced=%u overflow=%u last=%llu max push %llu ns -> %s\n", n,
+           rendered, q.coalescedCount(), q.overflows(), (unsigned long long)lastSeq, (unsigned long long)maxPushNs,
+           (accounted == n && lastSeq == n - 1) ? "OK" : "MISMATCH");
+  }
+}
@@ -0,0 +1,125 @@
+// 低功耗策略：虚拟时钟下模拟 1 小时 light sleep，统计清醒占比与 CO2 丢帧；对照"空闲就睡、靠串口唤醒"的朴素策略
+#include <stdlib.h>
+#include "bench.h"
+#include "power_manager.h"
+#include "task_scheduler.h"
+
+#define SIM_FRAME_BYTES_MS 17   // 16 字节 @9600 8N1
+
+struct PowerSim {
+  bool predict;                  // false = 朴素策略：不推迟轮询，任何空闲都睡
+  uint32_t now = 0;
+  TaskScheduler sched;
+  Co2FramePredictor pred;
+  int uartId = -1;
+  // 传感器帧：按 1003 ms（传感器时钟偏慢 0.3%）加 ±4 ms 抖动发出，每 600 帧有一帧提前 80 ms
+  uint32_t nextStart = 500;
+  uint32_t frameIdx = 0;
+  bool inFlight = false, corrupt = false;
+  uint32_t flightStart = 0;
+  uint32_t sent = 0, received = 0, corrupted = 0;
+  uint64_t sleptMs = 0;
+  uint32_t sleeps = 0, uartWakes = 0;
+
+  explicit PowerSim(bool p) : predict(p) {}
+
+  // 推进到 t：期间开始的帧进入"传输中"，传输完成的帧在下一次轮询时被取走
+  void advanceFrames(uint32_t t, bool asleep) {
+    while ((int32_t)(nextStart - t) <= 0 && !inFlight) {
+      inFlight = true;
+      corrupt = asleep;
+      flightStart = nextStart;
+      sent++;
+      frameIdx++;
+      int jitter = rand() % 9 - 4;
+      nextStart += 1003 + jitter - (frameIdx % 600 == 0 ? 80 : 0);
+    }
+  }
+
+  static void uartTask(void *ctx, uint32_t now) {
+    PowerSim *s = (PowerSim *)ctx;
+    s->advanceFrames(now, false);
+    if (s->inFlight && now - s->flightStart >= SIM_FRAME_BYTES_MS) {
+      s->inFlight = false;
+      if (s->corrupt) s->corrupted++;   // 缺了唤醒用掉的字节，解析器重同步丢弃
+      else { s->received++; s->pred.onFrame(now); }
+    }
+    if (!s->predict) return;
+    uint32_t wait = s->pred.msUntilWindow(now);
+    if (!s->inFlight && wait > 20) s->sched.reschedule(s->uartId, now + wait);
+  }
+
+  static void nopTask(void *, uint32_t) {}
+
+  void run(uint32_t simMs) {
+    uartId = sched.addPeriodic("uart", 20, uartTask, this, now);
+    sched.addPeriodic("sensors", 1000, nopTask, this, now, 1000);
+    sched.addPeriodic("heartbeat", 2000, nopTask, this, now, 2000);
+    sched.addPeriodic("power", 10000, nopTask, this, now, 10000);
+    while (now < simMs) {
+      sched.runDue(now);
+      now += 1;   // 每轮任务约 1 ms
+      uint32_t idle = sched.msUntilNext(now);
+      uint32_t budget = predict ? pred.sleepBudget(idle, now) : (idle >= POWER_MIN_SLEEP_MS ? idle : 0);
+      if (!budget) {
+        now += idle;
+        advanceFrames(now, false);
+        continue;
+      }
+      // light sleep：下一帧若在睡眠中开始，被串口唤醒，该帧损坏
+      uint32_t wake = now + budget;
+      advanceFrames(now, false);
+      bool uartWake = !inFlight && (int32_t)(nextStart - wake) < 0;
+      if (uartWake) wake = nextStart + 1;
+      sleeps++;
+      sleptMs += wake - now;
+      now = wake;
+      advanceFrames(now, true);
+      if (uartWake) {
+        uartWakes++;
+        pred.onEarlyArrival();
+        sched.reschedule(uartId, now);
+      }
+    }
+  }
+
+  void report(const char *name) {
+    printf("%-9s frames sent=%u ok=%u corrupted=%u predictor-lost=%u  awake=%.1f%%  sleeps=%u uart-wakes=%u guard=%ums\n",
+           name, sent, received, corrupted, pred.framesLost(), 100.0 * (now - sleptMs) / now, sleeps, uartWakes,
+           pred.guard());
+  }
+};
+
+void benchPower() {
+  printf("== power ==\n");
+  const uint32_t simMs = 3600u * 1000;
+  srand(5);
+  PowerSim naive(false);
+  naive.run(simMs);
+  naive.report("naive");
+  srand(5);
+  PowerSim predicted(true);
+  uint64_t t0 = benchNowNs();
+  predicted.run(simMs);
+  uint64_t dt = benchNowNs() - t0;
+  predicted.report("predicted");
+  // 每 600 帧一次提前 80 ms 的帧超出 guard，允许这部分损坏；其余必须全部收到
+  uint32_t allowed = predicted.sent / 600 + 1;
+  printf("predicted loss %s (corrupted %u, allowed %u), host %.1f ms for 1 h\n",
+         predicted.corrupted <= allowed ? "OK" : "TOO HIGH", predicted.corrupted, allowed, dt / 1e6);
+
+  // 屏幕策略：稳定 PANEL_STABLE_MS -> DIM；CO2 跳变 -> 立即 FULL；小幅波动不打断
+  PanelPowerPolicy pp;
+  SensorSnapshot s;
+  uint32_t dimAt = 0, fullAt = 0;
+  for (uint32_t t = 0; t < 300; t++) {
+    s.co2 = 600 + (t % 3) * 10;               // ±20 ppm 波动在容差带内
+    if (t >= 200) s.co2 = 900;
+    uint8_t prev = pp.level();
+    uint8_t lv = pp.update(s, t * 1000);
+    if (lv == PANEL_DIM && prev == PANEL_FULL && !dimAt) dimAt = t;
+    if (lv == PANEL_FULL && prev == PANEL_DIM && !fullAt) fullAt = t;
+  }
+  printf("panel: dim at %us (expect %u), full again at %us (expect 200) -> %s\n", dimAt, PANEL_STABLE_MS / 1000,
+         fullAt, (dimAt == PANEL_STABLE_MS / 1000 && fullAt == 200) ? "OK" : "MISMATCH");
+}
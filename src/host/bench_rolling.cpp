@@ -0,0 +1,101 @@
+// SamplePipeline 滚动统计：每样本耗时；跨 millis() 回绕的 26 小时 1 Hz 数据、以及时间戳略有先后颠倒的样本，
+// 与逐样本暴力统计逐项比对
+#include <vector>
+#include "bench.h"
+#include "sample_pipeline.h"
+
+struct RollRef {
+  uint64_t t;   // 回绕扩展后的毫秒
+  int32_t v;    // 中值滤波后的值
+};
+
+// 与 RollingWindow 同样的桶边界：窗口 = 当前桶 + 之前 B-1 个桶
+static WindowStat rollRefStat(const std::vector<RollRef> &s, uint64_t now, uint32_t bucketMs, uint16_t b) {
+  WindowStat w;
+  int64_t first = (int64_t)(now / bucketMs) - (b - 1), sum = 0;
+  for (size_t i = s.size(); i-- > 0;) {
+    if ((int64_t)(s[i].t / bucketMs) < first) break;
+    if (!w.count || s[i].v < w.min) w.min = s[i].v;
+    if (!w.count || s[i].v > w.max) w.max = s[i].v;
+    sum += s[i].v;
+    w.count++;
+  }
+  if (w.count) w.mean = (int32_t)((sum >= 0 ? sum + w.count / 2 : sum - (int64_t)(w.count / 2)) / (int64_t)w.count);
+  return w;
+}
+
+static bool rollSame(const WindowStat &a, const WindowStat &b) {
+  return a.count == b.count && (!a.count || (a.min == b.min && a.max == b.max && a.mean == b.mean));
+}
+
+void benchRolling() {
+  printf("== rolling ==\n");
+
+  {
+    static SamplePipeline p;
+    const uint32_t n = 2000000;
+    uint64_t t0 = benchNowNs();
+    for (uint32_t i = 0; i < n; i++) p.pushDht(20.0f + (i % 97) * 0.1f, 40.0f + (i % 13), i * 250);
+    benchReport("pushDht (temp+hum, 3 windows)", n, benchNowNs() - t0);
+    benchKeep(p.aggregates());
+  }
+
+  // 从回绕前 25 小时到回绕后 1 小时，1 Hz；回绕前后 10 分钟 / 5 分钟没有样本（只 tick），
+  // 之前温度 50.00，之后 10.00 附近。每分钟比对温度通道的三个窗口
+  static SamplePipeline p;
+  std::vector<RollRef> ref;
+  const uint64_t wrap = 1ULL << 32;
+  const uint64_t start = wrap - 25ULL * 3600 * 1000, end = wrap + 3600ULL * 1000;
+  uint32_t checks = 0, bad = 0;
+  for (uint64_t t = start; t < end; t += 1000) {
+    uint32_t ms = (uint32_t)t;
+    bool gap = t + 600000 > wrap && t < wrap + 300000;
+    if (!gap) {
+      float temp = t < wrap ? 50.0f : 10.0f + (t / 1000 % 7) * 0.25f;
+      p.pushDht(temp, 45.0f, ms);
+      ref.push_back({ t, p.aggregates().temp.last });
+    }
+    p.tick(ms);
+    if ((t - start) % 60000) continue;
+    const ChannelStats &c = p.aggregates().temp;
+    WindowStat e1m = rollRefStat(ref, t, 1000, 60), e1h = rollRefStat(ref, t, 60000, 60),
+               e24h = rollRefStat(ref, t, 900000, 96);
+    checks++;
+    if (rollSame(c.w1m, e1m) && rollSame(c.w1h, e1h) && rollSame(c.w24h, e24h)) continue;
+    if (bad++ < 3)
+      printf("  millis=%lu: 1m n=%lu mean=%ld (want %lu/%ld) 1h n=%lu (want %lu) 24h n=%lu (want %lu)\n",
+             (unsigned long)ms, (unsigned long)c.w1m.count, (long)c.w1m.mean, (unsigned long)e1m.count,
+             (long)e1m.mean, (unsigned long)c.w1h.count, (unsigned long)e1h.count, (unsigned long)c.w24h.count,
+             (unsigned long)e24h.count);
+  }
+  printf("millis() wrap: %u checks over 26 h, %u mismatches -> %s\n", checks, bad, bad ? "MISMATCH" : "OK");
+
+  // 固件一轮调度里 CO2 帧取的是处理时的 millis()，随后的 DHT/tick 用的是本轮开始时的 now：
+  // 每秒边界前 1 ms 开始的一轮，帧落在新桶，DHT 样本与 tick 落在上一桶。
+  // 略早的样本记入当前桶，参考统计按"截至此刻见过的最新时间"归桶
+  static ChannelRolling r;
+  ref.clear();
+  uint64_t seen = 0;
+  auto pushLate = [&](uint64_t t, int32_t v) {
+    r.push(t, v);
+    if (t > seen) seen = t;
+    ref.push_back({ seen, v });
+  };
+  checks = bad = 0;
+  for (uint64_t k = 1; k <= 7200; k++) {
+    uint64_t passStart = k * 1000 - 1;
+    pushLate(passStart + 1, (int32_t)(400 + k % 50));   // CO2 帧
+    pushLate(passStart, (int32_t)(2000 + k % 30));      // DHT
+    r.advance(passStart);
+    if (k % 60) continue;
+    WindowStat e1m = rollRefStat(ref, seen, 1000, 60), e1h = rollRefStat(ref, seen, 60000, 60);
+    checks++;
+    if (rollSame(r.w1m.stat(), e1m) && rollSame(r.w1h.stat(), e1h)) continue;
+    if (bad++ < 3)
+      printf("  t=%llu ms: 1m n=%lu (want %lu) 1h n=%lu (want %lu)\n", (unsigned long long)passStart,
+             (unsigned long)r.w1m.stat().count, (unsigned long)e1m.count, (unsigned long)r.w1h.stat().count,
+             (unsigned long)e1h.count);
+  }
+  printf("late samples at bucket edges: %u checks over 2 h, %u mismatches -> %s\n", checks, bad,
+         bad ? "MISMATCH" : "OK");
+}
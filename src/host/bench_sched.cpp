@@ -0,0 +1,89 @@
+// 调度器：虚拟时钟下模拟 24 小时固件任务，检查不早于到期执行、休眠时长精确、超时统计
+#include <stdlib.h>
+#include "bench.h"
+#include "task_scheduler.h"
+
+static uint32_t vNowMs = 0;
+static uint32_t vNowUs = 0;
+static uint32_t virtualMicros() { return vNowUs; }
+
+struct SimTask {
+  TaskScheduler *s;
+  int id;
+  uint32_t costMs;     // 模拟执行耗时（推进虚拟时钟）
+  uint32_t runs = 0;
+  uint32_t early = 0;  // 早于到期执行的次数（应为 0）
+};
+
+static void simRun(void *ctx, uint32_t now) {
+  SimTask *t = (SimTask *)ctx;
+  if ((int32_t)(now - t->s->nextDue(t->id)) < 0) t->early++;
+  t->runs++;
+  vNowUs += t->costMs * 1000;
+}
+
+// 暴力求最近到期时间，用于校验 msUntilNext
+static uint32_t bruteUntilNext(const TaskScheduler &s, const SimTask *tasks, int n, uint32_t now) {
+  uint32_t best = UINT32_MAX;
+  for (int i = 0; i < n; i++) {
+    if (!s.active(tasks[i].id)) continue;
+    int32_t d = (int32_t)(s.nextDue(tasks[i].id) - now);
+    uint32_t v = d > 0 ? (uint32_t)d : 0;
+    if (v < best) best = v;
+  }
+  return best;
+}
+
+void benchSched() {
+  printf("== sched ==\n");
+  TaskScheduler s(virtualMicros);
+  // 与 main.cpp 相同的任务组合，另加一个偶发 150 ms 卡顿的任务制造超时
+  struct { const char *name; uint32_t period, phase, cost; } spec[] = {
+    { "uart", 20, 0, 0 }, { "sensors", 1000, 0, 3 }, { "render", 1000, 5, 12 },
+    { "heartbeat", 2000, 0, 0 }, { "timing", 10000, 0, 0 }, { "stall", 3600000, 1800000, 150 },
+  };
+  const int n = sizeof(spec) / sizeof(spec[0]);
+  SimTask tasks[n];
+  vNowMs = 0xFFFF0000u;   // 起点靠近 32 位回绕，验证回绕处理
+  uint32_t start = vNowMs;
+  for (int i = 0; i < n; i++) {
+    tasks[i].s = &s;
+    tasks[i].costMs = spec[i].cost;
+    tasks[i].id = s.addPeriodic(spec[i].name, spec[i].period, simRun, &tasks[i], vNowMs, spec[i].phase);
+  }
+
+  const uint32_t simMs = 24u * 3600 * 1000;
+  srand(3);
+  uint64_t iters = 0, budgetErrors = 0, sleptMs = 0, busyMs = 0, ns = 0;
+  while (vNowMs - start < simMs) {
+    vNowUs = vNowMs * 1000;
+    uint64_t t0 = benchNowNs();
+    s.runDue(vNowMs);
+    ns += benchNowNs() - t0;
+    uint32_t spent = (vNowUs - vNowMs * 1000) / 1000;
+    busyMs += spent;
+    vNowMs += spent;
+    t0 = benchNowNs();
+    uint32_t budget = s.msUntilNext(vNowMs);
+    ns += benchNowNs() - t0;
+    if (budget != bruteUntilNext(s, tasks, n, vNowMs)) budgetErrors++;
+    // 睡满预算，偶尔晚醒 0~3 ms（中断唤醒延迟）
+    uint32_t wake = budget + (rand() % 8 == 0 ? rand() % 4 : 0);
+    if (!wake) wake = 1;
+    sleptMs += budget;
+    vNowMs += wake;
+    iters++;
+  }
+  benchReport("runDue+msUntilNext", iters, ns);
+
+  bool ok = budgetErrors == 0;
+  printf("%-10s %8s %8s %8s %8s %10s\n", "task", "runs", "expect", "misses", "skipped", "maxLateMs");
+  for (int i = 0; i < n; i++) {
+    const SchedTaskStats &st = s.stats(tasks[i].id);
+    uint32_t expect = (simMs - spec[i].phase + spec[i].period - 1) / spec[i].period;
+    printf("%-10s %8u %8u %8u %8u %10u\n", spec[i].name, st.runs, expect, st.misses, st.skipped, st.maxLateMs);
+    ok = ok && tasks[i].early == 0 && st.runs + st.skipped >= expect - 1 && st.runs + st.skipped <= expect + 1;
+  }
+  printf("idle %.2f%% of %u s, busy %.2f%%, budget mismatches=%llu -> %s\n", sleptMs * 100.0 / simMs, simMs / 1000,
+         busyMs * 100.0 / simMs, (unsigned long long)budgetErrors, ok ? "OK" : "MISMATCH");
+}
@@ -0,0 +1,80 @@
+// 二进制遥测流：COBS 往返、混入文本时的帧恢复、每秒串口字节数对比文本日志
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+#include "bench.h"
+#include "telemetry_stream.h"
+
+void benchTlm() {
+  printf("== tlm ==\n");
+
+  // COBS 往返：随机长度与零字节密度，覆盖 254 字节长块边界
+  srand(11);
+  uint64_t cobsBytes = 0, cobsEnc = 0;
+  bool cobsOk = true;
+  uint64_t dt = 0;
+  for (int iter = 0; iter < 200000 && cobsOk; iter++) {
+    uint8_t in[600], enc[620], dec[600];
+    size_t n = (size_t)(rand() % 600);
+    int zeroPct = rand() % 4 == 0 ? 0 : rand() % 30;
+    for (size_t i = 0; i < n; i++) in[i] = (rand() % 100 < zeroPct) ? 0 : (uint8_t)(1 + rand() % 255);
+    uint64_t t0 = benchNowNs();
+    size_t e = cobsEncode(in, n, enc);
+    size_t d = cobsDecode(enc, e, dec, sizeof(dec));
+    dt += benchNowNs() - t0;
+    cobsOk = e <= n + n / 254 + 1 && !memchr(enc, 0, e) && d == n && !memcmp(in, dec, n);
+    cobsBytes += n;
+    cobsEnc += e;
+  }
+  benchReport("cobs encode+decode (bytes)", cobsBytes, dt);
+  printf("cobs roundtrip %s, overhead %.2f%%\n", cobsOk ? "OK" : "MISMATCH", (cobsEnc - cobsBytes) * 100.0 / cobsBytes);
+
+  // 模拟一小时设备输出：每秒 1 条样本 + 1 条原始帧，每 10 秒 1 条耗时统计，穿插文本行与偶发误码
+  TelemetryStream ts;
+  std::vector<uint8_t> wire;
+  uint8_t out[TLM_MAX_FRAME];
+  uint32_t sent = 0, corrupted = 0;
+  for (uint32_t s = 0; s < 3600; s++) {
+    TlmRawFrame rf = { s * 1000, { 0x42, 0x4D, 0, 0, 0, 0, 0x02, 0x6C } };
+    TlmSample smp = { s * 1000 + 5, (uint16_t)(620 + s % 7), (int16_t)2350, (uint16_t)4810, 618, 7 };
+    size_t n = ts.frame(TLM_RAW_FRAME, &rf, sizeof(rf), out);
+    wire.insert(wire.end(), out, out + n); sent++;
+    n = ts.frame(TLM_SAMPLE, &smp, sizeof(smp), out);
+    if (s % 500 == 250) { out[n / 2] ^= 0x10; corrupted++; }   // 偶发误码
+    wire.insert(wire.end(), out, out + n); sent++;
+    if (s % 10 == 0) {
+      TlmTiming tt = { s * 1000, 9000, 1200, 85, s, 0, 0, 0 };
+      n = ts.frame(TLM_TIMING, &tt, sizeof(tt), out);
+      wire.insert(wire.end(), out, out + n); sent++;
+    }
+    if (s % 60 == 0) {
+      const char *txt = "DHT read -> t=nan h=nan (NaN)\n";
+      wire.insert(wire.end(), txt, txt + strlen(txt));
+    }
+  }
+  size_t binBytes = wire.size();
+  static TelemetryDeframer dfr;
+  TlmRecord r;
+  uint32_t got = 0;
+  uint64_t t0 = benchNowNs();
+  for (uint8_t b : wire) {
+    if (dfr.push(b, r)) got++;
+  }
+  dt = benchNowNs() - t0;
+  benchReport("deframe (bytes)", binBytes, dt);
+  const TlmDeframerStats &st = dfr.stats();
+  printf("records sent=%u decoded=%u corrupted=%u lost(by seq)=%llu text segments=%llu -> %s\n", sent, got, corrupted,
+         (unsigned long long)st.lostRecords, (unsigned long long)(st.badFrames - corrupted),
+         (got + corrupted == sent && st.lostRecords == corrupted) ? "OK" : "MISMATCH");
+
+  // 同样一秒的信息用文本日志表示（031 之前 loop() 的输出）
+  const char *textSecond =
+      "CO2 frame: 42 4D 00 00 00 00 02 6C 00 00 00 00 00 00 00 FD  -> CO2=620 filtered=620\n"
+      "CO2 value: 620\n"
+      "DHT read -> t=23.50 h=48.10\n"
+      "Using values -> Temp=23.50 Hum=48.10 CO2 1m/1h/24h mean=618/615/640 rejected co2=0 dht=0\n"
+      "Heartbeat @123456\n";
+  double textPerSec = strlen(textSecond) - strlen("Heartbeat @123456\n") / 2.0;
+  double binPerSec = (double)binBytes / 3600;
+  printf("serial bytes/s: text %.0f, binary %.1f (%.1fx less)\n", textPerSec, binPerSec, textPerSec / binPerSec);
+}
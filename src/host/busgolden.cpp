@@ -0,0 +1,255 @@
+// 显示总线黄金预算：典型画面切换（开机、CO2 450->451、999->1000、温度变号、跨日……）经 initDisplayLayout/updateDisplay
+// -> ST7789_AVR -> 虚拟面板，记录每个场景的 SPI 字节、地址窗口与最终画面哈希，与仓库里的 bus_golden.txt 对比。
+// 同时检查位级更新后的画面与同一读数冷启动重画一致、抗锯齿文字不比不透明文字多花总线字节。字节或窗口超出预算容差、画面哈希变化即失败（退出码 1）；
+// 有意的改动用 --update 重写预算后随代码一起提交。
+// 用法：busgolden [--golden FILE] [--tolerance PCT] [--update] [--shots DIR] [--verbose]
+#include <Arduino.h>
+#include <SPI.h>
+#include <ST7789_AVR.h>
+#include <VirtualPanel.h>
+#include <vector>
+#include "display_helper.h"
+
+// 与 main.cpp 相同的引脚、字号与显示全局量
+#define PIN_DC   16
+#define PIN_RST  5
+#define PIN_CS   17
+
+#define BUS_GOLDEN_DEFAULT "src/host/bus_golden.txt"
+
+ST7789_AVR tft(PIN_DC, PIN_RST, PIN_CS);
+uint8_t gFirstLineSize = 3;
+uint8_t gOtherLineSize = 3;
+bool layoutInited = false;
+DisplayState displayState;
+
+static VirtualPanel panel;
+
+struct BusReading {
+  const char *date;   // YYYY-MM-DD
+  uint32_t co2;
+  float temp, hum;
+};
+
+// from 先画好（不计入），只测量切到 to 的这一次 updateDisplay；boot 场景从冷启动开始整段计入。
+// aa：抗锯齿数字（displayAaText），aa_ 开头的场景另外要求总线字节不超过去掉前缀的不透明版本
+struct BusScenario {
+  const char *name;
+  bool boot, aa;
+  BusReading from, to;
+};
+
+static const BusScenario kScenarios[] = {
+  { "boot",               true,  false, { nullptr, 0, 0, 0 },                { "2026-03-14", 450, 21.5f, 45.0f } },
+  { "idle",               false, false, { "2026-03-14", 450, 21.5f, 45.0f },  { "2026-03-14", 450, 21.5f, 45.0f } },
+  { "co2_450_451",        false, false, { "2026-03-14", 450, 21.5f, 45.0f },  { "2026-03-14", 451, 21.5f, 45.0f } },
+  { "co2_999_1000",       false, false, { "2026-03-14", 999, 21.5f, 45.0f },  { "2026-03-14", 1000, 21.5f, 45.0f } },
+  { "co2_1000_999",       false, false, { "2026-03-14", 1000, 21.5f, 45.0f }, { "2026-03-14", 999, 21.5f, 45.0f } },
+  { "temp_sign",          false, false, { "2026-01-09", 620, 0.4f, 80.0f },   { "2026-01-09", 620, -0.3f, 80.0f } },
+  { "temp_9.9_10.0",      false, false, { "2026-03-14", 450, 9.9f, 45.0f },   { "2026-03-14", 450, 10.0f, 45.0f } },
+  { "all_rows",           false, false, { "2026-03-14", 450, 21.5f, 45.0f },  { "2026-03-14", 812, 23.7f, 51.2f } },
+  { "date_rollover",      false, false, { "2026-03-14", 450, 21.5f, 45.0f },  { "2026-03-15", 450, 21.5f, 45.0f } },
+  { "date_month_year",    false, false, { "2026-12-31", 450, 21.5f, 45.0f },  { "2027-01-01", 450, 21.5f, 45.0f } },
+  // CO2 告警横幅：出现、横幅下湿度变化（只重合成变化的列）、回差以下撤掉
+  { "alert_on",           false, false, { "2026-03-14", 1450, 21.5f, 45.0f }, { "2026-03-14", 1520, 21.5f, 45.0f } },
+  { "alert_hum",          false, false, { "2026-03-14", 1600, 21.5f, 45.0f }, { "2026-03-14", 1600, 21.5f, 45.3f } },
+  { "alert_off",          false, false, { "2026-03-14", 1520, 21.5f, 45.0f }, { "2026-03-14", 1380, 21.5f, 45.0f } },
+  { "aa_boot",            true,  true,  { nullptr, 0, 0, 0 },                { "2026-03-14", 450, 21.5f, 45.0f } },
+  { "aa_co2_450_451",     false, true,  { "2026-03-14", 450, 21.5f, 45.0f },  { "2026-03-14", 451, 21.5f, 45.0f } },
+  { "aa_co2_999_1000",    false, true,  { "2026-03-14", 999, 21.5f, 45.0f },  { "2026-03-14", 1000, 21.5f, 45.0f } },
+  { "aa_co2_1000_999",    false, true,  { "2026-03-14", 1000, 21.5f, 45.0f }, { "2026-03-14", 999, 21.5f, 45.0f } },
+  { "aa_temp_sign",       false, true,  { "2026-01-09", 620, 0.4f, 80.0f },   { "2026-01-09", 620, -0.3f, 80.0f } },
+  { "aa_all_rows",        false, true,  { "2026-03-14", 450, 21.5f, 45.0f },  { "2026-03-14", 812, 23.7f, 51.2f } },
+  { "aa_date_rollover",   false, true,  { "2026-03-14", 450, 21.5f, 45.0f },  { "2026-03-15", 450, 21.5f, 45.0f } },
+  { "aa_date_month_year", false, true,  { "2026-12-31", 450, 21.5f, 45.0f },  { "2027-01-01", 450, 21.5f, 45.0f } },
+  { "aa_alert_hum",       false, true,  { "2026-03-14", 1600, 21.5f, 45.0f }, { "2026-03-14", 1600, 21.5f, 45.3f } },
+};
+
+struct BusResult {
+  char name[32];
+  uint64_t bytes = 0, windows = 0, transactions = 0;
+  uint32_t hash = 0;
+  bool driverMatch = true;   // 驱动统计与面板看到的总线流量一致
+  bool coldMatch = true;     // 位级更新后的画面与同一读数冷启动整屏重画一致
+};
+
+// 面板可见区域在地址空间中的位置（172x320，旋转 3）
+static void visibleRect(uint16_t &x0, uint16_t &y0, uint16_t &w, uint16_t &h) {
+  x0 = 0; y0 = 34; w = tft.width(); h = tft.height();
+}
+
+static int32_t dayOf(const char *date) {
+  int32_t d = 0;
+  if (!wallParseDate(date, d)) {
+    fprintf(stderr, "bad scenario date %s\n", date);
+    exit(2);
+  }
+  return d;
+}
+
+static void show(const BusReading &r) {
+  updateDisplay(dayOf(r.date), r.co2, r.temp, r.hum);
+}
+
+// 与 setup() 中的显示初始化一致
+static void bootDisplay(int32_t day) {
+  layoutInited = false;
+  displayState = DisplayState();
+  tft.init(172, 320);
+  tft.setRotation(3);
+  initDisplayLayout(day);
+}
+
+static BusResult runScenario(const BusScenario &s, const char *shotDir) {
+  BusResult r;
+  snprintf(r.name, sizeof(r.name), "%s", s.name);
+  displayAaText() = s.aa;
+  panel.reset();
+  hostSetMicros(0);
+  tft.resetRenderStats();
+  if (!s.boot) {
+    bootDisplay(dayOf(s.from.date));
+    show(s.from);
+    panel.resetStats();
+    tft.resetRenderStats();
+  } else {
+    bootDisplay(dayOf(s.to.date));
+  }
+  show(s.to);
+
+  const VirtualPanelStats &ps = panel.stats();
+  const ST7789Cost &ds = tft.renderStats().total;
+  r.bytes = ps.bytes;
+  r.windows = ps.windows;
+  r.transactions = ps.transactions;
+  r.driverMatch = ds.bytes == ps.bytes && ds.windows == ps.windows && ds.transactions == ps.transactions;
+  uint16_t x0, y0, w, h;
+  visibleRect(x0, y0, w, h);
+  r.hash = panel.hash(x0, y0, w, h);
+  if (shotDir) {
+    char path[512];
+    snprintf(path, sizeof(path), "%s/%s.ppm", shotDir, s.name);
+    panel.savePpm(path, x0, y0, w, h);
+  }
+  if (!s.boot) {
+    panel.reset();
+    bootDisplay(dayOf(s.to.date));
+    show(s.to);
+    r.coldMatch = panel.hash(x0, y0, w, h) == r.hash;
+  }
+  displayAaText() = false;
+  return r;
+}
+
+// 每行 "name bytes windows transactions hash"，# 开头为注释
+static bool loadGolden(const char *path, std::vector<BusResult> &out) {
+  FILE *f = fopen(path, "r");
+  if (!f) return false;
+  char line[256];
+  while (fgets(line, sizeof(line), f)) {
+    if (line[0] == '#' || line[0] == '\n') continue;
+    BusResult g;
+    unsigned long long b, w, t;
+    unsigned h;
+    if (sscanf(line, "%31s %llu %llu %llu %x", g.name, &b, &w, &t, &h) == 5) {
+      g.bytes = b; g.windows = w; g.transactions = t; g.hash = h;
+      out.push_back(g);
+    }
+  }
+  fclose(f);
+  return true;
+}
+
+static bool saveGolden(const char *path, const std::vector<BusResult> &res) {
+  FILE *f = fopen(path, "w");
+  if (!f) { perror(path); return false; }
+  fprintf(f, "# 显示总线黄金预算（busgolden --update 生成）：场景 总线字节 地址窗口 事务数 画面哈希\n");
+  fprintf(f, "# 字节/窗口超出预算容差或哈希变化时 busgolden 失败；有意的改动重新生成后随代码一起提交\n");
+  for (const BusResult &r : res)
+    fprintf(f, "%-18s %8llu %6llu %6llu %08x\n", r.name, (unsigned long long)r.bytes, (unsigned long long)r.windows,
+            (unsigned long long)r.transactions, r.hash);
+  fclose(f);
+  return true;
+}
+
+static bool overBudget(uint64_t got, uint64_t budget, double tolPct) {
+  return (double)got > (double)budget * (1.0 + tolPct / 100.0);
+}
+
+int main(int argc, char **argv) {
+  const char *goldenPath = BUS_GOLDEN_DEFAULT, *shotDir = nullptr;
+  double tolPct = 2.0;
+  bool update = false, verbose = false;
+  for (int i = 1; i < argc; i++) {
+    if (!strcmp(argv[i], "--golden") && i + 1 < argc) goldenPath = argv[++i];
+    else if (!strcmp(argv[i], "--tolerance") && i + 1 < argc) tolPct = atof(argv[++i]);
+    else if (!strcmp(argv[i], "--shots") && i + 1 < argc) shotDir = argv[++i];
+    else if (!strcmp(argv[i], "--update")) update = true;
+    else if (!strcmp(argv[i], "--verbose")) verbose = true;
+    else {
+      fprintf(stderr, "usage: %s [--golden FILE] [--tolerance PCT] [--update] [--shots DIR] [--verbose]\n", argv[0]);
+      return 2;
+    }
+  }
+
+  hostSerialQuiet(!verbose);
+  hostAttachPanel(&panel, PIN_DC, PIN_CS);
+  std::vector<BusResult> res;
+  for (const BusScenario &s : kScenarios) res.push_back(runScenario(s, shotDir));
+
+  if (update) {
+    if (!saveGolden(goldenPath, res)) return 1;
+    printf("wrote %zu scenarios to %s\n", res.size(), goldenPath);
+    return 0;
+  }
+
+  std::vector<BusResult> golden;
+  if (!loadGolden(goldenPath, golden)) {
+    perror(goldenPath);
+    fprintf(stderr, "run with --update to create it\n");
+    return 2;
+  }
+  printf("golden %s, tolerance %.1f%%\n", goldenPath, tolPct);
+  printf("%-18s %9s %9s %7s %7s %8s  %s\n", "scenario", "bytes", "budget", "windows", "budget", "hash", "");
+  int failures = 0;
+  for (const BusResult &r : res) {
+    const BusResult *g = nullptr;
+    for (const BusResult &e : golden)
+      if (!strcmp(e.name, r.name)) g = &e;
+    char status[160] = "";
+    size_t k = 0;
+    auto note = [&](const char *s) { if (k < sizeof(status)) k += snprintf(status + k, sizeof(status) - k, "%s%s", k ? ", " : "", s); };
+    if (!r.driverMatch) note("DRIVER/BUS MISMATCH");
+    if (!r.coldMatch) note("DIFFERS FROM COLD REDRAW");
+    if (!strncmp(r.name, "aa_", 3)) {
+      for (const BusResult &o : res)
+        if (!strcmp(o.name, r.name + 3) && r.bytes > o.bytes) note("AA COSTS MORE THAN OPAQUE");
+    }
+    if (!g) {
+      note("NO GOLDEN");
+    } else {
+      if (overBudget(r.bytes, g->bytes, tolPct)) note("BYTES OVER BUDGET");
+      if (overBudget(r.windows, g->windows, tolPct)) note("WINDOWS OVER BUDGET");
+      if (r.hash != g->hash) note("FRAME CHANGED");
+    }
+    bool bad = k > 0;
+    // 明显低于预算只提示，便于把省下的字节锁进预算
+    if (!bad && g && r.bytes < g->bytes && overBudget(g->bytes, r.bytes, tolPct)) note("under budget, consider --update");
+    if (bad) failures++;
+    if (g)
+      printf("%-18s %9llu %9llu %7llu %7llu %08x  %s\n", r.name, (unsigned long long)r.bytes,
+             (unsigned long long)g->bytes, (unsigned long long)r.windows, (unsigned long long)g->windows, r.hash,
+             k ? status : "ok");
+    else
+      printf("%-18s %9llu %9s %7llu %7s %08x  %s\n", r.name, (unsigned long long)r.bytes, "-",
+             (unsigned long long)r.windows, "-", r.hash, status);
+  }
+  for (const BusResult &g : golden) {
+    bool found = false;
+    for (const BusResult &r : res) found |= !strcmp(r.name, g.name);
+    if (!found) printf("%-18s %9s %9llu %7s %7llu %8s  removed from tool\n", g.name, "-", (unsigned long long)g.bytes,
+                       "-", (unsigned long long)g.windows, "-");
+  }
+  printf("%s\n", failures ? "FAIL" : "OK");
+  return failures ? 1 : 0;
+}
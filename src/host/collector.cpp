@@ -0,0 +1,347 @@
+// 楼宇级遥测收集器与负载发生器（Linux）
+// 收集：collector [--udp PORT] [--tcp PORT[=ID]]... [--loopback] [--rx N] [--workers N] [--ring N]
+//                 [--report SEC] [--duration SEC] [--dump DEVICE]
+//   UDP 报文为 [设备 ID u32 小端][telemetry_stream 帧...]；TCP 为串口服务器转发的原始串口流
+//   --tcp   可重复，每路串口一个监听端口；ID 为该设备的 ID（缺省 0xF0000000 + 端口），与对端地址、重连无关
+//   --dump  退出时把该设备索引中的样本以 CSV 输出到 stdout
+// 压测：collector --loadgen [--host ADDR] [--udp PORT] [--devices N] [--rate HZ] [--batch K]
+//                 [--seconds S] [--threads N] [--loss PERMILLE]
+//   模拟 N 台设备各以 HZ 频率产生 TLM_SAMPLE，每 K 个样本打成一个 UDP 报文；--loss 按千分比模拟丢包
+// 自测：collector --bench [压测参数] [收集参数]：本进程内起收集器（回环、临时端口）再压测，报告吞吐、延迟分位与索引校验
+#include <signal.h>
+#include <stdlib.h>
+#include <algorithm>
+#include "fleet_collector.h"
+
+struct LoadGenConfig {
+  const char *host = "127.0.0.1";
+  uint16_t port = 47100;
+  uint32_t devices = 1000;
+  double rate = 1.0;         // 每台设备每秒样本数
+  uint32_t batch = 1;        // 每个报文的样本数（设备端攒批）
+  double seconds = 10.0;
+  uint32_t threads = 1;
+  uint32_t lossPermille = 0;
+};
+
+struct LoadGenResult {
+  uint64_t generated = 0, sent = 0, datagrams = 0, simLost = 0, sendErrors = 0;
+  double elapsed = 0;
+  std::vector<uint64_t> sentPerDevice;   // 按设备序号
+
+  void merge(const LoadGenResult &o) {
+    generated += o.generated;
+    sent += o.sent;
+    datagrams += o.datagrams;
+    simLost += o.simLost;
+    sendErrors += o.sendErrors;
+    sentPerDevice.insert(sentPerDevice.end(), o.sentPerDevice.begin(), o.sentPerDevice.end());
+  }
+};
+
+#define LOADGEN_SEND_BATCH 64
+#define LOADGEN_FRAME_MAX  (FLEET_PACKET_MAX / 24)   // 样本帧约 21 字节
+
+struct SimDevice {
+  uint32_t id;
+  TelemetryStream stream;
+  uint32_t ms;
+  uint16_t co2;
+  int16_t temp;
+  uint16_t hum;
+  uint64_t emitted;
+  uint8_t dgram[FLEET_DGRAM_HDR + FLEET_PACKET_MAX];
+  uint16_t len;
+  uint8_t pending;
+};
+
+static uint32_t lcg(uint32_t &s) { s = s * 1664525u + 1013904223u; return s >> 8; }
+
+static uint64_t nowUs() {
+  return (uint64_t)std::chrono::duration_cast<std::chrono::microseconds>(
+      std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static void loadGenThread(const LoadGenConfig &cfg, uint32_t first, uint32_t last, LoadGenResult &res) {
+  int fd = socket(AF_INET, SOCK_DGRAM, 0);
+  struct sockaddr_in a;
+  memset(&a, 0, sizeof(a));
+  a.sin_family = AF_INET;
+  a.sin_port = htons(cfg.port);
+  inet_pton(AF_INET, cfg.host, &a.sin_addr);
+  int sndBuf = 4 << 20;
+  setsockopt(fd, SOL_SOCKET, SO_SNDBUF, &sndBuf, sizeof(sndBuf));
+  if (connect(fd, (struct sockaddr *)&a, sizeof(a)) < 0) { perror("loadgen connect"); close(fd); return; }
+
+  uint32_t n = last - first, seed = 0xC0FFEEu ^ first;
+  std::vector<SimDevice> devs(n);
+  res.sentPerDevice.assign(n, 0);
+  for (uint32_t i = 0; i < n; i++) {
+    SimDevice &d = devs[i];
+    d.id = 0x10000u + first + i;
+    d.ms = lcg(seed) % 86400000u;   // 各设备开机时长不同
+    d.co2 = (uint16_t)(420 + lcg(seed) % 600);
+    d.temp = (int16_t)(2000 + lcg(seed) % 600);
+    d.hum = (uint16_t)(3500 + lcg(seed) % 2000);
+    d.emitted = 0;
+    for (int k = 0; k < 4; k++) d.dgram[k] = (uint8_t)(d.id >> (8 * k));
+    d.len = FLEET_DGRAM_HDR;
+    d.pending = 0;
+  }
+
+  struct mmsghdr msgs[LOADGEN_SEND_BATCH];
+  struct iovec iov[LOADGEN_SEND_BATCH];
+  uint32_t queued = 0;
+  auto flush = [&]() {
+    uint32_t off = 0;
+    while (off < queued) {
+      int r = sendmmsg(fd, msgs + off, queued - off, 0);
+      if (r < 0) {
+        if (errno == ENOBUFS || errno == EAGAIN) { std::this_thread::yield(); continue; }
+        res.sendErrors += queued - off;
+        break;
+      }
+      off += (uint32_t)r;
+    }
+    queued = 0;
+  };
+  auto send = [&](SimDevice &d, uint32_t i) {
+    if (cfg.lossPermille && lcg(seed) % 1000 < cfg.lossPermille) {
+      res.simLost += d.pending;
+    } else {
+      iov[queued].iov_base = d.dgram;
+      iov[queued].iov_len = d.len;
+      memset(&msgs[queued], 0, sizeof(msgs[queued]));
+      msgs[queued].msg_hdr.msg_iov = &iov[queued];
+      msgs[queued].msg_hdr.msg_iovlen = 1;
+      queued++;
+      res.sent += d.pending;
+      res.sentPerDevice[i] += d.pending;
+      res.datagrams++;
+    }
+    d.pending = 0;
+    d.len = FLEET_DGRAM_HDR;
+  };
+
+  const uint32_t stepMs = (uint32_t)(1000.0 / cfg.rate);
+  const uint32_t batch = std::min<uint32_t>(std::max<uint32_t>(cfg.batch, 1), LOADGEN_FRAME_MAX);
+  const uint64_t t0 = nowUs();
+  for (;;) {
+    double el = (nowUs() - t0) / 1e6;
+    bool done = el >= cfg.seconds;
+    if (done) el = cfg.seconds;
+    for (uint32_t i = 0; i < n; i++) {
+      SimDevice &d = devs[i];
+      // 各设备相位均匀错开，避免所有设备同一时刻发包
+      uint64_t target = (uint64_t)(el * cfg.rate + (double)(first + i) / cfg.devices);
+      while (d.emitted < target) {
+        TlmSample s;
+        d.ms += stepMs;
+        if (lcg(seed) % 8 == 0) d.co2 = (uint16_t)(d.co2 + (int)(lcg(seed) % 7) - 3);
+        if (lcg(seed) % 32 == 0) d.temp = (int16_t)(d.temp + (int)(lcg(seed) % 3) - 1);
+        s.ms = d.ms;
+        s.co2 = d.co2;
+        s.temp = d.temp;
+        s.hum = d.hum;
+        s.co2Mean1m = d.co2;
+        s.flags = TLM_SAMPLE_CO2_VALID | TLM_SAMPLE_TEMP_VALID | TLM_SAMPLE_HUM_VALID;
+        d.len = (uint16_t)(d.len + d.stream.frame(TLM_SAMPLE, &s, sizeof(s), d.dgram + d.len));
+        d.emitted++;
+        res.generated++;
+        if (++d.pending < batch) continue;
+        send(d, i);
+        // 报文直接引用设备缓冲，同一设备本轮还要再发时须先送出
+        if (queued == LOADGEN_SEND_BATCH || d.emitted < target) flush();
+      }
+      // 结束时把攒了一半的批次也发出去
+      if (done && d.pending) {
+        send(d, i);
+        if (queued == LOADGEN_SEND_BATCH) flush();
+      }
+    }
+    flush();
+    if (done) break;
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  close(fd);
+}
+
+static LoadGenResult runLoadGen(const LoadGenConfig &cfg) {
+  uint32_t nt = std::max<uint32_t>(1, std::min(cfg.threads, cfg.devices));
+  std::vector<LoadGenResult> parts(nt);
+  std::vector<std::thread> ts;
+  uint64_t t0 = nowUs();
+  for (uint32_t k = 0; k < nt; k++)
+    ts.emplace_back(loadGenThread, std::cref(cfg), cfg.devices * k / nt, cfg.devices * (k + 1) / nt, std::ref(parts[k]));
+  for (auto &t : ts) t.join();
+  LoadGenResult res;
+  for (auto &p : parts) res.merge(p);
+  res.elapsed = (nowUs() - t0) / 1e6;
+  return res;
+}
+
+static void printLoadGen(const LoadGenConfig &cfg, const LoadGenResult &r) {
+  printf("loadgen: %u devices x %.1f Hz, %u samples/datagram, %u threads, %.2f s\n", cfg.devices, cfg.rate, cfg.batch,
+         cfg.threads, r.elapsed);
+  printf("  generated %llu samples, sent %llu in %llu datagrams (%.0f samples/s), simulated loss %llu, send errors %llu\n",
+         (unsigned long long)r.generated, (unsigned long long)r.sent, (unsigned long long)r.datagrams,
+         r.elapsed > 0 ? r.sent / r.elapsed : 0.0, (unsigned long long)r.simLost, (unsigned long long)r.sendErrors);
+}
+
+static void printTotals(const char *tag, const FleetTotals &t, const FleetTotals *prev, double dt) {
+  printf("%s: devices=%u datagrams=%llu samples=%llu", tag, t.devices, (unsigned long long)t.datagrams,
+         (unsigned long long)t.samples);
+  if (prev && dt > 0) printf(" (%.0f/s)", (t.samples - prev->samples) / dt);
+  printf(" gaps=%llu lost=%llu bad=%llu ooo=%llu short=%llu qdrop=%llu lat p50<=%uus p99<=%uus p99.9<=%uus max=%uus\n",
+         (unsigned long long)t.seqGaps, (unsigned long long)t.lostRecords, (unsigned long long)t.badFrames,
+         (unsigned long long)t.outOfOrder, (unsigned long long)t.shortDgrams, (unsigned long long)t.queueDrops,
+         t.lat.percentile(500), t.lat.percentile(990), t.lat.percentile(999), t.lat.maxUs);
+}
+
+static void dumpDevice(FleetCollector &c, uint32_t device) {
+  std::vector<TelemetrySample> v;
+  c.query(device, 0, UINT32_MAX, v);
+  printf("# device,t,co2,temp_c,hum_pct\n");
+  for (const TelemetrySample &s : v) printf("%u,%u,%u,%.2f,%.2f\n", device, s.t, s.co2, s.temp / 100.0, s.hum / 100.0);
+}
+
+static volatile sig_atomic_t stopRequested = 0;
+static void onSignal(int) { stopRequested = 1; }
+
+// 本进程内压测：收集器绑定回环临时端口，负载发生器发完后等队列排空，再核对索引
+static int runBench(FleetConfig fc, LoadGenConfig lc) {
+  FleetCollector c;
+  fc.loopback = true;
+  fc.udpPort = 0;
+  if (!c.start(fc)) { perror("collector start"); return 1; }
+  lc.host = "127.0.0.1";
+  lc.port = c.udpPort();
+  printf("collector: udp %u, %u rx threads, %u workers, ring %u points/device\n", c.udpPort(), fc.rxThreads,
+         c.workers(), fc.ringPoints);
+
+  LoadGenResult r = runLoadGen(lc);
+  printLoadGen(lc, r);
+  uint64_t last = UINT64_MAX;
+  for (int i = 0; i < 100; i++) {
+    uint64_t now = c.totals().samples;
+    if (now == last) break;
+    last = now;
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  }
+
+  // 查询：随机设备最近 60 s
+  uint32_t seed = 7, t1 = (uint32_t)(fleetWallMs() / 1000);
+  std::vector<TelemetrySample> v;
+  const uint32_t nq = 20000;
+  uint64_t q0 = nowUs(), hits = 0;
+  for (uint32_t i = 0; i < nq; i++) {
+    v.clear();
+    hits += c.query(0x10000u + lcg(seed) % lc.devices, t1 - 60, t1, v);
+  }
+  double qUs = (double)(nowUs() - q0) / nq;
+
+  c.stop();
+  FleetTotals t = c.totals();
+  printTotals("collector", t, nullptr, 0);
+  printf("  ingest %.0f samples/s over the load window, query last 60 s: %.2f us/op (%.1f samples/op)\n",
+         r.elapsed > 0 ? t.samples / r.elapsed : 0.0, qUs, (double)hits / nq);
+
+  // 索引核对：每台设备写入数 = 发送数（无内核丢包时）；丢包只能少、不能多，且都应体现为序号缺口或报文丢失
+  uint32_t complete = 0, over = 0;
+  c.forEachDevice([&](const DeviceSeries &d) {
+    uint64_t sent = r.sentPerDevice[d.id - 0x10000u];
+    if (d.written() == sent) complete++;
+    if (d.written() > sent) over++;
+  });
+  uint64_t kernelDrops = r.datagrams - t.datagrams;
+  printf("  devices complete %u/%u, over-count %u, kernel drops %llu datagrams, queue drops %llu\n", complete,
+         lc.devices, over, (unsigned long long)kernelDrops, (unsigned long long)t.queueDrops);
+  bool ok = !over && t.samples + (kernelDrops + t.queueDrops) * lc.batch >= r.sent && t.samples <= r.sent &&
+            t.outOfOrder == 0 && t.badFrames == 0;
+  printf("fleet bench %s\n", ok ? "OK" : "MISMATCH");
+  return ok ? 0 : 1;
+}
+
+static void usage(const char *prog) {
+  fprintf(stderr,
+          "usage: %s [--udp PORT] [--tcp PORT[=ID]]... [--loopback] [--rx N] [--workers N] [--ring N] [--report SEC]\n"
+          "          [--duration SEC] [--dump DEVICE]\n"
+          "       %s --loadgen [--host ADDR] [--udp PORT] [--devices N] [--rate HZ] [--batch K] [--seconds S]\n"
+          "          [--threads N] [--loss PERMILLE]\n"
+          "       %s --bench [loadgen and collector options]\n",
+          prog, prog, prog);
+}
+
+int main(int argc, char **argv) {
+  FleetConfig fc;
+  LoadGenConfig lc;
+  bool loadgen = false, bench = false, haveDump = false;
+  double reportSec = 5, duration = 0;
+  uint32_t dumpId = 0;
+  for (int i = 1; i < argc; i++) {
+    const char *a = argv[i];
+    bool more = i + 1 < argc;
+    if (!strcmp(a, "--loadgen")) loadgen = true;
+    else if (!strcmp(a, "--bench")) bench = true;
+    else if (!strcmp(a, "--loopback")) fc.loopback = true;
+    else if (!strcmp(a, "--udp") && more) fc.udpPort = lc.port = (uint16_t)atoi(argv[++i]);
+    else if (!strcmp(a, "--tcp") && more) {
+      if (fc.tcpLines == FLEET_MAX_TCP) { fprintf(stderr, "at most %d --tcp ports\n", FLEET_MAX_TCP); return 2; }
+      char *end;
+      FleetTcpLine &l = fc.tcp[fc.tcpLines++];
+      l.port = (uint16_t)strtoul(argv[++i], &end, 10);
+      l.device = *end == '=' ? (uint32_t)strtoul(end + 1, nullptr, 0) : 0;
+    }
+    else if (!strcmp(a, "--rx") && more) fc.rxThreads = (uint32_t)atoi(argv[++i]);
+    else if (!strcmp(a, "--workers") && more) fc.workers = (uint32_t)atoi(argv[++i]);
+    else if (!strcmp(a, "--ring") && more) fc.ringPoints = (uint32_t)atoi(argv[++i]);
+    else if (!strcmp(a, "--report") && more) reportSec = atof(argv[++i]);
+    else if (!strcmp(a, "--duration") && more) duration = atof(argv[++i]);
+    else if (!strcmp(a, "--dump") && more) { dumpId = (uint32_t)strtoul(argv[++i], nullptr, 0); haveDump = true; }
+    else if (!strcmp(a, "--host") && more) lc.host = argv[++i];
+    else if (!strcmp(a, "--devices") && more) lc.devices = (uint32_t)atoi(argv[++i]);
+    else if (!strcmp(a, "--rate") && more) lc.rate = atof(argv[++i]);
+    else if (!strcmp(a, "--batch") && more) lc.batch = (uint32_t)atoi(argv[++i]);
+    else if (!strcmp(a, "--seconds") && more) lc.seconds = atof(argv[++i]);
+    else if (!strcmp(a, "--threads") && more) lc.threads = (uint32_t)atoi(argv[++i]);
+    else if (!strcmp(a, "--loss") && more) lc.lossPermille = (uint32_t)atoi(argv[++i]);
+    else { usage(argv[0]); return 2; }
+  }
+  if (!lc.devices || lc.rate <= 0 || lc.batch > LOADGEN_FRAME_MAX) {
+    fprintf(stderr, "need --devices > 0, --rate > 0 and --batch <= %d\n", LOADGEN_FRAME_MAX);
+    return 2;
+  }
+
+  if (bench) return runBench(fc, lc);
+  if (loadgen) {
+    LoadGenResult r = runLoadGen(lc);
+    printLoadGen(lc, r);
+    return 0;
+  }
+
+  FleetCollector c;
+  if (!c.start(fc)) { perror("collector start"); return 1; }
+  printf("collector: udp %u", c.udpPort());
+  for (const FleetTcpLine &l : c.tcpLines()) printf(", tcp %u -> device 0x%08x", l.port, l.device);
+  printf(", %u workers\n", c.workers());
+  fflush(stdout);
+  signal(SIGINT, onSignal);
+  signal(SIGTERM, onSignal);
+
+  uint64_t start = nowUs(), lastReport = start;
+  FleetTotals prev = c.totals();
+  while (!stopRequested && (duration <= 0 || (nowUs() - start) / 1e6 < duration)) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    uint64_t now = nowUs();
+    if ((now - lastReport) / 1e6 < reportSec) continue;
+    FleetTotals t = c.totals();
+    printTotals("collector", t, &prev, (now - lastReport) / 1e6);
+    fflush(stdout);
+    prev = t;
+    lastReport = now;
+  }
+  c.stop();
+  printTotals("collector final", c.totals(), nullptr, 0);
+  if (haveDump) dumpDevice(c, dumpId);
+  return 0;
+}
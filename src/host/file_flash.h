@@ -0,0 +1,96 @@
+// 文件模拟的 NOR 闪存（主机端），可在任意字节处模拟掉电，或让若干次写入只写一半并报错
+#ifndef HOST_FILE_FLASH_H
+#define HOST_FILE_FLASH_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include "flash_log.h"
+
+class FileFlash : public FlashDevice {
+ public:
+  // 打开（不存在则创建为全 0xFF）指定大小的镜像文件
+  bool open(const char *path, uint32_t bytes) {
+    close();
+    f = fopen(path, "r+b");
+    if (!f) {
+      f = fopen(path, "w+b");
+      if (!f) return false;
+      uint8_t ff[FLASH_LOG_SECTOR];
+      memset(ff, 0xFF, sizeof(ff));
+      for (uint32_t off = 0; off < bytes; off += sizeof(ff)) fwrite(ff, 1, sizeof(ff), f);
+      fflush(f);
+    }
+    cap = bytes;
+    dead = false;
+    cutAfter = UINT64_MAX;
+    return true;
+  }
+
+  void close() {
+    if (f) fclose(f);
+    f = nullptr;
+  }
+
+  ~FileFlash() { close(); }
+
+  uint32_t size() const override { return cap; }
+
+  bool read(uint32_t addr, void *dst, uint32_t len) override {
+    if (!f || dead || addr + len > cap) return false;
+    fseek(f, addr, SEEK_SET);
+    return fread(dst, 1, len, f) == len;
+  }
+
+  // NOR 写：新数据与原内容按位与；达到掉电点时只写入一部分并进入失效状态
+  bool write(uint32_t addr, const void *src, uint32_t len) override {
+    if (!f || dead || addr + len > cap) return false;
+    uint32_t n = len;
+    bool fail = failWrites > 0;
+    if (fail) { failWrites--; n = len / 2; }
+    if (written + n > cutAfter) { n = (uint32_t)(cutAfter - written); dead = true; }
+    uint8_t buf[FLASH_LOG_SECTOR];
+    const uint8_t *p = (const uint8_t *)src;
+    for (uint32_t done = 0; done < n;) {
+      uint32_t k = n - done < sizeof(buf) ? n - done : sizeof(buf);
+      fseek(f, addr + done, SEEK_SET);
+      if (fread(buf, 1, k, f) != k) return false;
+      for (uint32_t i = 0; i < k; i++) buf[i] &= p[done + i];
+      fseek(f, addr + done, SEEK_SET);
+      fwrite(buf, 1, k, f);
+      done += k;
+    }
+    written += n;
+    programmed += n;
+    return !dead && !fail;
+  }
+
+  bool eraseSector(uint32_t addr) override {
+    if (!f || dead || addr % FLASH_LOG_SECTOR || addr + FLASH_LOG_SECTOR > cap) return false;
+    uint8_t ff[FLASH_LOG_SECTOR];
+    memset(ff, 0xFF, sizeof(ff));
+    fseek(f, addr, SEEK_SET);
+    fwrite(ff, 1, sizeof(ff), f);
+    erases++;
+    return true;
+  }
+
+  // 再写入 bytes 字节后模拟掉电
+  void cutPowerAfter(uint64_t bytes) { cutAfter = written + bytes; }
+  bool powerLost() const { return dead; }
+  // 之后 n 次写入只编程前一半字节并返回失败（器件仍可用）
+  void failNextWrites(uint32_t n) { failWrites = n; }
+
+  uint64_t programmed = 0;   // 累计写入字节
+  uint64_t erases = 0;       // 累计擦除扇区数
+
+ private:
+  FILE *f = nullptr;
+  uint32_t cap = 0;
+  uint64_t written = 0;
+  uint64_t cutAfter = UINT64_MAX;
+  bool dead = false;
+  uint32_t failWrites = 0;
+};
+
+#endif // HOST_FILE_FLASH_H
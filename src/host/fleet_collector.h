@@ -0,0 +1,515 @@
+// 楼宇级遥测收集器（Linux 主机端）：UDP / 串口转 TCP 接收多台监测仪的二进制遥测流，
+// 按设备分片到工作线程（SPSC 无锁队列），用固件同一套 COBS/CRC 解帧代码解码，写入每设备环形时序索引
+#ifndef HOST_FLEET_COLLECTOR_H
+#define HOST_FLEET_COLLECTOR_H
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include "latency_hist.h"
+#include "spsc_queue.h"
+#include "telemetry_codec.h"
+#include "telemetry_stream.h"
+
+// UDP 报文：[设备 ID u32 小端][一个或多个完整 telemetry_stream 帧]
+// TCP（ser2net 等串口服务器）：原样的串口字节流，帧可跨读取边界。每路串口连到自己的监听端口，
+// 设备 ID 由监听端口决定（配置指定，缺省 FLEET_TCP_ID_BASE + 端口号），与对端地址和重连无关；
+// 同一端口上的新连接顶替旧连接（串口服务器重连时旧连接可能还未断开）
+#define FLEET_DGRAM_HDR     4
+#define FLEET_PACKET_MAX    480        // 单个报文/读取块的最大负载
+#define FLEET_QUEUE_DEPTH   1024       // 每个（接收线程, 工作线程）对一条队列
+#define FLEET_MAX_RX        8
+#define FLEET_MAX_WORKERS   16
+#define FLEET_RX_BATCH      32         // recvmmsg 一次最多取的报文数
+#define FLEET_REANCHOR_MS   30000      // 设备时间映射落后接收时间超过此值即重新锚定
+#define FLEET_MAX_TCP       32         // TCP 监听端口（串口）数
+#define FLEET_TCP_ID_BASE   0xF0000000u // 未指定 ID 的 TCP 端口：此值 + 端口号，避开 UDP 报文自带的 ID 段
+
+struct FleetPacket {
+  uint32_t device;
+  uint32_t rxUs;     // 接收时刻（latNowUs），用于接收到入索引的延迟
+  uint16_t len;
+  uint8_t data[FLEET_PACKET_MAX];
+};
+
+typedef SpscQueue<FleetPacket, FLEET_QUEUE_DEPTH> FleetQueue;
+
+// 设备 ID -> 工作线程；乘法散列打散连续编号的设备
+static inline uint32_t fleetShardOf(uint32_t device, uint32_t shards) {
+  return (uint32_t)(((uint64_t)(device * 0x9E3779B1u) * shards) >> 32);
+}
+
+static inline uint64_t fleetWallMs() {
+  return (uint64_t)std::chrono::duration_cast<std::chrono::milliseconds>(
+      std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+// 单设备：解帧状态 + 时间映射 + 环形缓冲（容量为 2 的幂，时间单调，可二分查找）
+class DeviceSeries {
+ public:
+  DeviceSeries(uint32_t id, uint32_t points) : id(id), ring(points) {}
+
+  // 返回是否写入（时间倒退的样本丢弃并计数）
+  bool append(const TelemetrySample &s) {
+    if (head && s.t < ring[(head - 1) & mask()].t) { outOfOrder++; return false; }
+    ring[head & mask()] = s;
+    head++;
+    return true;
+  }
+
+  // 设备 ms（开机计时）映射到墙上时间秒。首次、设备重启（ms 倒退）或映射落后接收时刻过多（设备停顿、
+  // 断线后时钟漂移）时以接收时刻重新锚定；映射超前（串口服务器成批补发积压）不回拨，保持时间单调
+  uint32_t mapTime(uint32_t ms, uint64_t rxWallMs) {
+    int64_t mapped = offsetMs + ms;
+    if (!anchored || ms < lastMs || mapped < (int64_t)rxWallMs - FLEET_REANCHOR_MS) {
+      if (anchored) reanchors++;
+      offsetMs = (int64_t)rxWallMs - ms;
+      mapped = (int64_t)rxWallMs;
+      anchored = true;
+    }
+    lastMs = ms;
+    return (uint32_t)(mapped / 1000);
+  }
+
+  uint32_t size() const { return head < ring.size() ? (uint32_t)head : (uint32_t)ring.size(); }
+  uint64_t written() const { return head; }
+  const TelemetrySample &at(uint32_t i) const { return ring[(head - size() + i) & mask()]; }   // 0 = 最早
+
+  // 第一个 t >= t0 的位置
+  uint32_t lowerBound(uint32_t t0) const {
+    uint32_t lo = 0, hi = size();
+    while (lo < hi) {
+      uint32_t mid = (lo + hi) / 2;
+      if (at(mid).t < t0) lo = mid + 1; else hi = mid;
+    }
+    return lo;
+  }
+
+  const uint32_t id;
+  TelemetryDeframer deframer;
+  TlmTiming lastTiming = {};
+  uint64_t checksumErrors = 0;
+  uint64_t outOfOrder = 0;
+  uint32_t reanchors = 0;
+
+ private:
+  uint64_t mask() const { return ring.size() - 1; }
+
+  std::vector<TelemetrySample> ring;
+  uint64_t head = 0;
+  int64_t offsetMs = 0;
+  uint32_t lastMs = 0;
+  bool anchored = false;
+};
+
+// 单写者计数器（与 LatencyHist 相同的 relaxed load+store），报告线程可随时读
+struct FleetCounter {
+  std::atomic<uint64_t> v{0};
+  void add(uint64_t n) { v.store(v.load(std::memory_order_relaxed) + n, std::memory_order_relaxed); }
+  uint64_t get() const { return v.load(std::memory_order_relaxed); }
+};
+
+struct FleetShardStats {
+  FleetCounter packets, bytes, records, samples, badFrames, seqGaps, lostRecords, outOfOrder;
+};
+
+// 多个工作线程的延迟直方图按桶相加后求分位数（分位数语义同 LatencyHist：桶上界，以 max 封顶）
+struct FleetLatency {
+  uint64_t buckets[LAT_HIST_BUCKETS] = {};
+  uint64_t n = 0;
+  uint32_t maxUs = 0;
+
+  void add(const LatencyHist &h) {
+    for (uint8_t b = 0; b < LAT_HIST_BUCKETS; b++) buckets[b] += h.bucket(b);
+    n += h.count();
+    if (h.max() > maxUs) maxUs = h.max();
+  }
+
+  uint32_t percentile(uint32_t q) const {
+    if (!n) return 0;
+    uint64_t rank = (n * q + 999) / 1000, acc = 0;
+    if (!rank) rank = 1;
+    for (uint8_t b = 0; b < LAT_HIST_BUCKETS; b++) {
+      acc += buckets[b];
+      if (acc >= rank) {
+        uint32_t up = LatencyHist::bucketUpper(b);
+        return up < maxUs ? up : maxUs;
+      }
+    }
+    return maxUs;
+  }
+};
+
+// 一个工作线程及其独占的设备分片；查询经分片互斥锁与写入串行（工作线程按批持锁，争用很少）
+class FleetShard {
+ public:
+  explicit FleetShard(uint32_t ringPoints) : ringPoints(ringPoints) {}
+
+  // 由工作线程调用：轮询所有输入队列，一批最多 batch 个报文
+  uint32_t drain(uint32_t batch) {
+    uint32_t got = 0;
+    uint64_t wallMs = 0;
+    std::lock_guard<std::mutex> g(mu);
+    for (FleetQueue *q : inputs) {
+      while (got < batch && q->pop(pkt)) {
+        if (!got) wallMs = fleetWallMs();
+        ingest(pkt, wallMs);
+        lat.since(pkt.rxUs);
+        got++;
+      }
+    }
+    return got;
+  }
+
+  DeviceSeries *find(uint32_t device) {
+    auto it = index.find(device);
+    return it == index.end() ? nullptr : devices[it->second].get();
+  }
+
+  std::vector<FleetQueue *> inputs;   // 启动前由收集器挂接，之后只读
+  std::vector<std::unique_ptr<DeviceSeries>> devices;
+  std::mutex mu;
+  FleetShardStats st;
+  LatencyHist lat{"ingest"};
+
+ private:
+  void ingest(const FleetPacket &p, uint64_t wallMs) {
+    DeviceSeries *d = find(p.device);
+    if (!d) {
+      index.emplace(p.device, (uint32_t)devices.size());
+      devices.emplace_back(new DeviceSeries(p.device, ringPoints));
+      d = devices.back().get();
+    }
+    TlmDeframerStats before = d->deframer.stats();
+    uint64_t ooo = d->outOfOrder, samples = 0;
+    TlmRecord r;
+    for (uint16_t i = 0; i < p.len; i++) {
+      if (!d->deframer.push(p.data[i], r)) continue;
+      d->deframer.clearBadSegment();
+      if (r.type == TLM_SAMPLE && r.len >= sizeof(TlmSample)) {
+        TlmSample s;
+        memcpy(&s, r.payload, sizeof(s));
+        TelemetrySample ts = { d->mapTime(s.ms, wallMs), s.co2, s.temp, s.hum };
+        if (d->append(ts)) samples++;
+      } else if (r.type == TLM_TIMING && r.len >= sizeof(TlmTiming)) {
+        memcpy(&d->lastTiming, r.payload, sizeof(TlmTiming));
+      } else if (r.type == TLM_CHECKSUM) {
+        d->checksumErrors++;
+      }
+    }
+    const TlmDeframerStats &after = d->deframer.stats();
+    st.packets.add(1);
+    st.bytes.add(p.len);
+    st.records.add(after.records - before.records);
+    st.samples.add(samples);
+    st.badFrames.add(after.badFrames - before.badFrames);
+    st.seqGaps.add(after.seqGaps - before.seqGaps);
+    st.lostRecords.add(after.lostRecords - before.lostRecords);
+    st.outOfOrder.add(d->outOfOrder - ooo);
+  }
+
+  const uint32_t ringPoints;
+  std::unordered_map<uint32_t, uint32_t> index;
+  FleetPacket pkt;   // 出队缓冲，避免 ~500 B 的栈拷贝
+};
+
+// 一个 TCP 监听端口对应一路串口、一台设备
+struct FleetTcpLine {
+  uint16_t port;                 // 0 = 临时端口（测试）
+  uint32_t device;               // 0 = FLEET_TCP_ID_BASE + 实际端口
+};
+
+struct FleetConfig {
+  uint16_t udpPort = 47100;
+  FleetTcpLine tcp[FLEET_MAX_TCP];
+  uint32_t tcpLines = 0;         // 0 = 不监听 TCP
+  bool loopback = false;         // 只绑定 127.0.0.1（测试、本机压测）
+  uint32_t rxThreads = 1;        // >1 时用 SO_REUSEPORT 由内核按四元组分流
+  uint32_t workers = 4;
+  uint32_t ringPoints = 1024;    // 每设备保留的样本数（向上取 2 的幂），1 Hz 时约 17 分钟
+  int rcvBufBytes = 8 << 20;
+};
+
+struct FleetRxStats {
+  FleetCounter datagrams, bytes, shortDgrams, queueDrops, tcpConnects;
+};
+
+struct FleetTotals {
+  uint64_t packets, bytes, records, samples, badFrames, seqGaps, lostRecords, outOfOrder;
+  uint64_t datagrams, shortDgrams, queueDrops, tcpConnects;
+  uint32_t devices;
+  FleetLatency lat;
+};
+
+class FleetCollector {
+ public:
+  ~FleetCollector() { stop(); }
+
+  bool start(const FleetConfig &c) {
+    cfg = c;
+    if (cfg.rxThreads < 1) cfg.rxThreads = 1;
+    if (cfg.rxThreads > FLEET_MAX_RX) cfg.rxThreads = FLEET_MAX_RX;
+    if (cfg.workers < 1) cfg.workers = 1;
+    if (cfg.workers > FLEET_MAX_WORKERS) cfg.workers = FLEET_MAX_WORKERS;
+    uint32_t pts = 1;
+    while (pts < cfg.ringPoints) pts <<= 1;
+    cfg.ringPoints = pts;
+
+    uint16_t port = cfg.udpPort;
+    for (uint32_t i = 0; i < cfg.rxThreads; i++) {
+      int fd = bindSocket(SOCK_DGRAM, port, cfg.rxThreads > 1);
+      if (fd < 0) { closeAll(); return false; }
+      port = boundPort(fd);   // 端口 0 时其余接收线程绑定到同一个临时端口
+      udpFds.push_back(fd);
+    }
+    udpBound = port;
+    if (cfg.tcpLines > FLEET_MAX_TCP) cfg.tcpLines = FLEET_MAX_TCP;
+    for (uint32_t i = 0; i < cfg.tcpLines; i++) {
+      int fd = bindSocket(SOCK_STREAM, cfg.tcp[i].port, false);
+      if (fd >= 0) tcpFds.push_back(fd);
+      if (fd < 0 || listen(fd, 4) < 0) { closeAll(); return false; }
+      FleetTcpLine line = { boundPort(fd), cfg.tcp[i].device };
+      if (!line.device) line.device = FLEET_TCP_ID_BASE + line.port;
+      tcpBound.push_back(line);
+    }
+
+    // 每个生产者（UDP 接收线程 + 可选的 TCP 线程）到每个工作线程一条 SPSC 队列
+    uint32_t producers = cfg.rxThreads + (tcpFds.empty() ? 0 : 1);
+    for (uint32_t w = 0; w < cfg.workers; w++) shards.emplace_back(new FleetShard(cfg.ringPoints));
+    for (uint32_t p = 0; p < producers; p++) {
+      for (uint32_t w = 0; w < cfg.workers; w++) {
+        queues.emplace_back(new FleetQueue());
+        shards[w]->inputs.push_back(queues.back().get());
+      }
+    }
+    rx.reset(new FleetRxStats[producers]);
+
+    working.store(true);
+    receiving.store(true);
+    for (uint32_t w = 0; w < cfg.workers; w++) workerThreads.emplace_back(&FleetCollector::workerLoop, this, w);
+    for (uint32_t i = 0; i < cfg.rxThreads; i++) rxThreads.emplace_back(&FleetCollector::udpLoop, this, i);
+    if (!tcpFds.empty()) rxThreads.emplace_back(&FleetCollector::tcpLoop, this, cfg.rxThreads);
+    return true;
+  }
+
+  // 先停接收，工作线程排空队列后再退出，已入队的报文不丢
+  void stop() {
+    if (!receiving.exchange(false)) return;
+    for (auto &t : rxThreads) t.join();
+    working.store(false);
+    for (auto &t : workerThreads) t.join();
+    rxThreads.clear();
+    workerThreads.clear();
+    closeAll();
+  }
+
+  uint16_t udpPort() const { return udpBound; }
+  // 实际监听的 TCP 端口及其设备 ID（端口 0 已换成临时端口，ID 0 已换成缺省值）
+  const std::vector<FleetTcpLine> &tcpLines() const { return tcpBound; }
+  uint32_t workers() const { return (uint32_t)shards.size(); }
+
+  // 取 [t0, t1] 内的样本（墙上时间秒），返回条数
+  size_t query(uint32_t device, uint32_t t0, uint32_t t1, std::vector<TelemetrySample> &out) {
+    FleetShard &s = *shards[fleetShardOf(device, workers())];
+    std::lock_guard<std::mutex> g(s.mu);
+    DeviceSeries *d = s.find(device);
+    if (!d) return 0;
+    size_t n0 = out.size();
+    for (uint32_t i = d->lowerBound(t0); i < d->size() && d->at(i).t <= t1; i++) out.push_back(d->at(i));
+    return out.size() - n0;
+  }
+
+  // 逐设备回调（持有所在分片的锁，回调内不要再调用 query）
+  template <typename Fn>
+  void forEachDevice(Fn fn) {
+    for (auto &s : shards) {
+      std::lock_guard<std::mutex> g(s->mu);
+      for (auto &d : s->devices) fn(*d);
+    }
+  }
+
+  FleetTotals totals() {
+    FleetTotals t = FleetTotals();
+    for (auto &s : shards) {
+      const FleetShardStats &st = s->st;
+      t.packets += st.packets.get();
+      t.bytes += st.bytes.get();
+      t.records += st.records.get();
+      t.samples += st.samples.get();
+      t.badFrames += st.badFrames.get();
+      t.seqGaps += st.seqGaps.get();
+      t.lostRecords += st.lostRecords.get();
+      t.outOfOrder += st.outOfOrder.get();
+      t.lat.add(s->lat);
+      std::lock_guard<std::mutex> g(s->mu);
+      t.devices += (uint32_t)s->devices.size();
+    }
+    uint32_t producers = cfg.rxThreads + (tcpBound.empty() ? 0 : 1);
+    for (uint32_t p = 0; p < producers; p++) {
+      t.datagrams += rx[p].datagrams.get();
+      t.shortDgrams += rx[p].shortDgrams.get();
+      t.queueDrops += rx[p].queueDrops.get();
+      t.tcpConnects += rx[p].tcpConnects.get();
+    }
+    return t;
+  }
+
+ private:
+  int bindSocket(int type, uint16_t port, bool reusePort) {
+    int fd = socket(AF_INET, type, 0);
+    if (fd < 0) return -1;
+    int one = 1;
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+    if (reusePort) setsockopt(fd, SOL_SOCKET, SO_REUSEPORT, &one, sizeof(one));
+    if (type == SOCK_DGRAM) setsockopt(fd, SOL_SOCKET, SO_RCVBUF, &cfg.rcvBufBytes, sizeof(cfg.rcvBufBytes));
+    struct sockaddr_in a;
+    memset(&a, 0, sizeof(a));
+    a.sin_family = AF_INET;
+    a.sin_port = htons(port);
+    a.sin_addr.s_addr = htonl(cfg.loopback ? INADDR_LOOPBACK : INADDR_ANY);
+    if (bind(fd, (struct sockaddr *)&a, sizeof(a)) < 0) { close(fd); return -1; }
+    fcntl(fd, F_SETFL, fcntl(fd, F_GETFL, 0) | O_NONBLOCK);
+    return fd;
+  }
+
+  static uint16_t boundPort(int fd) {
+    struct sockaddr_in a;
+    socklen_t len = sizeof(a);
+    getsockname(fd, (struct sockaddr *)&a, &len);
+    return ntohs(a.sin_port);
+  }
+
+  void closeAll() {
+    for (int fd : udpFds) close(fd);
+    udpFds.clear();
+    for (int fd : tcpFds) close(fd);
+    tcpFds.clear();
+  }
+
+  // 生产者 p 到工作线程 w 的队列
+  FleetQueue &queueOf(uint32_t p, uint32_t w) { return *queues[p * workers() + w]; }
+
+  void route(uint32_t p, uint32_t device, const uint8_t *data, size_t len, uint32_t rxUs) {
+    if (!queueOf(p, fleetShardOf(device, workers())).push(makePacket(device, data, len, rxUs))) rx[p].queueDrops.add(1);
+  }
+
+  static const FleetPacket &makePacket(uint32_t device, const uint8_t *data, size_t len, uint32_t rxUs) {
+    static thread_local FleetPacket p;
+    p.device = device;
+    p.rxUs = rxUs;
+    p.len = (uint16_t)len;
+    memcpy(p.data, data, len);
+    return p;
+  }
+
+  void udpLoop(uint32_t idx) {
+    int fd = udpFds[idx];
+    static const size_t kDgram = FLEET_DGRAM_HDR + FLEET_PACKET_MAX;
+    std::unique_ptr<uint8_t[]> bufs(new uint8_t[FLEET_RX_BATCH * kDgram]);
+    struct mmsghdr msgs[FLEET_RX_BATCH];
+    struct iovec iov[FLEET_RX_BATCH];
+    struct pollfd pfd = { fd, POLLIN, 0 };
+    while (receiving.load(std::memory_order_relaxed)) {
+      if (poll(&pfd, 1, 50) <= 0) continue;
+      memset(msgs, 0, sizeof(msgs));
+      for (uint32_t i = 0; i < FLEET_RX_BATCH; i++) {
+        iov[i].iov_base = bufs.get() + i * kDgram;
+        iov[i].iov_len = kDgram;
+        msgs[i].msg_hdr.msg_iov = &iov[i];
+        msgs[i].msg_hdr.msg_iovlen = 1;
+      }
+      int n = recvmmsg(fd, msgs, FLEET_RX_BATCH, MSG_DONTWAIT, nullptr);
+      if (n <= 0) continue;
+      uint32_t now = latNowUs();
+      for (int i = 0; i < n; i++) {
+        const uint8_t *b = bufs.get() + i * kDgram;
+        size_t len = msgs[i].msg_len;
+        rx[idx].datagrams.add(1);
+        rx[idx].bytes.add(len);
+        // 过长的报文被内核截断（MSG_TRUNC），只剩残帧，与过短的一并丢弃
+        if (len <= FLEET_DGRAM_HDR || (msgs[i].msg_hdr.msg_flags & MSG_TRUNC)) { rx[idx].shortDgrams.add(1); continue; }
+        uint32_t device = (uint32_t)b[0] | (uint32_t)b[1] << 8 | (uint32_t)b[2] << 16 | (uint32_t)b[3] << 24;
+        route(idx, device, b + FLEET_DGRAM_HDR, len - FLEET_DGRAM_HDR, now);
+      }
+    }
+  }
+
+  // fds 前 L 项为监听端口，其后是连接；line[i] 为连接所属的监听端口下标。连接断开即释放
+  void tcpLoop(uint32_t idx) {
+    const size_t L = tcpFds.size();
+    std::vector<struct pollfd> fds;
+    std::vector<size_t> line;
+    for (size_t k = 0; k < L; k++) {
+      fds.push_back(pollfd{ tcpFds[k], POLLIN, 0 });
+      line.push_back(k);
+    }
+    auto drop = [&](size_t i) {
+      close(fds[i].fd);
+      fds.erase(fds.begin() + i);
+      line.erase(line.begin() + i);
+    };
+    uint8_t buf[FLEET_PACKET_MAX];
+    while (receiving.load(std::memory_order_relaxed)) {
+      if (poll(fds.data(), fds.size(), 50) <= 0) continue;
+      uint32_t now = latNowUs();
+      for (size_t i = fds.size(); i-- > L;) {
+        if (!fds[i].revents) continue;
+        ssize_t r = recv(fds[i].fd, buf, sizeof(buf), MSG_DONTWAIT);
+        if (r > 0) { route(idx, tcpBound[line[i]].device, buf, (size_t)r, now); continue; }
+        if (r < 0 && (errno == EAGAIN || errno == EINTR)) continue;
+        drop(i);
+      }
+      for (size_t k = 0; k < L; k++) {
+        if (!(fds[k].revents & POLLIN)) continue;
+        int c = accept(tcpFds[k], nullptr, nullptr);
+        if (c < 0) continue;
+        for (size_t i = fds.size(); i-- > L;)
+          if (line[i] == k) drop(i);
+        fcntl(c, F_SETFL, fcntl(c, F_GETFL, 0) | O_NONBLOCK);
+        fds.push_back(pollfd{ c, POLLIN, 0 });
+        line.push_back(k);
+        rx[idx].tcpConnects.add(1);
+      }
+    }
+    for (size_t i = L; i < fds.size(); i++) close(fds[i].fd);
+  }
+
+  // 空闲时先让出 CPU 若干轮再短睡，兼顾延迟与空载功耗
+  void workerLoop(uint32_t w) {
+    FleetShard &s = *shards[w];
+    uint32_t idle = 0;
+    while (working.load(std::memory_order_relaxed)) {
+      if (s.drain(64)) { idle = 0; continue; }
+      if (++idle < 64) std::this_thread::yield();
+      else std::this_thread::sleep_for(std::chrono::microseconds(200));
+    }
+    while (s.drain(64)) {}
+  }
+
+  FleetConfig cfg;
+  std::vector<int> udpFds;
+  std::vector<int> tcpFds;
+  std::vector<FleetTcpLine> tcpBound;
+  uint16_t udpBound = 0;
+  std::vector<std::unique_ptr<FleetShard>> shards;
+  std::vector<std::unique_ptr<FleetQueue>> queues;
+  std::unique_ptr<FleetRxStats[]> rx;
+  std::vector<std::thread> rxThreads, workerThreads;
+  std::atomic<bool> receiving{false}, working{false};
+};
+
+#endif // HOST_FLEET_COLLECTOR_H
@@ -0,0 +1,524 @@
+// 样本日志离线分析（Linux/macOS）：mmap 闪存日志分区镜像（可多份、可整月拼接），多线程按段分块，
+// 输出每日 CO2 超标时长（>800/1000/1500 ppm）、温湿度分位数与传感器断档报告
+// 用法：loganalyze [--threads N] [--csv] [--epoch SEC] [--gap SEC] [--top N] image.bin...
+//   --epoch  日志时间 0 对应的墙上时间（秒），给出时按日期显示；日志时间是"上次最后时间 + 本次开机秒数"，
+//            不给时按日志日编号显示（合成数据的时间即墙上时间，用 --epoch 0）
+//   --gap    相邻样本间隔超过此值（默认 10 s）记为一次断档（三个传感器任一无效时设备不写日志）
+//   --csv    每日一行 CSV，否则为对齐的文本表
+// 合成数据：loganalyze --gen out.bin [--images N] [--days D]：N 份连续的 D 天分区镜像（每份 4 MB）
+// 基准：    loganalyze --bench image.bin...：线程数 1、2、4… 依次分析，报告吞吐、加速比并核对结果一致
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <map>
+#include <thread>
+#include <vector>
+#include "flash_log.h"
+#include "wall_clock.h"
+
+#define LA_THRESHOLDS     3
+#define LA_TEMP_MIN       (-4000)                    // 0.01 °C
+#define LA_TEMP_BINS      1251                       // -40.0 .. 85.0 °C，0.1 °C 一档
+#define LA_HUM_BINS       1001                       // 0 .. 100.0 %RH，0.1 % 一档
+#define LA_SCAN_CHUNK     256                        // 第一遍：每块扇区数（1 MB）
+#define LA_DECODE_CHUNK   128                        // 第二遍：每块段数
+#define LA_IMAGE_BYTES    (FLASH_LOG_MAX_SEGS * FLASH_LOG_SECTOR)
+
+static const uint16_t kThresholds[LA_THRESHOLDS] = { 800, 1000, 1500 };
+
+static uint64_t nowUs() {
+  return (uint64_t)std::chrono::duration_cast<std::chrono::microseconds>(
+      std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// ---- 输入：mmap 的镜像文件 ----
+struct MappedFile {
+  const char *path;
+  const uint8_t *data;
+  size_t size;
+};
+
+static bool mapFile(const char *path, MappedFile &m) {
+  int fd = open(path, O_RDONLY);
+  if (fd < 0) { perror(path); return false; }
+  struct stat st;
+  if (fstat(fd, &st) < 0 || st.st_size < FLASH_LOG_SECTOR) { fprintf(stderr, "%s: too small\n", path); close(fd); return false; }
+  void *p = mmap(nullptr, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (p == MAP_FAILED) { perror(path); return false; }
+  madvise(p, (size_t)st.st_size, MADV_SEQUENTIAL);
+  m = { path, (const uint8_t *)p, (size_t)st.st_size };
+  return true;
+}
+
+// ---- 第一遍：段头校验 + 记录头遍历（不做 CRC、不解码），得到每段的时间范围 ----
+struct LogSegment {
+  const uint8_t *base;
+  uint32_t seq;
+  uint32_t firstT, lastT;
+  uint32_t records;
+  uint32_t skipUntil;   // 排序去重后：本段中 t <= skipUntil 的样本已由前面的段给出（重叠的多份转储）
+};
+
+static bool scanSector(const uint8_t *p, LogSegment &s) {
+  FlashSegHdr h;
+  memcpy(&h, p, sizeof(h));
+  if (h.magic != FLASH_LOG_SEG_MAGIC || h.crc != modbus_calcuCRC(p, sizeof(h) - 2)) return false;
+  s.base = p;
+  s.seq = h.seq;
+  s.records = 0;
+  s.skipUntil = 0;
+  uint32_t off = sizeof(FlashSegHdr);
+  while (off + sizeof(FlashRecHdr) <= FLASH_LOG_SECTOR) {
+    FlashRecHdr r;
+    memcpy(&r, p + off, sizeof(r));
+    if (r.magic != FLASH_LOG_REC_MAGIC || r.len > FLASH_LOG_PAGE - sizeof(FlashRecHdr) ||
+        off + sizeof(FlashRecHdr) + r.len > FLASH_LOG_SECTOR)
+      break;
+    if (!s.records) s.firstT = r.firstT;
+    s.lastT = r.lastT;
+    s.records++;
+    off = (off + (uint32_t)sizeof(FlashRecHdr) + r.len + 3) & ~3u;
+  }
+  return s.records > 0;
+}
+
+// ---- 统计 ----
+struct DayStats {
+  uint64_t samples = 0;
+  uint64_t coveredSec = 0;               // 有数据的秒数（相邻样本间隔不超过 gap 的部分）
+  uint64_t aboveSec[LA_THRESHOLDS] = {};
+  uint64_t co2Sum = 0;
+  uint16_t co2Max = 0;
+  uint32_t dropouts = 0;
+  uint64_t dropoutSec = 0;
+  uint32_t temp[LA_TEMP_BINS] = {};
+  uint32_t hum[LA_HUM_BINS] = {};
+
+  void merge(const DayStats &o) {
+    samples += o.samples;
+    coveredSec += o.coveredSec;
+    for (int k = 0; k < LA_THRESHOLDS; k++) aboveSec[k] += o.aboveSec[k];
+    co2Sum += o.co2Sum;
+    if (o.co2Max > co2Max) co2Max = o.co2Max;
+    dropouts += o.dropouts;
+    dropoutSec += o.dropoutSec;
+    for (int i = 0; i < LA_TEMP_BINS; i++) temp[i] += o.temp[i];
+    for (int i = 0; i < LA_HUM_BINS; i++) hum[i] += o.hum[i];
+  }
+};
+
+struct Dropout {
+  uint32_t t;     // 断档前最后一个样本的时间
+  uint32_t secs;
+};
+
+struct AnalyzeParams {
+  uint32_t gapSec = 10;
+  uint32_t epoch = 0;
+  bool dates = false;   // 给了 --epoch 才按日期显示
+};
+
+// 一块连续段的部分结果；块首样本之前、块尾样本之后的间隔在合并时补上
+struct ChunkResult {
+  std::map<int32_t, DayStats> days;
+  std::vector<Dropout> dropouts;
+  bool any = false;
+  TelemetrySample first = {}, last = {};
+  uint64_t samples = 0, corrupt = 0, overlap = 0;
+};
+
+class DayAccumulator {
+ public:
+  DayAccumulator(const AnalyzeParams &p, std::map<int32_t, DayStats> &days, std::vector<Dropout> &drops)
+      : prm(p), days(days), drops(drops) {}
+
+  DayStats &dayOf(uint32_t t) {
+    int32_t d = (int32_t)(((uint64_t)t + prm.epoch) / WALL_SECS_PER_DAY);
+    if (!cur || d != curDay) { cur = &days[d]; curDay = d; }
+    return *cur;
+  }
+
+  void sample(const TelemetrySample &s) {
+    DayStats &d = dayOf(s.t);
+    d.samples++;
+    d.co2Sum += s.co2;
+    if (s.co2 > d.co2Max) d.co2Max = s.co2;
+    int32_t ti = ((int32_t)s.temp - LA_TEMP_MIN) / 10;
+    d.temp[ti < 0 ? 0 : ti >= LA_TEMP_BINS ? LA_TEMP_BINS - 1 : ti]++;
+    uint32_t hi = s.hum / 10u;
+    d.hum[hi >= LA_HUM_BINS ? LA_HUM_BINS - 1 : hi]++;
+  }
+
+  // a 到 b 的间隔记入 a 所在日：不超过 gap 时按 a 的读数保持计时，否则记一次断档、a 只计名义 1 秒
+  void interval(const TelemetrySample &a, const TelemetrySample &b) {
+    DayStats &d = dayOf(a.t);
+    uint32_t dt = b.t - a.t;
+    if (dt > prm.gapSec) {
+      d.dropouts++;
+      d.dropoutSec += dt - 1;
+      drops.push_back({ a.t, dt - 1 });
+      dt = 1;
+    }
+    d.coveredSec += dt;
+    for (int k = 0; k < LA_THRESHOLDS; k++)
+      if (a.co2 > kThresholds[k]) d.aboveSec[k] += dt;
+  }
+
+ private:
+  const AnalyzeParams &prm;
+  std::map<int32_t, DayStats> &days;
+  std::vector<Dropout> &drops;
+  DayStats *cur = nullptr;
+  int32_t curDay = 0;
+};
+
+static void decodeChunk(const LogSegment *segs, size_t n, const AnalyzeParams &prm, ChunkResult &res) {
+  DayAccumulator acc(prm, res.days, res.dropouts);
+  for (size_t i = 0; i < n; i++) {
+    const LogSegment &sg = segs[i];
+    uint32_t off = sizeof(FlashSegHdr);
+    for (uint32_t k = 0; k < sg.records; k++) {
+      FlashRecHdr r;
+      memcpy(&r, sg.base + off, sizeof(r));
+      const uint8_t *rec = sg.base + off;
+      off = (off + (uint32_t)sizeof(FlashRecHdr) + r.len + 3) & ~3u;
+      if (FlashLog::recordCrc(rec, r.len) != r.crc) { res.corrupt++; continue; }
+      if (r.lastT <= sg.skipUntil) { res.overlap += r.count; continue; }
+      TelemetryDecoder dec(rec + sizeof(FlashRecHdr), r.len);
+      TelemetrySample s;
+      while (dec.next(s)) {
+        if (s.t <= sg.skipUntil || (res.any && s.t <= res.last.t)) { res.overlap++; continue; }   // 后者：段内时间回退
+        if (res.any) acc.interval(res.last, s);
+        else res.first = s;
+        acc.sample(s);
+        res.last = s;
+        res.any = true;
+        res.samples++;
+      }
+    }
+  }
+}
+
+struct Analysis {
+  std::map<int32_t, DayStats> days;
+  std::vector<Dropout> dropouts;
+  uint64_t sectors = 0, segments = 0, duplicateSegs = 0, records = 0, samples = 0, corrupt = 0, overlap = 0;
+  uint64_t bytes = 0;
+  double scanSec = 0, decodeSec = 0;
+};
+
+// 按原子计数领取块，线程数不整除块数时也能均衡
+template <typename Fn>
+static void parallelFor(size_t chunks, unsigned threads, Fn fn) {
+  std::atomic<size_t> next{0};
+  auto work = [&]() {
+    for (size_t c; (c = next.fetch_add(1)) < chunks;) fn(c);
+  };
+  std::vector<std::thread> ts;
+  for (unsigned i = 1; i < threads; i++) ts.emplace_back(work);
+  work();
+  for (auto &t : ts) t.join();
+}
+
+static void analyze(const std::vector<MappedFile> &files, unsigned threads, const AnalyzeParams &prm, Analysis &out) {
+  out = Analysis();
+  uint64_t t0 = nowUs();
+
+  // 第一遍：所有文件的扇区按 1 MB 分块并行扫描
+  struct ScanChunk { const MappedFile *f; size_t firstSector, sectors; std::vector<LogSegment> segs; };
+  std::vector<ScanChunk> scan;
+  for (const MappedFile &f : files) {
+    size_t total = f.size / FLASH_LOG_SECTOR;
+    out.sectors += total;
+    out.bytes += f.size;
+    for (size_t s = 0; s < total; s += LA_SCAN_CHUNK)
+      scan.push_back({ &f, s, std::min<size_t>(LA_SCAN_CHUNK, total - s), {} });
+  }
+  parallelFor(scan.size(), threads, [&](size_t c) {
+    ScanChunk &sc = scan[c];
+    LogSegment sg;
+    for (size_t i = 0; i < sc.sectors; i++)
+      if (scanSector(sc.f->data + (sc.firstSector + i) * FLASH_LOG_SECTOR, sg)) sc.segs.push_back(sg);
+  });
+
+  // 排序：按首条记录时间；同一段的多份转储（firstT 相同）保留写得最满的一份
+  std::vector<LogSegment> segs;
+  for (ScanChunk &sc : scan) segs.insert(segs.end(), sc.segs.begin(), sc.segs.end());
+  std::sort(segs.begin(), segs.end(), [](const LogSegment &a, const LogSegment &b) {
+    return a.firstT != b.firstT ? a.firstT < b.firstT : a.lastT > b.lastT;
+  });
+  std::vector<LogSegment> kept;
+  uint32_t seen = 0;
+  bool haveSeen = false;
+  for (const LogSegment &s : segs) {
+    if (!kept.empty() && s.firstT == kept.back().firstT) { out.duplicateSegs++; continue; }
+    LogSegment k = s;
+    k.skipUntil = haveSeen ? seen : 0;
+    if (haveSeen && k.lastT <= seen) { out.duplicateSegs++; continue; }
+    if (!haveSeen || k.lastT > seen) seen = k.lastT;
+    haveSeen = true;
+    kept.push_back(k);
+    out.records += k.records;
+  }
+  out.segments = kept.size();
+  uint64_t t1 = nowUs();
+  out.scanSec = (t1 - t0) / 1e6;
+
+  // 第二遍：排好序的段按块并行解码统计，再按时间顺序合并
+  size_t nChunks = (kept.size() + LA_DECODE_CHUNK - 1) / LA_DECODE_CHUNK;
+  std::vector<ChunkResult> parts(nChunks);
+  parallelFor(nChunks, threads, [&](size_t c) {
+    size_t a = c * LA_DECODE_CHUNK, n = std::min<size_t>(LA_DECODE_CHUNK, kept.size() - a);
+    decodeChunk(kept.data() + a, n, prm, parts[c]);
+  });
+
+  DayAccumulator acc(prm, out.days, out.dropouts);
+  bool any = false;
+  TelemetrySample last = {};
+  for (ChunkResult &p : parts) {
+    out.corrupt += p.corrupt;
+    out.overlap += p.overlap;
+    if (!p.any) continue;
+    // 块间的那个间隔；skipUntil 已保证后一块的样本都晚于前一块
+    if (any) acc.interval(last, p.first);
+    for (auto &kv : p.days) out.days[kv.first].merge(kv.second);
+    out.dropouts.insert(out.dropouts.end(), p.dropouts.begin(), p.dropouts.end());
+    out.samples += p.samples;
+    last = p.last;
+    any = true;
+    std::map<int32_t, DayStats>().swap(p.days);
+  }
+  if (any) acc.dayOf(last.t).coveredSec += 1;   // 最后一个样本计名义 1 秒
+  out.decodeSec = (nowUs() - t1) / 1e6;
+}
+
+// ---- 输出 ----
+// 直方图分位数（q 为千分位），返回所在档的下界
+static int32_t histPercentile(const uint32_t *h, int bins, uint64_t total, uint32_t q) {
+  if (!total) return -1;
+  uint64_t rank = (total * q + 999) / 1000, acc = 0;
+  if (!rank) rank = 1;
+  for (int i = 0; i < bins; i++) {
+    acc += h[i];
+    if (acc >= rank) return i;
+  }
+  return bins - 1;
+}
+
+static void dayLabel(char *out, int32_t day, const AnalyzeParams &prm) {
+  if (prm.dates) wallFormatDate(out, day);
+  else snprintf(out, 16, "day %ld", (long)day);
+}
+
+static void printReport(const Analysis &a, const AnalyzeParams &prm, bool csv, uint32_t top) {
+  if (csv) {
+    printf("day,samples,coverage_pct,co2_mean,co2_max,above_800_h,above_1000_h,above_1500_h,"
+           "temp_p5,temp_p50,temp_p95,hum_p5,hum_p50,hum_p95,dropouts,dropout_min\n");
+  } else {
+    printf("%-10s %7s %6s %5s %5s %6s %6s %6s %17s %17s %5s %7s\n", "day", "samples", "cover", "co2", "max",
+           ">800h", ">1000h", ">1500h", "temp p5/50/95", "hum p5/50/95", "drops", "drop_m");
+  }
+  for (const auto &kv : a.days) {
+    const DayStats &d = kv.second;
+    char label[16];
+    dayLabel(label, kv.first, prm);
+    double tp[3], hp[3];
+    const uint32_t qs[3] = { 50, 500, 950 };
+    for (int i = 0; i < 3; i++) {
+      tp[i] = (histPercentile(d.temp, LA_TEMP_BINS, d.samples, qs[i]) * 10 + LA_TEMP_MIN) / 100.0;
+      hp[i] = histPercentile(d.hum, LA_HUM_BINS, d.samples, qs[i]) / 10.0;
+    }
+    double cover = 100.0 * d.coveredSec / WALL_SECS_PER_DAY, mean = d.samples ? (double)d.co2Sum / d.samples : 0;
+    if (csv) {
+      printf("%s,%llu,%.2f,%.0f,%u,%.3f,%.3f,%.3f,%.1f,%.1f,%.1f,%.1f,%.1f,%.1f,%u,%.1f\n", label,
+             (unsigned long long)d.samples, cover, mean, d.co2Max, d.aboveSec[0] / 3600.0, d.aboveSec[1] / 3600.0,
+             d.aboveSec[2] / 3600.0, tp[0], tp[1], tp[2], hp[0], hp[1], hp[2], d.dropouts, d.dropoutSec / 60.0);
+    } else {
+      printf("%-10s %7llu %5.1f%% %5.0f %5u %6.2f %6.2f %6.2f %5.1f/%4.1f/%4.1f  %4.1f/%4.1f/%4.1f %5u %7.1f\n", label,
+             (unsigned long long)d.samples, cover, mean, d.co2Max, d.aboveSec[0] / 3600.0, d.aboveSec[1] / 3600.0,
+             d.aboveSec[2] / 3600.0, tp[0], tp[1], tp[2], hp[0], hp[1], hp[2], d.dropouts, d.dropoutSec / 60.0);
+    }
+  }
+  if (csv || !top) return;
+
+  std::vector<Dropout> longest(a.dropouts);
+  size_t k = std::min<size_t>(top, longest.size());
+  std::partial_sort(longest.begin(), longest.begin() + k, longest.end(),
+                    [](const Dropout &x, const Dropout &y) { return x.secs != y.secs ? x.secs > y.secs : x.t < y.t; });
+  printf("\nlongest sensor dropouts (gap > %u s):\n", prm.gapSec);
+  for (size_t i = 0; i < k; i++) {
+    uint64_t t = (uint64_t)longest[i].t + prm.epoch;
+    uint32_t sod = (uint32_t)(t % WALL_SECS_PER_DAY);
+    char label[16];
+    dayLabel(label, (int32_t)(t / WALL_SECS_PER_DAY), prm);
+    printf("  %s %02u:%02u:%02u  %6.1f min\n", label, sod / 3600, sod / 60 % 60, sod % 60, longest[i].secs / 60.0);
+  }
+}
+
+static void printSummary(const Analysis &a, unsigned threads) {
+  double sec = a.scanSec + a.decodeSec;
+  fprintf(stderr,
+          "loganalyze: %.1f MB, %llu sectors, %llu segments (%llu duplicate), %llu records (%llu corrupt), %llu samples "
+          "(%llu overlapping skipped), %zu days, %zu dropouts; %u threads, scan %.3f s + decode %.3f s = %.0f MB/s\n",
+          a.bytes / 1048576.0, (unsigned long long)a.sectors, (unsigned long long)a.segments,
+          (unsigned long long)a.duplicateSegs, (unsigned long long)a.records, (unsigned long long)a.corrupt,
+          (unsigned long long)a.samples, (unsigned long long)a.overlap, a.days.size(), a.dropouts.size(), threads,
+          a.scanSec, a.decodeSec, sec > 0 ? a.bytes / 1048576.0 / sec : 0.0);
+}
+
+// 结果摘要（FNV-1a），用于核对不同线程数的结果一致
+static uint64_t digestOf(const Analysis &a) {
+  uint64_t h = 1469598103934665603ull;
+  auto mix = [&](const void *p, size_t n) {
+    for (size_t i = 0; i < n; i++) { h ^= ((const uint8_t *)p)[i]; h *= 1099511628211ull; }
+  };
+  for (const auto &kv : a.days) { mix(&kv.first, sizeof(kv.first)); mix(&kv.second, sizeof(kv.second)); }
+  for (const Dropout &d : a.dropouts) mix(&d, sizeof(d));
+  mix(&a.samples, sizeof(a.samples));
+  return h;
+}
+
+// ---- 合成数据：内存映射的输出文件当作闪存，用固件的 FlashLog 写入 ----
+class MapFlash : public FlashDevice {
+ public:
+  MapFlash(uint8_t *p, uint32_t n) : p(p), n(n) {}
+  uint32_t size() const override { return n; }
+  bool read(uint32_t addr, void *dst, uint32_t len) override { memcpy(dst, p + addr, len); return true; }
+  bool write(uint32_t addr, const void *src, uint32_t len) override {
+    for (uint32_t i = 0; i < len; i++) p[addr + i] &= ((const uint8_t *)src)[i];   // NOR：只能 1 -> 0
+    return true;
+  }
+  bool eraseSector(uint32_t addr) override { memset(p + addr, 0xFF, FLASH_LOG_SECTOR); return true; }
+
+ private:
+  uint8_t *p;
+  uint32_t n;
+};
+
+static uint32_t lcg(uint32_t &s) { s = s * 1664525u + 1013904223u; return s >> 8; }
+
+// 一份镜像 = 连续 days 天的 1 Hz 记录：工作时间 CO2 上升、夜间回落，温湿度日变化，
+// 每天若干次传感器断档（几秒到数十分钟不写日志）；返回是否装得下（未发生环形覆盖）
+static bool genImage(uint8_t *img, uint32_t t0, uint32_t days, uint32_t seed, uint64_t &samples) {
+  MapFlash dev(img, LA_IMAGE_BYTES);
+  memset(img, 0xFF, LA_IMAGE_BYTES);
+  static thread_local FlashLog log;
+  if (!log.begin(&dev)) return false;
+  int32_t co2 = 450;
+  uint32_t skipUntil = 0;
+  for (uint32_t t = t0; t < t0 + days * WALL_SECS_PER_DAY; t++) {
+    uint32_t sod = t % WALL_SECS_PER_DAY;
+    if (lcg(seed) % 20000 == 0) skipUntil = t + 5 + lcg(seed) % (lcg(seed) % 8 ? 120 : 2400);
+    if (t < skipUntil) continue;
+    bool occupied = sod >= 9 * 3600 && sod < 18 * 3600 && (t / WALL_SECS_PER_DAY + 3) % 7 < 5;   // 1970-01-01 是周四
+    int32_t target = occupied ? 1100 + (int32_t)(sod / 60 % 240) * 3 : 430;
+    if (lcg(seed) % 4 == 0) co2 += (target > co2) - (target < co2) + (int32_t)(lcg(seed) % 3) - 1;
+    int32_t phase = (int32_t)(sod / 60) - 720;
+    int16_t temp = (int16_t)(2250 - phase * phase / 2000 + (int32_t)(lcg(seed) % 8));
+    uint16_t hum = (uint16_t)(4500 + phase * phase / 1500 - (int32_t)(lcg(seed) % 8));
+    TelemetrySample s = { t, (uint16_t)co2, (int16_t)(temp / 10 * 10), (uint16_t)(hum / 10 * 10) };
+    if (!log.append(s)) return false;
+    samples++;
+  }
+  log.flush();
+  return log.getStats().sectorsErased <= log.segments();
+}
+
+static int generate(const char *path, uint32_t images, uint32_t days, unsigned threads) {
+  int fd = open(path, O_RDWR | O_CREAT | O_TRUNC, 0644);
+  if (fd < 0) { perror(path); return 1; }
+  size_t total = (size_t)images * LA_IMAGE_BYTES;
+  if (ftruncate(fd, (off_t)total) < 0) { perror(path); close(fd); return 1; }
+  uint8_t *p = (uint8_t *)mmap(nullptr, total, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  close(fd);
+  if (p == MAP_FAILED) { perror(path); return 1; }
+  const uint32_t base = (uint32_t)wallDaysFromCivil(2024, 1, 1) * WALL_SECS_PER_DAY;
+  std::atomic<uint64_t> samples{0};
+  std::atomic<uint32_t> overflow{0};
+  uint64_t t0 = nowUs();
+  parallelFor(images, threads, [&](size_t i) {
+    uint64_t n = 0;
+    if (!genImage(p + i * LA_IMAGE_BYTES, base + (uint32_t)i * days * WALL_SECS_PER_DAY, days, 0x5EED0000u + (uint32_t)i, n))
+      overflow++;
+    samples += n;
+  });
+  munmap(p, total);
+  fprintf(stderr, "loganalyze: wrote %s, %u images x %u days, %.1f MB, %llu samples in %.1f s%s\n", path, images, days,
+          total / 1048576.0, (unsigned long long)samples.load(), (nowUs() - t0) / 1e6,
+          overflow ? " (some images wrapped: use fewer --days)" : "");
+  return overflow ? 1 : 0;
+}
+
+int main(int argc, char **argv) {
+  AnalyzeParams prm;
+  unsigned threads = std::max(1u, std::thread::hardware_concurrency());
+  bool csv = false, bench = false;
+  const char *genPath = nullptr;
+  uint32_t images = 64, days = 28, top = 10;
+  std::vector<const char *> paths;
+  for (int i = 1; i < argc; i++) {
+    const char *a = argv[i];
+    bool more = i + 1 < argc;
+    if (!strcmp(a, "--threads") && more) threads = (unsigned)std::max(1, atoi(argv[++i]));
+    else if (!strcmp(a, "--csv")) csv = true;
+    else if (!strcmp(a, "--epoch") && more) { prm.epoch = (uint32_t)strtoul(argv[++i], nullptr, 0); prm.dates = true; }
+    else if (!strcmp(a, "--gap") && more) prm.gapSec = (uint32_t)std::max(1, atoi(argv[++i]));
+    else if (!strcmp(a, "--top") && more) top = (uint32_t)atoi(argv[++i]);
+    else if (!strcmp(a, "--gen") && more) genPath = argv[++i];
+    else if (!strcmp(a, "--images") && more) images = (uint32_t)std::max(1, atoi(argv[++i]));
+    else if (!strcmp(a, "--days") && more) days = (uint32_t)std::max(1, atoi(argv[++i]));
+    else if (!strcmp(a, "--bench")) bench = true;
+    else if (a[0] == '-') {
+      fprintf(stderr,
+              "usage: %s [--threads N] [--csv] [--epoch SEC] [--gap SEC] [--top N] image.bin...\n"
+              "       %s --gen out.bin [--images N] [--days D] [--threads N]\n"
+              "       %s --bench [--threads MAX] image.bin...\n",
+              argv[0], argv[0], argv[0]);
+      return 2;
+    } else paths.push_back(a);
+  }
+  if (genPath) return generate(genPath, images, days, threads);
+  if (paths.empty()) { fprintf(stderr, "%s: no input images\n", argv[0]); return 2; }
+
+  std::vector<MappedFile> files;
+  for (const char *p : paths) {
+    MappedFile m;
+    if (!mapFile(p, m)) return 1;
+    files.push_back(m);
+  }
+
+  Analysis a;
+  if (!bench) {
+    analyze(files, threads, prm, a);
+    printReport(a, prm, csv, top);
+    printSummary(a, threads);
+    return 0;
+  }
+
+  // 先跑一遍预热页缓存，再按线程数翻倍测量
+  analyze(files, 1, prm, a);
+  uint64_t ref = digestOf(a);
+  double base = 0;
+  bool same = true;
+  for (unsigned n = 1;; n = std::min(n * 2, threads)) {
+    analyze(files, n, prm, a);
+    double sec = a.scanSec + a.decodeSec;
+    if (n == 1) base = sec;
+    bool ok = digestOf(a) == ref;
+    same = same && ok;
+    printf("threads %-3u %8.3f s %8.0f MB/s %8.1f Msamples/s  speedup %.2fx %s\n", n, sec, a.bytes / 1048576.0 / sec,
+           a.samples / sec / 1e6, base / sec, ok ? "" : "<- result differs");
+    if (n >= threads) break;
+  }
+  printSummary(a, threads);
+  printf("loganalyze bench %s\n", same ? "OK" : "MISMATCH");
+  return same ? 0 : 1;
+}
@@ -0,0 +1,149 @@
+// 主机端热路径微基准（用例见 hotpath_bench.h）：ST7789_AVR 经 SPI 替身驱动虚拟面板，JSON 写到标准输出或文件；
+// 开跑前先校验 RGB565 内核（SSE2/SWAR）与标量参考逐位一致；
+// --compare 对比两份结果（主机或板上串口抓取的均可，单位须一致），中位数变慢超过容差或总线字节增加即失败。
+// 用法：microbench [--out FILE] [--no-panel]
+//       microbench --compare base.json new.json [--tolerance PCT]
+#include <Arduino.h>
+#include <SPI.h>
+#include <ST7789_AVR.h>
+#include <VirtualPanel.h>
+#include <vector>
+#include "hotpath_bench.h"
+
+// 与 main.cpp 相同的引脚、字号与显示全局量
+#define PIN_DC   16
+#define PIN_RST  5
+#define PIN_CS   17
+
+ST7789_AVR tft(PIN_DC, PIN_RST, PIN_CS);
+uint8_t gFirstLineSize = 3;
+uint8_t gOtherLineSize = 3;
+bool layoutInited = false;
+DisplayState displayState;
+
+static VirtualPanel panel;
+
+// hotpathBenchRun 的输出端：文件或标准输出
+struct FileOut {
+  FILE *f;
+  size_t write(const uint8_t *p, size_t n) { return fwrite(p, 1, n, f); }
+};
+
+struct BenchEntry {
+  char name[64];
+  unsigned long median = 0, min = 0, busBytes = 0, windows = 0;
+};
+
+struct BenchFile {
+  char unit[16] = "";
+  char target[16] = "";
+  char build[40] = "";
+  std::vector<BenchEntry> entries;
+};
+
+// 逐行找 {"name":...}；板上抓取的串口日志里夹着其它行也没关系
+static bool loadResults(const char *path, BenchFile &bf) {
+  FILE *f = fopen(path, "r");
+  if (!f) { perror(path); return false; }
+  char line[512];
+  while (fgets(line, sizeof(line), f)) {
+    const char *p;
+    if ((p = strstr(line, "\"suite\":\"hotpath\""))) {
+      const char *q;
+      if ((q = strstr(line, "\"unit\":\""))) sscanf(q, "\"unit\":\"%15[^\"]", bf.unit);
+      if ((q = strstr(line, "\"target\":\""))) sscanf(q, "\"target\":\"%15[^\"]", bf.target);
+      if ((q = strstr(line, "\"build\":\""))) sscanf(q, "\"build\":\"%39[^\"]", bf.build);
+    } else if ((p = strstr(line, "{\"name\":\""))) {
+      BenchEntry e;
+      unsigned long ops, mean;
+      if (sscanf(p, "{\"name\":\"%63[^\"]\",\"ops\":%lu,\"median\":%lu,\"min\":%lu,\"mean\":%lu,\"bus_bytes\":%lu,\"windows\":%lu",
+                 e.name, &ops, &e.median, &e.min, &mean, &e.busBytes, &e.windows) == 7)
+        bf.entries.push_back(e);
+    }
+  }
+  fclose(f);
+  if (bf.entries.empty()) { fprintf(stderr, "%s: no hotpath results\n", path); return false; }
+  return true;
+}
+
+static int compare(const char *basePath, const char *newPath, double tolPct) {
+  BenchFile a, b;
+  if (!loadResults(basePath, a) || !loadResults(newPath, b)) return 2;
+  if (strcmp(a.unit, b.unit)) {
+    fprintf(stderr, "unit mismatch: %s is %s, %s is %s\n", basePath, a.unit, newPath, b.unit);
+    return 2;
+  }
+  printf("base %s (%s)  vs  new %s (%s), unit=%s, tolerance=%.0f%%\n", a.target, a.build, b.target, b.build, a.unit,
+         tolPct);
+  printf("%-20s %10s %10s %8s %10s %10s  %s\n", "case", "base", "new", "change", "bus base", "bus new", "");
+  int regressions = 0;
+  for (const BenchEntry &n : b.entries) {
+    const BenchEntry *o = nullptr;
+    for (const BenchEntry &e : a.entries)
+      if (!strcmp(e.name, n.name)) o = &e;
+    if (!o) { printf("%-20s %10s %10lu %8s %10s %10lu  new\n", n.name, "-", n.median, "-", "-", n.busBytes); continue; }
+    double pct = o->median ? ((double)n.median - o->median) * 100.0 / o->median : 0.0;
+    bool slower = pct > tolPct;
+    bool moreBus = n.busBytes > o->busBytes;
+    if (slower || moreBus) regressions++;
+    printf("%-20s %10lu %10lu %+7.1f%% %10lu %10lu  %s\n", n.name, o->median, n.median, pct, o->busBytes, n.busBytes,
+           moreBus ? "BUS REGRESSION" : slower ? "SLOWER" : "");
+  }
+  for (const BenchEntry &o : a.entries) {
+    bool found = false;
+    for (const BenchEntry &e : b.entries) found |= !strcmp(e.name, o.name);
+    if (!found) printf("%-20s %10lu %10s %8s %10lu %10s  removed\n", o.name, o.median, "-", "-", o.busBytes, "-");
+  }
+  printf("%s\n", regressions ? "FAIL" : "OK");
+  return regressions ? 1 : 0;
+}
+
+int main(int argc, char **argv) {
+  const char *outPath = nullptr;
+  bool attach = true;
+  double tolPct = 10.0;
+  const char *cmpA = nullptr, *cmpB = nullptr;
+  for (int i = 1; i < argc; i++) {
+    if (!strcmp(argv[i], "--out") && i + 1 < argc) outPath = argv[++i];
+    else if (!strcmp(argv[i], "--no-panel")) attach = false;
+    else if (!strcmp(argv[i], "--tolerance") && i + 1 < argc) tolPct = atof(argv[++i]);
+    else if (!strcmp(argv[i], "--compare") && i + 2 < argc) { cmpA = argv[++i]; cmpB = argv[++i]; }
+    else {
+      fprintf(stderr, "usage: %s [--out FILE] [--no-panel]\n       %s --compare base.json new.json [--tolerance PCT]\n",
+              argv[0], argv[0]);
+      return 2;
+    }
+  }
+  if (cmpA) return compare(cmpA, cmpB, tolPct);
+
+  // 行缓冲内核各路径与标量参考逐位一致，否则结果没有意义
+  bool built[RGB565_IMPL_COUNT];
+  for (uint8_t i = 0; i < RGB565_IMPL_COUNT; i++) built[i] = rgb565ImplAvailable(i);
+  if (!rgb565Check()) {
+    fprintf(stderr, "rgb565 kernels disagree with the scalar reference:");
+    for (uint8_t i = 0; i < RGB565_IMPL_COUNT; i++)
+      if (built[i] && !rgb565ImplAvailable(i)) fprintf(stderr, " %s", rgb565ImplName(i));
+    fprintf(stderr, "\n");
+    return 1;
+  }
+  fprintf(stderr, "rgb565 kernels: %s (bit-exact with scalar)\n", rgb565ImplName(rgb565GetImpl()));
+
+  hostSerialQuiet(true);
+  if (attach) hostAttachPanel(&panel, PIN_DC, PIN_CS);
+  tft.init(172, 320);
+  tft.setRotation(3);
+
+  FileOut out = { stdout };
+  FILE *f = nullptr;
+  if (outPath) {
+    f = fopen(outPath, "w");
+    if (!f) { perror(outPath); return 1; }
+    out.f = f;
+  }
+  hotpathBenchRun(out, "host", __DATE__ " " __TIME__);
+  if (f) {
+    fclose(f);
+    fprintf(stderr, "wrote %s\n", outPath);
+  }
+  return 0;
+}
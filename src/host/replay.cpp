@@ -0,0 +1,222 @@
+// 主机端回放：把现场录制的 trace（串口抓包中的 "T:" 行）按 loop() 的处理顺序重新送入
+// 帧解析 -> SamplePipeline -> updateDisplay() -> ST7789_AVR -> 虚拟面板，虚拟时钟，快于实时。
+// 用法：replay <capture.log> [--snap-dir DIR] [--snap-every N] [--verbose]
+#include <Arduino.h>
+#include <SPI.h>
+#include <ST7789_AVR.h>
+#include <VirtualPanel.h>
+#include <chrono>
+#include "display_helper.h"
+#include "sample_pipeline.h"
+#include "trace_format.h"
+
+// 与 main.cpp 相同的引脚、字号与显示全局量
+#define PIN_DC   16
+#define PIN_RST  5
+#define PIN_CS   17
+
+ST7789_AVR tft(PIN_DC, PIN_RST, PIN_CS);
+uint8_t gFirstLineSize = 3;
+uint8_t gOtherLineSize = 3;
+bool layoutInited = false;
+DisplayState displayState;
+
+static VirtualPanel panel;
+static Co2FrameParser co2Parser;
+static SamplePipeline samplePipeline;
+static uint32_t co2ppm = 450;
+static float temperatureC = 25.3f;
+static float humidityPct = 48.5f;
+
+struct ReplayStats {
+  uint32_t records = 0, uartRecords = 0, dhtRecords = 0, boots = 0;
+  uint64_t uartBytes = 0;
+  uint32_t frames = 0, framesAccepted = 0;
+  uint32_t updates = 0;
+  uint32_t lateRenders = 0;       // 渲染耗时超过下一条记录的时间
+  ST7789Cost maxFrame;            // 字节数最多的一次 updateDisplay
+  uint32_t firstMs = 0, lastMs = 0;
+};
+
+static ReplayStats rs;
+
+// 面板可见区域在地址空间中的位置（172x320，旋转 3）
+static void visibleRect(uint16_t &x0, uint16_t &y0, uint16_t &w, uint16_t &h) {
+  x0 = 0; y0 = 34; w = tft.width(); h = tft.height();
+}
+
+static void snapshot(const char *dir, uint32_t idx) {
+  char path[512];
+  uint16_t x0, y0, w, h;
+  visibleRect(x0, y0, w, h);
+  snprintf(path, sizeof(path), "%s/frame_%06u.ppm", dir, idx);
+  panel.savePpm(path, x0, y0, w, h);
+}
+
+// 与 setup() 中的显示初始化一致
+static void bootDisplay(int32_t day) {
+  layoutInited = false;
+  displayState = DisplayState();
+  tft.init(172, 320);
+  tft.setRotation(3);
+  initDisplayLayout(day);
+}
+
+// 与 processCo2Buffer() 一致：只有通过校验与滤波的帧才更新 co2ppm
+static void processFrames(uint32_t now) {
+  uint8_t f[CO2_FRAME_LEN];
+  while (co2Parser.next(f)) {
+    rs.frames++;
+    if (samplePipeline.pushCo2Frame(f, now)) {
+      rs.framesAccepted++;
+      co2ppm = (uint32_t)samplePipeline.aggregates().co2.last;
+    }
+  }
+}
+
+// 与 loop() 中每秒更新块一致
+static void secondTick(uint32_t now, float t, float h, int32_t day) {
+  samplePipeline.pushDht(t, h, now);
+  samplePipeline.tick(now);
+  const SampleAggregates &agg = samplePipeline.aggregates();
+  if (agg.temp.valid) temperatureC = SamplePipeline::fromFixed(agg.temp.last);
+  if (agg.hum.valid) humidityPct = SamplePipeline::fromFixed(agg.hum.last);
+  DisplayFrameCost fc = updateDisplay(day, co2ppm, temperatureC, humidityPct);
+  if (fc.total.bytes > rs.maxFrame.bytes) rs.maxFrame = fc.total;
+  rs.updates++;
+}
+
+int main(int argc, char **argv) {
+  const char *path = nullptr, *snapDir = nullptr;
+  uint32_t snapEvery = 0;
+  bool verbose = false;
+  for (int i = 1; i < argc; i++) {
+    if (!strcmp(argv[i], "--snap-dir") && i + 1 < argc) snapDir = argv[++i];
+    else if (!strcmp(argv[i], "--snap-every") && i + 1 < argc) snapEvery = (uint32_t)atoi(argv[++i]);
+    else if (!strcmp(argv[i], "--verbose")) verbose = true;
+    else path = argv[i];
+  }
+  if (!path) {
+    fprintf(stderr, "usage: %s <capture.log> [--snap-dir DIR] [--snap-every N] [--verbose]\n", argv[0]);
+    return 2;
+  }
+  FILE *f = fopen(path, "r");
+  if (!f) { perror(path); return 1; }
+
+  hostSerialQuiet(!verbose);
+  hostAttachPanel(&panel, PIN_DC, PIN_CS);
+  int32_t day = 0;   // 没有 BOOT 记录时按 1970-01-01
+  bool booted = false;
+  auto wall0 = std::chrono::steady_clock::now();
+
+  static char line[4096];
+  uint8_t raw[TRACE_MAX_RECORD];
+  while (fgets(line, sizeof(line), f)) {
+    size_t n = traceFromHexLine(line, raw, sizeof(raw));
+    TraceRecord r;
+    if (!n || !traceDecode(raw, n, r)) continue;
+    rs.records++;
+    if (rs.records == 1) rs.firstMs = r.ms;
+    rs.lastMs = r.ms;
+    // 虚拟时钟对齐到记录时间；若上一次渲染的总线时间已越过该时刻则记为迟到
+    uint64_t recUs = (uint64_t)r.ms * 1000;
+    if (hostMicros64() > recUs) rs.lateRenders++;
+    else hostSetMicros(recUs);
+
+    switch (r.type) {
+      case TRACE_BOOT: {
+        TraceBoot tb;
+        memcpy(&tb, r.payload, sizeof(tb));
+        char d[11];
+        memcpy(d, tb.date, 10);
+        d[10] = 0;
+        if (!wallParseDate(d, day)) day = 0;
+        rs.boots++;
+        bootDisplay(day);
+        booted = true;
+        break;
+      }
+      case TRACE_UART:
+        rs.uartRecords++;
+        rs.uartBytes += r.len;
+        co2Parser.feed(r.payload, r.len);
+        processFrames(r.ms);
+        break;
+      case TRACE_DHT: {
+        float th[2];
+        memcpy(th, r.payload, sizeof(th));
+        rs.dhtRecords++;
+        if (!booted) { bootDisplay(day); booted = true; }
+        secondTick(r.ms, th[0], th[1], day);
+        if (snapDir && snapEvery && rs.updates % snapEvery == 0) snapshot(snapDir, rs.updates);
+        break;
+      }
+      default:
+        break;
+    }
+  }
+  fclose(f);
+  if (snapDir) snapshot(snapDir, rs.updates);
+
+  double wallS = std::chrono::duration<double>(std::chrono::steady_clock::now() - wall0).count();
+  double traceS = (rs.lastMs - rs.firstMs) / 1000.0;
+  const VirtualPanelStats &ps = panel.stats();
+  uint16_t x0, y0, w, h;
+  visibleRect(x0, y0, w, h);
+  printf("records=%u (boot=%u uart=%u dht=%u) trace=%.1fs replay=%.3fs speedup=%.0fx\n",
+         rs.records, rs.boots, rs.uartRecords, rs.dhtRecords, traceS, wallS, wallS > 0 ? traceS / wallS : 0.0);
+  printf("uart bytes=%llu frames=%u accepted=%u rejected=%u resync-skipped=%u overflow=%u\n",
+         (unsigned long long)rs.uartBytes, rs.frames, rs.framesAccepted, rs.frames - rs.framesAccepted,
+         co2Parser.skipped, co2Parser.overflow);
+  const SampleAggregates &agg = samplePipeline.aggregates();
+  printf("display updates=%u late=%u final co2=%u temp=%.1f hum=%.1f co2 1h mean=%d\n",
+         rs.updates, rs.lateRenders, co2ppm, temperatureC, humidityPct, agg.co2.w1h.mean);
+  printf("bus bytes=%llu (cmd=%llu data=%llu) windows=%llu transactions=%llu pixels=%llu\n",
+         (unsigned long long)ps.bytes, (unsigned long long)ps.cmdBytes, (unsigned long long)ps.dataBytes,
+         (unsigned long long)ps.windows, (unsigned long long)ps.transactions, (unsigned long long)ps.pixels);
+  // 驱动侧开销（虚拟时钟下 us 即总线时间）；驱动计数应与面板看到的总线字节一致
+  char cost[160];
+  const ST7789Stats &ds = tft.renderStats();
+  for (uint8_t p = 0; p < ST_PRIM_COUNT; p++) {
+    if (!ds.prim[p].calls) continue;
+    displayCostFormat(cost, sizeof(cost), ds.prim[p]);
+    printf("render prim %-8s %s\n", ST7789_AVR::primName(p), cost);
+  }
+  for (uint8_t t = 0; t < DTAG_COUNT; t++) {
+    if (!ds.tag[t].calls) continue;
+    displayCostFormat(cost, sizeof(cost), ds.tag[t]);
+    printf("render row  %-8s %s\n", displayTagName(t), cost);
+  }
+  displayCostFormat(cost, sizeof(cost), rs.maxFrame);
+  printf("render max frame %s, mean %.0f bytes/update\n", cost,
+         rs.updates ? (double)(ds.total.bytes - ds.tag[DTAG_LAYOUT].bytes) / rs.updates : 0.0);
+  printf("driver bytes=%lu windows=%lu transactions=%lu vs bus -> %s\n", (unsigned long)ds.total.bytes,
+         (unsigned long)ds.total.windows, (unsigned long)ds.total.transactions,
+         (ds.total.bytes == ps.bytes && ds.total.windows == ps.windows && ds.total.transactions == ps.transactions)
+             ? "OK"
+             : "MISMATCH");
+  uint32_t hash = panel.hash(x0, y0, w, h);
+  printf("frame hash=%08x\n", hash);
+
+  // 热复位（与 setup() 的 FAST_BOOT 路径一致）：不复位面板，从保留记录恢复差分状态，
+  // 同样的读数再刷新一次应不发送任何字节，画面不变
+  DisplayRetained kept;
+  uint32_t sig = displayLayoutSig("replay");
+  displayRetain(kept, sig);
+  layoutInited = false;
+  displayState = DisplayState();
+  uint32_t bootUs = micros();
+  tft.initAsync(172, 320, true);
+  while (!tft.initPoll()) delay(1);
+  tft.setRotation(3);
+  bootUs = micros() - bootUs;
+  bool restored = displayRestore(kept, sig);
+  uint64_t busBefore = ps.bytes;
+  updateDisplay(day, co2ppm, temperatureC, humidityPct);
+  uint64_t redraw = ps.bytes - busBefore;
+  bool same = panel.hash(x0, y0, w, h) == hash;
+  printf("warm boot panel init=%.1fms restored=%s redraw bytes=%llu frame %s -> %s\n", bootUs / 1000.0,
+         restored ? "yes" : "no", (unsigned long long)redraw, same ? "unchanged" : "CHANGED",
+         restored && !redraw && same ? "OK" : "MISMATCH");
+  return 0;
+}
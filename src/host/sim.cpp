@@ -0,0 +1,656 @@
+// 主机端整机仿真：在虚拟时钟下运行未修改的 main.cpp（setup()/loop()，需 DUAL_CORE=0），
+// CO2 串口帧、DHT 读数与串口控制台输入由脚本驱动，几秒内跑完数十天，检查堆增长、millis() 回绕、
+// 墙上时钟漂移、任务节拍、日志丢弃，以及滚动统计/历史/闪存日志在回绕前后的连续性。固件的串口输出经 hostSerialTap 旁路解析，不改动固件代码。
+// 用法：sim [--days N] [--script FILE] [--start-ms MS] [--epoch S] [--co2-period MS] [--baud B]
+//           [--shot out.ppm] [--echo]
+#include <Arduino.h>
+#include <DHT.h>
+#include <SPI.h>
+#include <ST7789_AVR.h>
+#include <VirtualPanel.h>
+#include <malloc.h>
+#include <chrono>
+#include <new>
+#include <vector>
+#include "co2_frame.h"
+#include "deferred_log.h"
+#include "sample_pipeline.h"
+#include "wall_clock.h"
+
+#if !defined(DUAL_CORE) || DUAL_CORE
+#error "native_sim runs setup()/loop() on one thread: build with -DDUAL_CORE=0"
+#endif
+#if (defined(LOW_POWER) && LOW_POWER) || (defined(METRICS_HTTP) && METRICS_HTTP) || (defined(MQTT_BATCH) && MQTT_BATCH)
+#error "native_sim has no light sleep / Wi-Fi stand-ins: LOW_POWER, METRICS_HTTP and MQTT_BATCH must be 0"
+#endif
+
+void setup();
+void loop();
+extern ST7789_AVR tft;
+
+// 与 main.cpp 一致
+#define SIM_PIN_DC      16
+#define SIM_PIN_CS      17
+#define SIM_CO2_UART    0
+#define SIM_HEARTBEAT_MS 2000
+
+#define SIM_DAY_MS       86400000ULL
+#define SIM_FEED_AHEAD_MS 50     // CO2 帧与脚本事件提前排入的时间（大于串口轮询周期 20 ms）
+#define SIM_LOG_FIFO     128     // UART 发送 FIFO：日志任务一次最多写入的字节
+#define SIM_LINE_MAX     256
+#define SIM_DATA_MS      60000   // "data" 查询周期
+#define SIM_DATA_FROM_MS 120000  // 开机稳定后才开始查询
+#define SIM_FRAME_RING   65536   // 好帧记录（静态数组，不计入堆统计），足够一小时 55 ms 周期的帧
+
+// ---- 堆统计：计数的全局 operator new/delete；malloc（HistoryStore、分区镜像）看 mallinfo2 ----
+static uint64_t gNewCalls = 0, gDeleteCalls = 0;
+static int64_t gNewLive = 0;
+
+void *operator new(size_t n) {
+  void *p = malloc(n ? n : 1);
+  if (!p) throw std::bad_alloc();
+  gNewCalls++;
+  gNewLive += (int64_t)malloc_usable_size(p);
+  return p;
+}
+void *operator new[](size_t n) { return operator new(n); }
+void operator delete(void *p) noexcept {
+  if (!p) return;
+  gDeleteCalls++;
+  gNewLive -= (int64_t)malloc_usable_size(p);
+  free(p);
+}
+void operator delete[](void *p) noexcept { operator delete(p); }
+void operator delete(void *p, size_t) noexcept { operator delete(p); }
+void operator delete[](void *p, size_t) noexcept { operator delete(p); }
+
+// ---- 传感器信号：目标值 + 线性渐变 ----
+struct SimSignal {
+  double from = 0, to = 0;
+  uint64_t t0 = 0, dur = 0;
+
+  double at(uint64_t ms) const {
+    if (ms >= t0 + dur) return to;
+    if (ms <= t0) return from;
+    return from + (to - from) * (double)(ms - t0) / (double)dur;
+  }
+  void set(double v, uint64_t ms, uint64_t rampMs) {
+    from = at(ms);
+    to = v;
+    t0 = ms;
+    dur = rampMs;
+  }
+};
+
+// 送出的好帧（校验正确且在量程内）：时刻与读数，核对固件的滚动统计
+struct SimFrame {
+  uint64_t ms;
+  uint32_t ppm;
+};
+
+struct SimEvent {
+  uint64_t ms;
+  uint32_t order;     // 同一时刻按脚本顺序执行
+  char cmd[96];
+};
+
+struct SimState {
+  uint64_t startUs = 0;
+  SimSignal co2, temp, hum;
+  uint32_t co2Noise = 0;
+  bool co2On = true;
+  uint32_t co2Bad = 0;
+  uint32_t dhtFail = 0;
+  uint64_t nextFrameMs = 0;
+  uint32_t framePeriodMs = 1000;
+  uint32_t rng = 0x2545F491;
+  HardwareSerial *uart = nullptr;
+
+  uint64_t framesSent = 0, badFramesSent = 0;
+  SimFrame goodFrames[SIM_FRAME_RING];   // 环形，最近约一小时
+  uint32_t goodCount = 0;                 // 累计写入数
+  uint64_t dhtReads = 0, dhtFailed = 0;
+  double co2Lo = 1e9, co2Hi = 0;
+};
+
+static SimState sim;
+
+static uint64_t simNowMs() { return (hostMicros64() - sim.startUs) / 1000; }
+
+// ---- 串口输出解析 ----
+struct SimObserved {
+  uint64_t lines = 0, bytes = 0;
+  uint64_t heartbeats = 0;
+  uint32_t lastHb = 0;
+  uint32_t hbMaxDevMs = 0;          // 相邻心跳间隔与 2000 ms 的最大偏差
+  uint32_t hbMaxLagMs = 0;          // 心跳行写出时相对其时间戳的延迟（日志积压）
+  uint32_t logDropped = 0, logPeak = 0, schedMisses = 0;
+  uint64_t dateRollovers = 0;
+  uint64_t sensorTicks = 0, dhtNan = 0;
+  uint64_t chkMismatch = 0, outOfRange = 0;
+  uint64_t dropNotes = 0;
+  uint32_t co2Lo = UINT32_MAX, co2Hi = 0;
+  // "time" 命令的回复：0 = 设置回显，1 = 基准，2 = 结束
+  uint32_t timeReplies = 0;
+  uint32_t epoch[3] = { 0, 0, 0 }, rollovers[3] = { 0, 0, 0 };
+  uint64_t replyMs[3] = { 0, 0, 0 };
+  uint64_t ticksAt[3] = { 0, 0, 0 };
+  // "data" 命令的回复：滚动窗口的个数/均值须与这段时间送出的好帧相符，历史与日志时间须随秒数前进
+  uint64_t dataAskMs = 0;
+  uint32_t dataReplies = 0, rollBad = 0, histBad = 0, logBad = 0;
+  uint32_t histT = 0, histN = 0, logT = 0;
+  char rollFirstBad[128] = "", histFirstBad[128] = "", logFirstBad[128] = "";
+};
+
+static SimObserved obs;
+static char lineBuf[SIM_LINE_MAX];
+static size_t lineLen = 0;
+
+// [t0, t1] 内送出的好帧个数，以及读数范围（无帧时 lo > hi）；范围另含 t0 之前的 before 帧
+// （中值滤波的输出可能来自窗口前的帧）
+static uint32_t framesIn(uint64_t t0, uint64_t t1, uint32_t before, uint32_t &lo, uint32_t &hi) {
+  uint32_t n = 0;
+  lo = UINT32_MAX;
+  hi = 0;
+  uint32_t kept = sim.goodCount < SIM_FRAME_RING ? sim.goodCount : SIM_FRAME_RING;
+  for (uint32_t i = 0; i < kept; i++) {
+    const SimFrame &f = sim.goodFrames[(sim.goodCount - 1 - i) % SIM_FRAME_RING];
+    if (f.ms > t1) continue;
+    if (f.ms >= t0) n++;
+    else if (!before--) break;
+    if (f.ppm < lo) lo = f.ppm;
+    if (f.ppm > hi) hi = f.ppm;
+  }
+  return n;
+}
+
+// 窗口（当前桶 + 之前的桶）覆盖查询前 59~60 个桶宽，快照最多晚一个传感器节拍（1 s），故个数按边界留出余量；
+// 均值须落在窗口内各帧及其前 SAMPLE_MEDIAN_N - 1 帧（中值滤波的输入）的读数范围内
+static bool checkWindow(const char *name, uint64_t askMs, uint64_t spanMs, unsigned long n, long mean, char *why,
+                        size_t whyLen) {
+  uint32_t lo, hi, mlo, mhi;
+  uint64_t a = askMs;
+  auto back = [a](uint64_t ms) { return a > ms ? a - ms : 0; };
+  uint32_t least = framesIn(back(spanMs - spanMs / 60 - 500), back(1200), 0, lo, hi);
+  uint32_t most = framesIn(back(spanMs + 1500), a + 200, SAMPLE_MEDIAN_N - 1, mlo, mhi);
+  bool ok = n >= least && n <= most && (!n || (mean + 1 >= (long)mlo && mean <= (long)mhi + 1));
+  if (!ok) snprintf(why, whyLen, "%s n=%lu mean=%ld, want n %u..%u mean %u..%u", name, n, mean, least, most, mlo, mhi);
+  return ok;
+}
+
+static void onData(unsigned long n1m, long m1m, unsigned long n1h, long m1h, uint32_t histT, uint32_t histN,
+                   uint32_t logT, unsigned n10) {
+  char why[96] = "";
+  uint64_t a = obs.dataAskMs;
+  bool roll = checkWindow("1m", a, 60000, n1m, m1m, why, sizeof(why));
+  if (roll && a >= 3600000 + SIM_DATA_FROM_MS)   // 1h 窗口完全落在开机之后才核对
+    roll = checkWindow("1h", a, 3600000, n1h, m1h, why, sizeof(why));
+  if (!roll && !obs.rollBad++)
+    snprintf(obs.rollFirstBad, sizeof(obs.rollFirstBad), " (first at millis=%lu: %s)", (unsigned long)millis(), why);
+
+  // 每秒写入一次：两次查询之间时间前进约 60 s，写入数与之相符；日志回读最近 10 秒应有 9~10 条
+  if (obs.dataReplies++) {
+    int64_t dt = (int64_t)histT - obs.histT, dn = (int64_t)histN - obs.histN, dl = (int64_t)logT - obs.logT;
+    if ((dt < 55 || dt > 65 || dn + 3 < dt || dn > dt) && !obs.histBad++)
+      snprintf(obs.histFirstBad, sizeof(obs.histFirstBad), " (first at millis=%lu: t %+lld s, inserts %+lld)",
+               (unsigned long)millis(), (long long)dt, (long long)dn);
+    if ((dl < 55 || dl > 65 || n10 < 9 || n10 > 10) && !obs.logBad++)
+      snprintf(obs.logFirstBad, sizeof(obs.logFirstBad), " (first at millis=%lu: t %+lld s, last 10 s read %u)",
+               (unsigned long)millis(), (long long)dl, n10);
+  }
+  obs.histT = histT;
+  obs.histN = histN;
+  obs.logT = logT;
+}
+
+static void onLine(const char *s) {
+  obs.lines++;
+  const char *p;
+  if ((p = strstr(s, "Heartbeat @"))) {
+    unsigned long now = 0, dropped = 0, peak = 0, misses = 0;
+    if (sscanf(p, "Heartbeat @%lu log dropped=%lu peak=%lu sched misses=%lu", &now, &dropped, &peak, &misses) == 4) {
+      if (obs.heartbeats) {
+        uint32_t d = (uint32_t)now - obs.lastHb;   // 跨 millis() 回绕也成立
+        uint32_t dev = d > SIM_HEARTBEAT_MS ? d - SIM_HEARTBEAT_MS : SIM_HEARTBEAT_MS - d;
+        if (dev > obs.hbMaxDevMs) obs.hbMaxDevMs = dev;
+      }
+      uint32_t lag = millis() - (uint32_t)now;
+      if (lag > obs.hbMaxLagMs) obs.hbMaxLagMs = lag;
+      obs.lastHb = (uint32_t)now;
+      obs.heartbeats++;
+      obs.logDropped = dropped;
+      obs.logPeak = peak;
+      obs.schedMisses = misses;
+    }
+  } else if (strstr(s, "Date rollover -> ")) {
+    obs.dateRollovers++;
+  } else if ((p = strstr(s, "CO2 value: "))) {
+    uint32_t v = (uint32_t)strtoul(p + 11, nullptr, 10);
+    if (v) { obs.co2Lo = v < obs.co2Lo ? v : obs.co2Lo; obs.co2Hi = v > obs.co2Hi ? v : obs.co2Hi; }
+  } else if (strstr(s, "DHT read -> ")) {
+    obs.sensorTicks++;
+    if (strstr(s, "(NaN)")) obs.dhtNan++;
+  } else if (strstr(s, "CO2 frame checksum mismatch")) {
+    obs.chkMismatch++;
+  } else if (strstr(s, "CO2 frame out of range")) {
+    obs.outOfRange++;
+  } else if (!strncmp(s, "[log] dropped ", 14)) {
+    obs.dropNotes++;
+  } else if (!strncmp(s, "time ", 5) && (p = strstr(s, "epoch=")) && obs.timeReplies < 3) {
+    uint32_t i = obs.timeReplies++;
+    obs.epoch[i] = (uint32_t)strtoul(p + 6, nullptr, 10);
+    if ((p = strstr(s, "rollovers="))) obs.rollovers[i] = (uint32_t)strtoul(p + 10, nullptr, 10);
+    obs.replyMs[i] = simNowMs();
+    obs.ticksAt[i] = obs.sensorTicks;
+  } else if (!strncmp(s, "data co2 ", 9)) {
+    unsigned long n1m = 0, n1h = 0, histT = 0, histN = 0, logT = 0;
+    long m1m = 0, m1h = 0;
+    unsigned n10 = 0;
+    if (sscanf(s, "data co2 1m n=%lu mean=%ld 1h n=%lu mean=%ld hist t=%lu n=%lu log t=%lu n10=%u", &n1m, &m1m, &n1h,
+               &m1h, &histT, &histN, &logT, &n10) == 8)
+      onData(n1m, m1m, n1h, m1h, (uint32_t)histT, (uint32_t)histN, (uint32_t)logT, n10);
+  }
+}
+
+static void onSerial(const uint8_t *buf, size_t n) {
+  obs.bytes += n;
+  for (size_t i = 0; i < n; i++) {
+    char c = (char)buf[i];
+    if (c == '\r') continue;
+    if (c == '\n') {
+      lineBuf[lineLen] = 0;
+      onLine(lineBuf);
+      lineLen = 0;
+    } else if (lineLen < SIM_LINE_MAX - 1) {
+      lineBuf[lineLen++] = c;
+    }
+  }
+}
+
+// ---- 传感器替身 ----
+static bool simDht(uint32_t, float *t, float *h) {
+  sim.dhtReads++;
+  if (sim.dhtFail) { sim.dhtFail--; sim.dhtFailed++; return false; }
+  uint64_t ms = simNowMs();
+  *t = (float)sim.temp.at(ms);
+  *h = (float)sim.hum.at(ms);
+  return true;
+}
+
+static uint32_t simRand() {
+  sim.rng ^= sim.rng << 13; sim.rng ^= sim.rng >> 17; sim.rng ^= sim.rng << 5;
+  return sim.rng;
+}
+
+static void feedCo2(uint64_t uptoMs) {
+  while (sim.nextFrameMs <= uptoMs) {
+    uint64_t t = sim.nextFrameMs;
+    sim.nextFrameMs += sim.framePeriodMs;
+    if (!sim.co2On || !sim.uart) continue;
+    double v = sim.co2.at(t);
+    if (sim.co2Noise) v += (double)(simRand() % (2 * sim.co2Noise + 1)) - sim.co2Noise;
+    uint32_t ppm = v < 0 ? 0 : v > 65535 ? 65535 : (uint32_t)(v + 0.5);
+    if (ppm < sim.co2Lo) sim.co2Lo = ppm;
+    if (ppm > sim.co2Hi) sim.co2Hi = ppm;
+    uint8_t f[CO2_FRAME_LEN] = { CO2_FRAME_HDR0, CO2_FRAME_HDR1, 0x00, 0x1C };
+    f[6] = (uint8_t)(ppm >> 8);
+    f[7] = (uint8_t)ppm;
+    f[CO2_FRAME_LEN - 1] = co2FrameChecksum(f);
+    if (sim.co2Bad) { f[CO2_FRAME_LEN - 1] ^= 0x5A; sim.co2Bad--; sim.badFramesSent++; }
+    else if (ppm >= CO2_PPM_MIN && ppm <= CO2_PPM_MAX) sim.goodFrames[sim.goodCount++ % SIM_FRAME_RING] = SimFrame{ t, ppm };
+    sim.uart->hostFeed(f, sizeof(f), sim.startUs + t * 1000);
+    sim.framesSent++;
+  }
+}
+
+// ---- 脚本 ----
+// 每行：[daily] <时刻> <命令> [参数]；时刻为秒数、hh:mm[:ss] 或 Nd[hh:mm[:ss]]（第 N 天，从 0 起），
+// 相对仿真开始；daily 行只写一天内的时刻，每天重复。命令：
+//   co2 <ppm> [渐变分钟] | co2 noise <ppm> | co2 off | co2 on | co2 bad <n>
+//   temp <°C> [渐变分钟] | hum <%RH> [渐变分钟] | dht fail <n> | cmd <串口控制台命令>
+// 仿真自己用 "time" 命令测量漂移，脚本里再设时间会使漂移检查失效
+static const char *kDefaultScript =
+    "0 temp 21.5\n"
+    "0 hum 45\n"
+    "0 co2 noise 8\n"
+    "daily 00:00 co2 430 30\n"
+    "daily 08:30 co2 900 60\n"
+    "daily 09:30 co2 1350 120\n"
+    "daily 12:00 co2 700 45\n"
+    "daily 13:00 co2 1200 90\n"
+    "daily 18:00 co2 480 120\n"
+    "daily 06:00 hum 52 120\n"
+    "daily 07:00 temp 23.5 90\n"
+    "daily 14:00 hum 40 240\n"
+    "daily 19:00 temp 20.5 180\n"
+    "daily 03:00 dht fail 3\n"
+    "1d10:00 co2 bad 5\n"
+    "2d04:00 co2 off\n"
+    "2d04:10 co2 on\n"
+    "3d12:00 co2 12000\n"
+    "3d12:01 co2 700\n"
+    "5d09:00 cmd stats\n";
+
+static bool parseWhen(const char *s, uint64_t &ms) {
+  unsigned d = 0, h = 0, m = 0, sec = 0;
+  const char *p = s;
+  const char *dpos = strchr(s, 'd');
+  if (dpos) { d = (unsigned)strtoul(s, nullptr, 10); p = dpos + 1; if (!*p) { ms = d * SIM_DAY_MS; return true; } }
+  if (strchr(p, ':')) {
+    if (sscanf(p, "%u:%u:%u", &h, &m, &sec) < 2) return false;
+  } else {
+    if (dpos) return false;
+    char *end;
+    double v = strtod(p, &end);
+    if (end == p) return false;
+    ms = (uint64_t)(v * 1000);
+    return true;
+  }
+  ms = d * SIM_DAY_MS + ((uint64_t)h * 3600 + m * 60 + sec) * 1000;
+  return true;
+}
+
+static bool loadScript(const char *text, uint32_t days, std::vector<SimEvent> &out) {
+  uint32_t order = 0, lineNo = 0;
+  const char *p = text;
+  while (*p) {
+    const char *e = strchr(p, '\n');
+    size_t n = e ? (size_t)(e - p) : strlen(p);
+    char line[160];
+    if (n >= sizeof(line)) n = sizeof(line) - 1;
+    memcpy(line, p, n);
+    line[n] = 0;
+    p = e ? e + 1 : p + n;
+    lineNo++;
+    char *c = strchr(line, '#');
+    if (c) *c = 0;
+    char when[32], rest[96];
+    bool daily = !strncmp(line, "daily ", 6);
+    if (sscanf(daily ? line + 6 : line, " %31s %95[^\n]", when, rest) != 2) {
+      if (strspn(line, " \t") != strlen(line)) { fprintf(stderr, "script line %u: cannot parse\n", lineNo); return false; }
+      continue;
+    }
+    uint64_t ms;
+    if (!parseWhen(when, ms) || (daily && ms >= SIM_DAY_MS)) {
+      fprintf(stderr, "script line %u: bad time '%s'\n", lineNo, when);
+      return false;
+    }
+    for (uint32_t d = 0; d < (daily ? days + 1 : 1); d++) {
+      SimEvent ev;
+      ev.ms = ms + (daily ? d * SIM_DAY_MS : 0);
+      ev.order = order++;
+      snprintf(ev.cmd, sizeof(ev.cmd), "%s", rest);
+      out.push_back(ev);
+    }
+  }
+  std::sort(out.begin(), out.end(), [](const SimEvent &a, const SimEvent &b) {
+    return a.ms != b.ms ? a.ms < b.ms : a.order < b.order;
+  });
+  return true;
+}
+
+static bool readFile(const char *path, std::string &out) {
+  FILE *f = fopen(path, "rb");
+  if (!f) return false;
+  char buf[4096];
+  size_t n;
+  while ((n = fread(buf, 1, sizeof(buf), f)) > 0) out.append(buf, n);
+  fclose(f);
+  return true;
+}
+
+static void runEvent(const SimEvent &ev) {
+  char what[16] = "", arg[80] = "";
+  double v = 0, ramp = 0;
+  sscanf(ev.cmd, "%15s %79[^\n]", what, arg);
+  uint64_t rampMs;
+  if (!strcmp(what, "cmd")) {
+    char line[96];
+    snprintf(line, sizeof(line), "%s\n", arg);
+    hostSerialFeed(line);
+    return;
+  }
+  if (!strcmp(what, "co2")) {
+    unsigned n = 0;
+    if (!strcmp(arg, "off")) sim.co2On = false;
+    else if (!strcmp(arg, "on")) sim.co2On = true;
+    else if (sscanf(arg, "bad %u", &n) == 1) sim.co2Bad += n;
+    else if (sscanf(arg, "noise %u", &n) == 1) sim.co2Noise = n;
+    else if (sscanf(arg, "%lf %lf", &v, &ramp) >= 1) { rampMs = (uint64_t)(ramp * 60000); sim.co2.set(v, ev.ms, rampMs); }
+    else fprintf(stderr, "script: bad co2 command '%s'\n", ev.cmd);
+  } else if (!strcmp(what, "temp") || !strcmp(what, "hum")) {
+    if (sscanf(arg, "%lf %lf", &v, &ramp) >= 1) {
+      rampMs = (uint64_t)(ramp * 60000);
+      (what[0] == 't' ? sim.temp : sim.hum).set(v, ev.ms, rampMs);
+    }
+  } else if (!strcmp(what, "dht")) {
+    unsigned n = 0;
+    if (sscanf(arg, "fail %u", &n) == 1) sim.dhtFail += n;
+  } else {
+    fprintf(stderr, "script: unknown command '%s'\n", ev.cmd);
+  }
+}
+
+// ---- 按天统计 ----
+struct SimDay {
+  uint64_t newCalls = 0, deleteCalls = 0;
+  int64_t newLive = 0;
+  size_t heapUsed = 0, heapArena = 0, heapFree = 0;
+  uint64_t logBytes = 0, frames = 0, ticks = 0;
+  uint32_t logDropped = 0, schedMisses = 0;
+};
+
+static SimDay sampleDay() {
+  struct mallinfo2 mi = mallinfo2();
+  SimDay d;
+  d.newCalls = gNewCalls;
+  d.deleteCalls = gDeleteCalls;
+  d.newLive = gNewLive;
+  d.heapUsed = mi.uordblks;
+  d.heapArena = mi.arena;
+  d.heapFree = mi.fordblks;
+  d.logBytes = obs.bytes;
+  d.frames = sim.framesSent;
+  d.ticks = obs.sensorTicks;
+  d.logDropped = obs.logDropped;
+  d.schedMisses = obs.schedMisses;
+  return d;
+}
+
+static bool check(bool ok, const char *what, int &failures) {
+  printf("  %-4s %s\n", ok ? "ok" : "FAIL", what);
+  if (!ok) failures++;
+  return ok;
+}
+
+int main(int argc, char **argv) {
+  uint32_t days = 30;
+  uint64_t startMs = 0;
+  uint32_t epoch0 = (uint32_t)wallDaysFromCivil(2026, 1, 1) * WALL_SECS_PER_DAY;
+  uint32_t baud = 9600;
+  const char *scriptPath = nullptr, *shotPath = nullptr;
+  bool echo = false;
+  for (int i = 1; i < argc; i++) {
+    const char *a = argv[i];
+    bool more = i + 1 < argc;
+    if (!strcmp(a, "--days") && more) days = (uint32_t)strtoul(argv[++i], nullptr, 10);
+    else if (!strcmp(a, "--script") && more) scriptPath = argv[++i];
+    else if (!strcmp(a, "--start-ms") && more) startMs = strtoull(argv[++i], nullptr, 10);
+    else if (!strcmp(a, "--epoch") && more) epoch0 = (uint32_t)strtoul(argv[++i], nullptr, 10);
+    else if (!strcmp(a, "--co2-period") && more) sim.framePeriodMs = (uint32_t)strtoul(argv[++i], nullptr, 10);
+    else if (!strcmp(a, "--baud") && more) baud = (uint32_t)strtoul(argv[++i], nullptr, 10);
+    else if (!strcmp(a, "--shot") && more) shotPath = argv[++i];
+    else if (!strcmp(a, "--echo")) echo = true;
+    else {
+      fprintf(stderr,
+              "usage: %s [--days N] [--script FILE] [--start-ms MS] [--epoch S] [--co2-period MS] [--baud B] "
+              "[--shot out.ppm] [--echo]\n",
+              argv[0]);
+      return 2;
+    }
+  }
+  if (!days || !sim.framePeriodMs) { fprintf(stderr, "--days and --co2-period must be > 0\n"); return 2; }
+
+  std::string scriptText = kDefaultScript;
+  if (scriptPath) {
+    scriptText.clear();
+    if (!readFile(scriptPath, scriptText)) { fprintf(stderr, "cannot read %s\n", scriptPath); return 1; }
+  }
+  std::vector<SimEvent> events;
+  if (!loadScript(scriptText.c_str(), days, events)) return 1;
+
+  static VirtualPanel panel;
+  hostSerialQuiet(!echo);
+  hostSerialTap(onSerial);
+  if (shotPath) hostAttachPanel(&panel, SIM_PIN_DC, SIM_PIN_CS);   // 面板解析约占三成时间，只在要截图时接上
+  hostDhtSource(simDht);
+  hostSetMicros(startMs * 1000);
+  sim.startUs = hostMicros64();
+  sim.uart = hostUart(SIM_CO2_UART);
+  sim.co2.set(450, 0, 0);
+  sim.temp.set(22, 0, 0);
+  sim.hum.set(45, 0, 0);
+
+  // 传感器一上电就开始发帧：开机阶段的帧在 begin() 之前到达，按硬件行为丢弃
+  size_t nextEv = 0;
+  auto pumpInputs = [&](uint64_t nowMs) {
+    while (nextEv < events.size() && events[nextEv].ms <= nowMs + SIM_FEED_AHEAD_MS) runEvent(events[nextEv++]);
+    feedCo2(nowMs + SIM_FEED_AHEAD_MS);
+  };
+  pumpInputs(0);
+
+  auto wall0 = std::chrono::steady_clock::now();
+  setup();
+
+  // 日志发送按波特率限速：credit 为本轮可写入 UART FIFO 的字节
+  uint64_t lastPumpUs = hostMicros64();
+  double credit = SIM_LOG_FIFO;
+  auto pumpLog = [&]() {
+    uint64_t now = hostMicros64();
+    if (!baud) { deferredLogPump(); lastPumpUs = now; return; }
+    credit += (double)(now - lastPumpUs) * baud / 10.0 / 1e6;
+    lastPumpUs = now;
+    if (credit > SIM_LOG_FIFO) credit = SIM_LOG_FIFO;
+    if (credit >= 1) credit -= (double)deferredLogPump((size_t)credit);
+  };
+  pumpLog();
+
+  // 先设时钟，设置回显几秒后取基准（开机耗时不定，例如 HOTPATH_BENCH）；结束时再取一次，两次之间比较墙上时钟与虚拟时间
+  char setCmd[32];
+  snprintf(setCmd, sizeof(setCmd), "time %lu\n", (unsigned long)epoch0);
+  hostSerialFeed(setCmd);
+  bool baselineAsked = false, finalAsked = false;
+
+  std::vector<SimDay> dayRows;
+  dayRows.reserve(days + 1);
+  uint64_t endMs = days * SIM_DAY_MS;
+  uint64_t nextDayMs = SIM_DAY_MS;
+  uint64_t nextDataMs = SIM_DATA_FROM_MS;
+  uint32_t wraps = 0, prevMillis = millis();
+  uint64_t loops = 0;
+  for (;;) {
+    loop();
+    loops++;
+    uint64_t nowMs = simNowMs();
+    uint32_t m = millis();
+    if (m < prevMillis) wraps++;
+    prevMillis = m;
+    pumpInputs(nowMs);
+    pumpLog();
+    if (!baselineAsked && obs.timeReplies >= 1 && nowMs >= obs.replyMs[0] + 5000) { hostSerialFeed("time\n"); baselineAsked = true; }
+    if (nowMs >= nextDataMs) {
+      hostSerialFeed("data\n");
+      obs.dataAskMs = nowMs;
+      nextDataMs += SIM_DATA_MS;
+    }
+    if (nowMs >= nextDayMs) {
+      dayRows.push_back(sampleDay());
+      nextDayMs += SIM_DAY_MS;
+    }
+    if (nowMs >= endMs && !finalAsked) { hostSerialFeed("time\n"); finalAsked = true; }
+    if (finalAsked && (obs.timeReplies >= 3 || nowMs >= endMs + 5000)) break;
+  }
+  double wallS = std::chrono::duration<double>(std::chrono::steady_clock::now() - wall0).count();
+  deferredLogPump();
+
+  if (shotPath) panel.savePpm(shotPath, 0, 34, tft.width(), tft.height());
+
+  // ---- 报告 ----
+  printf("simulated %u days (%llu loops) in %.1fs wall, %.0fx real time; millis start=%llu wraps=%u\n", days,
+         (unsigned long long)loops, wallS, days * 86400.0 / (wallS > 0 ? wallS : 1e-9), (unsigned long long)startMs,
+         wraps);
+  printf("inputs: co2 frames=%llu bad=%llu scripted %.0f..%.0f ppm, dht reads=%llu failed=%llu, events=%zu\n",
+         (unsigned long long)sim.framesSent, (unsigned long long)sim.badFramesSent, sim.co2Lo, sim.co2Hi,
+         (unsigned long long)sim.dhtReads, (unsigned long long)sim.dhtFailed, events.size());
+  HardwareSerial *u = sim.uart;
+  printf("co2 uart: read=%llu overflow=%llu dropped before begin=%llu\n", u ? (unsigned long long)u->rxBytes : 0ULL,
+         u ? (unsigned long long)u->rxOverflow : 0ULL, u ? (unsigned long long)u->rxDropped : 0ULL);
+  printf("serial: %llu lines %llu bytes, heartbeats=%llu interval dev max=%ums lag max=%ums, log dropped=%u peak=%u\n",
+         (unsigned long long)obs.lines, (unsigned long long)obs.bytes, (unsigned long long)obs.heartbeats,
+         obs.hbMaxDevMs, obs.hbMaxLagMs, obs.logDropped, obs.logPeak);
+  printf("firmware: co2 shown %u..%u ppm, checksum warnings=%llu out of range=%llu, dht NaN=%llu, rollovers=%llu\n",
+         obs.co2Lo == UINT32_MAX ? 0 : obs.co2Lo, obs.co2Hi, (unsigned long long)obs.chkMismatch,
+         (unsigned long long)obs.outOfRange, (unsigned long long)obs.dhtNan, (unsigned long long)obs.dateRollovers);
+
+  printf("\n day  heap used  arena    free  | new/day  delete/day  new live | log KB/day frames  ticks  drop miss\n");
+  SimDay prev;
+  for (size_t i = 0; i < dayRows.size(); i++) {
+    const SimDay &d = dayRows[i];
+    printf("%4zu %10zu %8zu %7zu | %7llu %11llu %9lld | %10.1f %6llu %6llu %5u %4u\n", i + 1, d.heapUsed, d.heapArena,
+           d.heapFree, (unsigned long long)(d.newCalls - prev.newCalls),
+           (unsigned long long)(d.deleteCalls - prev.deleteCalls), (long long)d.newLive,
+           (d.logBytes - prev.logBytes) / 1024.0, (unsigned long long)(d.frames - prev.frames),
+           (unsigned long long)(d.ticks - prev.ticks), d.logDropped, d.schedMisses);
+    prev = d;
+  }
+
+  printf("\nchecks:\n");
+  int failures = 0;
+  char what[192];
+  if (obs.timeReplies >= 3) {
+    double virtS = (double)(obs.replyMs[2] - obs.replyMs[1]) / 1000.0;
+    double wallDelta = (double)obs.epoch[2] - (double)obs.epoch[1];
+    double drift = wallDelta - virtS;
+    snprintf(what, sizeof(what), "wall clock drift %+.2fs over %.1f days (%+.3f ppm, limit 1s)", drift,
+             virtS / 86400.0, drift / virtS * 1e6);
+    check(drift > -1.0 && drift < 1.0, what, failures);
+    uint32_t expRoll = obs.epoch[2] / WALL_SECS_PER_DAY - obs.epoch[1] / WALL_SECS_PER_DAY;
+    uint32_t gotRoll = obs.rollovers[2] - obs.rollovers[1];
+    snprintf(what, sizeof(what), "date rollovers %u, expected %u", gotRoll, expRoll);
+    check(gotRoll == expRoll, what, failures);
+    double expTicks = virtS;
+    double gotTicks = (double)(obs.ticksAt[2] - obs.ticksAt[1]);
+    snprintf(what, sizeof(what), "sensor task ran %.0f times in %.0fs", gotTicks, expTicks);
+    check(gotTicks > expTicks - 2 && gotTicks < expTicks + 2, what, failures);
+  } else {
+    check(false, "console did not answer the \"time\" queries", failures);
+  }
+  snprintf(what, sizeof(what), "heartbeat interval within 50 ms of %u ms (max dev %u ms)", SIM_HEARTBEAT_MS,
+           obs.hbMaxDevMs);
+  check(obs.heartbeats > 1 && obs.hbMaxDevMs <= 50, what, failures);
+  if (dayRows.size() >= 2) {
+    const SimDay &d1 = dayRows.front(), &dn = dayRows.back();
+    long long growth = (long long)dn.heapUsed - (long long)d1.heapUsed;
+    snprintf(what, sizeof(what), "heap in use after day 1 grew %lld bytes (limit 1024), new live %lld -> %lld", growth,
+             (long long)d1.newLive, (long long)dn.newLive);
+    check(growth <= 1024 && dn.newLive - d1.newLive <= 1024, what, failures);
+    snprintf(what, sizeof(what), "no scheduler misses after day 1 (%u -> %u)", d1.schedMisses, dn.schedMisses);
+    check(dn.schedMisses == d1.schedMisses, what, failures);
+    snprintf(what, sizeof(what), "no log drops after day 1 (%u -> %u)", d1.logDropped, dn.logDropped);
+    check(dn.logDropped == d1.logDropped, what, failures);
+  }
+  snprintf(what, sizeof(what), "co2 rolling windows match the frames sent in %u/%u data replies%s",
+           obs.dataReplies - obs.rollBad, obs.dataReplies, obs.rollFirstBad);
+  check(obs.dataReplies && !obs.rollBad, what, failures);
+  snprintf(what, sizeof(what), "history accepted a sample every second between replies%s", obs.histFirstBad);
+  check(obs.dataReplies > 1 && !obs.histBad, what, failures);
+  snprintf(what, sizeof(what), "flash log time advanced with uptime and read back%s", obs.logFirstBad);
+  check(obs.dataReplies > 1 && !obs.logBad, what, failures);
+  snprintf(what, sizeof(what), "checksum warnings %llu match injected bad frames %llu",
+           (unsigned long long)obs.chkMismatch, (unsigned long long)sim.badFramesSent);
+  check(obs.chkMismatch == sim.badFramesSent, what, failures);
+  snprintf(what, sizeof(what), "co2 uart never overflowed (%llu)", u ? (unsigned long long)u->rxOverflow : 0ULL);
+  check(u && !u->rxOverflow, what, failures);
+  printf("%s\n", failures ? "FAIL" : "OK");
+  return failures ? 1 : 0;
+}
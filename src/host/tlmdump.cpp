@@ -0,0 +1,121 @@
+// 二进制遥测流解码：把串口抓包（TELEMETRY_BINARY 固件输出）转成 CSV 或 JSON Lines
+// 用法：tlmdump [--json] [--text] [capture.bin|-]
+//   --json  每条记录一行 JSON（默认 CSV，首列为记录类型）
+//   --text  把混在流中的文本行（启动信息、告警）原样输出到 stderr
+#include <stdio.h>
+#include <string.h>
+#include "telemetry_stream.h"
+
+static bool jsonOut = false;
+
+static void hexField(char *out, const uint8_t *p, size_t n) {
+  static const char hexd[] = "0123456789ABCDEF";
+  for (size_t i = 0; i < n; i++) { *out++ = hexd[p[i] >> 4]; *out++ = hexd[p[i] & 0xF]; }
+  *out = 0;
+}
+
+static void printHeader() {
+  printf("# sample,seq,ms,co2,temp_c,hum_pct,co2_mean_1m,flags\n");
+  printf("# raw,seq,ms,frame_hex\n");
+  printf("# checksum,seq,ms,expected,got,ppm,range_error\n");
+  printf("# timing,seq,ms,loops,loop_max_us,loop_mean_us,co2_accepted,co2_rejected,dht_rejected,log_dropped\n");
+}
+
+static void printRecord(const TlmRecord &r) {
+  switch (r.type) {
+    case TLM_SAMPLE: {
+      if (r.len < sizeof(TlmSample)) break;
+      TlmSample s;
+      memcpy(&s, r.payload, sizeof(s));
+      if (jsonOut) {
+        printf("{\"type\":\"sample\",\"seq\":%u,\"ms\":%u,\"co2\":%u,\"temp_c\":%.2f,\"hum_pct\":%.2f,\"co2_mean_1m\":%u,\"flags\":%u}\n",
+               r.seq, s.ms, s.co2, s.temp / 100.0, s.hum / 100.0, s.co2Mean1m, s.flags);
+      } else {
+        printf("sample,%u,%u,%u,%.2f,%.2f,%u,%u\n", r.seq, s.ms, s.co2, s.temp / 100.0, s.hum / 100.0, s.co2Mean1m, s.flags);
+      }
+      return;
+    }
+    case TLM_RAW_FRAME: {
+      if (r.len < sizeof(TlmRawFrame)) break;
+      TlmRawFrame f;
+      memcpy(&f, r.payload, sizeof(f));
+      char hex[2 * sizeof(f.frame) + 1];
+      hexField(hex, f.frame, sizeof(f.frame));
+      if (jsonOut) printf("{\"type\":\"raw\",\"seq\":%u,\"ms\":%u,\"frame\":\"%s\"}\n", r.seq, f.ms, hex);
+      else printf("raw,%u,%u,%s\n", r.seq, f.ms, hex);
+      return;
+    }
+    case TLM_CHECKSUM: {
+      if (r.len < sizeof(TlmChecksum)) break;
+      TlmChecksum c;
+      memcpy(&c, r.payload, sizeof(c));
+      if (jsonOut) {
+        printf("{\"type\":\"checksum\",\"seq\":%u,\"ms\":%u,\"expected\":%u,\"got\":%u,\"ppm\":%u,\"range_error\":%s}\n",
+               r.seq, c.ms, c.expected, c.got, c.ppm, c.rangeError ? "true" : "false");
+      } else {
+        printf("checksum,%u,%u,%u,%u,%u,%u\n", r.seq, c.ms, c.expected, c.got, c.ppm, c.rangeError);
+      }
+      return;
+    }
+    case TLM_TIMING: {
+      if (r.len < sizeof(TlmTiming)) break;
+      TlmTiming t;
+      memcpy(&t, r.payload, sizeof(t));
+      if (jsonOut) {
+        printf("{\"type\":\"timing\",\"seq\":%u,\"ms\":%u,\"loops\":%u,\"loop_max_us\":%u,\"loop_mean_us\":%u,"
+               "\"co2_accepted\":%u,\"co2_rejected\":%u,\"dht_rejected\":%u,\"log_dropped\":%u}\n",
+               r.seq, t.ms, t.loops, t.loopMaxUs, t.loopMeanUs, t.co2Accepted, t.co2Rejected, t.dhtRejected, t.logDropped);
+      } else {
+        printf("timing,%u,%u,%u,%u,%u,%u,%u,%u,%u\n", r.seq, t.ms, t.loops, t.loopMaxUs, t.loopMeanUs,
+               t.co2Accepted, t.co2Rejected, t.dhtRejected, t.logDropped);
+      }
+      return;
+    }
+    default:
+      break;
+  }
+  // 未知类型或负载过短：保留原始内容，方便新旧固件混用
+  char hex[2 * TLM_MAX_PAYLOAD + 1];
+  hexField(hex, r.payload, r.len);
+  if (jsonOut) printf("{\"type\":\"unknown\",\"id\":%u,\"seq\":%u,\"payload\":\"%s\"}\n", r.type, r.seq, hex);
+  else printf("unknown%u,%u,%s\n", r.type, r.seq, hex);
+}
+
+int main(int argc, char **argv) {
+  const char *path = "-";
+  bool echoText = false;
+  for (int i = 1; i < argc; i++) {
+    if (!strcmp(argv[i], "--json")) jsonOut = true;
+    else if (!strcmp(argv[i], "--text")) echoText = true;
+    else if (argv[i][0] == '-' && argv[i][1]) { fprintf(stderr, "usage: %s [--json] [--text] [capture.bin|-]\n", argv[0]); return 2; }
+    else path = argv[i];
+  }
+  FILE *f = strcmp(path, "-") ? fopen(path, "rb") : stdin;
+  if (!f) { perror(path); return 1; }
+  if (!jsonOut) printHeader();
+
+  static TelemetryDeframer deframer;
+  TlmRecord r;
+  uint64_t bytes = 0;
+  uint8_t buf[4096];
+  size_t n;
+  while ((n = fread(buf, 1, sizeof(buf), f)) > 0) {
+    bytes += n;
+    for (size_t i = 0; i < n; i++) {
+      if (deframer.push(buf[i], r)) { printRecord(r); continue; }
+      size_t tn;
+      const uint8_t *text = deframer.lastBadSegment(tn);
+      if (tn) {
+        if (echoText) fwrite(text, 1, tn, stderr);
+        deframer.clearBadSegment();
+      }
+    }
+  }
+  if (f != stdin) fclose(f);
+
+  const TlmDeframerStats &st = deframer.stats();
+  fprintf(stderr, "tlmdump: %llu bytes, %llu records, %llu non-frame segments (%llu bytes), %llu seq gaps (%llu lost)\n",
+          (unsigned long long)bytes, (unsigned long long)st.records, (unsigned long long)st.badFrames,
+          (unsigned long long)st.skippedBytes, (unsigned long long)st.seqGaps, (unsigned long long)st.lostRecords);
+  return 0;
+}
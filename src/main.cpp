@@ -1,7 +1,23 @@
 // 四行数据显示：日期/CO2/温度/湿度，屏幕方向上下颠倒
 #include <Arduino.h>
 #include <ST7789_AVR.h>
+#include <rgb565_simd.h>
 #include "display_helper.h"  // 使用新的display_helper.h
+#include "sample_pipeline.h"
+#include "history_store.h"
+#include "flash_log.h"
+#include "trace_format.h"
+#include "deferred_log.h"
+#include "telemetry_stream.h"
+#include "task_scheduler.h"
+#include "spsc_queue.h"
+#include "sensor_snapshot.h"
+#include "power_manager.h"
+#include "latency_hist.h"
+#include "serial_console.h"
+#include "boot_timeline.h"
+#include "wall_clock.h"
+#include "uptime_clock.h"
 #include <SPI.h>
 // DHT sensor
 #include <DHT.h>
@@ -24,20 +40,93 @@ DHT dht(DHTPIN, DHTTYPE);
 // CO2 传感器串口（被动输出 16 字节帧，每秒一次）
 #define CO2_UART_RX 38
 #define CO2_UART_TX -1  // 未使用
-HardwareSerial co2Serial(0);
+#define CO2_UART_NUM 0
+HardwareSerial co2Serial(CO2_UART_NUM);
 
-// CO2 串口帧缓冲
-static uint8_t co2Buf[64];
-static size_t co2BufLen = 0;
+// CO2 串口帧缓冲（字节流重同步见 co2_frame.h）
+static Co2FrameParser co2Parser;
 static uint32_t co2FrameCount = 0;
 static uint8_t lastFrame[16];
 static uint32_t lastFrameMillis = 0;
 static uint32_t lastByteMillis = 0;
 static uint32_t rxRetryCount = 0;
 
+// 串口日志经 deferred_log.h 的环形缓冲由 core 0 上的任务异步发送，loop() 不再阻塞在 9600 波特率上。
+// 编译期级别：默认 INFO，逐帧/逐块的十六进制转储属于 DEBUG，需要时在包含 deferred_log.h 前定义 LOG_LEVEL 为 LOG_LEVEL_DEBUG
+DeferredLog deferredLog;
+
+// 热路径延迟直方图（log2 分桶，见 latency_hist.h），串口输入 "stats" 输出，"stats reset" 清零；
+// "stats render" 输出 ST7789_AVR 开机以来按图元/按行累计的总线开销。
+// 每个直方图只在一个任务里记录：loop/co2/dht/uart-late 在采集侧，display 在渲染侧，log-write 在日志任务
+static LatencyHist latLoop("loop");            // 每轮调度中任务执行耗时（不含空闲等待）
+static LatencyHist latCo2("co2-frame");        // processCo2Buffer（仅统计解析出帧的调用）
+static LatencyHist latDht("dht-read");         // DHT 温湿度读取（单总线时序，阻塞）
+static LatencyHist latDisplay("display");      // updateDisplay
+static LatencyHist latUartLate("uart-late");   // 串口轮询相对到期时间的延迟（毫秒精度），即调度抖动
+static LatencyHist latLogWrite("log-write");   // 日志任务每次写串口的阻塞时间
+static LatencyHist *const latHists[] = { &latLoop, &latCo2, &latDht, &latDisplay, &latUartLate, &latLogWrite };
+static SerialConsole console;
+
+// 包在 Serial 外面，统计日志任务每次写出阻塞了多久
+class TimedPrint : public Print {
+ public:
+  explicit TimedPrint(Print &out) : out(out) {}
+  size_t write(uint8_t c) override { return write(&c, 1); }
+  using Print::write;
+  size_t write(const uint8_t *buf, size_t n) override {
+    uint32_t t0 = latNowUs();
+    size_t k = out.write(buf, n);
+    latLogWrite.since(t0);
+    return k;
+  }
+
+ private:
+  Print &out;
+};
+static TimedPrint timedSerial(Serial);
+
 // 临时串口自检开关
 // #define SERIAL_TEST 0
 
+// 现场录制开关：串口额外输出 "T:" 开头的 trace 行（CO2 串口原始字节、DHT 读数、millis），
+// 抓取串口日志后可用主机端 replay（pio run -e native_replay）离线回放整条传感器到屏幕的流程
+// #define TRACE_RECORD
+
+// 二进制遥测开关：逐帧/每秒的文本日志改为 COBS 分帧的二进制记录（格式见 telemetry_stream.h），
+// 每秒串口字节数降到原来的几分之一；抓包后用主机端 tlmdump（pio run -e native_tlmdump）转为 CSV/JSON
+// #define TELEMETRY_BINARY
+
+// 热路径微基准开关：面板就绪后在真实屏幕上跑一遍 hotpath_bench.h 的用例（CPU 周期计），JSON 直接写串口，
+// 之后按冷启动重画布局；抓下的串口日志可用主机端 microbench --compare（pio run -e native_microbench）与其它版本对比
+// #define HOTPATH_BENCH
+
+// 抗锯齿数字开关：数值与日期用 4x4 超采样的字形蒙版整格绘制（总线字节不多于原字体的逐像素更新）；
+// CO2 告警横幅（DISPLAY_ALERT，默认开启）与之独立，阈值等见 display_helper.h
+// #define DISPLAY_AA_TEXT 1
+
+#ifdef TELEMETRY_BINARY
+#define TLM_TIMING_PERIOD_MS 10000
+static TelemetryStream tlmStream;
+
+static_assert(TLM_MAX_FRAME <= LOG_SLOT_TEXT, "a telemetry frame must fit in one log slot");
+static void tlmEmit(uint8_t level, uint8_t type, const void *payload, uint8_t len) {
+  uint8_t out[TLM_MAX_FRAME];
+  size_t n = tlmStream.frame(type, payload, len, out);
+  // frame() 保证 n ≤ TLM_MAX_FRAME；显式夹住，让编译器看出 write() 的截断分支到不了，不会从 out 之外拷贝
+  deferredLog.write(level, (const char *)out, n < sizeof(out) ? n : sizeof(out));
+}
+#endif
+
+#ifdef TRACE_RECORD
+static void traceEmit(uint8_t type, uint32_t ms, const void *payload, uint8_t len) {
+  uint8_t rec[TRACE_MAX_RECORD];
+  char line[2 * TRACE_MAX_RECORD + 4];
+  size_t n = traceEncode(rec, type, ms, payload, len);
+  size_t k = traceToHexLine(rec, n, line);
+  deferredLog.write(LOG_LEVEL_ERROR, line, k);   // 与普通日志同一通道，避免两路并发写串口交错
+}
+#endif
+
 // 字体尺寸（与display_helper.h保持一致）
 uint8_t gFirstLineSize = 3;
 uint8_t gOtherLineSize = 3;
@@ -45,163 +134,874 @@ uint8_t gOtherLineSize = 3;
 // 全局变量定义（在display_helper.h中extern声明）
 bool layoutInited = false;
 DisplayState displayState;
-int16_t yDate, yLine, yCo2, yTemp, yHum, xUnit;
 
-// 状态数据
-static uint32_t co2ppm = 450;
-static float temperatureC = 25.3f;
-static float humidityPct = 48.5f;
-static uint32_t lastUpdateMs = 0;
+#ifdef HOTPATH_BENCH
+#include "hotpath_bench.h"
+
+// 结果行直接写串口：先等开机日志发完，避免与日志任务的输出交错
+static void runHotpathBench() {
+#if defined(ARDUINO_ARCH_ESP32)
+  while (deferredLog.depth()) delay(1);
+  hotpathBenchRun(Serial, "esp32", __DATE__ " " __TIME__);
+#else
+  deferredLogPump();
+  hotpathBenchRun(Serial, "host-sim", __DATE__ " " __TIME__);
+#endif
+}
+#endif
+
+// 状态数据：采集侧（唯一写者）维护暂存副本 sensorStage，每次变化后整体发布到 sensorSnapshot；
+// 显示、日志、导出等其它任务只通过 sensorSnapshot.read() 取得一致、带时间戳的副本，不加锁
+static SensorSnapshot sensorStage;
+static SensorSnapshotCell sensorSnapshot;
+
+static void publishSnapshot(uint32_t now) {
+  sensorStage.ms = now;
+  sensorSnapshot.write(sensorStage);
+}
+
+// 双核流水线：采集（CO2 串口、DHT、历史/日志）在 core 0，渲染（SPI 刷屏）在 core 1，
+// 二者只通过无锁 SPSC 队列交换显示样本，慢速刷屏不再推迟串口处理。设为 0 回到单一 loop()
+#ifndef DUAL_CORE
+#define DUAL_CORE 1
+#endif
+
+#if DUAL_CORE
+#define DISPLAY_QUEUE_LEN 8
+static SpscQueue<SensorSnapshot, DISPLAY_QUEUE_LEN> displayQueue;   // 按值传递快照
+static TaskHandle_t renderTaskHandle = nullptr;
+#endif
+
+// 低功耗：调度空闲期间进入 light sleep（定时器唤醒 + CO2 串口唤醒兜底），读数稳定时屏幕降功耗，
+// 每 POWER_REPORT_PERIOD_MS 报告清醒占比、唤醒延迟与 CO2 丢帧数（策略见 power_manager.h）。
+// 注意：USB 串口在 light sleep 期间会断开，接电脑调试时保持为 0
+#ifndef LOW_POWER
+#define LOW_POWER 0
+#endif
+
+#if LOW_POWER
+#define POWER_REPORT_PERIOD_MS 10000
+#define PANEL_DIM_BRIGHTNESS   40
+static Co2FramePredictor co2Predictor;
+static PowerStats powerStats;
+static PanelPowerPolicy panelPolicy;           // 仅渲染侧使用
+static volatile uint8_t panelLevel = PANEL_FULL;
+static volatile uint32_t panelDimCount = 0;
+#if DUAL_CORE
+static std::atomic<bool> renderBusy{false};
+#endif
+#endif
+
+// Wi-Fi 指标端点：http://<ip>/metrics（Prometheus 文本）与 /json，响应只在快照变化时重建（见 metrics_http.h）。
+// 需在构建参数中给出 WIFI_SSID / WIFI_PASSWORD；连接处理在采集侧调度器里，每 METRICS_POLL_MS 一轮
+#ifndef METRICS_HTTP
+#define METRICS_HTTP 0
+#endif
+
+// MQTT 批量上报：每 MQTT_BATCH_INTERVAL_MS 把新样本编码成一条消息（见 mqtt_publisher.h），
+// broker 不可达时积压留在闪存日志里，重连后每 MQTT_DRAIN_INTERVAL_MS 补发一批；同样需要 WIFI_SSID / WIFI_PASSWORD
+#ifndef MQTT_BATCH
+#define MQTT_BATCH 0
+#endif
+
+#define NET_WIFI (METRICS_HTTP || MQTT_BATCH)
+#if NET_WIFI
+#if LOW_POWER
+#error "light sleep drops the Wi-Fi link: LOW_POWER cannot be combined with METRICS_HTTP / MQTT_BATCH"
+#endif
+#include <WiFi.h>
+#endif
+
+#if METRICS_HTTP
+#include "metrics_http.h"
+#define METRICS_HTTP_PORT 80
+#define METRICS_POLL_MS   20
+static MetricsServer metricsServer;
+#endif
+
+// 采样流水线：校验/去尖峰/滚动统计，显示与导出读取其聚合结果
+static SamplePipeline samplePipeline;
+
+// 多分辨率历史（PSRAM），每秒写入一次滤波后的读数
+static HistoryStore history;
+static bool historyOk = false;
+
+// 闪存样本日志（samplelog 分区），重启后不丢数据；批次最多在 RAM 中停留 5 分钟
+#define FLASH_LOG_FLUSH_SEC 300
+static EspPartitionFlash sampleFlash;
+static FlashLog flashLog;
+static bool flashLogOk = false;
+static uint32_t logTimeBase = 0;   // 日志时间 = 上次日志最后时间 + 本次开机秒数（uptimeSec，跨 millis 回绕），跨重启单调
+static uint32_t lastSampleT = 0;   // 最近一次写入历史/日志的样本时间（日志时间轴）
+
+#if MQTT_BATCH
+#include "mqtt_publisher.h"
+#ifndef MQTT_BROKER_HOST
+#define MQTT_BROKER_HOST "192.168.1.2"   // 点分 IPv4
+#endif
+#ifndef MQTT_BROKER_PORT
+#define MQTT_BROKER_PORT 1883
+#endif
+#ifndef MQTT_CLIENT_ID
+#define MQTT_CLIENT_ID "airmon"
+#endif
+#ifndef MQTT_BATCH_INTERVAL_MS
+#define MQTT_BATCH_INTERVAL_MS 60000
+#endif
+#ifndef MQTT_BATCH_SIZE
+#define MQTT_BATCH_SIZE 120
+#endif
+#ifndef MQTT_DRAIN_INTERVAL_MS
+#define MQTT_DRAIN_INTERVAL_MS 1000
+#endif
+#define MQTT_POLL_MS 100
+#define MQTT_CURSOR_MAGIC 0x3154514DUL   // "MQT1"
+
+// 积压来源：优先闪存日志；闪存不可用时退回 PSRAM 历史的 1 秒级（只覆盖最近 1 小时）。
+// 闪存不可用时 logTimeBase 为 0，两者时间轴一致
+struct SampleBacklog {
+  size_t read(uint32_t t0, uint32_t t1, TelemetrySample *out, size_t maxOut) {
+    if (flashLogOk) return flashLog.read(t0, t1, out, maxOut);
+    if (!historyOk) return 0;
+    static HistPoint pts[MQTT_BATCH_CAP];
+    size_t n = history.read(HIST_RAW, t0, t1, pts, maxOut < MQTT_BATCH_CAP ? maxOut : MQTT_BATCH_CAP);
+    for (size_t i = 0; i < n; i++) out[i] = { pts[i].t, pts[i].v.co2Mean, pts[i].v.tempMean, pts[i].v.humMean };
+    return n;
+  }
+};
+
+static SampleBacklog sampleBacklog;
+static MqttClient mqttClient;
+static MqttBatchPublisher<SampleBacklog> mqttPublisher(mqttClient, sampleBacklog);
+static char mqttTopic[48];
+RTC_DATA_ATTR static uint32_t mqttCursorKeep[2];   // {magic, 游标}：热复位后接着补发
+#endif
 
 // 持久化 boot 计数
 RTC_DATA_ATTR static uint32_t bootCount = 0;
 
-// 将 __DATE__ 解析为 YYYY-MM-DD
-String formatDate() {
-  const char *dateStr = __DATE__;
-  char monStr[4];
-  int day, year;
-  sscanf(dateStr, "%3s %d %d", monStr, &day, &year);
-  const char *months = "JanFebMarAprMayJunJulAugSepOctNovDec";
-  int monthNum = (strstr(months, monStr) - months) / 3 + 1;
-  char buf[16];
-  snprintf(buf, sizeof(buf), "%04d-%02d-%02d", year, monthNum, day);
-  return String(buf);
-}
-
-// 仅解析 16 字节帧：格式
-// BYTE0=0x42, BYTE1=0x4D, BYTE2..BYTE14=数据内容, BYTE15= (BYTE0+...+BYTE14) & 0xFF
-// CO2 浓度 = BYTE6 * 256 + BYTE7
+// 快速启动：屏幕按数据手册时序异步初始化（ST7789_AVR::initAsync），等待期间并行初始化 DHT、CO2 串口、
+// 历史与闪存日志；去掉固定的 delay(200)/delay(3500)，第一帧有效 CO2 到达即刷新。
+// MCU 单独复位（软件重启/看门狗/panic）且 RTC 内存里的屏幕记录有效时，跳过面板复位与整屏重绘。
+// 各阶段耗时记入 bootTimeline，首次显示真实读数后输出。设为 0 回到原来的阻塞式启动
+#ifndef FAST_BOOT
+#define FAST_BOOT 1
+#endif
+#define DHT_POWERUP_MS      1000    // DHT22 上电后至少 1 s 才能读
+#define BOOT_REPORT_MAX_MS  15000   // 迟迟没有 CO2 帧时也输出时间线
+
+static BootTimeline bootTimeline;
+static std::atomic<uint32_t> firstRenderUs{0};   // 渲染侧写入：首次画出有效 CO2 读数的时间
+#if FAST_BOOT
+RTC_DATA_ATTR static DisplayRetained retainedDisplay;
+static uint32_t displaySig = 0;
+#endif
+
+// 墙上时钟：冷启动取编译时间（编译期解析），热复位接续 RTC 中的值，可经串口 "time <秒>" 设置。
+// 只在采集侧推进，日期随快照交给渲染侧，跨日时才重画日期行
+RTC_DATA_ATTR static WallClockRetained wallClockKeep;
+static WallClock wallClock;
+
+// 仅解析 16 字节帧（格式见 co2_frame.h），校验失败的帧不更新 CO2 读数
 void processCo2Buffer() {
-  while (co2BufLen >= 16) {
-    if (!(co2Buf[0] == 0x42 && co2Buf[1] == 0x4D)) {
-      memmove(co2Buf, co2Buf + 1, co2BufLen - 1);
-      co2BufLen -= 1;
-      continue;
-    }
-    
-    uint16_t sum = 0;
-    for (int i = 0; i <= 14; ++i) sum += co2Buf[i];
-    uint8_t expected = (uint8_t)(sum & 0xFF);
-    uint8_t recvChk = co2Buf[15];
+  uint32_t t0 = latNowUs();
+  bool any = false;
+  uint8_t co2Buf[CO2_FRAME_LEN];
+  while (co2Parser.next(co2Buf)) {
+    any = true;
+    uint8_t expected = co2FrameChecksum(co2Buf);
+    uint8_t recvChk = co2Buf[CO2_FRAME_LEN - 1];
     bool chkOk = (expected == recvChk);
-    uint16_t co2val = ((uint16_t)co2Buf[6] << 8) | co2Buf[7];
-    co2ppm = co2val;
+    uint32_t now = millis();
+    bool accepted = samplePipeline.pushCo2Frame(co2Buf, now);
+    if (accepted) {
+      sensorStage.co2 = (uint32_t)samplePipeline.aggregates().co2.last;
+      sensorStage.co2Ms = now;
+      sensorStage.flags |= SNAP_CO2_VALID;
+    }
+    sensorStage.co2Rejected = samplePipeline.aggregates().co2Rejected;
+    publishSnapshot(now);
     
-    memcpy(lastFrame, co2Buf, 16);
-    lastFrameMillis = millis();
+    memcpy(lastFrame, co2Buf, CO2_FRAME_LEN);
+    lastFrameMillis = now;
     co2FrameCount++;
+#if LOW_POWER
+    co2Predictor.onFrame(now);
+#endif
     
-    Serial.print("CO2 frame: ");
-    for (int i = 0; i < 16; ++i) {
-      if (co2Buf[i] < 16) Serial.print('0');
-      Serial.print(co2Buf[i], HEX); Serial.print(' ');
+#ifdef TELEMETRY_BINARY
+    TlmRawFrame rf;
+    rf.ms = now;
+    memcpy(rf.frame, co2Buf, CO2_FRAME_LEN);
+    tlmEmit(LOG_LEVEL_INFO, TLM_RAW_FRAME, &rf, sizeof(rf));
+    if (!accepted) {
+      TlmChecksum ce = { now, expected, recvChk, co2FramePpm(co2Buf), (uint8_t)chkOk };
+      tlmEmit(LOG_LEVEL_WARN, TLM_CHECKSUM, &ce, sizeof(ce));
     }
-    Serial.print(" -> CO2="); Serial.print(co2ppm);
+#else
     if (!chkOk) {
-      Serial.print(" (checksum mismatch exp="); Serial.print(expected, HEX);
-      Serial.print(" got="); Serial.print(recvChk, HEX); Serial.print(")");
+      LOGW("CO2 frame checksum mismatch exp=%X got=%X", expected, recvChk);
+    } else if (!accepted) {
+      LOGW("CO2 frame out of range: %u", co2FramePpm(co2Buf));
     }
-    Serial.println();
-    
-    if (co2BufLen > 16) memmove(co2Buf, co2Buf + 16, co2BufLen - 16);
-    co2BufLen -= 16;
+#endif
+    if (LOG_ENABLED(LOG_LEVEL_DEBUG)) {
+      char hex[3 * CO2_FRAME_LEN + 1];
+      logHex(hex, sizeof(hex), co2Buf, CO2_FRAME_LEN);
+      LOGD("CO2 frame: %s -> CO2=%u filtered=%lu", hex, co2FramePpm(co2Buf), (unsigned long)sensorStage.co2);
+    }
+  }
+  if (any) latCo2.since(t0);
+}
+
+// ---- 调度任务（周期与相位见 setup() 末尾的注册） ----
+static uint32_t schedMicros() { return (uint32_t)micros(); }
+static TaskScheduler sched(schedMicros);
+static int uartTaskId = -1;
+#if !DUAL_CORE
+static int renderTaskId = -1;
+#endif
+
+#if FAST_BOOT
+// 立即刷新一次屏幕（不等下一个整秒），用于启动后第一帧 CO2
+static void requestRender() {
+#if DUAL_CORE
+  if (displayQueue.push(sensorStage) && renderTaskHandle) xTaskNotifyGive(renderTaskHandle);
+#else
+  sched.reschedule(renderTaskId, millis());
+#endif
+}
+#endif
+
+// 每 20 ms：读取 CO2 串口字节并解析帧（硬件 FIFO + 驱动缓冲足够容纳两次轮询间的数据）
+static void taskUart(void *, uint32_t) {
+  latUartLate.record((millis() - sched.nextDue(uartTaskId)) * 1000);
+  size_t beforeLen = co2Parser.len;
+#ifdef TRACE_RECORD
+  uint8_t rxTrace[TRACE_MAX_PAYLOAD];
+  uint8_t rxTraceLen = 0;
+#endif
+  
+  while (co2Serial.available()) {
+    uint8_t b = (uint8_t)co2Serial.read();
+    co2Parser.push(b);
+    lastByteMillis = millis();
+#ifdef TRACE_RECORD
+    rxTrace[rxTraceLen++] = b;
+    if (rxTraceLen == TRACE_MAX_PAYLOAD) { traceEmit(TRACE_UART, lastByteMillis, rxTrace, rxTraceLen); rxTraceLen = 0; }
+#endif
+  }
+#ifdef TRACE_RECORD
+  if (rxTraceLen) traceEmit(TRACE_UART, lastByteMillis, rxTrace, rxTraceLen);
+#endif
+  
+  size_t co2BufLen = co2Parser.len;
+  const uint8_t *co2Buf = co2Parser.buf;
+  if (LOG_ENABLED(LOG_LEVEL_DEBUG) && co2BufLen != beforeLen) {
+    char hex[3 * 16 + 1];
+    logHex(hex, sizeof(hex), co2Buf, co2BufLen < 16 ? co2BufLen : 16);
+    LOGD("Passive CO2 bytes received: +%u total=%u", (unsigned)(co2BufLen - beforeLen), (unsigned)co2BufLen);
+    LOGD("Buf head: %s", hex);
+  }
+  
+  processCo2Buffer();
+#if FAST_BOOT
+  if ((sensorStage.flags & SNAP_CO2_VALID) && bootTimeline.find("first-co2") < 0) {
+    bootTimeline.mark("first-co2", micros());
+    requestRender();
+  }
+#endif
+
+#if LOW_POWER
+  // 本秒的帧已取走：下次轮询推迟到下一帧窗口，中间的空隙留给 light sleep
+  uint32_t now = millis();
+  uint32_t wait = co2Predictor.msUntilWindow(now);
+  if (co2Parser.len == 0 && wait > 20) sched.reschedule(uartTaskId, now + wait);
+#endif
+}
+
+// 每秒：读取 DHT，更新流水线，写入历史与闪存日志
+static void taskSensors(void *, uint32_t now) {
+  if (wallClock.tick(now)) {
+    char date[11];
+    wallFormatDate(date, wallClock.day());
+    sensorStage.day = wallClock.day();
+    LOGI("Date rollover -> %s", date);
+  }
+#ifndef TELEMETRY_BINARY
+  LOGI("CO2 value: %lu", (unsigned long)sensorStage.co2);
+#endif
+
+  // 读取DHT传感器数据
+  uint32_t dht0 = latNowUs();
+  float h = dht.readHumidity();
+  float t = dht.readTemperature();
+  latDht.since(dht0);
+#ifdef TRACE_RECORD
+  float th[2] = { t, h };
+  traceEmit(TRACE_DHT, now, th, sizeof(th));
+#endif
+
+  if (isnan(t) || isnan(h)) LOGW("DHT read -> t=%.2f h=%.2f (NaN)", t, h);
+#ifndef TELEMETRY_BINARY
+  else LOGI("DHT read -> t=%.2f h=%.2f", t, h);
+#endif
+
+  // 无效读数（NaN/超范围）被流水线丢弃，沿用上一次滤波值
+  bool dhtOk = samplePipeline.pushDht(t, h, now);
+  samplePipeline.tick(now);
+  const SampleAggregates &agg = samplePipeline.aggregates();
+  if (agg.temp.valid) { sensorStage.temp = SamplePipeline::fromFixed(agg.temp.last); sensorStage.flags |= SNAP_TEMP_VALID; }
+  if (agg.hum.valid) { sensorStage.hum = SamplePipeline::fromFixed(agg.hum.last); sensorStage.flags |= SNAP_HUM_VALID; }
+  if (dhtOk) sensorStage.dhtMs = now;
+  sensorStage.co2Mean1m = agg.co2.w1m.mean;
+  sensorStage.dhtRejected = agg.dhtRejected;
+  publishSnapshot(now);
+
+#ifdef TELEMETRY_BINARY
+  TlmSample ts;
+  ts.ms = now;
+  ts.co2 = (uint16_t)agg.co2.last;
+  ts.temp = (int16_t)agg.temp.last;
+  ts.hum = (uint16_t)agg.hum.last;
+  ts.co2Mean1m = (uint16_t)agg.co2.w1m.mean;
+  ts.flags = (agg.co2.valid ? TLM_SAMPLE_CO2_VALID : 0) | (agg.temp.valid ? TLM_SAMPLE_TEMP_VALID : 0) |
+             (agg.hum.valid ? TLM_SAMPLE_HUM_VALID : 0);
+  tlmEmit(LOG_LEVEL_INFO, TLM_SAMPLE, &ts, sizeof(ts));
+#else
+  LOGI("Using values -> Temp=%.2f Hum=%.2f CO2 1m/1h/24h mean=%ld/%ld/%ld rejected co2=%lu dht=%lu",
+       sensorStage.temp, sensorStage.hum, (long)agg.co2.w1m.mean, (long)agg.co2.w1h.mean, (long)agg.co2.w24h.mean,
+       (unsigned long)agg.co2Rejected, (unsigned long)agg.dhtRejected);
+#endif
+
+  // 历史与日志按开机秒数（跨 millis 回绕单调）计时，同一样本取同一时刻
+  const uint32_t upS = uptimeSec();
+  if (historyOk && agg.co2.valid && agg.temp.valid && agg.hum.valid) {
+    history.insert(upS, (uint16_t)agg.co2.last, (int16_t)agg.temp.last, (uint16_t)agg.hum.last);
+  }
+  if (flashLogOk && agg.co2.valid && agg.temp.valid && agg.hum.valid) {
+    uint32_t logT = logTimeBase + upS;
+    TelemetrySample s = { logT, (uint16_t)agg.co2.last, (int16_t)agg.temp.last, (uint16_t)agg.hum.last };
+    flashLog.append(s);
+    flashLog.flushIfOlder(logT, FLASH_LOG_FLUSH_SEC);
+  }
+  if ((historyOk || flashLogOk) && agg.co2.valid && agg.temp.valid && agg.hum.valid) lastSampleT = logTimeBase + upS;
+
+#if DUAL_CORE
+  if (displayQueue.push(sensorStage) && renderTaskHandle) xTaskNotifyGive(renderTaskHandle);
+#endif
+}
+
+#if LOW_POWER
+// 面板命令走 SPI，只在渲染侧调用
+static void applyPanelLevel(uint8_t lv) {
+  if (lv == panelLevel) return;
+  panelLevel = lv;
+  if (lv == PANEL_DIM) {
+    tft.setBrightness(PANEL_DIM_BRIGHTNESS);
+    tft.powerSave(3);        // 正常/空闲模式都开省电
+    tft.idleDisplay(true);   // 8 色空闲模式
+    panelDimCount = panelDimCount + 1;
+  } else {
+    tft.idleDisplay(false);
+    tft.powerSave(0);
+    tft.setBrightness(255);
+  }
+}
+#endif
+
+static void renderSample(const SensorSnapshot &s) {
+#if LOW_POWER
+  // 读数变化时先恢复全亮再画，变化不会以降功耗的画面出现
+  applyPanelLevel(panelPolicy.update(s, s.ms));
+#endif
+  // 使用新的显示更新函数（自动处理位级更新）
+  uint32_t t0 = latNowUs();
+#if FAST_BOOT
+  retainedDisplay.magic = 0;   // 刷新途中复位时屏上内容与记录不符，先作废
+#endif
+  DisplayFrameCost fc = updateDisplay(s.day, s.co2, s.temp, s.hum);
+#if FAST_BOOT
+  displayRetain(retainedDisplay, displaySig);
+#endif
+  latDisplay.since(t0);
+  if (!firstRenderUs.load(std::memory_order_relaxed) && (s.flags & SNAP_CO2_VALID))
+    firstRenderUs.store(micros(), std::memory_order_relaxed);
+  if (LOG_ENABLED(LOG_LEVEL_DEBUG) && fc.total.calls) {
+    char line[LOG_SLOT_TEXT - 16];
+    displayFrameCostLine(line, sizeof(line), fc);
+    LOGD("Render %s", line);
+  }
+}
+
+#if !DUAL_CORE
+// 每秒：刷新屏幕，相位排在 taskSensors 之后
+static void taskRender(void *, uint32_t) {
+  SensorSnapshot s;
+  sensorSnapshot.read(s);
+  renderSample(s);
+}
+#endif
+
+#if MQTT_BATCH
+static void taskMqtt(void *, uint32_t now) {
+  if (WiFi.status() != WL_CONNECTED) return;
+  mqttPublisher.tick(now, lastSampleT);
+  mqttCursorKeep[1] = mqttPublisher.cursor();
+}
+
+// 心跳里按 INFO 输出，串口 "mqtt" 命令按 ERROR（总是输出）
+static void logMqttStats(uint8_t level) {
+  if (!LOG_ENABLED(level)) return;
+  const MqttBatchStats &ms = mqttPublisher.stats();
+  const MqttClientStats &cs = mqttClient.stats();
+  const MqttBatchConfig &mc = mqttPublisher.config();
+  deferredLog.printf(level,
+                     "MQTT %s batches=%lu samples=%lu payload=%lluB backlog=%lus peak=%lus resends=%lu skipped=%lus "
+                     "connects=%lu failures=%lu interval=%lums batch=%u drain=%lums",
+                     mqttClient.connected() ? "up" : "down", (unsigned long)ms.batches, (unsigned long)ms.samples,
+                     (unsigned long long)ms.payloadBytes, (unsigned long)ms.backlogSec, (unsigned long)ms.peakBacklogSec,
+                     (unsigned long)ms.resends, (unsigned long)ms.skippedSec, (unsigned long)cs.connects,
+                     (unsigned long)cs.failures, (unsigned long)mc.batchIntervalMs, (unsigned)mc.batchMax,
+                     (unsigned long)mc.drainIntervalMs);
+}
+#endif
+
+#ifdef TELEMETRY_BINARY
+// loop() 中任务执行耗时（不含空闲等待），由 taskTiming 每 TLM_TIMING_PERIOD_MS 发送并清零
+static uint32_t loops = 0, loopMaxUs = 0;
+static uint64_t loopSumUs = 0;
+
+static void taskTiming(void *, uint32_t now) {
+  const SampleAggregates &agg = samplePipeline.aggregates();
+  TlmTiming tt;
+  tt.ms = now;
+  tt.loops = loops;
+  tt.loopMaxUs = loopMaxUs;
+  tt.loopMeanUs = loops ? (uint32_t)(loopSumUs / loops) : 0;
+  tt.co2Accepted = agg.co2Accepted;
+  tt.co2Rejected = agg.co2Rejected;
+  tt.dhtRejected = agg.dhtRejected;
+  tt.logDropped = deferredLog.getStats().dropped;
+  tlmEmit(LOG_LEVEL_INFO, TLM_TIMING, &tt, sizeof(tt));
+  loops = 0; loopMaxUs = 0; loopSumUs = 0;
+}
+#else
+static void taskHeartbeat(void *, uint32_t now) {
+#if LOG_ENABLED(LOG_LEVEL_INFO)
+  DeferredLogStats ls = deferredLog.getStats();
+  LOGI("Heartbeat @%lu log dropped=%lu peak=%lu sched misses=%lu snapshot v=%lu retries=%lu", (unsigned long)now,
+       (unsigned long)ls.dropped, (unsigned long)ls.highWater, (unsigned long)sched.totalMisses(),
+       (unsigned long)sensorSnapshot.version(), (unsigned long)sensorSnapshot.readRetries());
+#if DUAL_CORE
+  LOGI("Display queue overflow=%lu coalesced=%lu", (unsigned long)displayQueue.overflows(),
+       (unsigned long)displayQueue.coalescedCount());
+#endif
+#if METRICS_HTTP
+  const MetricsServerStats &hs = metricsServer.stats();
+  LOGI("HTTP served=%lu busy=%lu 404=%lu timeouts=%lu rebuilds=%lu peak clients=%u", (unsigned long)hs.served,
+       (unsigned long)hs.busy, (unsigned long)hs.notFound, (unsigned long)hs.timeouts, (unsigned long)hs.rebuilds,
+       (unsigned)hs.peakClients);
+#endif
+#else
+  (void)now;
+#endif
+#if MQTT_BATCH
+  logMqttStats(LOG_LEVEL_INFO);
+#endif
+}
+#endif
+
+#if METRICS_HTTP
+// 快照版本变化时发布一次（服务器只在这时格式化），然后处理监听与连接；Wi-Fi 连上后才开始监听
+static void taskHttp(void *, uint32_t now) {
+  if (!metricsServer.listening()) {
+    if (WiFi.status() != WL_CONNECTED) return;
+    if (!metricsServer.begin(METRICS_HTTP_PORT)) { LOGW("Metrics server listen failed"); return; }
+    LOGI("Metrics at http://%s/metrics", WiFi.localIP().toString().c_str());
+  }
+  const SampleAggregates &agg = samplePipeline.aggregates();
+  MetricsSample m;
+  m.version = sensorSnapshot.version();
+  m.co2 = sensorStage.co2;
+  m.temp = sensorStage.temp;
+  m.hum = sensorStage.hum;
+  m.flags = sensorStage.flags;
+  m.co2Mean1m = agg.co2.w1m.mean;
+  m.co2Mean1h = agg.co2.w1h.mean;
+  m.co2Mean24h = agg.co2.w24h.mean;
+  m.co2Min1h = agg.co2.w1h.min;
+  m.co2Max1h = agg.co2.w1h.max;
+  m.co2Accepted = agg.co2Accepted;
+  m.co2Rejected = agg.co2Rejected;
+  m.dhtRejected = agg.dhtRejected;
+  m.uptimeS = uptimeSec();
+  m.bootCount = bootCount;
+  m.epoch = wallClock.epoch();
+  metricsServer.publish(m);
+  metricsServer.poll(now);
+}
+#endif
+
+#if LOW_POWER
+static void taskPower(void *, uint32_t) {
+  uint32_t nowUs = micros();
+  uint32_t pm = powerStats.awakePermille(nowUs);
+  LOGI("Power: awake=%lu.%lu%% sleeps=%lu wake timer/uart/other=%lu/%lu/%lu wake latency mean=%luus max=%luus",
+       (unsigned long)(pm / 10), (unsigned long)(pm % 10), (unsigned long)powerStats.sleeps,
+       (unsigned long)powerStats.wakes[POWER_WAKE_TIMER], (unsigned long)powerStats.wakes[POWER_WAKE_UART],
+       (unsigned long)powerStats.wakes[POWER_WAKE_OTHER], (unsigned long)powerStats.latMeanUs(),
+       (unsigned long)powerStats.latMaxUs);
+  LOGI("Power: co2 frames=%lu lost=%lu period=%lums guard=%lums panel=%s dims=%lu",
+       (unsigned long)co2Predictor.framesSeen(), (unsigned long)co2Predictor.framesLost(),
+       (unsigned long)co2Predictor.period(), (unsigned long)co2Predictor.guard(),
+       panelLevel == PANEL_DIM ? "dim" : "full", (unsigned long)panelDimCount);
+  powerStats.reset(nowUs);
+}
+
+// 空闲足够长、未临近 CO2 帧窗口、且渲染与日志都已空闲时进入 light sleep，返回 false 时调用方退回 delay
+static bool idleSleep(uint32_t idleMs) {
+  uint32_t budget = co2Predictor.sleepBudget(idleMs, millis());
+  if (!budget || deferredLog.depth()) return false;
+#if DUAL_CORE
+  if (renderBusy.load() || displayQueue.size()) return false;
+#endif
+  Serial.flush();   // 睡眠期间 UART 时钟停止，先发完已交给驱动的日志
+  uint32_t sleptUs = 0;
+  uint8_t cause = lightSleepFor(budget, sleptUs);
+  powerStats.record(cause, budget * 1000, sleptUs);
+  if (cause == POWER_WAKE_UART) {
+    // 帧比预测早到：这一帧已缺字节，立即恢复轮询并加大提前量
+    co2Predictor.onEarlyArrival();
+    sched.reschedule(uartTaskId, millis());
+  }
+  return true;
+}
+#endif
+
+// 串口命令的回复用 ERROR 级别写入，不受编译期日志级别影响
+static void dumpLatency() {
+  char line[LOG_SLOT_TEXT - 8];
+  for (LatencyHist *h : latHists) {
+    h->summary(line, sizeof(line));
+    deferredLog.printf(LOG_LEVEL_ERROR, "lat %s", line);
+    if (!h->count()) continue;
+    h->bucketLine(line, sizeof(line));
+    deferredLog.printf(LOG_LEVEL_ERROR, "lat %s buckets %s", h->name(), line);
+  }
+}
+
+// 开机以来的屏幕总线开销，按图元与按行；计数由渲染侧累加，这里读到的是近似快照
+static void dumpRenderCost() {
+#if ST7789_STATS
+  char line[LOG_SLOT_TEXT - 24];
+  const ST7789Stats &st = tft.renderStats();
+  displayCostFormat(line, sizeof(line), st.total);
+  deferredLog.printf(LOG_LEVEL_ERROR, "render total %s", line);
+  for (uint8_t p = 0; p < ST_PRIM_COUNT; p++) {
+    if (!st.prim[p].calls) continue;
+    displayCostFormat(line, sizeof(line), st.prim[p]);
+    deferredLog.printf(LOG_LEVEL_ERROR, "render prim %s %s", ST7789_AVR::primName(p), line);
+  }
+  for (uint8_t t = 0; t < DTAG_COUNT; t++) {
+    if (!st.tag[t].calls) continue;
+    displayCostFormat(line, sizeof(line), st.tag[t]);
+    deferredLog.printf(LOG_LEVEL_ERROR, "render row %s %s", displayTagName(t), line);
+  }
+#endif
+}
+
+// 每 100 ms：处理串口命令
+static void taskConsole(void *, uint32_t now) {
+  if (!console.poll(Serial)) return;
+  if (console.is("stats")) {
+    if (!strcmp(console.arg(), "reset")) {
+      for (LatencyHist *h : latHists) h->reset();
+      deferredLog.printf(LOG_LEVEL_ERROR, "stats cleared");
+    } else if (!strcmp(console.arg(), "render")) {
+      dumpRenderCost();
+    } else {
+      dumpLatency();
+    }
+  } else if (console.is("time")) {
+    // "time <秒>"：设置本地时间（自 1970-01-01 00:00:00 的秒数）；不带参数时只显示
+    if (*console.arg()) wallClock.set((uint32_t)strtoul(console.arg(), nullptr, 10), now);
+    char date[11];
+    uint32_t sod = wallClock.secondOfDay();
+    wallFormatDate(date, (int32_t)(wallClock.epoch() / WALL_SECS_PER_DAY));
+    deferredLog.printf(LOG_LEVEL_ERROR, "time %s %02lu:%02lu:%02lu epoch=%lu source=%s rollovers=%lu", date,
+                       (unsigned long)(sod / 3600), (unsigned long)(sod / 60 % 60), (unsigned long)(sod % 60),
+                       (unsigned long)wallClock.epoch(), WallClock::sourceName(wallClock.source()),
+                       (unsigned long)wallClock.rollovers());
+  } else if (console.is("data")) {
+    // 滚动统计、历史与闪存日志的进度：日志只回读最近 10 秒，条数应与秒数相符
+    const SampleAggregates &agg = samplePipeline.aggregates();
+    uint32_t logT = flashLogOk ? flashLog.lastTime() : 0;
+    TelemetrySample tail[16];
+    size_t tailN = logT >= 9 ? flashLog.read(logT - 9, logT, tail, 16) : 0;
+    deferredLog.printf(LOG_LEVEL_ERROR, "data co2 1m n=%lu mean=%ld 1h n=%lu mean=%ld hist t=%lu n=%lu log t=%lu n10=%u",
+                       (unsigned long)agg.co2.w1m.count, (long)agg.co2.w1m.mean, (unsigned long)agg.co2.w1h.count,
+                       (long)agg.co2.w1h.mean, (unsigned long)(historyOk ? history.lastTime() : 0),
+                       (unsigned long)(historyOk ? history.insertCount() : 0), (unsigned long)logT, (unsigned)tailN);
+#if MQTT_BATCH
+  } else if (console.is("mqtt")) {
+    // "mqtt interval|batch|drain <值>" 在线调整；不带参数只显示
+    char key[12];
+    unsigned long v = 0;
+    if (sscanf(console.arg(), "%11s %lu", key, &v) == 2) {
+      MqttBatchConfig mc = mqttPublisher.config();
+      if (!strcmp(key, "interval") && v >= 1000) mc.batchIntervalMs = v;
+      else if (!strcmp(key, "batch")) mc.batchMax = (uint16_t)v;
+      else if (!strcmp(key, "drain") && v >= 100) mc.drainIntervalMs = v;
+      mqttPublisher.setConfig(mc);
+    }
+    logMqttStats(LOG_LEVEL_ERROR);
+#endif
+  } else {
+    deferredLog.printf(LOG_LEVEL_ERROR, "commands: stats | stats render | stats reset | time [epoch] | data%s",
+                       MQTT_BATCH ? " | mqtt [interval|batch|drain <n>]" : "");
+  }
+}
+
+// 一轮调度：执行到期任务，然后睡到下一个任务到期
+static void schedulerPass() {
+#ifdef TELEMETRY_BINARY
+  uint32_t loopStartUs = micros();
+#endif
+  uint32_t t0 = latNowUs();
+  if (sched.runDue(millis())) latLoop.since(t0);
+#ifdef TELEMETRY_BINARY
+  uint32_t loopUs = micros() - loopStartUs;
+  loops++;
+  loopSumUs += loopUs;
+  if (loopUs > loopMaxUs) loopMaxUs = loopUs;
+#endif
+
+  // 空闲：睡到下一个任务到期（delay 让出 CPU，FreeRTOS 空闲任务可进入省电）
+  uint32_t idleMs = sched.msUntilNext(millis());
+#if LOW_POWER
+  if (idleSleep(idleMs)) return;
+#endif
+  if (idleMs) delay(idleMs);
+}
+
+#if DUAL_CORE
+static void ingestTaskMain(void *) {
+  for (;;) schedulerPass();
+}
+
+// 渲染任务：等采集侧通知，只画队列里最新的一份（积压时合并，计入 coalesced）
+static void renderTaskMain(void *) {
+  for (;;) {
+    ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+#if LOW_POWER
+    renderBusy = true;   // 先于出队置位：采集侧看到队列已空时，忙标志一定已经生效
+#endif
+    SensorSnapshot s;
+    if (displayQueue.popLatest(s)) renderSample(s);
+#if LOW_POWER
+    renderBusy = false;
+#endif
+  }
+}
+#endif
+
+#if FAST_BOOT
+// 只有 MCU 单独复位时面板才一直带电、屏上内容还在；上电/掉电复位一律按冷启动处理
+static bool warmReset(esp_reset_reason_t rr) {
+  return bootCount > 1 && (rr == ESP_RST_SW || rr == ESP_RST_PANIC || rr == ESP_RST_INT_WDT ||
+                           rr == ESP_RST_TASK_WDT || rr == ESP_RST_WDT);
+}
+
+// 首次画出真实 CO2 读数后（或超时）输出一次启动时间线，然后注销自己
+static int bootReportId = -1;
+static void taskBootReport(void *, uint32_t now) {
+  uint32_t renderUs = firstRenderUs.load(std::memory_order_relaxed);
+  if (!renderUs && now < BOOT_REPORT_MAX_MS) return;
+  if (renderUs) bootTimeline.mark("first-render", renderUs);
+  else bootTimeline.mark("timeout", micros());
+#if LOG_ENABLED(LOG_LEVEL_INFO)
+  LOGI("Boot timeline (%u marks):", (unsigned)bootTimeline.count());
+  bootTimeline.forEachLine([](const char *line) { LOGI("  %s", line); });
+#endif
+  sched.cancel(bootReportId);
+}
+#endif
+
+// 初始化 DHT 与 CO2 串口
+static void initSensors() {
+  dht.begin();
+  co2Serial.begin(9600, SERIAL_8N1, CO2_UART_RX, CO2_UART_TX);
+  LOGI("CO2 UART(%d) fixed RX=%d TX=%d @9600 passive frames", CO2_UART_NUM, CO2_UART_RX, CO2_UART_TX);
+}
+
+// 初始化历史环形缓冲与闪存日志
+static void initStorage() {
+  historyOk = history.begin();
+  LOGI("History store %s%lu bytes", historyOk ? "ok " : "alloc FAILED ", (unsigned long)HistoryStore::memoryBytes());
+
+  flashLogOk = sampleFlash.begin() && flashLog.begin(&sampleFlash);
+  if (flashLogOk) logTimeBase = flashLog.lastTime() + 1;
+  if (flashLogOk) {
+    LOGI("Flash log ok segments=%lu recovered=%lu%s", (unsigned long)flashLog.segments(),
+         (unsigned long)flashLog.getStats().recoveredRecords, flashLog.getStats().tailDirty ? " (torn tail skipped)" : "");
+  } else {
+    LOGW("Flash log unavailable");
   }
 }
 
 void setup() {
   bootCount++;
+  bootTimeline.mark("setup", micros());
   Serial.begin(9600);
+#if !FAST_BOOT
   delay(200);
-  Serial.print("Serial started @9600, bootCount="); Serial.println(bootCount);
+#endif
+  deferredLogStart(timedSerial);
+  LOGI("Serial started @9600, bootCount=%lu", (unsigned long)bootCount);
   
   esp_reset_reason_t rr = esp_reset_reason();
-  Serial.print("Reset reason: "); Serial.println((int)rr);
+  LOGI("Reset reason: %d", (int)rr);
+  bootTimeline.mark("serial", micros());
 
   #ifdef SERIAL_TEST
-  Serial.println("SERIAL_TEST is enabled.");
+  LOGI("SERIAL_TEST is enabled.");
   #endif
 
   // SPI初始化
   SPI.begin(18, -1, 15, PIN_CS);
 
+  wallClock.begin(&wallClockKeep, millis());
+  sensorStage.day = wallClock.day();
+  publishSnapshot(millis());
+  char currentDate[11];
+  wallFormatDate(currentDate, wallClock.day());
+  LOGI("Clock %s (%s)", currentDate, WallClock::sourceName(wallClock.source()));
+#if FAST_BOOT
+  // 面板复位后要等 120 ms 才能退出睡眠：先发起异步初始化，等待期间初始化传感器与存储
+  bool warm = warmReset(rr);
+  tft.initAsync(172, 320, warm);
+  bootTimeline.mark("panel-start", micros());
+  initSensors();
+  bootTimeline.mark("sensors", micros());
+  tft.initPoll();
+  initStorage();
+  bootTimeline.mark("storage", micros());
+  while (!tft.initPoll()) delay(1);
+  tft.setRotation(3);  // 上下颠倒
+  bootTimeline.mark("panel-ready", micros());
+#ifdef HOTPATH_BENCH
+  runHotpathBench();
+  warm = false;   // 屏上内容已被基准覆盖
+#endif
+
+  // 热复位且 RTC 中的屏幕记录与当前布局/固件一致：屏上已是完整布局，只同步差分状态
+  displaySig = displayLayoutSig(__DATE__ " " __TIME__);
+  bool kept = warm && displayRestore(retainedDisplay, displaySig);
+  if (!kept) initDisplayLayout(wallClock.day());
+  bootTimeline.mark(kept ? "layout-kept" : "layout", micros());
+  LOGI("TFT %s init, layout %s, boot millis=%lu", warm ? "warm" : "cold", kept ? "kept" : "drawn",
+       (unsigned long)millis());
+#else
   tft.init(172, 320);
   tft.setRotation(3);  // 上下颠倒
-  Serial.println("TFT initialized");
-  Serial.print("Boot millis= "); Serial.println(millis());
+#ifdef HOTPATH_BENCH
+  runHotpathBench();
+#endif
+  LOGI("TFT initialized");
+  LOGI("Boot millis= %lu", (unsigned long)millis());
   
   // 使用新的显示初始化函数
-  String currentDate = formatDate();
-  initDisplayLayout(currentDate);
-  
-  delay(3500);
+  initDisplayLayout(wallClock.day());
+#endif
+#if ST7789_LINEBUF
+  // 行缓冲内核在 tft 初始化时已与标量参考逐位比对，不一致的向量路径会退回 SWAR
+  LOGI("Pixel kernels: %s", rgb565ImplName(rgb565GetImpl()));
+#endif
+#ifdef TRACE_RECORD
+  TraceBoot tb;
+  tb.bootCount = bootCount;
+  tb.resetReason = (uint8_t)rr;
+  memcpy(tb.date, currentDate, sizeof(tb.date));
+  traceEmit(TRACE_BOOT, millis(), &tb, sizeof(tb));
+#endif
 
-  // 初始化传感器
-  dht.begin();
-  co2Serial.begin(9600, SERIAL_8N1, CO2_UART_RX, CO2_UART_TX);
-  
-  Serial.print("CO2 UART(0) fixed RX="); Serial.print(CO2_UART_RX);
-  Serial.print(" TX="); Serial.print(CO2_UART_TX);
-  Serial.println(" @9600 passive frames");
-}
-
-void loop() {
-  // 处理CO2串口数据
-  static size_t lastReportedCo2BufLen = 0;
-  size_t beforeLen = co2BufLen;
-  
-  while (co2Serial.available()) {
-    uint8_t b = (uint8_t)co2Serial.read();
-    if (co2BufLen < sizeof(co2Buf)) co2Buf[co2BufLen++] = b;
-    lastByteMillis = millis();
-  }
-  
-  if (co2BufLen != beforeLen) {
-    Serial.print("Passive CO2 bytes received: +"); Serial.print(co2BufLen - beforeLen);
-    Serial.print(" total="); Serial.println(co2BufLen);
-    size_t dumpN = co2BufLen < 16 ? co2BufLen : 16;
-    Serial.print("Buf head: ");
-    for (size_t z = 0; z < dumpN; z++) {
-      if (co2Buf[z] < 16) Serial.print('0');
-      Serial.print(co2Buf[z], HEX);
-      Serial.print(' ');
-    }
-    Serial.println();
-    lastReportedCo2BufLen = co2BufLen;
-  }
-  
-  processCo2Buffer();
+#if !FAST_BOOT
+  delay(3500);
+  initStorage();
+  initSensors();
+#endif
 
   uint32_t now = millis();
-  static uint32_t lastHeartbeat = 0;
-  if (now - lastHeartbeat > 2000) {
-    lastHeartbeat = now;
-    Serial.print("Heartbeat @"); Serial.println(now);
+  uartTaskId = sched.addPeriodic("uart", 20, taskUart, nullptr, now);
+  sched.addPeriodic("console", 100, taskConsole, nullptr, now, 50);
+#if FAST_BOOT
+  // DHT22 上电 1 s 内不响应：冷启动按开机时间等到就绪，热复位时传感器一直带电，立即读
+  uint32_t dhtPhase = warm || now >= DHT_POWERUP_MS ? 0 : DHT_POWERUP_MS - now;
+  sched.addPeriodic("sensors", 1000, taskSensors, nullptr, now, dhtPhase);
+  bootReportId = sched.addPeriodic("boot", 50, taskBootReport, nullptr, now, 50);
+#else
+  sched.addPeriodic("sensors", 1000, taskSensors, nullptr, now, 1000);
+#endif
+#if !DUAL_CORE
+  renderTaskId = sched.addPeriodic("render", 1000, taskRender, nullptr, now, 1005);
+#endif
+#ifdef TELEMETRY_BINARY
+  sched.addPeriodic("timing", TLM_TIMING_PERIOD_MS, taskTiming, nullptr, now, TLM_TIMING_PERIOD_MS);
+#else
+  sched.addPeriodic("heartbeat", 2000, taskHeartbeat, nullptr, now, 2000);
+#endif
+#if NET_WIFI
+  WiFi.mode(WIFI_STA);
+  WiFi.begin(WIFI_SSID, WIFI_PASSWORD);   // 不等待：各网络任务在连上后才开始工作
+#endif
+#if METRICS_HTTP
+  sched.addPeriodic("http", METRICS_POLL_MS, taskHttp, nullptr, now, 10);
+#endif
+#if MQTT_BATCH
+  {
+    // 冷启动只上报本次开机之后的样本；热复位从保留的游标继续补发
+    bool keep = mqttCursorKeep[0] == MQTT_CURSOR_MAGIC && mqttCursorKeep[1] < logTimeBase;
+    uint32_t cursor = keep ? mqttCursorKeep[1] : (logTimeBase ? logTimeBase - 1 : 0);
+    mqttCursorKeep[0] = MQTT_CURSOR_MAGIC;
+    mqttCursorKeep[1] = cursor;
+    MqttBatchConfig mc;
+    mc.batchIntervalMs = MQTT_BATCH_INTERVAL_MS;
+    mc.batchMax = MQTT_BATCH_SIZE;
+    mc.drainIntervalMs = MQTT_DRAIN_INTERVAL_MS;
+    snprintf(mqttTopic, sizeof(mqttTopic), "airmon/%s/batch", MQTT_CLIENT_ID);
+#if defined(MQTT_USER) && defined(MQTT_PASSWORD)
+    mqttClient.configure(MQTT_BROKER_HOST, MQTT_BROKER_PORT, MQTT_CLIENT_ID, MQTT_USER, MQTT_PASSWORD);
+#else
+    mqttClient.configure(MQTT_BROKER_HOST, MQTT_BROKER_PORT, MQTT_CLIENT_ID);
+#endif
+    mqttPublisher.begin(mqttTopic, cursor, mc);
+    LOGI("MQTT %s:%d topic %s cursor=%lu (%s)", MQTT_BROKER_HOST, MQTT_BROKER_PORT, mqttTopic, (unsigned long)cursor,
+         keep ? "resumed" : "from boot");
+    sched.addPeriodic("mqtt", MQTT_POLL_MS, taskMqtt, nullptr, now, 30);
   }
-  
-  // 每秒更新显示
-  if (now - lastUpdateMs > 1000) {
-    lastUpdateMs = now;
-    
-    Serial.print("CO2 value: "); Serial.println(co2ppm);
-
-    // 读取DHT传感器数据
-    float h = dht.readHumidity();
-    float t = dht.readTemperature();
-
-    Serial.print("DHT read -> t="); Serial.print(t);
-    Serial.print(" h="); Serial.print(h);
-    if (isnan(t) || isnan(h)) Serial.println(" (NaN)"); else Serial.println();
+#endif
+#if LOW_POWER
+  lightSleepInit(CO2_UART_NUM);
+  powerStats.reset(micros());
+  sched.addPeriodic("power", POWER_REPORT_PERIOD_MS, taskPower, nullptr, now, POWER_REPORT_PERIOD_MS);
+#endif
 
-    if (!isnan(t)) temperatureC = t;
-    if (!isnan(h)) humidityPct = h;
+  bootTimeline.mark("sched", micros());   // 之后时间线只由采集侧写
 
-    Serial.print("Using values -> Temp="); Serial.print(temperatureC);
-    Serial.print(" Hum="); Serial.println(humidityPct);
+#if DUAL_CORE
+  // 渲染先于采集创建，保证第一次通知时句柄有效；采集优先级高于 core 0 上的日志任务
+  xTaskCreatePinnedToCore(renderTaskMain, "render", 6144, nullptr, 1, &renderTaskHandle, 1);
+  xTaskCreatePinnedToCore(ingestTaskMain, "ingest", 6144, nullptr, 3, nullptr, 0);
+#endif
+}
 
-    // 使用新的显示更新函数（自动处理位级更新）
-    String currentDate = formatDate();
-    updateDisplay(currentDate, co2ppm, temperatureC, humidityPct);
+void loop() {
+#if DUAL_CORE
+  // 工作都在两个固定核心的任务里，loopTask 不再需要
+  vTaskDelete(NULL);
+#else
+  schedulerPass();
+#endif
+}
 
-  }
-}
\ No newline at end of file